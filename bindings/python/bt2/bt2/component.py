@@ -627,6 +627,21 @@ class _UserComponent(metaclass=_UserComponentType):
             if not _NO_PRINT_TRACEBACK:
                 traceback.print_exc()
 
+    # Creates a message iterator on one of this component's input
+    # ports.
+    #
+    # Iterating the returned iterator gets the messages from the
+    # upstream component in batches: one native call per batch of
+    # messages instead of one per message.
+    def _create_input_port_message_iterator(self, input_port):
+        utils._check_type(input_port, bt2.port._PrivateInputPort)
+        msg_iter_ptr = native_bt.self_component_port_input_message_iterator_create(input_port._ptr)
+
+        if msg_iter_ptr is None:
+            raise bt2.CreationError('cannot create message iterator object')
+
+        return bt2.message_iterator._UserComponentInputPortMessageIterator._create_from_ptr(msg_iter_ptr)
+
 
 class _UserSourceComponent(_UserComponent, _SourceComponent):
     _as_not_self_specific_component_ptr = staticmethod(native_bt.self_component_source_as_component_source)
@@ -54,7 +54,8 @@ def _msg_types_from_msg_classes(message_types):
 
 
 class _Message(object._SharedObject):
-    pass
+    _get_ref = staticmethod(native_bt.message_get_ref)
+    _put_ref = staticmethod(native_bt.message_put_ref)
 
 
 class _CopyableMessage(_Message):
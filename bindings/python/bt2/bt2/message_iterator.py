@@ -29,14 +29,12 @@ import bt2
 
 class _MessageIterator(collections.abc.Iterator):
     def _handle_status(self, status, gen_error_msg):
-        if status == native_bt.MESSAGE_ITERATOR_STATUS_CANCELED:
-            raise bt2.MessageIteratorCanceled
-        elif status == native_bt.MESSAGE_ITERATOR_STATUS_AGAIN:
+        if status == native_bt.MESSAGE_ITERATOR_STATUS_AGAIN:
             raise bt2.TryAgain
         elif status == native_bt.MESSAGE_ITERATOR_STATUS_END:
             raise bt2.Stop
-        elif status == native_bt.MESSAGE_ITERATOR_STATUS_UNSUPPORTED:
-            raise bt2.UnsupportedFeature
+        elif status == native_bt.MESSAGE_ITERATOR_STATUS_NOMEM:
+            raise MemoryError(gen_error_msg)
         elif status < 0:
             raise bt2.Error(gen_error_msg)
 
@@ -44,20 +42,47 @@ class _MessageIterator(collections.abc.Iterator):
         raise NotImplementedError
 
 
+# Message iterator which gets its messages from a native message
+# iterator.
+#
+# The native "next" method returns a batch of messages: this object
+# gets a whole batch with a single native call and then returns its
+# messages one at a time from __next__() without crossing the native
+# boundary.
 class _GenericMessageIterator(object._SharedObject, _MessageIterator):
-    def _get_msg(self):
-        msg_ptr = native_bt.message_iterator_get_message(self._ptr)
-        utils._handle_ptr(msg_ptr, "cannot get message iterator object's current message object")
-        return bt2.message._create_from_ptr(msg_ptr)
+    # Calls the native "next" method.
+    #
+    # This must be implemented by subclasses: it returns a (status,
+    # list of message pointers) tuple, the list owning one reference
+    # to each message.
+    @staticmethod
+    def _get_msg_range(ptr):
+        raise NotImplementedError
 
-    def _next(self):
-        status = native_bt.message_iterator_next(self._ptr)
+    def _next_batch(self):
+        status, msg_ptrs = self._get_msg_range(self._ptr)
         self._handle_status(status,
                             'unexpected error: cannot advance the message iterator')
+        assert(msg_ptrs)
+        return [bt2.message._create_from_ptr(msg_ptr) for msg_ptr in msg_ptrs]
+
+    @classmethod
+    def _create_from_ptr(cls, ptr_owned):
+        obj = super()._create_from_ptr(ptr_owned)
+        obj._current_msgs = collections.deque()
+        return obj
 
     def __next__(self):
-        self._next()
-        return self._get_msg()
+        if not self._current_msgs:
+            self._current_msgs.extend(self._next_batch())
+
+        return self._current_msgs.popleft()
+
+
+class _UserComponentInputPortMessageIterator(_GenericMessageIterator):
+    _get_ref = staticmethod(native_bt.self_component_port_input_message_iterator_get_ref)
+    _put_ref = staticmethod(native_bt.self_component_port_input_message_iterator_put_ref)
+    _get_msg_range = staticmethod(native_bt.py3_self_component_port_input_get_msg_range)
 
 
 class _PrivateConnectionMessageIterator(_GenericMessageIterator):
@@ -69,7 +94,9 @@ class _PrivateConnectionMessageIterator(_GenericMessageIterator):
 
 
 class _OutputPortMessageIterator(_GenericMessageIterator):
-    pass
+    _get_ref = staticmethod(native_bt.port_output_message_iterator_get_ref)
+    _put_ref = staticmethod(native_bt.port_output_message_iterator_put_ref)
+    _get_msg_range = staticmethod(native_bt.py3_port_output_get_msg_range)
 
 
 class _UserMessageIterator(_MessageIterator):
@@ -86,6 +113,10 @@ class _UserMessageIterator(_MessageIterator):
         # to do in __del__().
         self = super().__new__(cls)
         self._ptr = ptr
+
+        # Messages returned by __next__() which did not fit in the
+        # native message array yet.
+        self._pending_msgs = collections.deque()
         return self
 
     def __init__(self):
@@ -102,20 +133,44 @@ class _UserMessageIterator(_MessageIterator):
     def _finalize(self):
         pass
 
+    # Returns either a single message or a sequence of messages.
+    #
+    # Returning many messages at once is faster: all of them are
+    # transferred to the native message array with a single call
+    # from the native side.
     def __next__(self):
         raise bt2.Stop
 
-    def _next_from_native(self):
+    def _next_from_native(self, capacity):
         # this can raise anything: it's catched by the native part
-        try:
-            msg = next(self)
-        except StopIteration:
-            raise bt2.Stop
-        except:
-            raise
+        if not self._pending_msgs:
+            try:
+                msgs = next(self)
+            except StopIteration:
+                raise bt2.Stop
+            except:
+                raise
+
+            if isinstance(msgs, bt2.message._Message):
+                msgs = (msgs,)
+            else:
+                utils._check_type(msgs, collections.abc.Sequence)
+
+                if len(msgs) == 0:
+                    raise ValueError('__next__() returned an empty sequence of messages')
+
+                for msg in msgs:
+                    utils._check_type(msg, bt2.message._Message)
+
+            self._pending_msgs.extend(msgs)
+
+        msg_addrs = []
+
+        while self._pending_msgs and len(msg_addrs) < capacity:
+            msg = self._pending_msgs.popleft()
 
-        utils._check_type(msg, bt2.message._Message)
+            # take a new reference for the native part
+            msg._get_ref(msg._ptr)
+            msg_addrs.append(int(msg._ptr))
 
-        # take a new reference for the native part
-        msg._get()
-        return int(msg._ptr)
+        return msg_addrs
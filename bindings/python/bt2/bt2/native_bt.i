@@ -35,6 +35,7 @@
 #include <babeltrace/babeltrace.h>
 #include <babeltrace/property.h>
 #include <babeltrace/assert-internal.h>
+#include <inttypes.h>
 
 typedef const uint8_t *bt_uuid;
 %}
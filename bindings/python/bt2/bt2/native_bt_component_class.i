@@ -1493,6 +1493,47 @@ bt_py3_component_class_message_iterator_finalize(
 	Py_DECREF(py_message_iter);
 }
 
+/*
+ * Puts the reference of each native message of which `py_msg_addrs`
+ * contains the address: either a single integer object (PyLong) or a
+ * sequence of them.
+ *
+ * This is used when the object which _next_from_native() returns is
+ * invalid: the references it transferred to the native side must still
+ * be released.
+ */
+static
+void bt_py3_put_msg_addrs(PyObject *py_msg_addrs)
+{
+	Py_ssize_t len;
+	Py_ssize_t i;
+
+	if (PyLong_Check(py_msg_addrs)) {
+		bt_message_put_ref(PyLong_AsVoidPtr(py_msg_addrs));
+		goto end;
+	}
+
+	if (!PySequence_Check(py_msg_addrs)) {
+		goto end;
+	}
+
+	len = PySequence_Size(py_msg_addrs);
+
+	for (i = 0; i < len; i++) {
+		PyObject *py_msg_addr = PySequence_GetItem(py_msg_addrs, i);
+
+		if (py_msg_addr && PyLong_Check(py_msg_addr)) {
+			bt_message_put_ref(PyLong_AsVoidPtr(py_msg_addr));
+		}
+
+		Py_XDECREF(py_msg_addr);
+	}
+
+end:
+	/* Not reported: the caller reports the invalid object itself */
+	PyErr_Clear();
+}
+
 /* Valid for both sources and filters. */
 
 static bt_self_message_iterator_status
@@ -1504,10 +1545,12 @@ bt_py3_component_class_message_iterator_next(
 	bt_self_message_iterator_status status = BT_SELF_MESSAGE_ITERATOR_STATUS_OK;
 	PyObject *py_message_iter = bt_self_message_iterator_get_data(message_iterator);
 	PyObject *py_method_result = NULL;
+	Py_ssize_t len;
+	Py_ssize_t i;
 
 	BT_ASSERT(py_message_iter);
 	py_method_result = PyObject_CallMethod(py_message_iter,
-		"_next_from_native", NULL);
+		"_next_from_native", "K", (unsigned long long) capacity);
 	if (!py_method_result) {
 		status = bt_py3_exc_to_self_message_iterator_status();
 		BT_ASSERT(status != BT_SELF_MESSAGE_ITERATOR_STATUS_OK);
@@ -1515,12 +1558,36 @@ bt_py3_component_class_message_iterator_next(
 	}
 
 	/*
-	 * The returned object, on success, is an integer object
-	 * (PyLong) containing the address of a native message
-	 * object (which is now ours).
+	 * The returned object, on success, is a list of integer objects
+	 * (PyLong), each one containing the address of a native message
+	 * object (which is now ours). This list contains at least one
+	 * and at most `capacity` elements.
 	 */
-	msgs[0] = PyLong_AsVoidPtr(py_method_result);
-	*count = 1;
+	if (!PyList_Check(py_method_result)) {
+		BT_LOGE("User's _next_from_native() method did not return a list: "
+			"py-msg-iter-addr=%p", py_message_iter);
+		bt_py3_put_msg_addrs(py_method_result);
+		status = BT_SELF_MESSAGE_ITERATOR_STATUS_ERROR;
+		goto end;
+	}
+
+	len = PyList_GET_SIZE(py_method_result);
+	if (len < 1 || (uint64_t) len > capacity) {
+		BT_LOGE("User's _next_from_native() method returned an invalid "
+			"number of messages: py-msg-iter-addr=%p, "
+			"count=%zd, capacity=%" PRIu64,
+			py_message_iter, len, capacity);
+		bt_py3_put_msg_addrs(py_method_result);
+		status = BT_SELF_MESSAGE_ITERATOR_STATUS_ERROR;
+		goto end;
+	}
+
+	for (i = 0; i < len; i++) {
+		msgs[i] = PyLong_AsVoidPtr(
+			PyList_GET_ITEM(py_method_result, i));
+	}
+
+	*count = (uint64_t) len;
 
 	/* Clear potential overflow error; should never happen */
 	BT_ASSERT(!PyErr_Occurred());
@@ -0,0 +1,577 @@
+/*
+ * Babeltrace trace converter - plugin manifest cache
+ *
+ * Copyright 2019 - EfficiOS Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#define BT_LOG_TAG "CLI-PLUGIN-CACHE"
+#include "logging.h"
+
+#include <babeltrace/babeltrace.h>
+#include <babeltrace/assert-internal.h>
+#include <babeltrace/common-internal.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <string.h>
+#include <sys/stat.h>
+#include "babeltrace-plugin-cache.h"
+
+#define MANIFEST_DIR_NAME	"babeltrace2"
+#define MANIFEST_FILE_NAME	"plugin-manifest"
+#define MANIFEST_VERSION	1
+#define MANIFEST_INFO_GROUP	"manifest"
+#define MANIFEST_KEY_VERSION	"version"
+#define MANIFEST_KEY_MTIME	"mtime"
+#define MANIFEST_KEY_SIZE	"size"
+#define MANIFEST_KEY_PLUGINS	"plugins"
+
+struct bt_plugin_cache {
+	/*
+	 * Manifest: one group per plugin file path, plus the
+	 * `MANIFEST_INFO_GROUP` group.
+	 */
+	GKeyFile *manifest;
+
+	/* Manifest's path (`NULL` if the manifest is not used) */
+	char *manifest_path;
+
+	/* True if `manifest` changed since it was read */
+	bool manifest_is_dirty;
+
+	/*
+	 * Array of `const char *` (weak, owned by `plugin_paths`):
+	 * known plugin names, in order of priority.
+	 */
+	GPtrArray *plugin_names;
+
+	/*
+	 * Plugin name (`char *`, owned) to the path of the file
+	 * providing this plugin (`char *`, owned), or `NULL` if it's a
+	 * static plugin.
+	 */
+	GHashTable *plugin_paths;
+
+	/*
+	 * Plugin file path (`char *`, owned) to loaded plugin set
+	 * (`const bt_plugin_set *`, owned).
+	 */
+	GHashTable *plugin_sets;
+
+	/* Owned by this */
+	const bt_plugin_set *static_plugin_set;
+};
+
+static
+void put_plugin_set(void *data)
+{
+	bt_plugin_set_put_ref(data);
+}
+
+static
+void reset_manifest(struct bt_plugin_cache *cache)
+{
+	if (cache->manifest) {
+		g_key_file_free(cache->manifest);
+	}
+
+	cache->manifest = g_key_file_new();
+	BT_ASSERT(cache->manifest);
+	g_key_file_set_integer(cache->manifest, MANIFEST_INFO_GROUP,
+		MANIFEST_KEY_VERSION, MANIFEST_VERSION);
+	cache->manifest_is_dirty = true;
+}
+
+static
+void load_manifest(struct bt_plugin_cache *cache)
+{
+	GError *error = NULL;
+	gint version;
+
+	cache->manifest = g_key_file_new();
+	BT_ASSERT(cache->manifest);
+
+	if (!cache->manifest_path) {
+		goto reset;
+	}
+
+	if (!g_key_file_load_from_file(cache->manifest, cache->manifest_path,
+			G_KEY_FILE_NONE, &error)) {
+		BT_LOGD("Cannot read plugin manifest: path=\"%s\", error=\"%s\"",
+			cache->manifest_path, error->message);
+		goto reset;
+	}
+
+	version = g_key_file_get_integer(cache->manifest, MANIFEST_INFO_GROUP,
+		MANIFEST_KEY_VERSION, NULL);
+	if (version != MANIFEST_VERSION) {
+		BT_LOGD("Ignoring plugin manifest with unknown version: "
+			"path=\"%s\", version=%d", cache->manifest_path,
+			version);
+		goto reset;
+	}
+
+	BT_LOGD("Read plugin manifest: path=\"%s\"", cache->manifest_path);
+	cache->manifest_is_dirty = false;
+	goto end;
+
+reset:
+	reset_manifest(cache);
+
+end:
+	if (error) {
+		g_error_free(error);
+	}
+}
+
+/*
+ * Returns whether or not `path` can be a group name of the manifest.
+ */
+static
+bool path_is_manifest_compatible(const char *path)
+{
+	const char *ch;
+
+	for (ch = path; *ch != '\0'; ch++) {
+		if (*ch == '[' || *ch == ']' || g_ascii_iscntrl(*ch)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/*
+ * Returns the plugin names recorded in the manifest for the file
+ * `path`, or `NULL` if there's no entry for this file or if the file
+ * changed since it was recorded. Free the returned value with
+ * g_strfreev().
+ */
+static
+char **get_manifest_plugin_names(struct bt_plugin_cache *cache,
+		const char *path, const struct stat *st)
+{
+	char **names = NULL;
+
+	if (!path_is_manifest_compatible(path) ||
+			!g_key_file_has_group(cache->manifest, path)) {
+		goto end;
+	}
+
+	if (g_key_file_get_int64(cache->manifest, path,
+				MANIFEST_KEY_MTIME, NULL) != (gint64) st->st_mtime ||
+			g_key_file_get_int64(cache->manifest, path,
+				MANIFEST_KEY_SIZE, NULL) != (gint64) st->st_size) {
+		BT_LOGD("Plugin file changed since it was recorded: "
+			"path=\"%s\"", path);
+		goto end;
+	}
+
+	names = g_key_file_get_string_list(cache->manifest, path,
+		MANIFEST_KEY_PLUGINS, NULL, NULL);
+	if (!names) {
+		/* Recorded file without plugins */
+		names = g_new0(char *, 1);
+	}
+
+end:
+	return names;
+}
+
+static
+void set_manifest_plugin_names(struct bt_plugin_cache *cache,
+		const char *path, const struct stat *st,
+		const char * const *names, gsize count)
+{
+	if (!path_is_manifest_compatible(path)) {
+		BT_LOGD("Not recording plugin file in manifest: "
+			"path=\"%s\"", path);
+		return;
+	}
+
+	g_key_file_set_int64(cache->manifest, path, MANIFEST_KEY_MTIME,
+		(gint64) st->st_mtime);
+	g_key_file_set_int64(cache->manifest, path, MANIFEST_KEY_SIZE,
+		(gint64) st->st_size);
+	g_key_file_set_string_list(cache->manifest, path,
+		MANIFEST_KEY_PLUGINS, names, count);
+	cache->manifest_is_dirty = true;
+}
+
+static
+void add_plugin_name(struct bt_plugin_cache *cache, const char *name,
+		const char *path)
+{
+	char *name_copy;
+
+	if (g_hash_table_contains(cache->plugin_paths, name)) {
+		BT_LOGI("Not using plugin: another one already exists with the same name: "
+			"plugin-name=\"%s\", plugin-path=\"%s\"", name,
+			path ? path : "(static)");
+		return;
+	}
+
+	name_copy = g_strdup(name);
+	BT_ASSERT(name_copy);
+	g_hash_table_insert(cache->plugin_paths, name_copy,
+		path ? g_strdup(path) : NULL);
+	g_ptr_array_add(cache->plugin_names, name_copy);
+}
+
+static
+void add_plugin_file(struct bt_plugin_cache *cache, const char *path,
+		const struct stat *st)
+{
+	char **names = get_manifest_plugin_names(cache, path, st);
+	char **name;
+
+	if (names && !names[0]) {
+		/*
+		 * Written by a previous version for a file which failed
+		 * to load: try again.
+		 */
+		g_strfreev(names);
+		names = NULL;
+	}
+
+	if (!names) {
+		/* Unknown or changed file: load it to find its plugins */
+		const bt_plugin_set *plugin_set =
+			bt_plugin_find_all_from_file(path);
+		uint64_t count = 0;
+		uint64_t i;
+
+		if (plugin_set) {
+			count = bt_plugin_set_get_plugin_count(plugin_set);
+		}
+
+		names = g_new0(char *, count + 1);
+		BT_ASSERT(names);
+
+		for (i = 0; i < count; i++) {
+			names[i] = g_strdup(bt_plugin_get_name(
+				bt_plugin_set_borrow_plugin_by_index_const(
+					plugin_set, i)));
+		}
+
+		if (plugin_set) {
+			/*
+			 * Only cache the files which load: loading can
+			 * fail because of the environment (for example,
+			 * a missing dependency or disabled Python
+			 * plugins), which can change without the file
+			 * changing.
+			 */
+			set_manifest_plugin_names(cache, path, st,
+				(const char * const *) names, count);
+
+			/* Keep it: it's already loaded */
+			g_hash_table_insert(cache->plugin_sets,
+				g_strdup(path), (void *) plugin_set);
+		} else {
+			BT_LOGD("Not adding plugin file which failed to load "
+				"to manifest: path=\"%s\"", path);
+		}
+	} else {
+		BT_LOGV("Found plugin file in manifest: path=\"%s\"", path);
+	}
+
+	for (name = names; *name; name++) {
+		add_plugin_name(cache, *name, path);
+	}
+
+	g_strfreev(names);
+}
+
+static
+void add_plugin_dir(struct bt_plugin_cache *cache, const char *dir_path)
+{
+	GDir *dir;
+	GError *error = NULL;
+	const char *basename;
+
+	/*
+	 * Skip this if the directory does not exist, like
+	 * bt_plugin_find_all_from_dir() users do.
+	 */
+	if (!g_file_test(dir_path, G_FILE_TEST_IS_DIR)) {
+		BT_LOGV("Skipping nonexistent directory path: "
+			"path=\"%s\"", dir_path);
+		return;
+	}
+
+	dir = g_dir_open(dir_path, 0, &error);
+	if (!dir) {
+		BT_LOGW("Cannot open plugin directory: path=\"%s\", error=\"%s\"",
+			dir_path, error->message);
+		g_error_free(error);
+		return;
+	}
+
+	while ((basename = g_dir_read_name(dir))) {
+		GStatBuf st;
+		char *path;
+
+		if (basename[0] == '.') {
+			/* Skip hidden files */
+			continue;
+		}
+
+		path = g_build_filename(dir_path, basename, NULL);
+		BT_ASSERT(path);
+
+		/*
+		 * Like bt_plugin_find_all_from_dir(), only consider
+		 * regular files, without following symbolic links.
+		 */
+		if (g_lstat(path, &st) == 0 && S_ISREG(st.st_mode)) {
+			add_plugin_file(cache, path, &st);
+		}
+
+		g_free(path);
+	}
+
+	g_dir_close(dir);
+}
+
+static
+void prune_manifest(struct bt_plugin_cache *cache)
+{
+	char **groups = g_key_file_get_groups(cache->manifest, NULL);
+	char **group;
+
+	for (group = groups; *group; group++) {
+		if (strcmp(*group, MANIFEST_INFO_GROUP) == 0) {
+			continue;
+		}
+
+		if (!g_file_test(*group, G_FILE_TEST_EXISTS)) {
+			BT_LOGD("Removing plugin file from manifest: "
+				"path=\"%s\"", *group);
+			g_key_file_remove_group(cache->manifest, *group,
+				NULL);
+		}
+	}
+
+	g_strfreev(groups);
+}
+
+static
+void save_manifest(struct bt_plugin_cache *cache)
+{
+	char *data = NULL;
+	char *dir_path = NULL;
+	GError *error = NULL;
+	gsize size;
+
+	if (!cache->manifest_path || !cache->manifest_is_dirty) {
+		goto end;
+	}
+
+	prune_manifest(cache);
+	dir_path = g_path_get_dirname(cache->manifest_path);
+	if (g_mkdir_with_parents(dir_path, 0700)) {
+		BT_LOGW_ERRNO("Cannot create plugin manifest's directory",
+			": path=\"%s\"", dir_path);
+		goto end;
+	}
+
+	data = g_key_file_to_data(cache->manifest, &size, NULL);
+	BT_ASSERT(data);
+
+	/* This writes a temporary file and renames it */
+	if (!g_file_set_contents(cache->manifest_path, data, size, &error)) {
+		BT_LOGW("Cannot write plugin manifest: path=\"%s\", error=\"%s\"",
+			cache->manifest_path, error->message);
+		goto end;
+	}
+
+	BT_LOGD("Wrote plugin manifest: path=\"%s\"", cache->manifest_path);
+	cache->manifest_is_dirty = false;
+
+end:
+	if (error) {
+		g_error_free(error);
+	}
+
+	g_free(data);
+	g_free(dir_path);
+}
+
+struct bt_plugin_cache *bt_plugin_cache_create(const bt_value *plugin_paths,
+		bool use_manifest)
+{
+	struct bt_plugin_cache *cache = g_new0(struct bt_plugin_cache, 1);
+	uint64_t i;
+
+	if (!cache) {
+		BT_LOGE_STR("Failed to allocate one plugin cache.");
+		goto error;
+	}
+
+	if (use_manifest) {
+		cache->manifest_path = g_build_filename(g_get_user_cache_dir(),
+			MANIFEST_DIR_NAME, MANIFEST_FILE_NAME, NULL);
+		BT_ASSERT(cache->manifest_path);
+	}
+
+	load_manifest(cache);
+	cache->plugin_names = g_ptr_array_new();
+	BT_ASSERT(cache->plugin_names);
+	cache->plugin_paths = g_hash_table_new_full(g_str_hash, g_str_equal,
+		g_free, g_free);
+	BT_ASSERT(cache->plugin_paths);
+	cache->plugin_sets = g_hash_table_new_full(g_str_hash, g_str_equal,
+		g_free, put_plugin_set);
+	BT_ASSERT(cache->plugin_sets);
+	BT_LOGI("Finding dynamic plugins.");
+
+	for (i = 0; i < bt_value_array_get_size(plugin_paths); i++) {
+		add_plugin_dir(cache, bt_value_string_get(
+			bt_value_array_borrow_element_by_index_const(
+				plugin_paths, i)));
+	}
+
+	BT_LOGI("Finding static plugins.");
+	cache->static_plugin_set = bt_plugin_find_all_from_static();
+	if (!cache->static_plugin_set) {
+		BT_LOGE_STR("Unable to load static plugins.");
+		goto error;
+	}
+
+	for (i = 0; i < bt_plugin_set_get_plugin_count(
+			cache->static_plugin_set); i++) {
+		add_plugin_name(cache, bt_plugin_get_name(
+			bt_plugin_set_borrow_plugin_by_index_const(
+				cache->static_plugin_set, i)), NULL);
+	}
+
+	BT_LOGI("Found plugins: count=%u, loaded-plugin-file-count=%u",
+		cache->plugin_names->len,
+		g_hash_table_size(cache->plugin_sets));
+	goto end;
+
+error:
+	bt_plugin_cache_destroy(cache);
+	cache = NULL;
+
+end:
+	return cache;
+}
+
+void bt_plugin_cache_destroy(struct bt_plugin_cache *cache)
+{
+	if (!cache) {
+		return;
+	}
+
+	if (cache->manifest) {
+		save_manifest(cache);
+		g_key_file_free(cache->manifest);
+	}
+
+	if (cache->plugin_names) {
+		g_ptr_array_free(cache->plugin_names, TRUE);
+	}
+
+	if (cache->plugin_paths) {
+		g_hash_table_destroy(cache->plugin_paths);
+	}
+
+	if (cache->plugin_sets) {
+		g_hash_table_destroy(cache->plugin_sets);
+	}
+
+	bt_plugin_set_put_ref(cache->static_plugin_set);
+	g_free(cache->manifest_path);
+	g_free(cache);
+}
+
+uint64_t bt_plugin_cache_get_plugin_name_count(struct bt_plugin_cache *cache)
+{
+	BT_ASSERT(cache);
+	return (uint64_t) cache->plugin_names->len;
+}
+
+const char *bt_plugin_cache_get_plugin_name_by_index(
+		struct bt_plugin_cache *cache, uint64_t index)
+{
+	BT_ASSERT(cache);
+	BT_ASSERT(index < cache->plugin_names->len);
+	return g_ptr_array_index(cache->plugin_names, index);
+}
+
+const bt_plugin *bt_plugin_cache_load_plugin_by_name(
+		struct bt_plugin_cache *cache, const char *name)
+{
+	const bt_plugin *plugin = NULL;
+	const bt_plugin_set *plugin_set;
+	gpointer path;
+	uint64_t i;
+
+	BT_ASSERT(cache);
+	BT_ASSERT(name);
+
+	if (!g_hash_table_lookup_extended(cache->plugin_paths, name, NULL,
+			&path)) {
+		goto end;
+	}
+
+	if (!path) {
+		plugin_set = cache->static_plugin_set;
+	} else {
+		plugin_set = g_hash_table_lookup(cache->plugin_sets, path);
+		if (!plugin_set) {
+			BT_LOGD("Loading plugin file: path=\"%s\"",
+				(const char *) path);
+			plugin_set = bt_plugin_find_all_from_file(path);
+			if (!plugin_set) {
+				BT_LOGW("Cannot load plugin file: path=\"%s\"",
+					(const char *) path);
+				goto end;
+			}
+
+			g_hash_table_insert(cache->plugin_sets,
+				g_strdup(path), (void *) plugin_set);
+		}
+	}
+
+	for (i = 0; i < bt_plugin_set_get_plugin_count(plugin_set); i++) {
+		const bt_plugin *candidate =
+			bt_plugin_set_borrow_plugin_by_index_const(
+				plugin_set, i);
+
+		if (strcmp(bt_plugin_get_name(candidate), name) == 0) {
+			plugin = candidate;
+			bt_plugin_get_ref(plugin);
+			goto end;
+		}
+	}
+
+	BT_LOGW("Plugin file does not provide the plugin anymore: "
+		"plugin-name=\"%s\", path=\"%s\"", name,
+		path ? (const char *) path : "(static)");
+
+end:
+	return plugin;
+}
@@ -0,0 +1,79 @@
+#ifndef CLI_BABELTRACE_PLUGIN_CACHE_H
+#define CLI_BABELTRACE_PLUGIN_CACHE_H
+
+/*
+ * Babeltrace trace converter - plugin manifest cache
+ *
+ * Copyright 2019 - EfficiOS Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <babeltrace/babeltrace.h>
+#include <stdbool.h>
+
+/*
+ * A plugin cache knows which file of the plugin directories provides
+ * which plugin without loading all the plugin files.
+ *
+ * It reads and writes an on-disk manifest which, for each plugin
+ * file, records the file's modification time and size and the names
+ * of the plugins it provides. A plugin file is only loaded if it's
+ * not in the manifest, if it changed since it was recorded, or if
+ * the user needs one of its plugins.
+ */
+struct bt_plugin_cache;
+
+/*
+ * Creates a plugin cache for the directories of `plugin_paths` (array
+ * value of string values), in this order of priority.
+ *
+ * Set `use_manifest` to false to ignore the on-disk manifest: the
+ * cache then loads all the plugin files to find their plugins.
+ */
+struct bt_plugin_cache *bt_plugin_cache_create(const bt_value *plugin_paths,
+		bool use_manifest);
+
+/*
+ * Writes the on-disk manifest if it needs to be updated and destroys
+ * `cache`.
+ */
+void bt_plugin_cache_destroy(struct bt_plugin_cache *cache);
+
+/*
+ * Returns the number of known plugin names, including the names of the
+ * static plugins.
+ */
+uint64_t bt_plugin_cache_get_plugin_name_count(struct bt_plugin_cache *cache);
+
+/*
+ * Returns the known plugin name at index `index`, in order of
+ * priority.
+ */
+const char *bt_plugin_cache_get_plugin_name_by_index(
+		struct bt_plugin_cache *cache, uint64_t index);
+
+/*
+ * Loads, if not already done, and returns a new reference to the plugin
+ * named `name`, or `NULL` if there's no such plugin.
+ */
+const bt_plugin *bt_plugin_cache_load_plugin_by_name(
+		struct bt_plugin_cache *cache, const char *name);
+
+#endif /* CLI_BABELTRACE_PLUGIN_CACHE_H */
@@ -39,9 +39,11 @@
 #include "babeltrace-cfg.h"
 #include "babeltrace-cfg-cli-args.h"
 #include "babeltrace-cfg-cli-args-default.h"
+#include "babeltrace-plugin-cache.h"
 
 #define ENV_BABELTRACE_WARN_COMMAND_NAME_DIRECTORY_CLASH "BABELTRACE_CLI_WARN_COMMAND_NAME_DIRECTORY_CLASH"
 #define ENV_BABELTRACE_CLI_LOG_LEVEL "BABELTRACE_CLI_LOG_LEVEL"
+#define ENV_BABELTRACE_CLI_PLUGIN_MANIFEST "BABELTRACE_CLI_PLUGIN_MANIFEST"
 #define NSEC_PER_SEC	1000000000LL
 
 /*
@@ -75,8 +77,12 @@ static bt_graph *the_graph;
 static bt_query_executor *the_query_executor;
 static bool canceled = false;
 
+/* Array of `const bt_plugin *` (owned): plugins loaded so far */
 GPtrArray *loaded_plugins;
 
+/* Knows which file provides which plugin (owned) */
+static struct bt_plugin_cache *plugin_cache;
+
 #ifdef __MINGW32__
 
 #include <windows.h>
@@ -148,6 +154,7 @@ static
 void fini_static_data(void)
 {
 	g_ptr_array_free(loaded_plugins, TRUE);
+	bt_plugin_cache_destroy(plugin_cache);
 }
 
 static
@@ -281,6 +288,17 @@ const bt_plugin *find_plugin(const char *name)
 		plugin = NULL;
 	}
 
+	if (!plugin && plugin_cache) {
+		/* Not loaded yet: load it on demand */
+		plugin = bt_plugin_cache_load_plugin_by_name(plugin_cache,
+			name);
+		if (plugin) {
+			BT_LOGD("Adding plugin to loaded plugins: "
+				"plugin-path=\"%s\"", bt_plugin_get_path(plugin));
+			g_ptr_array_add(loaded_plugins, (void *) plugin);
+		}
+	}
+
 	if (BT_LOG_ON_DEBUG) {
 		if (plugin) {
 			BT_LOGD("Found plugin: plugin-addr=%p", plugin);
@@ -763,128 +781,58 @@ void print_cfg(struct bt_config *cfg)
 }
 
 static
-void add_to_loaded_plugins(const bt_plugin_set *plugin_set)
+bool plugin_manifest_is_enabled(void)
 {
-	int64_t i;
-	int64_t count;
-
-	count = bt_plugin_set_get_plugin_count(plugin_set);
-	BT_ASSERT(count >= 0);
+	const char *env = getenv(ENV_BABELTRACE_CLI_PLUGIN_MANIFEST);
 
-	for (i = 0; i < count; i++) {
-		const bt_plugin *plugin =
-			bt_plugin_set_borrow_plugin_by_index_const(plugin_set, i);
-		const bt_plugin *loaded_plugin =
-			find_plugin(bt_plugin_get_name(plugin));
-
-		BT_ASSERT(plugin);
-
-		if (loaded_plugin) {
-			BT_LOGI("Not using plugin: another one already exists with the same name: "
-				"plugin-name=\"%s\", plugin-path=\"%s\", "
-				"existing-plugin-path=\"%s\"",
-				bt_plugin_get_name(plugin),
-				bt_plugin_get_path(plugin),
-				bt_plugin_get_path(loaded_plugin));
-			bt_plugin_put_ref(loaded_plugin);
-		} else {
-			/* Add to global array. */
-			BT_LOGD("Adding plugin to loaded plugins: plugin-path=\"%s\"",
-				bt_plugin_get_name(plugin));
-			bt_plugin_get_ref(plugin);
-			g_ptr_array_add(loaded_plugins, (void *) plugin);
-		}
-	}
+	/*
+	 * Never read or write a manifest in the user's cache directory
+	 * when running as setuid/setgid.
+	 */
+	return !bt_common_is_setuid_setgid() &&
+		!(env && strcmp(env, "0") == 0);
 }
 
+/*
+ * Finds the available plugins without loading them: find_plugin()
+ * loads them on demand.
+ */
 static
-int load_dynamic_plugins(const bt_value *plugin_paths)
+int init_plugins(const bt_value *plugin_paths)
 {
-	int nr_paths, i, ret = 0;
+	int ret = 0;
 
-	nr_paths = bt_value_array_get_size(plugin_paths);
-	if (nr_paths < 0) {
-		BT_LOGE_STR("Cannot load dynamic plugins: no plugin path.");
+	plugin_cache = bt_plugin_cache_create(plugin_paths,
+		plugin_manifest_is_enabled());
+	if (!plugin_cache) {
 		ret = -1;
 		goto end;
 	}
 
-	BT_LOGI("Loading dynamic plugins.");
-
-	for (i = 0; i < nr_paths; i++) {
-		const bt_value *plugin_path_value = NULL;
-		const char *plugin_path;
-		const bt_plugin_set *plugin_set;
-
-		plugin_path_value =
-			bt_value_array_borrow_element_by_index_const(
-				plugin_paths, i);
-		plugin_path = bt_value_string_get(plugin_path_value);
+	BT_LOGI("Found all plugins: count=%" PRIu64,
+		bt_plugin_cache_get_plugin_name_count(plugin_cache));
 
-		/*
-		 * Skip this if the directory does not exist because
-		 * bt_plugin_find_all_from_dir() expects an existing
-		 * directory.
-		 */
-		if (!g_file_test(plugin_path, G_FILE_TEST_IS_DIR)) {
-			BT_LOGV("Skipping nonexistent directory path: "
-				"path=\"%s\"", plugin_path);
-			continue;
-		}
-
-		plugin_set = bt_plugin_find_all_from_dir(plugin_path, false);
-		if (!plugin_set) {
-			BT_LOGD("Unable to load dynamic plugins: path=\"%s\"",
-				plugin_path);
-			continue;
-		}
-
-		add_to_loaded_plugins(plugin_set);
-		bt_plugin_set_put_ref(plugin_set);
-	}
 end:
 	return ret;
 }
 
 static
-int load_static_plugins(void)
+void load_all_plugins(void)
 {
-	int ret = 0;
-	const bt_plugin_set *plugin_set;
-
-	BT_LOGI("Loading static plugins.");
-	plugin_set = bt_plugin_find_all_from_static();
-	if (!plugin_set) {
-		BT_LOGE("Unable to load static plugins.");
-		ret = -1;
-		goto end;
-	}
-
-	add_to_loaded_plugins(plugin_set);
-	bt_plugin_set_put_ref(plugin_set);
-end:
-	return ret;
-}
+	uint64_t i;
 
-static
-int load_all_plugins(const bt_value *plugin_paths)
-{
-	int ret = 0;
+	BT_ASSERT(plugin_cache);
 
-	if (load_dynamic_plugins(plugin_paths)) {
-		ret = -1;
-		goto end;
-	}
+	for (i = 0; i < bt_plugin_cache_get_plugin_name_count(plugin_cache);
+			i++) {
+		const bt_plugin *plugin = find_plugin(
+			bt_plugin_cache_get_plugin_name_by_index(plugin_cache,
+				i));
 
-	if (load_static_plugins()) {
-		ret = -1;
-		goto end;
+		bt_plugin_put_ref(plugin);
 	}
 
 	BT_LOGI("Loaded all plugins: count=%u", loaded_plugins->len);
-
-end:
-	return ret;
 }
 
 static
@@ -1167,6 +1115,7 @@ int cmd_list_plugins(struct bt_config *cfg)
 	printf("From the following plugin paths:\n\n");
 	print_value(stdout, cfg->plugin_paths, 2);
 	printf("\n");
+	load_all_plugins();
 	plugins_count = loaded_plugins->len;
 	if (plugins_count == 0) {
 		printf("No plugins found.\n");
@@ -1918,6 +1867,41 @@ end:
 	return ret;
 }
 
+/*
+ * Returns the first connection of the run command's configuration
+ * which matches the output port named `upstream_port_name` of the
+ * component named `upstream_comp_name`, or `NULL` if none matches.
+ * This is the connection the port gets once it's added.
+ */
+static
+struct bt_config_connection *borrow_connection_for_upstream_port(
+		struct cmd_run_ctx *ctx, const char *upstream_comp_name,
+		const char *upstream_port_name)
+{
+	size_t i;
+
+	for (i = 0; i < ctx->cfg->cmd_data.run.connections->len; i++) {
+		struct bt_config_connection *cfg_conn =
+			g_ptr_array_index(
+				ctx->cfg->cmd_data.run.connections, i);
+
+		if (strcmp(cfg_conn->upstream_comp_name->str,
+				upstream_comp_name)) {
+			continue;
+		}
+
+		if (!bt_common_star_glob_match(
+			    cfg_conn->upstream_port_glob->str,
+			    SIZE_MAX, upstream_port_name, SIZE_MAX)) {
+			continue;
+		}
+
+		return cfg_conn;
+	}
+
+	return NULL;
+}
+
 static
 int cmd_run_ctx_connect_upstream_port(struct cmd_run_ctx *ctx,
 		const bt_port_output *upstream_port)
@@ -1926,7 +1910,7 @@ int cmd_run_ctx_connect_upstream_port(struct cmd_run_ctx *ctx,
 	const char *upstream_port_name;
 	const char *upstream_comp_name;
 	const bt_component *upstream_comp = NULL;
-	size_t i;
+	struct bt_config_connection *cfg_conn;
 
 	BT_ASSERT(ctx);
 	BT_ASSERT(upstream_port);
@@ -1950,22 +1934,9 @@ int cmd_run_ctx_connect_upstream_port(struct cmd_run_ctx *ctx,
 		upstream_comp, upstream_comp_name,
 		upstream_port, upstream_port_name);
 
-	for (i = 0; i < ctx->cfg->cmd_data.run.connections->len; i++) {
-		struct bt_config_connection *cfg_conn =
-			g_ptr_array_index(
-				ctx->cfg->cmd_data.run.connections, i);
-
-		if (strcmp(cfg_conn->upstream_comp_name->str,
-				upstream_comp_name)) {
-			continue;
-		}
-
-		if (!bt_common_star_glob_match(
-			    cfg_conn->upstream_port_glob->str,
-			    SIZE_MAX, upstream_port_name, SIZE_MAX)) {
-			continue;
-		}
-
+	cfg_conn = borrow_connection_for_upstream_port(ctx, upstream_comp_name,
+		upstream_port_name);
+	if (cfg_conn) {
 		ret = cmd_run_ctx_connect_upstream_port_to_downstream_component(
 			ctx, upstream_comp, upstream_port, cfg_conn);
 		if (ret) {
@@ -2493,6 +2464,448 @@ end:
 	return ret;
 }
 
+/*
+ * Source component classes which add all their output ports when
+ * they're initialized: once such a component exists, the graph
+ * simplification pass knows all the ports it connects.
+ */
+static const char * const static_port_src_comp_classes[][2] = {
+	{ "ctf", "fs" },
+	{ "text", "dmesg" },
+};
+
+static
+struct bt_config_component *borrow_cfg_filter_component_by_name(
+		struct cmd_run_ctx *ctx, const char *name, guint *index)
+{
+	guint i;
+	GPtrArray *filters = ctx->cfg->cmd_data.run.filters;
+
+	for (i = 0; i < filters->len; i++) {
+		struct bt_config_component *cfg_comp =
+			g_ptr_array_index(filters, i);
+
+		if (strcmp(cfg_comp->instance_name->str, name) == 0) {
+			if (index) {
+				*index = i;
+			}
+
+			return cfg_comp;
+		}
+	}
+
+	return NULL;
+}
+
+static
+bool cfg_component_is(struct bt_config_component *cfg_comp,
+		const char *plugin_name, const char *comp_cls_name)
+{
+	return strcmp(cfg_comp->plugin_name->str, plugin_name) == 0 &&
+		strcmp(cfg_comp->comp_cls_name->str, comp_cls_name) == 0;
+}
+
+static
+struct bt_config_component *borrow_cfg_source_component_by_name(
+		struct cmd_run_ctx *ctx, const char *name)
+{
+	guint i;
+	GPtrArray *sources = ctx->cfg->cmd_data.run.sources;
+
+	for (i = 0; i < sources->len; i++) {
+		struct bt_config_component *cfg_comp =
+			g_ptr_array_index(sources, i);
+
+		if (strcmp(cfg_comp->instance_name->str, name) == 0) {
+			return cfg_comp;
+		}
+	}
+
+	return NULL;
+}
+
+static
+bool source_has_static_ports(struct bt_config_component *cfg_comp)
+{
+	size_t i;
+
+	for (i = 0; i < BT_ARRAY_SIZE(static_port_src_comp_classes); i++) {
+		if (cfg_component_is(cfg_comp,
+				static_port_src_comp_classes[i][0],
+				static_port_src_comp_classes[i][1])) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/*
+ * Appends to `ports` (array of `const bt_port_output *`) all the
+ * source component output ports which feed the component named
+ * `comp_name`, either directly or through muxers.
+ *
+ * Returns -1 if this set of ports is unknown before running the
+ * graph: a filter other than a muxer is upstream, or an upstream
+ * source component can add output ports later.
+ */
+static
+int append_upstream_source_ports(struct cmd_run_ctx *ctx,
+		const char *comp_name, GPtrArray *ports)
+{
+	int ret = 0;
+	guint i;
+	GPtrArray *connections = ctx->cfg->cmd_data.run.connections;
+
+	for (i = 0; i < connections->len; i++) {
+		struct bt_config_connection *cfg_conn =
+			g_ptr_array_index(connections, i);
+		const char *upstream_comp_name =
+			cfg_conn->upstream_comp_name->str;
+		struct bt_config_component *upstream_cfg_comp;
+
+		if (strcmp(cfg_conn->downstream_comp_name->str,
+				comp_name)) {
+			continue;
+		}
+
+		upstream_cfg_comp = borrow_cfg_source_component_by_name(ctx,
+			upstream_comp_name);
+		if (upstream_cfg_comp) {
+			const bt_component_source *src_comp;
+			uint64_t port_count;
+			uint64_t port_i;
+
+			if (!source_has_static_ports(upstream_cfg_comp)) {
+				goto unknown;
+			}
+
+			src_comp = g_hash_table_lookup(ctx->src_components,
+				GUINT_TO_POINTER(g_quark_from_string(
+					upstream_comp_name)));
+			BT_ASSERT(src_comp);
+			port_count = bt_component_source_get_output_port_count(
+				src_comp);
+
+			for (port_i = 0; port_i < port_count; port_i++) {
+				const bt_port_output *port =
+					bt_component_source_borrow_output_port_by_index_const(
+						src_comp, port_i);
+
+				if (borrow_connection_for_upstream_port(ctx,
+						upstream_comp_name,
+						bt_port_get_name(
+							bt_port_output_as_port_const(port))) ==
+						cfg_conn) {
+					g_ptr_array_add(ports, (void *) port);
+				}
+			}
+
+			continue;
+		}
+
+		upstream_cfg_comp = borrow_cfg_filter_component_by_name(ctx,
+			upstream_comp_name, NULL);
+		if (!upstream_cfg_comp ||
+				!cfg_component_is(upstream_cfg_comp,
+					"utils", "muxer")) {
+			goto unknown;
+		}
+
+		/* A muxer has a single output port named `out` */
+		if (borrow_connection_for_upstream_port(ctx,
+				upstream_comp_name, "out") != cfg_conn) {
+			continue;
+		}
+
+		ret = append_upstream_source_ports(ctx, upstream_comp_name,
+			ports);
+		if (ret) {
+			goto end;
+		}
+	}
+
+	goto end;
+
+unknown:
+	ret = -1;
+
+end:
+	return ret;
+}
+
+/*
+ * Removes the filter component `cfg_comp`, which has a single input
+ * port and a single output port named `out`, from the run command's
+ * configuration, making the connections to it go to where its output
+ * port would be connected instead.
+ *
+ * Leaves `cfg_comp` as is if its output port has no connection.
+ */
+static
+void bypass_cfg_filter_component(struct cmd_run_ctx *ctx,
+		struct bt_config_component *cfg_comp, guint index)
+{
+	guint i;
+	GPtrArray *connections = ctx->cfg->cmd_data.run.connections;
+	const char *comp_name = cfg_comp->instance_name->str;
+	struct bt_config_connection *out_conn =
+		borrow_connection_for_upstream_port(ctx, comp_name, "out");
+
+	if (!out_conn) {
+		goto end;
+	}
+
+	for (i = 0; i < connections->len; i++) {
+		struct bt_config_connection *cfg_conn =
+			g_ptr_array_index(connections, i);
+
+		if (strcmp(cfg_conn->downstream_comp_name->str, comp_name)) {
+			continue;
+		}
+
+		g_string_assign(cfg_conn->downstream_comp_name,
+			out_conn->downstream_comp_name->str);
+		g_string_assign(cfg_conn->downstream_port_glob,
+			out_conn->downstream_port_glob->str);
+		g_string_printf(cfg_conn->arg, "%s.%s:%s.%s",
+			cfg_conn->upstream_comp_name->str,
+			cfg_conn->upstream_port_glob->str,
+			cfg_conn->downstream_comp_name->str,
+			cfg_conn->downstream_port_glob->str);
+	}
+
+	/* Remove all the connections from the bypassed component */
+	i = 0;
+
+	while (i < connections->len) {
+		struct bt_config_connection *cfg_conn =
+			g_ptr_array_index(connections, i);
+
+		if (strcmp(cfg_conn->upstream_comp_name->str, comp_name)) {
+			i++;
+			continue;
+		}
+
+		g_ptr_array_remove_index(connections, i);
+	}
+
+	BT_LOGI("Removed filter component from graph: comp-name=\"%s\"",
+		comp_name);
+
+	/* This destroys `cfg_comp` */
+	g_ptr_array_remove_index(ctx->cfg->cmd_data.run.filters, index);
+
+end:
+	return;
+}
+
+/*
+ * Parses `str`, a `begin` or `end` parameter of a
+ * `filter.utils.trimmer` component, exactly like this component class
+ * does when it has the `[-]SECONDS[.NANOSECONDS]` form.
+ *
+ * Returns -1 for the other forms: their value depends on the trace.
+ */
+static
+int trimmer_bound_ns_from_str(const char *str, int64_t *ns)
+{
+	unsigned int second, nsec;
+	char dummy;
+
+	if (sscanf(str, "-%u.%u%c", &second, &nsec, &dummy) == 2) {
+		*ns = -((int64_t) second) * NSEC_PER_SEC - (int64_t) nsec;
+	} else if (sscanf(str, "%u.%u%c", &second, &nsec, &dummy) == 2) {
+		*ns = ((int64_t) second) * NSEC_PER_SEC + (int64_t) nsec;
+	} else if (sscanf(str, "-%u%c", &second, &dummy) == 1) {
+		*ns = -((int64_t) second) * NSEC_PER_SEC;
+	} else if (sscanf(str, "%u%c", &second, &dummy) == 1) {
+		*ns = ((int64_t) second) * NSEC_PER_SEC;
+	} else {
+		return -1;
+	}
+
+	return 0;
+}
+
+/*
+ * Gets the time range of the `filter.utils.trimmer` component
+ * `cfg_comp`. Returns -1 if it's not a single range of absolute times.
+ */
+static
+int get_trimmer_range(struct bt_config_component *cfg_comp,
+		int64_t *begin_ns, int64_t *end_ns)
+{
+	const bt_value *value;
+
+	*begin_ns = INT64_MIN;
+	*end_ns = INT64_MAX;
+
+	if (bt_value_map_has_entry(cfg_comp->params, "ranges")) {
+		return -1;
+	}
+
+	value = bt_value_map_borrow_entry_value_const(cfg_comp->params,
+		"begin");
+	if (value && (!bt_value_is_string(value) ||
+			trimmer_bound_ns_from_str(bt_value_string_get(value),
+				begin_ns))) {
+		return -1;
+	}
+
+	value = bt_value_map_borrow_entry_value_const(cfg_comp->params,
+		"end");
+	if (value && (!bt_value_is_string(value) ||
+			trimmer_bound_ns_from_str(bt_value_string_get(value),
+				end_ns))) {
+		return -1;
+	}
+
+	return 0;
+}
+
+/*
+ * Tries to remove the `filter.utils.trimmer` component `cfg_comp`
+ * because all the source output ports which feed it already go through
+ * a stream intersection trimmer: narrow the ranges of those instead.
+ */
+static
+int try_merge_trimmer_into_intersection_trimmers(struct cmd_run_ctx *ctx,
+		struct bt_config_component *cfg_comp, guint index)
+{
+	int ret = 0;
+	guint i;
+	int64_t begin_ns, end_ns;
+	GPtrArray *ports = g_ptr_array_new();
+
+	if (!ports) {
+		ret = -1;
+		goto end;
+	}
+
+	if (get_trimmer_range(cfg_comp, &begin_ns, &end_ns)) {
+		goto end;
+	}
+
+	if (append_upstream_source_ports(ctx, cfg_comp->instance_name->str,
+			ports)) {
+		goto end;
+	}
+
+	/* First pass: check that all the merged ranges are valid */
+	for (i = 0; i < ports->len; i++) {
+		const bt_port *port = bt_port_output_as_port_const(
+			g_ptr_array_index(ports, i));
+		struct port_id port_id = {
+			.instance_name = (char *) bt_component_get_name(
+				bt_port_borrow_component_const(port)),
+			.port_name = (char *) bt_port_get_name(port),
+		};
+		struct trace_range *range = g_hash_table_lookup(
+			ctx->intersections, &port_id);
+
+		if (!range) {
+			goto end;
+		}
+
+		if (MAX((int64_t) range->intersection_range_begin_ns,
+				begin_ns) > MIN((int64_t)
+				range->intersection_range_end_ns, end_ns)) {
+			/*
+			 * Empty range: the trimmer component class
+			 * does not accept it.
+			 */
+			goto end;
+		}
+	}
+
+	for (i = 0; i < ports->len; i++) {
+		const bt_port *port = bt_port_output_as_port_const(
+			g_ptr_array_index(ports, i));
+		struct port_id port_id = {
+			.instance_name = (char *) bt_component_get_name(
+				bt_port_borrow_component_const(port)),
+			.port_name = (char *) bt_port_get_name(port),
+		};
+		struct trace_range *range = g_hash_table_lookup(
+			ctx->intersections, &port_id);
+
+		range->intersection_range_begin_ns = MAX(
+			(int64_t) range->intersection_range_begin_ns, begin_ns);
+		range->intersection_range_end_ns = MIN(
+			(int64_t) range->intersection_range_end_ns, end_ns);
+	}
+
+	bypass_cfg_filter_component(ctx, cfg_comp, index);
+
+end:
+	if (ports) {
+		g_ptr_array_free(ports, TRUE);
+	}
+
+	return ret;
+}
+
+/*
+ * Simplifies the graph to build before creating the filter and sink
+ * components, and once the source components exist, so that each
+ * message crosses fewer components to produce the same output:
+ *
+ * * Removes the muxers which only get one source output port.
+ *
+ * * In stream intersection mode, merges the trimmers which only get
+ *   source output ports with an intersection trimmer into the latter
+ *   ones.
+ */
+static
+int cmd_run_ctx_simplify_graph(struct cmd_run_ctx *ctx)
+{
+	int ret = 0;
+	guint i = 0;
+	GPtrArray *filters = ctx->cfg->cmd_data.run.filters;
+	GPtrArray *ports = g_ptr_array_new();
+
+	if (!ports) {
+		ret = -1;
+		goto end;
+	}
+
+	while (i < filters->len) {
+		struct bt_config_component *cfg_comp =
+			g_ptr_array_index(filters, i);
+		guint prev_len = filters->len;
+
+		if (cfg_component_is(cfg_comp, "utils", "muxer")) {
+			g_ptr_array_set_size(ports, 0);
+
+			if (append_upstream_source_ports(ctx,
+					cfg_comp->instance_name->str,
+					ports) == 0 && ports->len == 1) {
+				bypass_cfg_filter_component(ctx, cfg_comp, i);
+			}
+		} else if (ctx->intersections &&
+				cfg_component_is(cfg_comp, "utils", "trimmer")) {
+			ret = try_merge_trimmer_into_intersection_trimmers(
+				ctx, cfg_comp, i);
+		}
+
+		if (ret) {
+			goto end;
+		}
+
+		if (filters->len == prev_len) {
+			i++;
+		}
+	}
+
+end:
+	if (ports) {
+		g_ptr_array_free(ports, TRUE);
+	}
+
+	return ret;
+}
+
 static
 int cmd_run_ctx_create_components(struct cmd_run_ctx *ctx)
 {
@@ -2513,6 +2926,11 @@ int cmd_run_ctx_create_components(struct cmd_run_ctx *ctx)
 		goto end;
 	}
 
+	ret = cmd_run_ctx_simplify_graph(ctx);
+	if (ret) {
+		goto end;
+	}
+
 	ret = cmd_run_ctx_create_components_from_config_components(
 		ctx, ctx->cfg->cmd_data.run.filters);
 	if (ret) {
@@ -2925,9 +3343,9 @@ int main(int argc, const char **argv)
 	print_cfg(cfg);
 
 	if (cfg->command_needs_plugins) {
-		ret = load_all_plugins(cfg->plugin_paths);
+		ret = init_plugins(cfg->plugin_paths);
 		if (ret) {
-			BT_LOGE("Failed to load plugins: ret=%d", ret);
+			BT_LOGE("Failed to find plugins: ret=%d", ret);
 			retcode = 1;
 			goto end;
 		}
@@ -20,12 +20,17 @@
  * SOFTWARE.
  */
 
+#define BT_LOG_TAG "COMMON-ASSERT"
+#include "logging.h"
+
 #include <babeltrace/assert-internal.h>
 #include <babeltrace/common-internal.h>
 
 void bt_common_assert_failed(const char *file, int line, const char *func,
 		const char *assertion)
 {
+	/* Keep the pending log lines before the assertion message */
+	bt_log_async_flush();
 	fprintf(stderr,
 		"%s\n%s%s%s (╯°□°)╯︵ ┻━┻ %s %s%s%s%s:%s%d%s: %s%s()%s: "
 		"%sAssertion %s`%s`%s%s failed.%s\n",
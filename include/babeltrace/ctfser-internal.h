@@ -190,6 +190,44 @@ end:
 	return ret;
 }
 
+/*
+ * Makes sure that the current packet has at least `size_bits` bits
+ * left after the current offset, increasing its size as many times as
+ * needed.
+ *
+ * This makes it possible to write many fields with a single check: see
+ * bt_ctfser_get_cur_packet_addr().
+ */
+static inline
+int bt_ctfser_reserve_in_current_packet(struct bt_ctfser *ctfser,
+		uint64_t size_bits)
+{
+	int ret = 0;
+
+	while (unlikely(!_bt_ctfser_has_space_left(ctfser, size_bits))) {
+		ret = _bt_ctfser_increase_cur_packet_size(ctfser);
+		if (unlikely(ret)) {
+			goto end;
+		}
+	}
+
+end:
+	return ret;
+}
+
+/*
+ * Returns the address of the first byte of the current packet.
+ *
+ * This address is only valid until the next call to a function which
+ * can increase the current packet's size.
+ */
+static inline
+uint8_t *bt_ctfser_get_cur_packet_addr(struct bt_ctfser *ctfser)
+{
+	return ((uint8_t *) mmap_align_addr(ctfser->base_mma)) +
+		ctfser->mmap_base_offset;
+}
+
 static inline
 int _bt_ctfser_write_byte_aligned_unsigned_int_no_align(
 		struct bt_ctfser *ctfser, uint64_t value,
@@ -502,7 +540,7 @@ int bt_ctfser_write_float64(struct bt_ctfser *ctfser, double value,
 {
 	union u64f {
 		uint64_t u;
-		float f;
+		double f;
 	} u64f;
 
 	u64f.f = value;
@@ -31,6 +31,7 @@
 #include <babeltrace/graph/message-iterator-const.h>
 #include <babeltrace/types.h>
 #include <babeltrace/assert-internal.h>
+#include <babeltrace/msg-ring-internal.h>
 #include <stdbool.h>
 
 struct bt_port;
@@ -112,7 +113,7 @@ struct bt_self_component_port_input_message_iterator {
 	} methods;
 
 	enum bt_self_component_port_input_message_iterator_state state;
-	GQueue *auto_seek_msgs;
+	struct bt_msg_ring auto_seek_msgs;
 	void *user_data;
 };
 
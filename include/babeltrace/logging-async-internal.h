@@ -0,0 +1,90 @@
+#ifndef BABELTRACE_LOGGING_ASYNC_INTERNAL_H
+#define BABELTRACE_LOGGING_ASYNC_INTERNAL_H
+
+/*
+ * Copyright 2019 EfficiOS Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * Asynchronous logging output backend.
+ *
+ * There's a single backend per process, inside the Babeltrace library:
+ * the logging code which is statically linked into each module (the
+ * library, the CLI, the plugins) references these functions weakly, so
+ * that all the modules share the same ring buffers and writer thread.
+ *
+ * The backend only transports opaque records: the logging code writes a
+ * record with bt_log_async_backend_reserve() and
+ * bt_log_async_backend_commit(), and the writer thread passes each
+ * record to _bt_log_async_output_record(), which formats and outputs
+ * it.
+ */
+
+#include <stddef.h>
+#include <babeltrace/babeltrace-internal.h>
+
+/*
+ * Returns whether or not the asynchronous output is enabled for the
+ * calling thread (`BABELTRACE_LOGGING_ASYNC` is `1` and the calling
+ * thread is not the writer thread), initializing the backend on the
+ * first call.
+ */
+int bt_log_async_backend_is_enabled(void);
+
+/*
+ * Reserves `size` bytes in the calling thread's ring buffer and returns
+ * the address of the reserved space, aligned for any record, or `NULL`
+ * if the ring buffer is full (the record is then counted as dropped).
+ *
+ * Call bt_log_async_backend_commit() after writing the record: the
+ * calling thread must not reserve again before that.
+ */
+void *bt_log_async_backend_reserve(size_t size);
+
+/*
+ * Makes the record which the calling thread reserved last visible to
+ * the writer thread.
+ */
+void bt_log_async_backend_commit(void);
+
+/*
+ * Waits, for a bounded time, until the writer thread outputs all the
+ * records committed so far.
+ *
+ * This function is async-signal-safe: a fatal signal handler calls it.
+ */
+void bt_log_async_backend_flush(void);
+
+/*
+ * Outputs, on the calling thread, all the records committed so far.
+ *
+ * Call this before unloading a module: pending records can reference
+ * its output callbacks.
+ */
+void bt_log_async_backend_sync(void);
+
+/*
+ * Formats and outputs the record `data` (defined by the logging code).
+ */
+BT_HIDDEN
+void _bt_log_async_output_record(const void *data);
+
+#endif /* BABELTRACE_LOGGING_ASYNC_INTERNAL_H */
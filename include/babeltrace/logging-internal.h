@@ -425,6 +425,7 @@
 	#define bt_log_set_output_v _BT_LOG_DECOR(bt_log_set_output_v)
 	#define bt_log_set_output_p _BT_LOG_DECOR(bt_log_set_output_p)
 	#define bt_log_out_stderr_callback _BT_LOG_DECOR(bt_log_out_stderr_callback)
+	#define bt_log_async_flush _BT_LOG_DECOR(bt_log_async_flush)
 	#define _bt_log_tag_prefix _BT_LOG_DECOR(_bt_log_tag_prefix)
 	#define _bt_log_global_format _BT_LOG_DECOR(_bt_log_global_format)
 	#define _bt_log_global_output _BT_LOG_DECOR(_bt_log_global_output)
@@ -574,6 +575,13 @@ static _BT_LOG_INLINE void bt_log_set_output_p(const bt_log_output *const output
 	bt_log_set_output_v(output->mask, output->arg, output->callback);
 }
 
+/* Waits until the writer thread of the asynchronous output (see the
+ * BABELTRACE_LOGGING_ASYNC environment variable), if it's enabled, writes the
+ * pending log lines. Call it before terminating the process abnormally. Gives
+ * up after a bounded time: the writer thread could be stuck. Async-signal-safe.
+ */
+void bt_log_async_flush(void);
+
 /* Used with _AUX macros and allows to override global format and output
  * facility. Use BT_LOG_GLOBAL_FORMAT and BT_LOG_GLOBAL_OUTPUT for values from
  * global configuration. Example:
@@ -0,0 +1,273 @@
+#ifndef BABELTRACE_MSG_RING_INTERNAL_H
+#define BABELTRACE_MSG_RING_INTERNAL_H
+
+/*
+ * Copyright 2019 - EfficiOS Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * Growable FIFO ring buffer of message pointers.
+ *
+ * The capacity of a ring is always a power of two so that wrapping an
+ * index is a single bitwise AND. Pushing to a full ring doubles its
+ * capacity; a ring never shrinks.
+ *
+ * A ring does not own the messages it contains: the user is
+ * responsible for getting and putting the message references.
+ */
+
+#include <babeltrace/types.h>
+#include <babeltrace/babeltrace-internal.h>
+#include <babeltrace/assert-internal.h>
+#include <glib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#define BT_MSG_RING_DEFAULT_CAPACITY	16
+
+struct bt_msg_ring {
+	/* Array of `capacity` message pointers, owned by this */
+	const bt_message **msgs;
+
+	/* Always a power of two */
+	uint64_t capacity;
+
+	/* Index, within `msgs`, of the oldest message */
+	uint64_t head;
+
+	/* Number of messages in the ring */
+	uint64_t len;
+};
+
+/*
+ * Initializes `ring` with an initial capacity of at least
+ * `init_capacity` messages (BT_MSG_RING_DEFAULT_CAPACITY if 0).
+ *
+ * Returns 0 on success, or -1 if the storage cannot be allocated.
+ */
+static inline
+int bt_msg_ring_init(struct bt_msg_ring *ring, uint64_t init_capacity)
+{
+	uint64_t capacity = 1;
+
+	BT_ASSERT(ring);
+
+	if (init_capacity == 0) {
+		init_capacity = BT_MSG_RING_DEFAULT_CAPACITY;
+	}
+
+	while (capacity < init_capacity) {
+		capacity <<= 1;
+	}
+
+	ring->msgs = g_new(const bt_message *, capacity);
+	if (!ring->msgs) {
+		return -1;
+	}
+
+	ring->capacity = capacity;
+	ring->head = 0;
+	ring->len = 0;
+	return 0;
+}
+
+/*
+ * Frees the storage of `ring`. `ring` must be empty, or the remaining
+ * messages must be owned elsewhere.
+ */
+static inline
+void bt_msg_ring_fini(struct bt_msg_ring *ring)
+{
+	BT_ASSERT(ring);
+	g_free(ring->msgs);
+	ring->msgs = NULL;
+	ring->capacity = 0;
+	ring->head = 0;
+	ring->len = 0;
+}
+
+static inline
+uint64_t bt_msg_ring_length(const struct bt_msg_ring *ring)
+{
+	return ring->len;
+}
+
+static inline
+bool bt_msg_ring_is_empty(const struct bt_msg_ring *ring)
+{
+	return ring->len == 0;
+}
+
+static inline
+uint64_t _bt_msg_ring_index(const struct bt_msg_ring *ring, uint64_t offset)
+{
+	return (ring->head + offset) & (ring->capacity - 1);
+}
+
+/*
+ * Copies `count` messages, starting at offset `offset` from the ring's
+ * head, to `msgs`, taking care of the wrap-around.
+ */
+static inline
+void _bt_msg_ring_copy_out(const struct bt_msg_ring *ring, uint64_t offset,
+		const bt_message **msgs, uint64_t count)
+{
+	uint64_t start = _bt_msg_ring_index(ring, offset);
+	uint64_t first_count = MIN(count, ring->capacity - start);
+
+	memcpy(msgs, &ring->msgs[start], first_count * sizeof(*msgs));
+	memcpy(&msgs[first_count], &ring->msgs[0],
+		(count - first_count) * sizeof(*msgs));
+}
+
+/*
+ * Grows the storage of `ring` so that it can contain at least
+ * `min_capacity` messages, keeping the current messages in order.
+ *
+ * Returns 0 on success, or -1 if the storage cannot be allocated.
+ */
+static inline
+int _bt_msg_ring_grow(struct bt_msg_ring *ring, uint64_t min_capacity)
+{
+	uint64_t capacity = ring->capacity;
+	const bt_message **msgs;
+
+	while (capacity < min_capacity) {
+		capacity <<= 1;
+	}
+
+	msgs = g_new(const bt_message *, capacity);
+	if (!msgs) {
+		return -1;
+	}
+
+	_bt_msg_ring_copy_out(ring, 0, msgs, ring->len);
+	g_free(ring->msgs);
+	ring->msgs = msgs;
+	ring->capacity = capacity;
+	ring->head = 0;
+	return 0;
+}
+
+/*
+ * Appends `msg` to the tail of `ring`.
+ *
+ * Returns 0 on success, or -1 if the ring needed to grow and its new
+ * storage cannot be allocated (`ring` is unchanged in this case).
+ */
+static inline
+int bt_msg_ring_push(struct bt_msg_ring *ring, const bt_message *msg)
+{
+	BT_ASSERT(msg);
+
+	if (unlikely(ring->len == ring->capacity)) {
+		if (_bt_msg_ring_grow(ring, ring->capacity + 1)) {
+			return -1;
+		}
+	}
+
+	ring->msgs[_bt_msg_ring_index(ring, ring->len)] = msg;
+	ring->len++;
+	return 0;
+}
+
+/*
+ * Appends the `count` messages of `msgs`, in order, to the tail of
+ * `ring`.
+ *
+ * Returns 0 on success, or -1 if the ring needed to grow and its new
+ * storage cannot be allocated (`ring` is unchanged in this case).
+ */
+static inline
+int bt_msg_ring_push_array(struct bt_msg_ring *ring,
+		bt_message_array_const msgs, uint64_t count)
+{
+	uint64_t tail;
+	uint64_t first_count;
+
+	if (unlikely(ring->len + count > ring->capacity)) {
+		if (_bt_msg_ring_grow(ring, ring->len + count)) {
+			return -1;
+		}
+	}
+
+	tail = _bt_msg_ring_index(ring, ring->len);
+	first_count = MIN(count, ring->capacity - tail);
+	memcpy(&ring->msgs[tail], msgs, first_count * sizeof(*msgs));
+	memcpy(&ring->msgs[0], &msgs[first_count],
+		(count - first_count) * sizeof(*msgs));
+	ring->len += count;
+	return 0;
+}
+
+/*
+ * Returns the message at the head of `ring` without removing it, or
+ * NULL if `ring` is empty.
+ */
+static inline
+const bt_message *bt_msg_ring_peek(const struct bt_msg_ring *ring)
+{
+	if (unlikely(ring->len == 0)) {
+		return NULL;
+	}
+
+	return ring->msgs[ring->head];
+}
+
+/*
+ * Removes and returns the message at the head of `ring`, or NULL if
+ * `ring` is empty.
+ */
+static inline
+const bt_message *bt_msg_ring_pop(struct bt_msg_ring *ring)
+{
+	const bt_message *msg;
+
+	if (unlikely(ring->len == 0)) {
+		return NULL;
+	}
+
+	msg = ring->msgs[ring->head];
+	ring->head = _bt_msg_ring_index(ring, 1);
+	ring->len--;
+	return msg;
+}
+
+/*
+ * Removes up to `capacity` messages from the head of `ring` and
+ * writes them, in order, to `msgs`.
+ *
+ * Returns the number of removed messages.
+ */
+static inline
+uint64_t bt_msg_ring_pop_array(struct bt_msg_ring *ring,
+		bt_message_array_const msgs, uint64_t capacity)
+{
+	uint64_t count = MIN(capacity, ring->len);
+
+	_bt_msg_ring_copy_out(ring, 0, msgs, count);
+	ring->head = _bt_msg_ring_index(ring, count);
+	ring->len -= count;
+	return count;
+}
+
+#endif /* BABELTRACE_MSG_RING_INTERNAL_H */
@@ -130,6 +130,21 @@ struct bt_field_class_enumeration_mapping {
 	GArray *ranges;
 };
 
+/*
+ * Maximal interval of ordered keys (see the `index` member of
+ * `struct bt_field_class_enumeration`) which all map to the same
+ * labels.
+ */
+struct bt_field_class_enumeration_segment {
+	uint64_t lower;
+	uint64_t upper;
+
+	/* Index of the segment's first label within `index.labels` */
+	uint64_t label_index;
+
+	uint64_t label_count;
+};
+
 struct bt_field_class_unsigned_enumeration_mapping;
 struct bt_field_class_signed_enumeration_mapping;
 
@@ -149,6 +164,44 @@ struct bt_field_class_enumeration {
 	 * The actual strings are owned by the mappings above.
 	 */
 	GPtrArray *label_buf;
+
+	/*
+	 * Value lookup index, built by
+	 * bt_field_class_enumeration_build_index() when the field class
+	 * is frozen or on the first value lookup, and reset when a
+	 * mapping is added.
+	 *
+	 * Values are converted to ordered keys first: an unsigned value
+	 * is its own key, while a signed value's key has its sign bit
+	 * flipped so that the unsigned order of keys is the order of
+	 * values.
+	 */
+	struct {
+		bool is_valid;
+
+		/*
+		 * Array of `struct bt_field_class_enumeration_segment`,
+		 * sorted and disjoint; keys outside any segment map to
+		 * no labels.
+		 */
+		GArray *segments;
+
+		/*
+		 * Array of `const char *`: contiguous label sets of the
+		 * segments, each in mapping order (the actual strings
+		 * are owned by the mappings above).
+		 */
+		GPtrArray *labels;
+
+		/*
+		 * If not `NULL`, direct table of `dense_len` segment
+		 * indexes plus one (0 means no segment), the first
+		 * element being the one for key `dense_base`.
+		 */
+		uint32_t *dense;
+		uint64_t dense_base;
+		uint64_t dense_len;
+	} index;
 };
 
 struct bt_field_class_real {
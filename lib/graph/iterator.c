@@ -150,14 +150,13 @@ void bt_self_component_port_input_message_iterator_destroy(struct bt_object *obj
 		iterator->connection = NULL;
 	}
 
-	if (iterator->auto_seek_msgs) {
-		while (!g_queue_is_empty(iterator->auto_seek_msgs)) {
+	if (iterator->auto_seek_msgs.msgs) {
+		while (!bt_msg_ring_is_empty(&iterator->auto_seek_msgs)) {
 			bt_object_put_no_null_check(
-				g_queue_pop_tail(iterator->auto_seek_msgs));
+				bt_msg_ring_pop(&iterator->auto_seek_msgs));
 		}
 
-		g_queue_free(iterator->auto_seek_msgs);
-		iterator->auto_seek_msgs = NULL;
+		bt_msg_ring_fini(&iterator->auto_seek_msgs);
 	}
 
 	destroy_base_message_iterator(obj);
@@ -322,9 +321,8 @@ bt_self_component_port_input_message_iterator_create_initial(
 		goto end;
 	}
 
-	iterator->auto_seek_msgs = g_queue_new();
-	if (!iterator->auto_seek_msgs) {
-		BT_LOGE_STR("Failed to allocate a GQueue.");
+	if (bt_msg_ring_init(&iterator->auto_seek_msgs, MSG_BATCH_SIZE)) {
+		BT_LOGE_STR("Failed to allocate a message queue.");
 		ret = -1;
 		goto end;
 	}
@@ -1144,7 +1142,12 @@ skip_msg:
 	goto end;
 
 push_msg:
-	g_queue_push_head(iterator->auto_seek_msgs, (void *) msg);
+	if (bt_msg_ring_push(&iterator->auto_seek_msgs, msg)) {
+		BT_LOGE_STR("Failed to grow the auto-seek message queue.");
+		status = BT_MESSAGE_ITERATOR_STATUS_NOMEM;
+		goto end;
+	}
+
 	msg = NULL;
 
 end:
@@ -1214,13 +1217,6 @@ enum bt_message_iterator_status find_message_ge_ns_from_origin(
 		}
 
 		for (i = 0; i < user_count; i++) {
-			if (got_first) {
-				g_queue_push_head(iterator->auto_seek_msgs,
-					(void *) messages[i]);
-				messages[i] = NULL;
-				continue;
-			}
-
 			status = auto_seek_handle_message(iterator,
 				ns_from_origin, messages[i], &got_first);
 			if (status == BT_MESSAGE_ITERATOR_STATUS_OK) {
@@ -1229,6 +1225,28 @@ enum bt_message_iterator_status find_message_ge_ns_from_origin(
 			} else {
 				goto end;
 			}
+
+			if (got_first) {
+				/*
+				 * Push the remaining messages of this
+				 * batch as is.
+				 */
+				i++;
+
+				if (bt_msg_ring_push_array(
+						&iterator->auto_seek_msgs,
+						&messages[i], user_count - i)) {
+					BT_LOGE_STR("Failed to grow the auto-seek message queue.");
+					status = BT_MESSAGE_ITERATOR_STATUS_NOMEM;
+					goto end;
+				}
+
+				for (; i < user_count; i++) {
+					messages[i] = NULL;
+				}
+
+				break;
+			}
 		}
 	}
 
@@ -1249,22 +1267,17 @@ enum bt_self_message_iterator_status post_auto_seek_next(
 		bt_message_array_const msgs, uint64_t capacity,
 		uint64_t *count)
 {
-	BT_ASSERT(!g_queue_is_empty(iterator->auto_seek_msgs));
-	*count = 0;
+	BT_ASSERT(!bt_msg_ring_is_empty(&iterator->auto_seek_msgs));
 
 	/*
 	 * Move auto-seek messages to the output array (which is this
 	 * iterator's base message array).
 	 */
-	while (capacity > 0 && !g_queue_is_empty(iterator->auto_seek_msgs)) {
-		msgs[*count] = g_queue_pop_tail(iterator->auto_seek_msgs);
-		capacity--;
-		(*count)++;
-	}
-
+	*count = bt_msg_ring_pop_array(&iterator->auto_seek_msgs, msgs,
+		capacity);
 	BT_ASSERT(*count > 0);
 
-	if (g_queue_is_empty(iterator->auto_seek_msgs)) {
+	if (bt_msg_ring_is_empty(&iterator->auto_seek_msgs)) {
 		/* No more auto-seek messages */
 		switch (iterator->upstream_component->class->type) {
 		case BT_COMPONENT_CLASS_TYPE_SOURCE:
@@ -1365,9 +1378,9 @@ bt_self_component_port_input_message_iterator_seek_ns_from_origin(
 		 * this point in the batch to this iterator's auto-seek
 		 * message queue.
 		 */
-		while (!g_queue_is_empty(iterator->auto_seek_msgs)) {
+		while (!bt_msg_ring_is_empty(&iterator->auto_seek_msgs)) {
 			bt_object_put_no_null_check(
-				g_queue_pop_tail(iterator->auto_seek_msgs));
+				bt_msg_ring_pop(&iterator->auto_seek_msgs));
 		}
 
 		status = find_message_ge_ns_from_origin(iterator,
@@ -1381,7 +1394,7 @@ bt_self_component_port_input_message_iterator_seek_ns_from_origin(
 			 * method with a custom, temporary "next" method
 			 * which returns them.
 			 */
-			if (!g_queue_is_empty(iterator->auto_seek_msgs)) {
+			if (!bt_msg_ring_is_empty(&iterator->auto_seek_msgs)) {
 				iterator->methods.next =
 					(bt_self_component_port_input_message_iterator_next_method)
 						post_auto_seek_next;
@@ -0,0 +1,547 @@
+/*
+ * Copyright 2019 EfficiOS Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * Asynchronous logging output backend (see
+ * <babeltrace/logging-async-internal.h>).
+ *
+ * Each logging thread owns a ring buffer. Each ring buffer has a single
+ * producer (its owning thread) and a single consumer (whoever holds
+ * `consumer_mutex`: the writer thread, or a thread which calls
+ * bt_log_async_backend_sync()), so that writing a record is lock-free.
+ * When a ring buffer is full, the record is dropped and counted; the
+ * writer thread reports the dropped records on the standard error.
+ *
+ * A thread which needs the pending records to be written before the
+ * process terminates (fatal signal handler, assertion failure, FATAL
+ * log line) calls bt_log_async_backend_flush(): it only increments a
+ * request counter and waits until the writer thread reports a complete
+ * pass over the ring buffers which started after the request. This is
+ * async-signal-safe, and does not block forever if the writer thread is
+ * the crashing one or is stuck.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <babeltrace/babeltrace-internal.h>
+#include <babeltrace/logging-async-internal.h>
+
+#if defined(_WIN32) || defined(_WIN64)
+
+/* Not supported: the logging code outputs synchronously */
+
+int bt_log_async_backend_is_enabled(void)
+{
+	return 0;
+}
+
+void *bt_log_async_backend_reserve(size_t size)
+{
+	return NULL;
+}
+
+void bt_log_async_backend_commit(void)
+{
+}
+
+void bt_log_async_backend_flush(void)
+{
+}
+
+void bt_log_async_backend_sync(void)
+{
+}
+
+#else /* defined(_WIN32) || defined(_WIN64) */
+
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+
+#define RING_SZ			(256 * 1024)
+#define RECORD_ALIGN		16
+#define WRITER_PERIOD_NS	10000000
+
+/* Number of 1-ms waits for the writer thread when flushing */
+#define FLUSH_WAIT_TRIES	1000
+
+/*
+ * Record header. Since all the record sizes are multiples of
+ * `RECORD_ALIGN`, and this header's size is `RECORD_ALIGN`, there's
+ * always room for a header at the end of a ring buffer.
+ */
+struct record_header {
+	/* Total size of this record (aligned), header included */
+	size_t size;
+
+	/* True if this record only skips the end of the ring buffer */
+	int is_padding;
+} __attribute__((aligned(RECORD_ALIGN)));
+
+struct ring {
+	struct ring *next;
+
+	/* Written by the producer only */
+	size_t head;
+
+	/* Value of `head` once the reserved record is committed */
+	size_t reserved_head;
+
+	/* Written by the consumer only */
+	size_t tail;
+
+	/* Number of dropped records (written by the producer only) */
+	unsigned long dropped;
+
+	/* True when the owning thread exited */
+	int orphaned;
+
+	char data[RING_SZ] __attribute__((aligned(RECORD_ALIGN)));
+};
+
+static pthread_once_t init_once = PTHREAD_ONCE_INIT;
+static pthread_mutex_t consumer_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t writer_cond = PTHREAD_COND_INITIALIZER;
+static pthread_key_t ring_key;
+static pthread_t writer_thread;
+static int enabled;
+
+/* Protected by `consumer_mutex` */
+static int writer_stop;
+static struct ring *rings;
+static unsigned long freed_rings_dropped;
+static unsigned long reported_dropped;
+
+/*
+ * Number of flush requests, and value of `flush_requests` when the
+ * writer thread started its last complete pass.
+ */
+static unsigned long flush_requests;
+static unsigned long flush_requests_done;
+
+static __thread struct ring *thread_ring;
+static __thread int is_writer_thread;
+
+static const int fatal_signals[] = {
+	SIGABRT, SIGBUS, SIGFPE, SIGILL, SIGSEGV,
+};
+
+#define NR_FATAL_SIGNALS	(sizeof(fatal_signals) / sizeof(fatal_signals[0]))
+
+static struct sigaction prev_sigactions[NR_FATAL_SIGNALS];
+static int fatal_signal_handlers_installed;
+
+/*
+ * Passes all the records of `ring` to the logging code, returning the
+ * number of handled records.
+ *
+ * `consumer_mutex` must be held.
+ */
+static
+size_t drain_ring(struct ring *ring)
+{
+	const size_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+	size_t tail = ring->tail;
+	size_t count = 0;
+
+	while (tail != head) {
+		const struct record_header *hdr =
+			(const void *) &ring->data[tail & (RING_SZ - 1)];
+
+		if (!hdr->is_padding) {
+			_bt_log_async_output_record(hdr + 1);
+			count++;
+		}
+
+		tail += hdr->size;
+	}
+
+	__atomic_store_n(&ring->tail, tail, __ATOMIC_RELEASE);
+	return count;
+}
+
+/*
+ * Drains all the rings, frees the orphaned ones, and reports new
+ * dropped records. Returns the number of handled records.
+ *
+ * `consumer_mutex` must be held.
+ */
+static
+size_t drain_all_rings(void)
+{
+	struct ring **ring_p = &rings;
+	unsigned long dropped;
+	size_t count = 0;
+
+	while (*ring_p) {
+		struct ring *ring = *ring_p;
+		const int orphaned = __atomic_load_n(&ring->orphaned,
+			__ATOMIC_ACQUIRE);
+
+		count += drain_ring(ring);
+
+		if (orphaned && ring->tail ==
+				__atomic_load_n(&ring->head, __ATOMIC_ACQUIRE)) {
+			freed_rings_dropped += ring->dropped;
+			*ring_p = ring->next;
+			free(ring);
+			continue;
+		}
+
+		ring_p = &ring->next;
+	}
+
+	dropped = freed_rings_dropped;
+
+	for (ring_p = &rings; *ring_p; ring_p = &(*ring_p)->next) {
+		dropped += __atomic_load_n(&(*ring_p)->dropped,
+			__ATOMIC_RELAXED);
+	}
+
+	if (dropped != reported_dropped) {
+		char buf[96];
+		int len;
+
+		len = snprintf(buf, sizeof(buf),
+			"Babeltrace: dropped %lu log line(s) "
+			"(asynchronous logging ring buffer is full)\n",
+			dropped - reported_dropped);
+		if (write(STDERR_FILENO, buf,
+				len < (int) sizeof(buf) ?
+					(size_t) len : sizeof(buf) - 1)) {
+			/* Nothing else to do */
+		}
+
+		reported_dropped = dropped;
+	}
+
+	return count;
+}
+
+static
+void *writer_thread_func(void *data)
+{
+	is_writer_thread = 1;
+	pthread_mutex_lock(&consumer_mutex);
+
+	while (true) {
+		const unsigned long requests = __atomic_load_n(&flush_requests,
+			__ATOMIC_ACQUIRE);
+		struct timespec deadline;
+		size_t count;
+
+		count = drain_all_rings();
+		__atomic_store_n(&flush_requests_done, requests,
+			__ATOMIC_RELEASE);
+
+		if (count > 0) {
+			continue;
+		}
+
+		if (writer_stop) {
+			break;
+		}
+
+		clock_gettime(CLOCK_REALTIME, &deadline);
+		deadline.tv_nsec += WRITER_PERIOD_NS;
+
+		if (deadline.tv_nsec >= 1000000000) {
+			deadline.tv_sec++;
+			deadline.tv_nsec -= 1000000000;
+		}
+
+		pthread_cond_timedwait(&writer_cond, &consumer_mutex,
+			&deadline);
+	}
+
+	pthread_mutex_unlock(&consumer_mutex);
+	return NULL;
+}
+
+static
+void fatal_signal_handler(int sig)
+{
+	size_t i;
+
+	bt_log_async_backend_flush();
+
+	/*
+	 * Restore the previous action and raise the signal again: it's
+	 * delivered as soon as this handler returns, so that the
+	 * previous handler (or the default action) still runs.
+	 */
+	for (i = 0; i < NR_FATAL_SIGNALS; i++) {
+		if (fatal_signals[i] == sig) {
+			sigaction(sig, &prev_sigactions[i], NULL);
+			break;
+		}
+	}
+
+	raise(sig);
+}
+
+static
+void install_fatal_signal_handlers(void)
+{
+	struct sigaction sa;
+	size_t i;
+
+	memset(&sa, 0, sizeof(sa));
+	sa.sa_handler = fatal_signal_handler;
+	sigemptyset(&sa.sa_mask);
+
+	for (i = 0; i < NR_FATAL_SIGNALS; i++) {
+		sigaction(fatal_signals[i], &sa, &prev_sigactions[i]);
+	}
+
+	fatal_signal_handlers_installed = 1;
+}
+
+/*
+ * Restores the previous actions of the fatal signals which are still
+ * handled by fatal_signal_handler(): the handler must not outlive the
+ * library.
+ */
+static
+void restore_fatal_signal_handlers(void)
+{
+	size_t i;
+
+	if (!fatal_signal_handlers_installed) {
+		return;
+	}
+
+	for (i = 0; i < NR_FATAL_SIGNALS; i++) {
+		struct sigaction cur;
+
+		if (sigaction(fatal_signals[i], NULL, &cur) == 0 &&
+				cur.sa_handler == fatal_signal_handler) {
+			sigaction(fatal_signals[i], &prev_sigactions[i], NULL);
+		}
+	}
+
+	fatal_signal_handlers_installed = 0;
+}
+
+static
+void ring_key_destroy(void *data)
+{
+	struct ring *ring = data;
+
+	/* The consumer frees it once it's drained */
+	__atomic_store_n(&ring->orphaned, 1, __ATOMIC_RELEASE);
+}
+
+/*
+ * A forked child only has the forking thread: it outputs synchronously,
+ * and its copies of the parent's pending records are not its own to
+ * write. `consumer_mutex` could have been held by the writer thread.
+ */
+static
+void atfork_child(void)
+{
+	__atomic_store_n(&enabled, 0, __ATOMIC_RELEASE);
+	pthread_mutex_init(&consumer_mutex, NULL);
+	rings = NULL;
+	thread_ring = NULL;
+}
+
+static
+void init(void)
+{
+	const char *val = getenv("BABELTRACE_LOGGING_ASYNC");
+
+	if (!val || strcmp(val, "1") != 0) {
+		return;
+	}
+
+	if (pthread_key_create(&ring_key, ring_key_destroy)) {
+		return;
+	}
+
+	if (pthread_atfork(NULL, NULL, atfork_child)) {
+		pthread_key_delete(ring_key);
+		return;
+	}
+
+	if (pthread_create(&writer_thread, NULL, writer_thread_func, NULL)) {
+		pthread_key_delete(ring_key);
+		return;
+	}
+
+	__atomic_store_n(&enabled, 1, __ATOMIC_RELEASE);
+	install_fatal_signal_handlers();
+}
+
+static __attribute__((destructor))
+void fini(void)
+{
+	restore_fatal_signal_handlers();
+
+	if (!__atomic_load_n(&enabled, __ATOMIC_ACQUIRE)) {
+		return;
+	}
+
+	__atomic_store_n(&enabled, 0, __ATOMIC_RELEASE);
+	pthread_mutex_lock(&consumer_mutex);
+	writer_stop = 1;
+	pthread_cond_signal(&writer_cond);
+	pthread_mutex_unlock(&consumer_mutex);
+	pthread_join(writer_thread, NULL);
+
+	/* Catch any record committed after the writer thread's last pass */
+	bt_log_async_backend_sync();
+}
+
+static
+struct ring *borrow_thread_ring(void)
+{
+	struct ring *ring = thread_ring;
+
+	if (ring) {
+		goto end;
+	}
+
+	ring = calloc(1, sizeof(*ring));
+	if (!ring) {
+		goto end;
+	}
+
+	pthread_mutex_lock(&consumer_mutex);
+	ring->next = rings;
+	rings = ring;
+	pthread_mutex_unlock(&consumer_mutex);
+	pthread_setspecific(ring_key, ring);
+	thread_ring = ring;
+
+end:
+	return ring;
+}
+
+int bt_log_async_backend_is_enabled(void)
+{
+	pthread_once(&init_once, init);
+	return __atomic_load_n(&enabled, __ATOMIC_ACQUIRE) &&
+		!is_writer_thread;
+}
+
+void *bt_log_async_backend_reserve(size_t size)
+{
+	struct ring *ring = borrow_thread_ring();
+	struct record_header *hdr = NULL;
+	size_t rec_size, tail, head, off, contig, needed;
+
+	if (!ring) {
+		goto end;
+	}
+
+	if (size > RING_SZ / 4) {
+		goto drop;
+	}
+
+	rec_size = (sizeof(*hdr) + size + RECORD_ALIGN - 1) &
+		~((size_t) RECORD_ALIGN - 1);
+	tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+	head = ring->head;
+	off = head & (RING_SZ - 1);
+	contig = RING_SZ - off;
+	needed = rec_size;
+
+	if (contig < rec_size) {
+		/* Record cannot wrap: skip the end of the ring buffer */
+		needed += contig;
+	}
+
+	if (RING_SZ - (head - tail) < needed) {
+		goto drop;
+	}
+
+	if (contig < rec_size) {
+		hdr = (void *) &ring->data[off];
+		hdr->size = contig;
+		hdr->is_padding = 1;
+		head += contig;
+		off = 0;
+	}
+
+	hdr = (void *) &ring->data[off];
+	hdr->size = rec_size;
+	hdr->is_padding = 0;
+	ring->reserved_head = head + rec_size;
+	hdr++;
+	goto end;
+
+drop:
+	__atomic_store_n(&ring->dropped, ring->dropped + 1,
+		__ATOMIC_RELAXED);
+
+end:
+	return hdr;
+}
+
+void bt_log_async_backend_commit(void)
+{
+	struct ring *ring = thread_ring;
+
+	__atomic_store_n(&ring->head, ring->reserved_head, __ATOMIC_RELEASE);
+}
+
+void bt_log_async_backend_flush(void)
+{
+	unsigned long request;
+	int i;
+
+	if (!__atomic_load_n(&enabled, __ATOMIC_ACQUIRE) ||
+			is_writer_thread) {
+		return;
+	}
+
+	request = __atomic_add_fetch(&flush_requests, 1, __ATOMIC_SEQ_CST);
+
+	for (i = 0; i < FLUSH_WAIT_TRIES; i++) {
+		const unsigned long done = __atomic_load_n(
+			&flush_requests_done, __ATOMIC_ACQUIRE);
+
+		if ((long) (done - request) >= 0) {
+			break;
+		}
+
+		poll(NULL, 0, 1);
+	}
+}
+
+void bt_log_async_backend_sync(void)
+{
+	if (is_writer_thread) {
+		return;
+	}
+
+	pthread_mutex_lock(&consumer_mutex);
+	drain_all_rings();
+	pthread_mutex_unlock(&consumer_mutex);
+}
+
+#endif /* defined(_WIN32) || defined(_WIN64) */
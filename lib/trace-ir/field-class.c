@@ -199,6 +199,369 @@ void finalize_enumeration_field_class_mapping(
 	}
 }
 
+/*
+ * Above this number of values between the lowest and highest mapped
+ * keys, an enumeration field class's index has no direct table.
+ */
+#define ENUM_INDEX_DENSE_MAX_SPAN	4096
+
+static inline
+uint64_t enumeration_field_class_value_key(
+		const struct bt_field_class_enumeration *enum_fc, uint64_t value)
+{
+	return enum_fc->common.common.type ==
+		BT_FIELD_CLASS_TYPE_SIGNED_ENUMERATION ?
+		value ^ (UINT64_C(1) << 63) : value;
+}
+
+static
+void reset_enumeration_field_class_index(
+		struct bt_field_class_enumeration *enum_fc)
+{
+	if (enum_fc->index.segments) {
+		g_array_free(enum_fc->index.segments, TRUE);
+		enum_fc->index.segments = NULL;
+	}
+
+	if (enum_fc->index.labels) {
+		g_ptr_array_free(enum_fc->index.labels, TRUE);
+		enum_fc->index.labels = NULL;
+	}
+
+	g_free(enum_fc->index.dense);
+	enum_fc->index.dense = NULL;
+	enum_fc->index.dense_base = 0;
+	enum_fc->index.dense_len = 0;
+	enum_fc->index.is_valid = false;
+}
+
+static
+gint compare_keys(gconstpointer a, gconstpointer b)
+{
+	const uint64_t key_a = *(const uint64_t *) a;
+	const uint64_t key_b = *(const uint64_t *) b;
+
+	if (key_a < key_b) {
+		return -1;
+	} else if (key_a > key_b) {
+		return 1;
+	}
+
+	return 0;
+}
+
+/*
+ * Builds the value lookup index of `enum_fc` (see the `index` member
+ * of `struct bt_field_class_enumeration`).
+ *
+ * Each range bound splits the key space: between two consecutive
+ * bounds, all the keys map to the same labels. Adjacent segments
+ * mapping to the same labels are merged.
+ */
+static
+int build_enumeration_field_class_index(
+		struct bt_field_class_enumeration *enum_fc)
+{
+	int ret = 0;
+	GArray *bounds = NULL;
+	uint64_t i;
+
+	reset_enumeration_field_class_index(enum_fc);
+	bounds = g_array_new(FALSE, FALSE, sizeof(uint64_t));
+	if (!bounds) {
+		BT_LOGE_STR("Failed to allocate a GArray.");
+		goto error;
+	}
+
+	enum_fc->index.segments = g_array_new(FALSE, FALSE,
+		sizeof(struct bt_field_class_enumeration_segment));
+	if (!enum_fc->index.segments) {
+		BT_LOGE_STR("Failed to allocate a GArray.");
+		goto error;
+	}
+
+	enum_fc->index.labels = g_ptr_array_new();
+	if (!enum_fc->index.labels) {
+		BT_LOGE_STR("Failed to allocate a GPtrArray.");
+		goto error;
+	}
+
+	for (i = 0; i < enum_fc->mappings->len; i++) {
+		uint64_t j;
+		const struct bt_field_class_enumeration_mapping *mapping =
+			BT_FIELD_CLASS_ENUM_MAPPING_AT_INDEX(enum_fc, i);
+
+		for (j = 0; j < mapping->ranges->len; j++) {
+			const struct bt_field_class_enumeration_mapping_range *range =
+				BT_FIELD_CLASS_ENUM_MAPPING_RANGE_AT_INDEX(
+					mapping, j);
+			uint64_t lower = enumeration_field_class_value_key(
+				enum_fc, range->lower.u);
+			uint64_t upper = enumeration_field_class_value_key(
+				enum_fc, range->upper.u);
+
+			g_array_append_val(bounds, lower);
+
+			if (upper != UINT64_MAX) {
+				upper++;
+				g_array_append_val(bounds, upper);
+			}
+		}
+	}
+
+	g_array_sort(bounds, compare_keys);
+
+	for (i = 0; i < bounds->len; i++) {
+		struct bt_field_class_enumeration_segment segment;
+		struct bt_field_class_enumeration_segment *prev_segment = NULL;
+		uint64_t j;
+
+		segment.lower = g_array_index(bounds, uint64_t, i);
+
+		if (i > 0 && segment.lower ==
+				g_array_index(bounds, uint64_t, i - 1)) {
+			/* Duplicate bound */
+			continue;
+		}
+
+		segment.upper = UINT64_MAX;
+
+		for (j = i + 1; j < bounds->len; j++) {
+			uint64_t next_bound = g_array_index(bounds, uint64_t, j);
+
+			if (next_bound != segment.lower) {
+				segment.upper = next_bound - 1;
+				break;
+			}
+		}
+
+		segment.label_index = enum_fc->index.labels->len;
+
+		for (j = 0; j < enum_fc->mappings->len; j++) {
+			uint64_t k;
+			const struct bt_field_class_enumeration_mapping *mapping =
+				BT_FIELD_CLASS_ENUM_MAPPING_AT_INDEX(enum_fc, j);
+
+			for (k = 0; k < mapping->ranges->len; k++) {
+				const struct bt_field_class_enumeration_mapping_range *range =
+					BT_FIELD_CLASS_ENUM_MAPPING_RANGE_AT_INDEX(
+						mapping, k);
+
+				if (segment.lower >=
+						enumeration_field_class_value_key(
+							enum_fc, range->lower.u) &&
+						segment.lower <=
+						enumeration_field_class_value_key(
+							enum_fc, range->upper.u)) {
+					g_ptr_array_add(enum_fc->index.labels,
+						mapping->label->str);
+					break;
+				}
+			}
+		}
+
+		segment.label_count = enum_fc->index.labels->len -
+			segment.label_index;
+		if (segment.label_count == 0) {
+			continue;
+		}
+
+		if (enum_fc->index.segments->len > 0) {
+			prev_segment = &g_array_index(enum_fc->index.segments,
+				struct bt_field_class_enumeration_segment,
+				enum_fc->index.segments->len - 1);
+		}
+
+		if (prev_segment && prev_segment->upper + 1 == segment.lower &&
+				prev_segment->label_count ==
+					segment.label_count &&
+				memcmp(&enum_fc->index.labels->pdata[prev_segment->label_index],
+					&enum_fc->index.labels->pdata[segment.label_index],
+					segment.label_count * sizeof(gpointer)) == 0) {
+			/* Same labels: extend previous segment */
+			prev_segment->upper = segment.upper;
+			g_ptr_array_set_size(enum_fc->index.labels,
+				segment.label_index);
+			continue;
+		}
+
+		g_array_append_val(enum_fc->index.segments, segment);
+	}
+
+	if (enum_fc->index.segments->len > 0) {
+		const struct bt_field_class_enumeration_segment *first =
+			&g_array_index(enum_fc->index.segments,
+				struct bt_field_class_enumeration_segment, 0);
+		const struct bt_field_class_enumeration_segment *last =
+			&g_array_index(enum_fc->index.segments,
+				struct bt_field_class_enumeration_segment,
+				enum_fc->index.segments->len - 1);
+
+		if (last->upper - first->lower < ENUM_INDEX_DENSE_MAX_SPAN) {
+			enum_fc->index.dense_base = first->lower;
+			enum_fc->index.dense_len =
+				last->upper - first->lower + 1;
+			enum_fc->index.dense = g_new0(uint32_t,
+				enum_fc->index.dense_len);
+			if (!enum_fc->index.dense) {
+				BT_LOGE_STR("Failed to allocate a direct lookup table.");
+				goto error;
+			}
+
+			for (i = 0; i < enum_fc->index.segments->len; i++) {
+				const struct bt_field_class_enumeration_segment *segment =
+					&g_array_index(enum_fc->index.segments,
+						struct bt_field_class_enumeration_segment,
+						i);
+				const uint64_t base = segment->lower -
+					enum_fc->index.dense_base;
+				uint64_t n;
+
+				/*
+				 * Count the keys instead of comparing them
+				 * to the upper value, which can be
+				 * UINT64_MAX.
+				 */
+				for (n = 0; n <= segment->upper -
+						segment->lower; n++) {
+					enum_fc->index.dense[base + n] =
+						(uint32_t) i + 1;
+				}
+			}
+		}
+	}
+
+	enum_fc->index.is_valid = true;
+	BT_LIB_LOGD("Built enumeration field class's value lookup index: "
+		"%![fc-]+F, segment-count=%u, has-direct-table=%d",
+		enum_fc, enum_fc->index.segments->len,
+		enum_fc->index.dense != NULL);
+	goto end;
+
+error:
+	reset_enumeration_field_class_index(enum_fc);
+	ret = -1;
+
+end:
+	if (bounds) {
+		g_array_free(bounds, TRUE);
+	}
+
+	return ret;
+}
+
+static
+const struct bt_field_class_enumeration_segment *
+find_enumeration_field_class_segment(
+		const struct bt_field_class_enumeration *enum_fc, uint64_t key)
+{
+	const struct bt_field_class_enumeration_segment *segment = NULL;
+
+	BT_ASSERT(enum_fc->index.is_valid);
+
+	if (enum_fc->index.dense) {
+		if (key - enum_fc->index.dense_base <
+				enum_fc->index.dense_len) {
+			uint32_t segment_index = enum_fc->index.dense[key -
+				enum_fc->index.dense_base];
+
+			if (segment_index > 0) {
+				segment = &g_array_index(
+					enum_fc->index.segments,
+					struct bt_field_class_enumeration_segment,
+					segment_index - 1);
+			}
+		}
+	} else {
+		uint64_t low = 0;
+		uint64_t high = enum_fc->index.segments->len;
+
+		while (low < high) {
+			uint64_t mid = low + (high - low) / 2;
+			const struct bt_field_class_enumeration_segment *candidate =
+				&g_array_index(enum_fc->index.segments,
+					struct bt_field_class_enumeration_segment,
+					mid);
+
+			if (key < candidate->lower) {
+				high = mid;
+			} else if (key > candidate->upper) {
+				low = mid + 1;
+			} else {
+				segment = candidate;
+				break;
+			}
+		}
+	}
+
+	return segment;
+}
+
+static
+void get_enumeration_field_class_mapping_labels_by_value(
+		const struct bt_field_class_enumeration *c_enum_fc,
+		uint64_t value,
+		bt_field_class_enumeration_mapping_label_array *label_array,
+		uint64_t *count)
+{
+	struct bt_field_class_enumeration *enum_fc = (void *) c_enum_fc;
+	const uint64_t key = enumeration_field_class_value_key(enum_fc, value);
+	uint64_t i;
+
+	if (!enum_fc->index.is_valid) {
+		/*
+		 * On failure, keep the index invalid: the linear scan
+		 * below still gives the right answer.
+		 */
+		(void) build_enumeration_field_class_index(enum_fc);
+	}
+
+	if (enum_fc->index.is_valid) {
+		const struct bt_field_class_enumeration_segment *segment =
+			find_enumeration_field_class_segment(enum_fc, key);
+
+		if (segment) {
+			*label_array = (void *)
+				&enum_fc->index.labels->pdata[segment->label_index];
+			*count = segment->label_count;
+		} else {
+			*label_array = (void *) enum_fc->index.labels->pdata;
+			*count = 0;
+		}
+
+		goto end;
+	}
+
+	g_ptr_array_set_size(enum_fc->label_buf, 0);
+
+	for (i = 0; i < enum_fc->mappings->len; i++) {
+		uint64_t j;
+		const struct bt_field_class_enumeration_mapping *mapping =
+			BT_FIELD_CLASS_ENUM_MAPPING_AT_INDEX(enum_fc, i);
+
+		for (j = 0; j < mapping->ranges->len; j++) {
+			const struct bt_field_class_enumeration_mapping_range *range =
+				BT_FIELD_CLASS_ENUM_MAPPING_RANGE_AT_INDEX(
+					mapping, j);
+
+			if (key >= enumeration_field_class_value_key(enum_fc,
+						range->lower.u) &&
+					key <= enumeration_field_class_value_key(
+						enum_fc, range->upper.u)) {
+				g_ptr_array_add(enum_fc->label_buf,
+					mapping->label->str);
+				break;
+			}
+		}
+	}
+
+	*label_array = (void *) enum_fc->label_buf->pdata;
+	*count = (uint64_t) enum_fc->label_buf->len;
+
+end:
+	return;
+}
+
 static
 void destroy_enumeration_field_class(struct bt_object *obj)
 {
@@ -224,6 +587,7 @@ void destroy_enumeration_field_class(struct bt_object *obj)
 		fc->label_buf = NULL;
 	}
 
+	reset_enumeration_field_class_index(fc);
 	g_free(fc);
 }
 
@@ -371,36 +735,14 @@ bt_field_class_unsigned_enumeration_get_mapping_labels_by_value(
 		uint64_t *count)
 {
 	const struct bt_field_class_enumeration *enum_fc = (const void *) fc;
-	uint64_t i;
 
 	BT_ASSERT_PRE_NON_NULL(fc, "Field class");
 	BT_ASSERT_PRE_NON_NULL(label_array, "Label array (output)");
 	BT_ASSERT_PRE_NON_NULL(count, "Count (output)");
 	BT_ASSERT_PRE_FC_HAS_ID(fc, BT_FIELD_CLASS_TYPE_UNSIGNED_ENUMERATION,
 		"Field class");
-	g_ptr_array_set_size(enum_fc->label_buf, 0);
-
-	for (i = 0; i < enum_fc->mappings->len; i++) {
-		uint64_t j;
-		const struct bt_field_class_enumeration_mapping *mapping =
-			BT_FIELD_CLASS_ENUM_MAPPING_AT_INDEX(enum_fc, i);
-
-		for (j = 0; j < mapping->ranges->len; j++) {
-			const struct bt_field_class_enumeration_mapping_range *range =
-				BT_FIELD_CLASS_ENUM_MAPPING_RANGE_AT_INDEX(
-					mapping, j);
-
-			if (value >= range->lower.u &&
-					value <= range->upper.u) {
-				g_ptr_array_add(enum_fc->label_buf,
-					mapping->label->str);
-				break;
-			}
-		}
-	}
-
-	*label_array = (void *) enum_fc->label_buf->pdata;
-	*count = (uint64_t) enum_fc->label_buf->len;
+	get_enumeration_field_class_mapping_labels_by_value(enum_fc,
+		(uint64_t) value, label_array, count);
 	return BT_FIELD_CLASS_STATUS_OK;
 }
 
@@ -411,36 +753,14 @@ bt_field_class_signed_enumeration_get_mapping_labels_by_value(
 		uint64_t *count)
 {
 	const struct bt_field_class_enumeration *enum_fc = (const void *) fc;
-	uint64_t i;
 
 	BT_ASSERT_PRE_NON_NULL(fc, "Field class");
 	BT_ASSERT_PRE_NON_NULL(label_array, "Label array (output)");
 	BT_ASSERT_PRE_NON_NULL(count, "Count (output)");
 	BT_ASSERT_PRE_FC_HAS_ID(fc, BT_FIELD_CLASS_TYPE_SIGNED_ENUMERATION,
 		"Field class");
-	g_ptr_array_set_size(enum_fc->label_buf, 0);
-
-	for (i = 0; i < enum_fc->mappings->len; i++) {
-		uint64_t j;
-		const struct bt_field_class_enumeration_mapping *mapping =
-			BT_FIELD_CLASS_ENUM_MAPPING_AT_INDEX(enum_fc, i);
-
-		for (j = 0; j < mapping->ranges->len; j++) {
-			const struct bt_field_class_enumeration_mapping_range *range =
-				BT_FIELD_CLASS_ENUM_MAPPING_RANGE_AT_INDEX(
-					mapping, j);
-
-			if (value >= range->lower.i &&
-					value <= range->upper.i) {
-				g_ptr_array_add(enum_fc->label_buf,
-					mapping->label->str);
-				break;
-			}
-		}
-	}
-
-	*label_array = (void *) enum_fc->label_buf->pdata;
-	*count = (uint64_t) enum_fc->label_buf->len;
+	get_enumeration_field_class_mapping_labels_by_value(enum_fc,
+		(uint64_t) value, label_array, count);
 	return BT_FIELD_CLASS_STATUS_OK;
 }
 
@@ -501,6 +821,7 @@ enum bt_field_class_status add_mapping_to_enumeration_field_class(
 		mapping->ranges->len - 1);
 	range->lower.u = lower;
 	range->upper.u = upper;
+	reset_enumeration_field_class_index(enum_fc);
 	BT_LIB_LOGV("Added mapping to enumeration field class: "
 		"%![fc-]+F, label=\"%s\", lower-unsigned=%" PRIu64 ", "
 		"upper-unsigned=%" PRIu64, fc, label, lower, upper);
@@ -1290,6 +1611,14 @@ void _bt_field_class_freeze(const struct bt_field_class *c_fc)
 
 		break;
 	}
+	case BT_FIELD_CLASS_TYPE_UNSIGNED_ENUMERATION:
+	case BT_FIELD_CLASS_TYPE_SIGNED_ENUMERATION:
+		/*
+		 * Not fatal: the index is built again on the first
+		 * value lookup.
+		 */
+		(void) build_enumeration_field_class_index((void *) fc);
+		break;
 	default:
 		break;
 	}
@@ -295,6 +295,7 @@ extern unsigned long pthread_getsequence_np(pthread_t *);
 #include <time.h>
 #include <stdarg.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <stdio.h>
 
@@ -530,6 +531,26 @@ typedef struct mem_block
 }
 mem_block;
 
+#if !defined(_WIN32) && !defined(_WIN64)
+	#define BT_LOG_ASYNC 1
+#else
+	#define BT_LOG_ASYNC 0
+#endif
+
+#if BT_LOG_ASYNC
+/* Time and process/thread IDs of a deferred log line
+ */
+typedef struct log_ctx
+{
+	struct timeval tv;
+	int pid;
+	int tid;
+}
+log_ctx;
+#else
+typedef struct log_ctx log_ctx;
+#endif
+
 static void time_callback(struct tm *const tm, unsigned *const usec);
 static void pid_callback(int *const pid, int *const tid);
 static void buffer_callback(bt_log_message *msg, char *buf);
@@ -780,6 +801,23 @@ static INLINE void tcache_set(const struct timeval *const tv, struct tm *const t
 }
 #endif
 
+#if _BT_LOG_MESSAGE_FORMAT_DATETIME_USED && !defined(_WIN32) && !defined(_WIN64)
+static void local_time(const struct timeval *const tv,
+					   struct tm *const tm, unsigned *const msec)
+{
+	#ifndef TCACHE
+	localtime_r(&tv->tv_sec, tm);
+	#else
+	if (!tcache_get(tv, tm))
+	{
+		localtime_r(&tv->tv_sec, tm);
+		tcache_set(tv, tm);
+	}
+	#endif
+	*msec = (unsigned)tv->tv_usec / 1000;
+}
+#endif
+
 static void time_callback(struct tm *const tm, unsigned *const msec)
 {
 #if !_BT_LOG_MESSAGE_FORMAT_DATETIME_USED
@@ -800,16 +838,7 @@ static void time_callback(struct tm *const tm, unsigned *const msec)
 	#else
 	struct timeval tv;
 	gettimeofday(&tv, 0);
-		#ifndef TCACHE
-		localtime_r(&tv.tv_sec, tm);
-		#else
-		if (!tcache_get(&tv, tm))
-		{
-			localtime_r(&tv.tv_sec, tm);
-			tcache_set(&tv, tm);
-		}
-		#endif
-	*msec = (unsigned)tv.tv_usec / 1000;
+	local_time(&tv, tm, msec);
 	#endif
 #endif
 }
@@ -1070,21 +1099,43 @@ static INLINE char *put_uint(unsigned v, const unsigned w, const char wc,
 #define _BT_LOG_MESSAGE_FORMAT_PUT_R(field) \
 	_PP_CONCAT_3(_BT_LOG_MESSAGE_FORMAT_PUT_R_, _, field)
 
-static void put_ctx(bt_log_message *const msg)
+/* Puts the context of a log line: the current one if `ctx` is 0.
+ */
+static void put_ctx(bt_log_message *const msg, const log_ctx *const ctx)
 {
 	_PP_MAP(_BT_LOG_MESSAGE_FORMAT_INIT, BT_LOG_MESSAGE_CTX_FORMAT)
+	VAR_UNUSED(ctx);
 #if !_BT_LOG_MESSAGE_FORMAT_FIELDS(BT_LOG_MESSAGE_CTX_FORMAT)
 	VAR_UNUSED(msg);
 #else
 	#if _BT_LOG_MESSAGE_FORMAT_DATETIME_USED
 	struct tm tm;
 	unsigned msec;
-	g_time_cb(&tm, &msec);
+		#if BT_LOG_ASYNC
+	if (0 != ctx)
+	{
+		local_time(&ctx->tv, &tm, &msec);
+	}
+	else
+		#endif
+	{
+		g_time_cb(&tm, &msec);
+	}
 	#endif
 	#if _BT_LOG_MESSAGE_FORMAT_CONTAINS(PID, BT_LOG_MESSAGE_CTX_FORMAT) || \
 		_BT_LOG_MESSAGE_FORMAT_CONTAINS(TID, BT_LOG_MESSAGE_CTX_FORMAT)
 	int pid, tid;
-	g_pid_cb(&pid, &tid);
+		#if BT_LOG_ASYNC
+	if (0 != ctx)
+	{
+		pid = ctx->pid;
+		tid = ctx->tid;
+	}
+	else
+		#endif
+	{
+		g_pid_cb(&pid, &tid);
+	}
 	#endif
 
 	#if BT_LOG_OPTIMIZE_SIZE
@@ -1103,11 +1154,11 @@ static void put_ctx(bt_log_message *const msg)
 #endif
 }
 
-#define PUT_TAG(msg, tag, prefix_delim, tag_delim) \
+#define PUT_TAG(msg, tag, prefix, prefix_delim, tag_delim) \
 	do { \
 		const char *ch; \
 		msg->tag_b = msg->p; \
-		if (0 != (ch = _bt_log_tag_prefix)) { \
+		if (0 != (ch = prefix)) { \
 			for (;msg->e != msg->p && 0 != (*msg->p = *ch); ++msg->p, ++ch) {} \
 		} \
 		if (0 != (ch = tag) && 0 != tag[0]) { \
@@ -1135,7 +1186,7 @@ static void put_ctx(bt_log_message *const msg)
 #define _BT_LOG_MESSAGE_FORMAT_PUT__PID          UNDEFINED
 #define _BT_LOG_MESSAGE_FORMAT_PUT__TID          UNDEFINED
 #define _BT_LOG_MESSAGE_FORMAT_PUT__LEVEL        UNDEFINED
-#define _BT_LOG_MESSAGE_FORMAT_PUT__TAG(pd, td)  PUT_TAG(msg, tag, pd, td);
+#define _BT_LOG_MESSAGE_FORMAT_PUT__TAG(pd, td)  PUT_TAG(msg, tag, tag_prefix, pd, td);
 #define _BT_LOG_MESSAGE_FORMAT_PUT__FUNCTION     msg->p = put_string(funcname(src->func), msg->p, msg->e);
 #define _BT_LOG_MESSAGE_FORMAT_PUT__FILENAME     msg->p = put_string(filename(src->file), msg->p, msg->e);
 #define _BT_LOG_MESSAGE_FORMAT_PUT__FILELINE     msg->p = put_uint(src->line, 0, '\0', msg->p, msg->e);
@@ -1145,10 +1196,12 @@ static void put_ctx(bt_log_message *const msg)
 #define _BT_LOG_MESSAGE_FORMAT_PUT(field) \
 	_PP_CONCAT_3(_BT_LOG_MESSAGE_FORMAT_PUT_, _, field)
 
-static void put_tag(bt_log_message *const msg, const char *const tag)
+static void put_tag(bt_log_message *const msg, const char *const tag_prefix,
+					const char *const tag)
 {
 	_PP_MAP(_BT_LOG_MESSAGE_FORMAT_INIT, BT_LOG_MESSAGE_TAG_FORMAT)
 #if !_BT_LOG_MESSAGE_FORMAT_CONTAINS(TAG, BT_LOG_MESSAGE_TAG_FORMAT)
+	VAR_UNUSED(tag_prefix);
 	VAR_UNUSED(tag);
 #endif
 #if !_BT_LOG_MESSAGE_FORMAT_FIELDS(BT_LOG_MESSAGE_TAG_FORMAT)
@@ -1190,6 +1243,807 @@ static void put_msg(bt_log_message *const msg,
 	put_nprintf(msg, n);
 }
 
+/* Puts the color, context, tag, and source location of a log line.
+ */
+static void put_line_prefix(bt_log_message *const msg, const unsigned mask,
+							const log_ctx *const ctx,
+							const char *const tag_prefix,
+							const src_location *const src)
+{
+	const char *color_p = "";
+
+	switch (msg->lvl) {
+	case BT_LOG_INFO:
+		color_p = bt_common_color_fg_blue();
+		break;
+	case BT_LOG_WARN:
+		color_p = bt_common_color_fg_yellow();
+		break;
+	case BT_LOG_ERROR:
+	case BT_LOG_FATAL:
+		color_p = bt_common_color_fg_red();
+		break;
+	default:
+		break;
+	}
+
+	msg->p = put_stringn(color_p, color_p + strlen(color_p), msg->p, msg->e);
+
+	if (BT_LOG_PUT_CTX & mask)
+	{
+		put_ctx(msg, ctx);
+	}
+	if (BT_LOG_PUT_TAG & mask)
+	{
+		put_tag(msg, tag_prefix, msg->tag);
+	}
+	if (0 != src && BT_LOG_PUT_SRC & mask)
+	{
+		put_src(msg, src);
+	}
+}
+
+static void put_line_suffix(bt_log_message *const msg)
+{
+	const char *const rst_color_p = bt_common_color_reset();
+
+	msg->p = put_stringn(rst_color_p, rst_color_p + strlen(rst_color_p),
+						 msg->p, msg->e);
+}
+
+/*
+ * Asynchronous output.
+ *
+ * When the `BABELTRACE_LOGGING_ASYNC` environment variable is `1`, the
+ * calling thread does not format the log line: it copies what's needed
+ * to format it (format string, arguments, tag, source location, time,
+ * and process/thread IDs) as a record to the asynchronous output
+ * backend of the Babeltrace library (see
+ * <babeltrace/logging-async-internal.h>). The backend's writer thread
+ * then formats the record and calls the output callback with
+ * _bt_log_async_output_record().
+ *
+ * The string arguments (`%s`) are copied: the caller is free to modify
+ * or free them once the logging statement returns. If the format string
+ * contains a conversion specification of which this file cannot copy
+ * the argument (for example a positional argument, `%n`, `%ls`, `%Lf`,
+ * or more than `ASYNC_MAX_ARGS` arguments), the calling thread formats
+ * the message part itself: only the rest of the log line is deferred.
+ * Memory dump lines are always formatted by the calling thread.
+ *
+ * The backend's functions are weak references: a module which is not
+ * linked with the Babeltrace library always outputs synchronously. Each
+ * module outputs its pending records when it's unloaded, as they can
+ * reference its output callbacks.
+ */
+#if BT_LOG_ASYNC
+#include <babeltrace/logging-async-internal.h>
+
+#pragma weak bt_log_async_backend_is_enabled
+#pragma weak bt_log_async_backend_reserve
+#pragma weak bt_log_async_backend_commit
+#pragma weak bt_log_async_backend_flush
+#pragma weak bt_log_async_backend_sync
+
+/* Maximum number of captured arguments of a deferred log line,
+ * including the `*` field widths and precisions.
+ */
+#define ASYNC_MAX_ARGS 16
+
+typedef enum async_arg_type
+{
+	ASYNC_ARG_INT,
+	ASYNC_ARG_LONG,
+	ASYNC_ARG_LLONG,
+	ASYNC_ARG_INTMAX,
+	ASYNC_ARG_SIZE,
+	ASYNC_ARG_PTRDIFF,
+	ASYNC_ARG_DOUBLE,
+	ASYNC_ARG_PTR,
+	ASYNC_ARG_STR,
+	ASYNC_ARG_UNSUPPORTED,
+}
+async_arg_type;
+
+typedef enum async_length
+{
+	ASYNC_LENGTH_NONE,
+	ASYNC_LENGTH_HH,
+	ASYNC_LENGTH_H,
+	ASYNC_LENGTH_L,
+	ASYNC_LENGTH_LL,
+	ASYNC_LENGTH_J,
+	ASYNC_LENGTH_Z,
+	ASYNC_LENGTH_T,
+	ASYNC_LENGTH_BIG_L,
+}
+async_length;
+
+/* Conversion specification of a format string.
+ */
+typedef struct async_conv
+{
+	/* End of the conversion specification */
+	const char *end;
+	async_arg_type type;
+
+	/* Number of `*` (each one consumes an `int` argument first) */
+	unsigned nstars;
+
+	/* Whether the precision is `*`, or the precision (-1 if none) */
+	int prec_star;
+	int prec;
+}
+async_conv;
+
+typedef struct async_arg
+{
+	async_arg_type type;
+
+	/* For ASYNC_ARG_STR, `p` is the string to copy while capturing, and
+	 * `z` is the offset of its copy within the record (SIZE_MAX for a
+	 * null pointer) once it's copied.
+	 */
+	union
+	{
+		int i;
+		long l;
+		long long ll;
+		intmax_t j;
+		size_t z;
+		ptrdiff_t t;
+		double d;
+		const void *p;
+	}
+	v;
+
+	/* Length of the string to copy (ASYNC_ARG_STR) */
+	size_t len;
+}
+async_arg;
+
+typedef enum async_record_type
+{
+	/* Log line to format, possibly with an already formatted message */
+	ASYNC_RECORD_LOG,
+
+	/* Formatted log line (memory dump) */
+	ASYNC_RECORD_LINE,
+}
+async_record_type;
+
+typedef struct async_record
+{
+	async_record_type type;
+	bt_log_output_cb callback;
+	void *arg;
+	unsigned mask;
+	int lvl;
+	log_ctx ctx;
+	int has_src;
+	unsigned line;
+
+	/* Number of captured arguments, or -1 if the text is the formatted
+	 * message (ASYNC_RECORD_LOG)
+	 */
+	int nargs;
+
+	/* Offsets of the message fields within the text (ASYNC_RECORD_LINE) */
+	size_t tag_b_off;
+	size_t tag_e_off;
+	size_t msg_b_off;
+
+	/* Sizes of the strings which follow the arguments, including their
+	 * null character (0 for a null pointer): tag prefix, tag, function
+	 * name, file name, text (format string, formatted message, or line),
+	 * and string arguments
+	 */
+	size_t tag_prefix_sz;
+	size_t tag_sz;
+	size_t func_sz;
+	size_t file_sz;
+	size_t text_sz;
+	size_t str_sz;
+}
+async_record;
+
+static INLINE int async_is_enabled(void)
+{
+	return 0 != bt_log_async_backend_is_enabled &&
+		bt_log_async_backend_is_enabled();
+}
+
+static INLINE size_t async_str_size(const char *const s)
+{
+	return 0 != s? strlen(s) + 1: 0;
+}
+
+static INLINE char *async_put_str(char *const p, const char *const s,
+								  const size_t sz)
+{
+	memcpy(p, s, sz);
+	return p + sz;
+}
+
+static INLINE const char *async_get_str(const char **const p, const size_t sz)
+{
+	const char *const s = 0 != sz? *p: 0;
+	*p += sz;
+	return s;
+}
+
+/* Finds the next conversion specification of `p`, skipping `%%`, and
+ * sets `*conv` accordingly. Returns 0 if there's none.
+ */
+static int async_next_conv(const char *p, async_conv *const conv)
+{
+	async_length length = ASYNC_LENGTH_NONE;
+
+	for (;;)
+	{
+		p = strchr(p, '%');
+		if (0 == p)
+		{
+			return 0;
+		}
+		if ('%' != p[1])
+		{
+			break;
+		}
+		p += 2;
+	}
+
+	++p;
+	conv->type = ASYNC_ARG_UNSUPPORTED;
+	conv->nstars = 0;
+	conv->prec_star = 0;
+	conv->prec = -1;
+
+	while (0 != *p && 0 != strchr("-+ #0'", *p))
+	{
+		++p;
+	}
+
+	if ('*' == *p)
+	{
+		++conv->nstars;
+		++p;
+	}
+	else
+	{
+		while (isdigit((unsigned char)*p))
+		{
+			++p;
+		}
+		if ('$' == *p)
+		{
+			/* Positional argument */
+			goto end;
+		}
+	}
+
+	if ('.' == *p)
+	{
+		++p;
+		if ('*' == *p)
+		{
+			++conv->nstars;
+			conv->prec_star = 1;
+			++p;
+		}
+		else
+		{
+			conv->prec = 0;
+			for (; isdigit((unsigned char)*p); ++p)
+			{
+				if (conv->prec < 0x10000)
+				{
+					conv->prec = 10 * conv->prec + (*p - '0');
+				}
+			}
+		}
+	}
+
+	switch (*p)
+	{
+	case 'h':
+		length = 'h' == *++p? ++p, ASYNC_LENGTH_HH: ASYNC_LENGTH_H;
+		break;
+	case 'l':
+		length = 'l' == *++p? ++p, ASYNC_LENGTH_LL: ASYNC_LENGTH_L;
+		break;
+	case 'q':
+		length = ASYNC_LENGTH_LL;
+		++p;
+		break;
+	case 'j':
+		length = ASYNC_LENGTH_J;
+		++p;
+		break;
+	case 'z':
+	case 'Z':
+		length = ASYNC_LENGTH_Z;
+		++p;
+		break;
+	case 't':
+		length = ASYNC_LENGTH_T;
+		++p;
+		break;
+	case 'L':
+		length = ASYNC_LENGTH_BIG_L;
+		++p;
+		break;
+	default:
+		break;
+	}
+
+	switch (*p)
+	{
+	case 'd':
+	case 'i':
+	case 'o':
+	case 'u':
+	case 'x':
+	case 'X':
+		switch (length)
+		{
+		case ASYNC_LENGTH_NONE:
+		case ASYNC_LENGTH_HH:
+		case ASYNC_LENGTH_H:
+			conv->type = ASYNC_ARG_INT;
+			break;
+		case ASYNC_LENGTH_L:
+			conv->type = ASYNC_ARG_LONG;
+			break;
+		case ASYNC_LENGTH_LL:
+			conv->type = ASYNC_ARG_LLONG;
+			break;
+		case ASYNC_LENGTH_J:
+			conv->type = ASYNC_ARG_INTMAX;
+			break;
+		case ASYNC_LENGTH_Z:
+			conv->type = ASYNC_ARG_SIZE;
+			break;
+		case ASYNC_LENGTH_T:
+			conv->type = ASYNC_ARG_PTRDIFF;
+			break;
+		default:
+			break;
+		}
+		break;
+	case 'e':
+	case 'E':
+	case 'f':
+	case 'F':
+	case 'g':
+	case 'G':
+	case 'a':
+	case 'A':
+		if (ASYNC_LENGTH_NONE == length || ASYNC_LENGTH_L == length)
+		{
+			conv->type = ASYNC_ARG_DOUBLE;
+		}
+		break;
+	case 'c':
+		if (ASYNC_LENGTH_NONE == length)
+		{
+			conv->type = ASYNC_ARG_INT;
+		}
+		break;
+	case 'p':
+		if (ASYNC_LENGTH_NONE == length)
+		{
+			conv->type = ASYNC_ARG_PTR;
+		}
+		break;
+	case 's':
+		if (ASYNC_LENGTH_NONE == length)
+		{
+			conv->type = ASYNC_ARG_STR;
+		}
+		break;
+	default:
+		break;
+	}
+
+	if (0 != *p)
+	{
+		++p;
+	}
+
+end:
+	conv->end = p;
+	return !0;
+}
+
+/* Captures the arguments of the conversion specifications of `fmt` from
+ * `*va` to `args`, and sets `*str_sz` to the total size of the string
+ * arguments to copy, including their null characters. Returns the
+ * number of captured arguments, or -1 if they cannot be captured.
+ */
+static int async_capture_args(const char *fmt, va_list *const va,
+							  async_arg *const args, size_t *const str_sz)
+{
+	async_conv conv;
+	int nargs = 0;
+
+	*str_sz = 0;
+
+	while (async_next_conv(fmt, &conv))
+	{
+		int prec = conv.prec;
+		async_arg *arg;
+
+		if (ASYNC_ARG_UNSUPPORTED == conv.type ||
+			ASYNC_MAX_ARGS - nargs < (int)conv.nstars + 1)
+		{
+			return -1;
+		}
+
+		for (unsigned i = 0; conv.nstars > i; ++i)
+		{
+			arg = &args[nargs++];
+			arg->type = ASYNC_ARG_INT;
+			arg->v.i = va_arg(*va, int);
+		}
+
+		if (conv.prec_star)
+		{
+			prec = args[nargs - 1].v.i;
+		}
+
+		arg = &args[nargs++];
+		arg->type = conv.type;
+
+		switch (conv.type)
+		{
+		case ASYNC_ARG_INT:
+			arg->v.i = va_arg(*va, int);
+			break;
+		case ASYNC_ARG_LONG:
+			arg->v.l = va_arg(*va, long);
+			break;
+		case ASYNC_ARG_LLONG:
+			arg->v.ll = va_arg(*va, long long);
+			break;
+		case ASYNC_ARG_INTMAX:
+			arg->v.j = va_arg(*va, intmax_t);
+			break;
+		case ASYNC_ARG_SIZE:
+			arg->v.z = va_arg(*va, size_t);
+			break;
+		case ASYNC_ARG_PTRDIFF:
+			arg->v.t = va_arg(*va, ptrdiff_t);
+			break;
+		case ASYNC_ARG_DOUBLE:
+			arg->v.d = va_arg(*va, double);
+			break;
+		case ASYNC_ARG_PTR:
+			arg->v.p = va_arg(*va, void *);
+			break;
+		case ASYNC_ARG_STR:
+		{
+			const char *const s = va_arg(*va, const char *);
+
+			/* What does not fit in a log line is not output anyway */
+			arg->v.p = s;
+			arg->len = 0 != s?
+				strnlen(s, 0 <= prec && (unsigned)prec < g_buf_sz?
+					(size_t)prec: g_buf_sz): 0;
+			*str_sz += arg->len + 1;
+			break;
+		}
+		default:
+			return -1;
+		}
+
+		fmt = conv.end;
+	}
+
+	return nargs;
+}
+
+/* Writes the log line `msg` to the asynchronous output as is.
+ */
+static void async_write_line(const bt_log_output *const output,
+							 const bt_log_message *const msg)
+{
+	const size_t tag_sz = async_str_size(msg->tag);
+	const size_t text_sz = (size_t)(msg->p - msg->buf);
+	async_record *const rec = bt_log_async_backend_reserve(
+		sizeof(*rec) + tag_sz + text_sz);
+	char *p;
+
+	if (0 == rec)
+	{
+		return;
+	}
+
+	memset(rec, 0, sizeof(*rec));
+	rec->type = ASYNC_RECORD_LINE;
+	rec->callback = output->callback;
+	rec->arg = output->arg;
+	rec->lvl = msg->lvl;
+	rec->tag_b_off = (size_t)(msg->tag_b - msg->buf);
+	rec->tag_e_off = (size_t)(msg->tag_e - msg->buf);
+	rec->msg_b_off = (size_t)(msg->msg_b - msg->buf);
+	rec->tag_sz = tag_sz;
+	rec->text_sz = text_sz;
+	p = (char *)(rec + 1);
+	p = async_put_str(p, msg->tag, tag_sz);
+	async_put_str(p, msg->buf, text_sz);
+	bt_log_async_backend_commit();
+}
+
+/* Writes the log line to format later to the asynchronous output.
+ */
+static void async_write_log(const bt_log_output *const output,
+							const src_location *const src,
+							const int lvl, const char *const tag,
+							const char *const fmt, va_list va)
+{
+	async_arg args[ASYNC_MAX_ARGS];
+	async_record *rec;
+	const char *text = fmt;
+	size_t str_sz;
+	va_list va_args;
+	int nargs;
+	char *p;
+
+	va_copy(va_args, va);
+	nargs = async_capture_args(fmt, &va_args, args, &str_sz);
+	va_end(va_args);
+
+	if (0 > nargs || BT_LOG_BUF_SZ <= strlen(fmt))
+	{
+		/* Cannot defer the message part: format it now */
+		vsnprintf(logging_buf, g_buf_sz, fmt, va);
+		text = logging_buf;
+		nargs = -1;
+		str_sz = 0;
+	}
+
+	const size_t args_sz = 0 < nargs? (size_t)nargs * sizeof(*args): 0;
+	const size_t tag_prefix_sz = async_str_size(_bt_log_tag_prefix);
+	const size_t tag_sz = async_str_size(tag);
+	const size_t func_sz = 0 != src? async_str_size(src->func): 0;
+	const size_t file_sz = 0 != src? async_str_size(src->file): 0;
+	const size_t text_sz = strlen(text) + 1;
+
+	rec = bt_log_async_backend_reserve(sizeof(*rec) + args_sz +
+		tag_prefix_sz + tag_sz + func_sz + file_sz + text_sz + str_sz);
+	if (0 == rec)
+	{
+		return;
+	}
+
+	memset(rec, 0, sizeof(*rec));
+	rec->type = ASYNC_RECORD_LOG;
+	rec->callback = output->callback;
+	rec->arg = output->arg;
+	rec->mask = output->mask;
+	rec->lvl = lvl;
+#if _BT_LOG_MESSAGE_FORMAT_DATETIME_USED
+	gettimeofday(&rec->ctx.tv, 0);
+#endif
+#if _BT_LOG_MESSAGE_FORMAT_CONTAINS(PID, BT_LOG_MESSAGE_CTX_FORMAT) || \
+	_BT_LOG_MESSAGE_FORMAT_CONTAINS(TID, BT_LOG_MESSAGE_CTX_FORMAT)
+	g_pid_cb(&rec->ctx.pid, &rec->ctx.tid);
+#endif
+	rec->has_src = 0 != src;
+	rec->line = 0 != src? src->line: 0;
+	rec->nargs = nargs;
+	rec->tag_prefix_sz = tag_prefix_sz;
+	rec->tag_sz = tag_sz;
+	rec->func_sz = func_sz;
+	rec->file_sz = file_sz;
+	rec->text_sz = text_sz;
+	rec->str_sz = str_sz;
+	memcpy(rec + 1, args, args_sz);
+	p = (char *)(rec + 1) + args_sz;
+	p = async_put_str(p, _bt_log_tag_prefix, tag_prefix_sz);
+	p = async_put_str(p, tag, tag_sz);
+	p = async_put_str(p, 0 != src? src->func: 0, func_sz);
+	p = async_put_str(p, 0 != src? src->file: 0, file_sz);
+	p = async_put_str(p, text, text_sz);
+
+	if (0 < str_sz)
+	{
+		async_arg *const rec_args = (async_arg *)(rec + 1);
+		char *const str_b = p;
+
+		for (int i = 0; nargs > i; ++i)
+		{
+			if (ASYNC_ARG_STR != args[i].type)
+			{
+				continue;
+			}
+			if (0 == args[i].v.p)
+			{
+				rec_args[i].v.z = SIZE_MAX;
+				continue;
+			}
+			rec_args[i].v.z = (size_t)(p - str_b);
+			p = async_put_str(p, args[i].v.p, args[i].len);
+			*p++ = '\0';
+		}
+	}
+
+	bt_log_async_backend_commit();
+}
+
+/* Formats a single conversion specification `fmt` with its captured
+ * `*`-values `stars` and argument `arg`.
+ */
+static int async_snprintf(bt_log_message *const msg, const char *const fmt,
+						  const unsigned nstars, const int *const stars,
+						  const async_arg *const arg, const char *const str_b)
+{
+#define ASYNC_SNPRINTF(val) \
+	(0 == nstars? snprintf(msg->p, nprintf_size(msg), fmt, val): \
+	 1 == nstars? snprintf(msg->p, nprintf_size(msg), fmt, stars[0], val): \
+	 snprintf(msg->p, nprintf_size(msg), fmt, stars[0], stars[1], val))
+
+	switch (arg->type)
+	{
+	case ASYNC_ARG_INT:
+		return ASYNC_SNPRINTF(arg->v.i);
+	case ASYNC_ARG_LONG:
+		return ASYNC_SNPRINTF(arg->v.l);
+	case ASYNC_ARG_LLONG:
+		return ASYNC_SNPRINTF(arg->v.ll);
+	case ASYNC_ARG_INTMAX:
+		return ASYNC_SNPRINTF(arg->v.j);
+	case ASYNC_ARG_SIZE:
+		return ASYNC_SNPRINTF(arg->v.z);
+	case ASYNC_ARG_PTRDIFF:
+		return ASYNC_SNPRINTF(arg->v.t);
+	case ASYNC_ARG_DOUBLE:
+		return ASYNC_SNPRINTF(arg->v.d);
+	case ASYNC_ARG_PTR:
+		return ASYNC_SNPRINTF(arg->v.p);
+	case ASYNC_ARG_STR:
+		return ASYNC_SNPRINTF(SIZE_MAX != arg->v.z?
+			str_b + arg->v.z: (const char *)0);
+	default:
+		return 0;
+	}
+
+#undef ASYNC_SNPRINTF
+}
+
+/* Puts the message of a log line from its format string `fmt` (modified
+ * temporarily) and captured arguments `args`.
+ */
+static void async_put_msg(bt_log_message *const msg, char *fmt,
+						  const async_arg *args, const char *const str_b)
+{
+	async_conv conv;
+
+	msg->msg_b = msg->p;
+
+	while (async_next_conv(fmt, &conv))
+	{
+		char *const end = (char *)conv.end;
+		const char end_ch = *end;
+		int stars[2];
+		int n;
+
+		for (unsigned i = 0; conv.nstars > i; ++i)
+		{
+			stars[i] = (args++)->v.i;
+		}
+
+		*end = '\0';
+		n = async_snprintf(msg, fmt, conv.nstars, stars, args++, str_b);
+		*end = end_ch;
+		put_nprintf(msg, n);
+		fmt = end;
+	}
+
+	for (; 0 != *fmt && msg->e != msg->p; ++fmt)
+	{
+		if ('%' == fmt[0] && '%' == fmt[1])
+		{
+			++fmt;
+		}
+		*msg->p++ = *fmt;
+	}
+}
+
+BT_HIDDEN
+void _bt_log_async_output_record(const void *const data)
+{
+	/* Only the backend's consumer calls this */
+	static char line_buf[BT_LOG_BUF_SZ];
+	static char fmt_buf[BT_LOG_BUF_SZ];
+	const async_record *const rec = data;
+	const async_arg *const args = (const async_arg *)(rec + 1);
+	const char *str = (const char *)(args + (0 < rec->nargs? rec->nargs: 0));
+	const char *const tag_prefix = async_get_str(&str, rec->tag_prefix_sz);
+	const char *const tag = async_get_str(&str, rec->tag_sz);
+	const char *const func = async_get_str(&str, rec->func_sz);
+	const char *const file = async_get_str(&str, rec->file_sz);
+	const char *const text = str;
+	bt_log_message msg;
+
+	msg.lvl = rec->lvl;
+	msg.tag = tag;
+	g_buffer_cb(&msg, line_buf);
+
+	if (ASYNC_RECORD_LINE == rec->type)
+	{
+		/* Same layout as the calling thread's buffer: an output
+		 * callback is allowed to write the end of line at `msg.p`.
+		 */
+		memcpy(line_buf, text, rec->text_sz);
+		msg.p = line_buf + rec->text_sz;
+		msg.tag_b = line_buf + rec->tag_b_off;
+		msg.tag_e = line_buf + rec->tag_e_off;
+		msg.msg_b = line_buf + rec->msg_b_off;
+	}
+	else
+	{
+		const src_location src = {func, file, rec->line};
+
+		put_line_prefix(&msg, rec->mask, &rec->ctx, tag_prefix,
+						rec->has_src? &src: 0);
+		if (BT_LOG_PUT_MSG & rec->mask)
+		{
+			if (0 > rec->nargs)
+			{
+				msg.msg_b = msg.p;
+				msg.p = put_string(text, msg.p, msg.e);
+			}
+			else
+			{
+				memcpy(fmt_buf, text, rec->text_sz);
+				async_put_msg(&msg, fmt_buf, args, text + rec->text_sz);
+			}
+		}
+		put_line_suffix(&msg);
+	}
+
+	rec->callback(&msg, rec->arg);
+}
+
+static __attribute__((destructor)) void async_fini(void)
+{
+	/* Pending records can reference this module's output callbacks */
+	if (0 != bt_log_async_backend_sync)
+	{
+		bt_log_async_backend_sync();
+	}
+}
+#endif /* BT_LOG_ASYNC */
+
+BT_HIDDEN
+void bt_log_async_flush(void)
+{
+#if BT_LOG_ASYNC
+	if (0 != bt_log_async_backend_flush)
+	{
+		bt_log_async_backend_flush();
+	}
+#endif
+}
+
+/* Sends the log line `msg` to the output callback of `output`, either
+ * directly or through the asynchronous output.
+ */
+static void output_msg(const bt_log_output *const output,
+		bt_log_message *const msg)
+{
+#if BT_LOG_ASYNC
+	if (async_is_enabled())
+	{
+		async_write_line(output, msg);
+		return;
+	}
+#endif
+	output->callback(msg, output->arg);
+}
+
 static void output_mem(const bt_log_spec *log, bt_log_message *const msg,
 					   const mem_block *const mem)
 {
@@ -1225,7 +2079,7 @@ static void output_mem(const bt_log_spec *log, bt_log_message *const msg,
 			*hex++ = ' ';
 		}
 		msg->p = ascii;
-		log->output->callback(msg, log->output->arg);
+		output_msg(log->output, msg);
 	}
 }
 
@@ -1262,58 +2116,36 @@ static void _bt_log_write_imp(
 		const int lvl, const char *const tag, const char *const fmt, va_list va)
 {
 	bt_log_message msg;
-	char *buf = logging_buf;
 	const unsigned mask = log->output->mask;
-	msg.lvl = lvl;
-	msg.tag = tag;
-	g_buffer_cb(&msg, buf);
-	const char *rst_color_p = bt_common_color_reset();
-	const char *rst_color_e = rst_color_p + strlen(rst_color_p);
-	const char *color_p = "";
-	const char *color_e = color_p;
-
-	switch (lvl) {
-	case BT_LOG_INFO:
-		color_p = bt_common_color_fg_blue();
-		color_e = color_p + strlen(color_p);
-		break;
-	case BT_LOG_WARN:
-		color_p = bt_common_color_fg_yellow();
-		color_e = color_p + strlen(color_p);
-		break;
-	case BT_LOG_ERROR:
-	case BT_LOG_FATAL:
-		color_p = bt_common_color_fg_red();
-		color_e = color_p + strlen(color_p);
-		break;
-	default:
-		break;
-	}
-
-	msg.p = put_stringn(color_p, color_e, msg.p, msg.e);
-
-	if (BT_LOG_PUT_CTX & mask)
+#if BT_LOG_ASYNC
+	if (0 == mem && async_is_enabled())
 	{
-		put_ctx(&msg);
-	}
-	if (BT_LOG_PUT_TAG & mask)
-	{
-		put_tag(&msg, tag);
-	}
-	if (0 != src && BT_LOG_PUT_SRC & mask)
-	{
-		put_src(&msg, src);
+		async_write_log(log->output, src, lvl, tag, fmt, va);
+		goto end;
 	}
+#endif
+	msg.lvl = lvl;
+	msg.tag = tag;
+	g_buffer_cb(&msg, logging_buf);
+	put_line_prefix(&msg, mask, 0, _bt_log_tag_prefix, src);
 	if (BT_LOG_PUT_MSG & mask)
 	{
 		put_msg(&msg, fmt, va);
 	}
-	msg.p = put_stringn(rst_color_p, rst_color_e, msg.p, msg.e);
-	log->output->callback(&msg, log->output->arg);
+	put_line_suffix(&msg);
+	output_msg(log->output, &msg);
 	if (0 != mem && BT_LOG_PUT_MSG & mask)
 	{
 		output_mem(log, &msg, mem);
 	}
+#if BT_LOG_ASYNC
+end:
+#endif
+	if (BT_LOG_FATAL == lvl)
+	{
+		/* An abort() follows: do not lose anything */
+		bt_log_async_flush();
+	}
 }
 
 BT_HIDDEN
@@ -0,0 +1,219 @@
+#ifndef BABELTRACE_PLUGIN_CTF_COLUMNAR_SINK_COLUMNAR_FORMAT_H
+#define BABELTRACE_PLUGIN_CTF_COLUMNAR_SINK_COLUMNAR_FORMAT_H
+
+/*
+ * Copyright 2019 - EfficiOS Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <string.h>
+
+/*
+ * On-disk layout of a `sink.ctf.columnar` table, shared by the sink
+ * and by the reader library.
+ *
+ * A table is a directory which contains all the events of a given
+ * event class. Its `schema` file is a GLib key file:
+ *
+ *     [table]
+ *     version=1
+ *     event-class-name=my_event
+ *     event-class-id=0
+ *     byte-order=little-endian
+ *     row-count=1542
+ *     column-count=3
+ *
+ *     [column 0]
+ *     name=timestamp
+ *     type=int64
+ *
+ *     [column 1]
+ *     name=payload.msg
+ *     type=string
+ *
+ *     [column 2]
+ *     name=payload.values
+ *     type=list-uint32
+ *
+ * Column N's values are in the `col-N.data` file of the table
+ * directory. Fixed-width columns contain exactly `row-count` values,
+ * in the native byte order of the machine which wrote the table
+ * (`byte-order` above).
+ *
+ * String and list columns also have a `col-N.offsets` file containing
+ * `row-count` 64-bit unsigned integers: the value at index I is the
+ * end offset (bytes for a string column, elements for a list column)
+ * of row I within `col-N.data`. The beginning offset of row I is the
+ * end offset of row I - 1, or 0 for the first row. String data does
+ * not contain null characters.
+ */
+
+#define COLUMNAR_FORMAT_VERSION		1
+
+#define COLUMNAR_SCHEMA_FILE_NAME	"schema"
+#define COLUMNAR_TABLE_GROUP		"table"
+#define COLUMNAR_COLUMN_GROUP_FMT	"column %" PRIu64
+#define COLUMNAR_DATA_FILE_NAME_FMT	"col-%" PRIu64 ".data"
+#define COLUMNAR_OFFSETS_FILE_NAME_FMT	"col-%" PRIu64 ".offsets"
+
+#define COLUMNAR_TIMESTAMP_COLUMN_NAME	"timestamp"
+
+enum columnar_column_type {
+	COLUMNAR_COLUMN_TYPE_INT8,
+	COLUMNAR_COLUMN_TYPE_UINT8,
+	COLUMNAR_COLUMN_TYPE_INT16,
+	COLUMNAR_COLUMN_TYPE_UINT16,
+	COLUMNAR_COLUMN_TYPE_INT32,
+	COLUMNAR_COLUMN_TYPE_UINT32,
+	COLUMNAR_COLUMN_TYPE_INT64,
+	COLUMNAR_COLUMN_TYPE_UINT64,
+	COLUMNAR_COLUMN_TYPE_FLOAT32,
+	COLUMNAR_COLUMN_TYPE_FLOAT64,
+	COLUMNAR_COLUMN_TYPE_STRING,
+
+	/*
+	 * List types: same order as the scalar types above, so that
+	 * `type - COLUMNAR_COLUMN_TYPE_LIST_INT8` is the element type.
+	 */
+	COLUMNAR_COLUMN_TYPE_LIST_INT8,
+	COLUMNAR_COLUMN_TYPE_LIST_UINT8,
+	COLUMNAR_COLUMN_TYPE_LIST_INT16,
+	COLUMNAR_COLUMN_TYPE_LIST_UINT16,
+	COLUMNAR_COLUMN_TYPE_LIST_INT32,
+	COLUMNAR_COLUMN_TYPE_LIST_UINT32,
+	COLUMNAR_COLUMN_TYPE_LIST_INT64,
+	COLUMNAR_COLUMN_TYPE_LIST_UINT64,
+	COLUMNAR_COLUMN_TYPE_LIST_FLOAT32,
+	COLUMNAR_COLUMN_TYPE_LIST_FLOAT64,
+};
+
+static inline
+const char *columnar_column_type_string(enum columnar_column_type type)
+{
+	switch (type) {
+	case COLUMNAR_COLUMN_TYPE_INT8:
+		return "int8";
+	case COLUMNAR_COLUMN_TYPE_UINT8:
+		return "uint8";
+	case COLUMNAR_COLUMN_TYPE_INT16:
+		return "int16";
+	case COLUMNAR_COLUMN_TYPE_UINT16:
+		return "uint16";
+	case COLUMNAR_COLUMN_TYPE_INT32:
+		return "int32";
+	case COLUMNAR_COLUMN_TYPE_UINT32:
+		return "uint32";
+	case COLUMNAR_COLUMN_TYPE_INT64:
+		return "int64";
+	case COLUMNAR_COLUMN_TYPE_UINT64:
+		return "uint64";
+	case COLUMNAR_COLUMN_TYPE_FLOAT32:
+		return "float32";
+	case COLUMNAR_COLUMN_TYPE_FLOAT64:
+		return "float64";
+	case COLUMNAR_COLUMN_TYPE_STRING:
+		return "string";
+	case COLUMNAR_COLUMN_TYPE_LIST_INT8:
+		return "list-int8";
+	case COLUMNAR_COLUMN_TYPE_LIST_UINT8:
+		return "list-uint8";
+	case COLUMNAR_COLUMN_TYPE_LIST_INT16:
+		return "list-int16";
+	case COLUMNAR_COLUMN_TYPE_LIST_UINT16:
+		return "list-uint16";
+	case COLUMNAR_COLUMN_TYPE_LIST_INT32:
+		return "list-int32";
+	case COLUMNAR_COLUMN_TYPE_LIST_UINT32:
+		return "list-uint32";
+	case COLUMNAR_COLUMN_TYPE_LIST_INT64:
+		return "list-int64";
+	case COLUMNAR_COLUMN_TYPE_LIST_UINT64:
+		return "list-uint64";
+	case COLUMNAR_COLUMN_TYPE_LIST_FLOAT32:
+		return "list-float32";
+	case COLUMNAR_COLUMN_TYPE_LIST_FLOAT64:
+		return "list-float64";
+	default:
+		return "(unknown)";
+	}
+}
+
+static inline
+int columnar_column_type_from_string(const char *str,
+		enum columnar_column_type *type)
+{
+	int i;
+
+	for (i = COLUMNAR_COLUMN_TYPE_INT8;
+			i <= COLUMNAR_COLUMN_TYPE_LIST_FLOAT64; i++) {
+		if (strcmp(str, columnar_column_type_string(i)) == 0) {
+			*type = i;
+			return 0;
+		}
+	}
+
+	return -1;
+}
+
+static inline
+bool columnar_column_type_is_list(enum columnar_column_type type)
+{
+	return type >= COLUMNAR_COLUMN_TYPE_LIST_INT8;
+}
+
+static inline
+bool columnar_column_type_has_offsets(enum columnar_column_type type)
+{
+	return type == COLUMNAR_COLUMN_TYPE_STRING ||
+		columnar_column_type_is_list(type);
+}
+
+/*
+ * Size (bytes) of a single value (fixed-width column) or of a single
+ * element (list column) in a column's data file, or 1 for a string
+ * column.
+ */
+static inline
+unsigned int columnar_column_type_value_size(enum columnar_column_type type)
+{
+	if (columnar_column_type_is_list(type)) {
+		type -= COLUMNAR_COLUMN_TYPE_LIST_INT8;
+	}
+
+	switch (type) {
+	case COLUMNAR_COLUMN_TYPE_INT8:
+	case COLUMNAR_COLUMN_TYPE_UINT8:
+	case COLUMNAR_COLUMN_TYPE_STRING:
+		return 1;
+	case COLUMNAR_COLUMN_TYPE_INT16:
+	case COLUMNAR_COLUMN_TYPE_UINT16:
+		return 2;
+	case COLUMNAR_COLUMN_TYPE_INT32:
+	case COLUMNAR_COLUMN_TYPE_UINT32:
+	case COLUMNAR_COLUMN_TYPE_FLOAT32:
+		return 4;
+	default:
+		return 8;
+	}
+}
+
+#endif /* BABELTRACE_PLUGIN_CTF_COLUMNAR_SINK_COLUMNAR_FORMAT_H */
@@ -0,0 +1,348 @@
+/*
+ * Copyright 2019 - EfficiOS Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <babeltrace/assert-internal.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <glib.h>
+
+#include "columnar-reader.h"
+
+static
+void destroy_column(struct columnar_reader_column *column)
+{
+	if (!column) {
+		return;
+	}
+
+	if (column->name) {
+		g_string_free(column->name, TRUE);
+	}
+
+	if (column->data) {
+		g_mapped_file_unref(column->data);
+	}
+
+	if (column->offsets) {
+		g_mapped_file_unref(column->offsets);
+	}
+
+	g_free(column);
+}
+
+static
+GMappedFile *map_file(const char *dir_path, const char *name_fmt,
+		uint64_t index)
+{
+	gchar *name = g_strdup_printf(name_fmt, index);
+	gchar *path = g_build_filename(dir_path, name, NULL);
+	GMappedFile *file = g_mapped_file_new(path, FALSE, NULL);
+
+	g_free(name);
+	g_free(path);
+	return file;
+}
+
+static
+uint64_t get_end_offset(struct columnar_reader_column *column, uint64_t row)
+{
+	const uint64_t *offsets =
+		(const void *) g_mapped_file_get_contents(column->offsets);
+
+	return offsets[row];
+}
+
+/*
+ * Checks that the sizes of the files of `column` match the table's
+ * row count so that the getters below never read out of bounds.
+ */
+static
+bool column_is_valid(struct columnar_reader_column *column,
+		uint64_t row_count)
+{
+	uint64_t data_size = g_mapped_file_get_length(column->data);
+	uint64_t value_size = columnar_column_type_value_size(column->type);
+	uint64_t prev_end = 0;
+	uint64_t row;
+
+	if (!column->offsets) {
+		return data_size == row_count * value_size;
+	}
+
+	if (g_mapped_file_get_length(column->offsets) !=
+			row_count * sizeof(uint64_t)) {
+		return false;
+	}
+
+	for (row = 0; row < row_count; row++) {
+		uint64_t end = get_end_offset(column, row);
+
+		if (end < prev_end) {
+			return false;
+		}
+
+		prev_end = end;
+	}
+
+	return prev_end * value_size == data_size;
+}
+
+struct columnar_reader_table *columnar_reader_table_open(const char *path)
+{
+	struct columnar_reader_table *table =
+		g_new0(struct columnar_reader_table, 1);
+	GKeyFile *schema = g_key_file_new();
+	gchar *schema_path = g_build_filename(path,
+		COLUMNAR_SCHEMA_FILE_NAME, NULL);
+	gchar *str = NULL;
+	uint64_t column_count;
+	uint64_t i;
+
+	table->path = g_string_new(path);
+	table->columns = g_ptr_array_new_with_free_func(
+		(GDestroyNotify) destroy_column);
+
+	if (!g_key_file_load_from_file(schema, schema_path, G_KEY_FILE_NONE,
+			NULL)) {
+		goto error;
+	}
+
+	if (g_key_file_get_integer(schema, COLUMNAR_TABLE_GROUP, "version",
+			NULL) != COLUMNAR_FORMAT_VERSION) {
+		goto error;
+	}
+
+	str = g_key_file_get_string(schema, COLUMNAR_TABLE_GROUP,
+		"byte-order", NULL);
+	if (!str || strcmp(str, G_BYTE_ORDER == G_LITTLE_ENDIAN ?
+			"little-endian" : "big-endian") != 0) {
+		goto error;
+	}
+
+	g_free(str);
+	str = g_key_file_get_string(schema, COLUMNAR_TABLE_GROUP,
+		"event-class-name", NULL);
+	if (!str) {
+		goto error;
+	}
+
+	table->event_class_name = g_string_new(str);
+	g_free(str);
+	str = g_key_file_get_string(schema, COLUMNAR_TABLE_GROUP,
+		"event-class-id", NULL);
+	if (!str) {
+		goto error;
+	}
+
+	table->event_class_id = g_ascii_strtoull(str, NULL, 10);
+	g_free(str);
+	str = g_key_file_get_string(schema, COLUMNAR_TABLE_GROUP,
+		"row-count", NULL);
+	if (!str) {
+		goto error;
+	}
+
+	table->row_count = g_ascii_strtoull(str, NULL, 10);
+	g_free(str);
+	str = g_key_file_get_string(schema, COLUMNAR_TABLE_GROUP,
+		"column-count", NULL);
+	if (!str) {
+		goto error;
+	}
+
+	column_count = g_ascii_strtoull(str, NULL, 10);
+	g_free(str);
+	str = NULL;
+
+	for (i = 0; i < column_count; i++) {
+		gchar *group = g_strdup_printf(COLUMNAR_COLUMN_GROUP_FMT, i);
+		struct columnar_reader_column *column =
+			g_new0(struct columnar_reader_column, 1);
+		int ret;
+
+		g_ptr_array_add(table->columns, column);
+		str = g_key_file_get_string(schema, group, "name", NULL);
+		if (!str) {
+			g_free(group);
+			goto error;
+		}
+
+		column->name = g_string_new(str);
+		g_free(str);
+		str = g_key_file_get_string(schema, group, "type", NULL);
+		g_free(group);
+		if (!str) {
+			goto error;
+		}
+
+		ret = columnar_column_type_from_string(str, &column->type);
+		g_free(str);
+		str = NULL;
+		if (ret) {
+			goto error;
+		}
+
+		column->data = map_file(path, COLUMNAR_DATA_FILE_NAME_FMT, i);
+		if (!column->data) {
+			goto error;
+		}
+
+		if (columnar_column_type_has_offsets(column->type)) {
+			column->offsets = map_file(path,
+				COLUMNAR_OFFSETS_FILE_NAME_FMT, i);
+			if (!column->offsets) {
+				goto error;
+			}
+		}
+
+		if (!column_is_valid(column, table->row_count)) {
+			goto error;
+		}
+	}
+
+	goto end;
+
+error:
+	columnar_reader_table_close(table);
+	table = NULL;
+
+end:
+	g_free(str);
+	g_free(schema_path);
+	g_key_file_free(schema);
+	return table;
+}
+
+void columnar_reader_table_close(struct columnar_reader_table *table)
+{
+	if (!table) {
+		return;
+	}
+
+	if (table->path) {
+		g_string_free(table->path, TRUE);
+	}
+
+	if (table->event_class_name) {
+		g_string_free(table->event_class_name, TRUE);
+	}
+
+	if (table->columns) {
+		g_ptr_array_free(table->columns, TRUE);
+	}
+
+	g_free(table);
+}
+
+struct columnar_reader_column *columnar_reader_table_borrow_column_by_name(
+		struct columnar_reader_table *table, const char *name)
+{
+	uint64_t i;
+
+	for (i = 0; i < table->columns->len; i++) {
+		struct columnar_reader_column *column =
+			table->columns->pdata[i];
+
+		if (strcmp(column->name->str, name) == 0) {
+			return column;
+		}
+	}
+
+	return NULL;
+}
+
+const void *columnar_reader_column_borrow_value(
+		struct columnar_reader_column *column, uint64_t row)
+{
+	BT_ASSERT(!columnar_column_type_has_offsets(column->type));
+	return g_mapped_file_get_contents(column->data) +
+		row * columnar_column_type_value_size(column->type);
+}
+
+int64_t columnar_reader_column_get_signed_int(
+		struct columnar_reader_column *column, uint64_t row)
+{
+	const void *value = columnar_reader_column_borrow_value(column, row);
+
+	switch (column->type) {
+	case COLUMNAR_COLUMN_TYPE_INT8:
+		return *(const int8_t *) value;
+	case COLUMNAR_COLUMN_TYPE_INT16:
+		return *(const int16_t *) value;
+	case COLUMNAR_COLUMN_TYPE_INT32:
+		return *(const int32_t *) value;
+	case COLUMNAR_COLUMN_TYPE_INT64:
+		return *(const int64_t *) value;
+	default:
+		abort();
+	}
+}
+
+uint64_t columnar_reader_column_get_unsigned_int(
+		struct columnar_reader_column *column, uint64_t row)
+{
+	const void *value = columnar_reader_column_borrow_value(column, row);
+
+	switch (column->type) {
+	case COLUMNAR_COLUMN_TYPE_UINT8:
+		return *(const uint8_t *) value;
+	case COLUMNAR_COLUMN_TYPE_UINT16:
+		return *(const uint16_t *) value;
+	case COLUMNAR_COLUMN_TYPE_UINT32:
+		return *(const uint32_t *) value;
+	case COLUMNAR_COLUMN_TYPE_UINT64:
+		return *(const uint64_t *) value;
+	default:
+		abort();
+	}
+}
+
+double columnar_reader_column_get_real(
+		struct columnar_reader_column *column, uint64_t row)
+{
+	const void *value = columnar_reader_column_borrow_value(column, row);
+
+	switch (column->type) {
+	case COLUMNAR_COLUMN_TYPE_FLOAT32:
+		return *(const float *) value;
+	case COLUMNAR_COLUMN_TYPE_FLOAT64:
+		return *(const double *) value;
+	default:
+		abort();
+	}
+}
+
+uint64_t columnar_reader_column_borrow_var_value(
+		struct columnar_reader_column *column, uint64_t row,
+		const void **data)
+{
+	uint64_t begin = row == 0 ? 0 : get_end_offset(column, row - 1);
+	uint64_t end = get_end_offset(column, row);
+
+	BT_ASSERT(columnar_column_type_has_offsets(column->type));
+	*data = g_mapped_file_get_contents(column->data) +
+		begin * columnar_column_type_value_size(column->type);
+	return end - begin;
+}
@@ -0,0 +1,101 @@
+#ifndef BABELTRACE_PLUGIN_CTF_COLUMNAR_SINK_COLUMNAR_READER_H
+#define BABELTRACE_PLUGIN_CTF_COLUMNAR_SINK_COLUMNAR_READER_H
+
+/*
+ * Copyright 2019 - EfficiOS Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * Minimal reader of the tables written by a `sink.ctf.columnar`
+ * component (see `columnar-format.h`). The column files are mapped
+ * into memory: getting a value does not copy anything.
+ *
+ * This reader only supports tables written on a machine with the
+ * same byte order.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <glib.h>
+
+#include "columnar-format.h"
+
+struct columnar_reader_column {
+	GString *name;
+	enum columnar_column_type type;
+
+	/* Owned by this */
+	GMappedFile *data;
+
+	/* Owned by this, only for string and list columns */
+	GMappedFile *offsets;
+};
+
+struct columnar_reader_table {
+	GString *path;
+	GString *event_class_name;
+	uint64_t event_class_id;
+	uint64_t row_count;
+
+	/* Array of `struct columnar_reader_column *` (owned by this) */
+	GPtrArray *columns;
+};
+
+/*
+ * Opens the table in the directory `path`, returning `NULL` on error.
+ */
+struct columnar_reader_table *columnar_reader_table_open(const char *path);
+
+void columnar_reader_table_close(struct columnar_reader_table *table);
+
+struct columnar_reader_column *columnar_reader_table_borrow_column_by_name(
+		struct columnar_reader_table *table, const char *name);
+
+/*
+ * Returns the address of the fixed-width value of the row `row` of
+ * `column`.
+ */
+const void *columnar_reader_column_borrow_value(
+		struct columnar_reader_column *column, uint64_t row);
+
+/*
+ * Returns the value of the row `row` of the integer column `column`,
+ * converted to a 64-bit integer.
+ */
+int64_t columnar_reader_column_get_signed_int(
+		struct columnar_reader_column *column, uint64_t row);
+
+uint64_t columnar_reader_column_get_unsigned_int(
+		struct columnar_reader_column *column, uint64_t row);
+
+double columnar_reader_column_get_real(
+		struct columnar_reader_column *column, uint64_t row);
+
+/*
+ * Sets `*data` to the address of the first byte (string column) or
+ * element (list column) of the row `row` of `column` and returns its
+ * length (bytes or elements).
+ */
+uint64_t columnar_reader_column_borrow_var_value(
+		struct columnar_reader_column *column, uint64_t row,
+		const void **data);
+
+#endif /* BABELTRACE_PLUGIN_CTF_COLUMNAR_SINK_COLUMNAR_READER_H */
@@ -0,0 +1,885 @@
+/*
+ * Copyright 2019 - EfficiOS Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#define BT_LOG_TAG "PLUGIN-CTF-COLUMNAR-SINK-TABLE"
+#include "logging.h"
+
+#include <babeltrace/babeltrace.h>
+#include <babeltrace/assert-internal.h>
+#include <babeltrace/endian-internal.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <inttypes.h>
+#include <glib.h>
+
+#include "columnar-sink.h"
+#include "columnar-sink-table.h"
+#include "columnar-format.h"
+
+/*
+ * Size of a column file's write buffer: columns are written with
+ * large sequential writes instead of one small write per event.
+ */
+#define COLUMNAR_SINK_FILE_BUF_SIZE	(256 * 1024)
+
+static
+int file_init(struct columnar_sink_file *file, const char *dir_path,
+		const char *name)
+{
+	int ret = 0;
+
+	file->path = g_string_new(dir_path);
+	BT_ASSERT(file->path);
+	g_string_append_printf(file->path, "/%s", name);
+	file->fp = fopen(file->path->str, "wb");
+	if (!file->fp) {
+		BT_LOGE_ERRNO("Cannot open column file for writing",
+			": path=\"%s\"", file->path->str);
+		ret = -1;
+		goto end;
+	}
+
+	/* We do our own buffering */
+	setvbuf(file->fp, NULL, _IONBF, 0);
+	file->buf = g_malloc(COLUMNAR_SINK_FILE_BUF_SIZE);
+	BT_ASSERT(file->buf);
+
+end:
+	return ret;
+}
+
+static
+int file_flush(struct columnar_sink_file *file)
+{
+	int ret = 0;
+
+	if (file->len == 0) {
+		goto end;
+	}
+
+	if (fwrite(file->buf, 1, file->len, file->fp) != file->len) {
+		BT_LOGE_ERRNO("Cannot write column file",
+			": path=\"%s\", size=%zu", file->path->str,
+			file->len);
+		ret = -1;
+		goto end;
+	}
+
+	file->len = 0;
+
+end:
+	return ret;
+}
+
+static inline
+int file_write(struct columnar_sink_file *file, const void *data,
+		size_t size)
+{
+	int ret = 0;
+
+	if (unlikely(file->len + size > COLUMNAR_SINK_FILE_BUF_SIZE)) {
+		ret = file_flush(file);
+		if (ret) {
+			goto end;
+		}
+
+		if (size > COLUMNAR_SINK_FILE_BUF_SIZE) {
+			/* Too large for the buffer: write directly */
+			if (fwrite(data, 1, size, file->fp) != size) {
+				BT_LOGE_ERRNO("Cannot write column file",
+					": path=\"%s\", size=%zu",
+					file->path->str, size);
+				ret = -1;
+			}
+
+			goto end;
+		}
+	}
+
+	memcpy(&file->buf[file->len], data, size);
+	file->len += size;
+
+end:
+	return ret;
+}
+
+static
+int file_fini(struct columnar_sink_file *file)
+{
+	int ret = 0;
+
+	if (file->fp) {
+		ret = file_flush(file);
+
+		if (fclose(file->fp)) {
+			BT_LOGE_ERRNO("Cannot close column file",
+				": path=\"%s\"", file->path->str);
+			ret = -1;
+		}
+
+		file->fp = NULL;
+	}
+
+	g_free(file->buf);
+	file->buf = NULL;
+
+	if (file->path) {
+		g_string_free(file->path, TRUE);
+		file->path = NULL;
+	}
+
+	return ret;
+}
+
+static
+int column_close(struct columnar_sink_column *column)
+{
+	int ret = 0;
+
+	ret |= file_fini(&column->data);
+	ret |= file_fini(&column->offsets);
+	return ret;
+}
+
+static
+void column_destroy(struct columnar_sink_column *column)
+{
+	if (!column) {
+		goto end;
+	}
+
+	(void) column_close(column);
+
+	if (column->name) {
+		g_string_free(column->name, TRUE);
+	}
+
+	g_free(column);
+
+end:
+	return;
+}
+
+static
+int add_column(struct columnar_sink_table *table, const char *name,
+		enum columnar_column_type type)
+{
+	int ret;
+	uint64_t index = table->columns->len;
+	struct columnar_sink_column *column =
+		g_new0(struct columnar_sink_column, 1);
+	gchar *file_name = NULL;
+
+	BT_ASSERT(column);
+	column->name = g_string_new(name);
+	BT_ASSERT(column->name);
+	column->type = type;
+	g_ptr_array_add(table->columns, column);
+	file_name = g_strdup_printf(COLUMNAR_DATA_FILE_NAME_FMT, index);
+	ret = file_init(&column->data, table->path->str, file_name);
+	if (ret) {
+		goto end;
+	}
+
+	if (columnar_column_type_has_offsets(type)) {
+		g_free(file_name);
+		file_name = g_strdup_printf(COLUMNAR_OFFSETS_FILE_NAME_FMT,
+			index);
+		ret = file_init(&column->offsets, table->path->str,
+			file_name);
+		if (ret) {
+			goto end;
+		}
+	}
+
+	BT_LOGD("Added column: table-path=\"%s\", index=%" PRIu64 ", "
+		"name=\"%s\", type=%s", table->path->str, index, name,
+		columnar_column_type_string(type));
+
+end:
+	g_free(file_name);
+	return ret;
+}
+
+static
+bool scalar_column_type(struct fs_sink_ctf_field_class *fc,
+		enum columnar_column_type *type)
+{
+	bool is_scalar = true;
+
+	switch (fc->type) {
+	case FS_SINK_CTF_FIELD_CLASS_TYPE_INT:
+	{
+		struct fs_sink_ctf_field_class_int *int_fc = (void *) fc;
+		unsigned int size = int_fc->base.size;
+
+		if (size <= 8) {
+			*type = COLUMNAR_COLUMN_TYPE_INT8;
+		} else if (size <= 16) {
+			*type = COLUMNAR_COLUMN_TYPE_INT16;
+		} else if (size <= 32) {
+			*type = COLUMNAR_COLUMN_TYPE_INT32;
+		} else {
+			*type = COLUMNAR_COLUMN_TYPE_INT64;
+		}
+
+		/* Unsigned type immediately follows its signed type */
+		if (!int_fc->is_signed) {
+			(*type)++;
+		}
+
+		break;
+	}
+	case FS_SINK_CTF_FIELD_CLASS_TYPE_FLOAT:
+	{
+		struct fs_sink_ctf_field_class_float *float_fc = (void *) fc;
+
+		*type = float_fc->base.size == 32 ?
+			COLUMNAR_COLUMN_TYPE_FLOAT32 :
+			COLUMNAR_COLUMN_TYPE_FLOAT64;
+		break;
+	}
+	default:
+		is_scalar = false;
+		break;
+	}
+
+	return is_scalar;
+}
+
+static inline
+bool sequence_has_column(struct fs_sink_ctf_field_class_sequence *fc)
+{
+	enum columnar_column_type elem_type;
+
+	return scalar_column_type(fc->base.elem_fc, &elem_type);
+}
+
+/*
+ * Adds the columns of a field described by `fc` named `name` to
+ * `table`.
+ *
+ * append_field() must walk the fields exactly like this function
+ * walks the field classes: it fills the columns in the order in which
+ * they are added here.
+ */
+static
+int add_columns(struct columnar_sink_table *table,
+		struct fs_sink_ctf_field_class *fc, GString *name)
+{
+	int ret = 0;
+	size_t name_len = name->len;
+	enum columnar_column_type type;
+	uint64_t i;
+
+	switch (fc->type) {
+	case FS_SINK_CTF_FIELD_CLASS_TYPE_INT:
+	case FS_SINK_CTF_FIELD_CLASS_TYPE_FLOAT:
+	{
+		bool is_scalar = scalar_column_type(fc, &type);
+
+		BT_ASSERT(is_scalar);
+		ret = add_column(table, name->str, type);
+		break;
+	}
+	case FS_SINK_CTF_FIELD_CLASS_TYPE_STRING:
+		ret = add_column(table, name->str,
+			COLUMNAR_COLUMN_TYPE_STRING);
+		break;
+	case FS_SINK_CTF_FIELD_CLASS_TYPE_STRUCT:
+	{
+		struct fs_sink_ctf_field_class_struct *struct_fc = (void *) fc;
+
+		for (i = 0; i < struct_fc->members->len; i++) {
+			struct fs_sink_ctf_named_field_class *named_fc =
+				fs_sink_ctf_field_class_struct_borrow_member_by_index(
+					struct_fc, i);
+			const bt_field_class_structure_member *ir_member =
+				bt_field_class_structure_borrow_member_by_index_const(
+					fc->ir_fc, i);
+
+			g_string_append_printf(name, "%s%s",
+				name->len > 0 ? "." : "",
+				bt_field_class_structure_member_get_name(
+					ir_member));
+			ret = add_columns(table, named_fc->fc, name);
+			g_string_truncate(name, name_len);
+			if (ret) {
+				goto end;
+			}
+		}
+
+		break;
+	}
+	case FS_SINK_CTF_FIELD_CLASS_TYPE_ARRAY:
+	{
+		struct fs_sink_ctf_field_class_array *array_fc = (void *) fc;
+
+		/* Static arrays are flattened: one column per element */
+		for (i = 0; i < array_fc->length; i++) {
+			g_string_append_printf(name, "[%" PRIu64 "]", i);
+			ret = add_columns(table, array_fc->base.elem_fc,
+				name);
+			g_string_truncate(name, name_len);
+			if (ret) {
+				goto end;
+			}
+		}
+
+		break;
+	}
+	case FS_SINK_CTF_FIELD_CLASS_TYPE_SEQUENCE:
+	{
+		struct fs_sink_ctf_field_class_sequence *seq_fc = (void *) fc;
+
+		if (!sequence_has_column(seq_fc)) {
+			BT_LOGW("Unsupported sequence field class: "
+				"element field class is not an integer or "
+				"a real field class: skipping field: "
+				"table-path=\"%s\", field-name=\"%s\"",
+				table->path->str, name->str);
+			break;
+		}
+
+		scalar_column_type(seq_fc->base.elem_fc, &type);
+		ret = add_column(table, name->str,
+			COLUMNAR_COLUMN_TYPE_LIST_INT8 + type);
+		break;
+	}
+	case FS_SINK_CTF_FIELD_CLASS_TYPE_VARIANT:
+		BT_LOGW("Unsupported variant field class: skipping field: "
+			"table-path=\"%s\", field-name=\"%s\"",
+			table->path->str, name->str);
+		break;
+	default:
+		abort();
+	}
+
+end:
+	return ret;
+}
+
+static
+int add_scope_columns(struct columnar_sink_table *table,
+		struct fs_sink_ctf_field_class *fc, const char *scope_name)
+{
+	int ret = 0;
+	GString *name;
+
+	if (!fc) {
+		goto end;
+	}
+
+	name = g_string_new(scope_name);
+	BT_ASSERT(name);
+	ret = add_columns(table, fc, name);
+	g_string_free(name, TRUE);
+
+end:
+	return ret;
+}
+
+static inline
+int write_scalar(struct columnar_sink_file *file,
+		enum columnar_column_type type, const bt_field *field)
+{
+	int ret;
+
+	switch (type) {
+	case COLUMNAR_COLUMN_TYPE_INT8:
+	{
+		int8_t val = (int8_t) bt_field_signed_integer_get_value(field);
+
+		ret = file_write(file, &val, sizeof(val));
+		break;
+	}
+	case COLUMNAR_COLUMN_TYPE_UINT8:
+	{
+		uint8_t val =
+			(uint8_t) bt_field_unsigned_integer_get_value(field);
+
+		ret = file_write(file, &val, sizeof(val));
+		break;
+	}
+	case COLUMNAR_COLUMN_TYPE_INT16:
+	{
+		int16_t val =
+			(int16_t) bt_field_signed_integer_get_value(field);
+
+		ret = file_write(file, &val, sizeof(val));
+		break;
+	}
+	case COLUMNAR_COLUMN_TYPE_UINT16:
+	{
+		uint16_t val =
+			(uint16_t) bt_field_unsigned_integer_get_value(field);
+
+		ret = file_write(file, &val, sizeof(val));
+		break;
+	}
+	case COLUMNAR_COLUMN_TYPE_INT32:
+	{
+		int32_t val =
+			(int32_t) bt_field_signed_integer_get_value(field);
+
+		ret = file_write(file, &val, sizeof(val));
+		break;
+	}
+	case COLUMNAR_COLUMN_TYPE_UINT32:
+	{
+		uint32_t val =
+			(uint32_t) bt_field_unsigned_integer_get_value(field);
+
+		ret = file_write(file, &val, sizeof(val));
+		break;
+	}
+	case COLUMNAR_COLUMN_TYPE_INT64:
+	{
+		int64_t val = bt_field_signed_integer_get_value(field);
+
+		ret = file_write(file, &val, sizeof(val));
+		break;
+	}
+	case COLUMNAR_COLUMN_TYPE_UINT64:
+	{
+		uint64_t val = bt_field_unsigned_integer_get_value(field);
+
+		ret = file_write(file, &val, sizeof(val));
+		break;
+	}
+	case COLUMNAR_COLUMN_TYPE_FLOAT32:
+	{
+		float val = (float) bt_field_real_get_value(field);
+
+		ret = file_write(file, &val, sizeof(val));
+		break;
+	}
+	case COLUMNAR_COLUMN_TYPE_FLOAT64:
+	{
+		double val = bt_field_real_get_value(field);
+
+		ret = file_write(file, &val, sizeof(val));
+		break;
+	}
+	default:
+		abort();
+	}
+
+	return ret;
+}
+
+static inline
+int write_end_offset(struct columnar_sink_column *column, uint64_t count)
+{
+	column->end_offset += count;
+	return file_write(&column->offsets, &column->end_offset,
+		sizeof(column->end_offset));
+}
+
+static
+int append_field(struct columnar_sink_table *table,
+		struct fs_sink_ctf_field_class *fc, const bt_field *field,
+		uint64_t *col_index)
+{
+	int ret = 0;
+	struct columnar_sink_column *column;
+	uint64_t i;
+
+	switch (fc->type) {
+	case FS_SINK_CTF_FIELD_CLASS_TYPE_INT:
+	case FS_SINK_CTF_FIELD_CLASS_TYPE_FLOAT:
+		column = table->columns->pdata[*col_index];
+		(*col_index)++;
+		ret = write_scalar(&column->data, column->type, field);
+		break;
+	case FS_SINK_CTF_FIELD_CLASS_TYPE_STRING:
+	{
+		uint64_t len = bt_field_string_get_length(field);
+
+		column = table->columns->pdata[*col_index];
+		(*col_index)++;
+		ret = file_write(&column->data,
+			bt_field_string_get_value(field), (size_t) len);
+		if (unlikely(ret)) {
+			goto end;
+		}
+
+		ret = write_end_offset(column, len);
+		break;
+	}
+	case FS_SINK_CTF_FIELD_CLASS_TYPE_STRUCT:
+	{
+		struct fs_sink_ctf_field_class_struct *struct_fc = (void *) fc;
+
+		for (i = 0; i < struct_fc->members->len; i++) {
+			ret = append_field(table,
+				fs_sink_ctf_field_class_struct_borrow_member_by_index(
+					struct_fc, i)->fc,
+				bt_field_structure_borrow_member_field_by_index_const(
+					field, i),
+				col_index);
+			if (unlikely(ret)) {
+				goto end;
+			}
+		}
+
+		break;
+	}
+	case FS_SINK_CTF_FIELD_CLASS_TYPE_ARRAY:
+	{
+		struct fs_sink_ctf_field_class_array *array_fc = (void *) fc;
+
+		for (i = 0; i < array_fc->length; i++) {
+			ret = append_field(table, array_fc->base.elem_fc,
+				bt_field_array_borrow_element_field_by_index_const(
+					field, i),
+				col_index);
+			if (unlikely(ret)) {
+				goto end;
+			}
+		}
+
+		break;
+	}
+	case FS_SINK_CTF_FIELD_CLASS_TYPE_SEQUENCE:
+	{
+		uint64_t len;
+		enum columnar_column_type elem_type;
+
+		if (!sequence_has_column((void *) fc)) {
+			break;
+		}
+
+		column = table->columns->pdata[*col_index];
+		(*col_index)++;
+		elem_type = column->type - COLUMNAR_COLUMN_TYPE_LIST_INT8;
+		len = bt_field_array_get_length(field);
+
+		for (i = 0; i < len; i++) {
+			ret = write_scalar(&column->data, elem_type,
+				bt_field_array_borrow_element_field_by_index_const(
+					field, i));
+			if (unlikely(ret)) {
+				goto end;
+			}
+		}
+
+		ret = write_end_offset(column, len);
+		break;
+	}
+	case FS_SINK_CTF_FIELD_CLASS_TYPE_VARIANT:
+		/* No columns */
+		break;
+	default:
+		abort();
+	}
+
+end:
+	return ret;
+}
+
+BT_HIDDEN
+int columnar_sink_table_append_event(struct columnar_sink_table *table,
+		const bt_clock_snapshot *cs, const bt_event *event)
+{
+	int ret = 0;
+	uint64_t col_index = 0;
+	struct fs_sink_ctf_event_class *ec = table->ec;
+
+	if (table->has_timestamp) {
+		struct columnar_sink_column *column = table->columns->pdata[0];
+		int64_t ns_from_origin;
+
+		BT_ASSERT(cs);
+		if (bt_clock_snapshot_get_ns_from_origin(cs,
+				&ns_from_origin)) {
+			BT_LOGE("Cannot get nanoseconds from origin of "
+				"event's clock snapshot: "
+				"table-path=\"%s\", cs-val=%" PRIu64,
+				table->path->str,
+				bt_clock_snapshot_get_value(cs));
+			ret = -1;
+			goto end;
+		}
+
+		col_index++;
+		ret = file_write(&column->data, &ns_from_origin,
+			sizeof(ns_from_origin));
+		if (unlikely(ret)) {
+			goto end;
+		}
+	}
+
+	if (ec->sc->event_common_context_fc) {
+		ret = append_field(table, ec->sc->event_common_context_fc,
+			bt_event_borrow_common_context_field_const(event),
+			&col_index);
+		if (unlikely(ret)) {
+			goto end;
+		}
+	}
+
+	if (ec->spec_context_fc) {
+		ret = append_field(table, ec->spec_context_fc,
+			bt_event_borrow_specific_context_field_const(event),
+			&col_index);
+		if (unlikely(ret)) {
+			goto end;
+		}
+	}
+
+	if (ec->payload_fc) {
+		ret = append_field(table, ec->payload_fc,
+			bt_event_borrow_payload_field_const(event),
+			&col_index);
+		if (unlikely(ret)) {
+			goto end;
+		}
+	}
+
+	BT_ASSERT(col_index == table->columns->len);
+	table->row_count++;
+
+end:
+	if (unlikely(ret)) {
+		table->failed = true;
+	}
+
+	return ret;
+}
+
+static
+GString *make_table_path(struct columnar_sink_table *table)
+{
+	const char *ec_name = bt_event_class_get_name(table->ec->ir_ec);
+	GString *base = g_string_new(table->trace->path->str);
+	GString *path;
+	unsigned int suffix = 0;
+	const char *ch;
+
+	BT_ASSERT(base);
+	g_string_append_c(base, '/');
+
+	if (!ec_name || strlen(ec_name) == 0 ||
+			strcmp(ec_name, ".") == 0 ||
+			strcmp(ec_name, "..") == 0) {
+		g_string_append_printf(base, "event-class-%" PRIu64,
+			bt_event_class_get_id(table->ec->ir_ec));
+	} else {
+		for (ch = ec_name; *ch != '\0'; ch++) {
+			g_string_append_c(base, *ch == '/' ? '_' : *ch);
+		}
+	}
+
+	/* Two stream classes can contain event classes with the same name */
+	path = g_string_new(base->str);
+	BT_ASSERT(path);
+
+	while (g_file_test(path->str, G_FILE_TEST_EXISTS)) {
+		g_string_printf(path, "%s-%u", base->str, suffix);
+		suffix++;
+	}
+
+	g_string_free(base, TRUE);
+	return path;
+}
+
+BT_HIDDEN
+struct columnar_sink_table *columnar_sink_table_create(
+		struct columnar_sink_trace *trace,
+		struct fs_sink_ctf_event_class *ec)
+{
+	int ret;
+	struct columnar_sink_table *table =
+		g_new0(struct columnar_sink_table, 1);
+
+	if (!table) {
+		goto end;
+	}
+
+	table->trace = trace;
+	table->ec = ec;
+	table->columns = g_ptr_array_new_with_free_func(
+		(GDestroyNotify) column_destroy);
+	BT_ASSERT(table->columns);
+	table->path = make_table_path(table);
+	ret = g_mkdir_with_parents(table->path->str, 0755);
+	if (ret) {
+		BT_LOGE_ERRNO("Cannot create directories for table directory",
+			": path=\"%s\"", table->path->str);
+		goto error;
+	}
+
+	if (ec->sc->default_clock_class) {
+		ret = add_column(table, COLUMNAR_TIMESTAMP_COLUMN_NAME,
+			COLUMNAR_COLUMN_TYPE_INT64);
+		if (ret) {
+			goto error;
+		}
+
+		table->has_timestamp = true;
+	}
+
+	ret = add_scope_columns(table, ec->sc->event_common_context_fc,
+		"common-context");
+	if (ret) {
+		goto error;
+	}
+
+	ret = add_scope_columns(table, ec->spec_context_fc,
+		"specific-context");
+	if (ret) {
+		goto error;
+	}
+
+	ret = add_scope_columns(table, ec->payload_fc, "payload");
+	if (ret) {
+		goto error;
+	}
+
+	BT_LOGI("Created table: path=\"%s\", ec-name=\"%s\", "
+		"column-count=%u", table->path->str,
+		bt_event_class_get_name(ec->ir_ec), table->columns->len);
+	goto end;
+
+error:
+	table->failed = true;
+	columnar_sink_table_destroy(table);
+	table = NULL;
+
+end:
+	return table;
+}
+
+static
+void set_uint64(GKeyFile *key_file, const char *group, const char *key,
+		uint64_t value)
+{
+	gchar *str = g_strdup_printf("%" PRIu64, value);
+
+	g_key_file_set_string(key_file, group, key, str);
+	g_free(str);
+}
+
+static
+int write_schema(struct columnar_sink_table *table)
+{
+	int ret = 0;
+	GKeyFile *schema = g_key_file_new();
+	gchar *schema_path = g_build_filename(table->path->str,
+		COLUMNAR_SCHEMA_FILE_NAME, NULL);
+	const char *ec_name = bt_event_class_get_name(table->ec->ir_ec);
+	gchar *data = NULL;
+	gsize len;
+	GError *error = NULL;
+	uint64_t i;
+
+	BT_ASSERT(schema);
+	g_key_file_set_integer(schema, COLUMNAR_TABLE_GROUP, "version",
+		COLUMNAR_FORMAT_VERSION);
+	g_key_file_set_string(schema, COLUMNAR_TABLE_GROUP,
+		"event-class-name", ec_name ? ec_name : "");
+	set_uint64(schema, COLUMNAR_TABLE_GROUP, "event-class-id",
+		bt_event_class_get_id(table->ec->ir_ec));
+	g_key_file_set_string(schema, COLUMNAR_TABLE_GROUP, "byte-order",
+		BYTE_ORDER == LITTLE_ENDIAN ? "little-endian" : "big-endian");
+	set_uint64(schema, COLUMNAR_TABLE_GROUP, "row-count",
+		table->row_count);
+	set_uint64(schema, COLUMNAR_TABLE_GROUP, "column-count",
+		table->columns->len);
+
+	for (i = 0; i < table->columns->len; i++) {
+		struct columnar_sink_column *column = table->columns->pdata[i];
+		gchar *group = g_strdup_printf(COLUMNAR_COLUMN_GROUP_FMT, i);
+
+		g_key_file_set_string(schema, group, "name",
+			column->name->str);
+		g_key_file_set_string(schema, group, "type",
+			columnar_column_type_string(column->type));
+		g_free(group);
+	}
+
+	data = g_key_file_to_data(schema, &len, NULL);
+	BT_ASSERT(data);
+
+	if (!g_file_set_contents(schema_path, data, len, &error)) {
+		BT_LOGE("Cannot write table's schema file: "
+			"path=\"%s\", error=\"%s\"", schema_path,
+			error->message);
+		g_error_free(error);
+		ret = -1;
+	}
+
+	g_free(data);
+	g_free(schema_path);
+	g_key_file_free(schema);
+	return ret;
+}
+
+BT_HIDDEN
+void columnar_sink_table_destroy(struct columnar_sink_table *table)
+{
+	bool complete;
+	uint64_t i;
+
+	if (!table) {
+		goto end;
+	}
+
+	complete = !table->failed;
+
+	if (table->columns) {
+		for (i = 0; i < table->columns->len; i++) {
+			if (column_close(table->columns->pdata[i])) {
+				complete = false;
+			}
+		}
+
+		/*
+		 * Written last: a table directory without a schema
+		 * file is incomplete.
+		 */
+		if (complete && write_schema(table)) {
+			complete = false;
+		}
+
+		g_ptr_array_free(table->columns, TRUE);
+		table->columns = NULL;
+	}
+
+	if (table->path) {
+		if (!complete) {
+			BT_LOGE("Columnar table is incomplete: path=\"%s\"",
+				table->path->str);
+		}
+
+		g_string_free(table->path, TRUE);
+		table->path = NULL;
+	}
+
+	g_free(table);
+
+end:
+	return;
+}
@@ -0,0 +1,99 @@
+#ifndef BABELTRACE_PLUGIN_CTF_COLUMNAR_SINK_COLUMNAR_SINK_TABLE_H
+#define BABELTRACE_PLUGIN_CTF_COLUMNAR_SINK_COLUMNAR_SINK_TABLE_H
+
+/*
+ * Copyright 2019 - EfficiOS Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <babeltrace/babeltrace-internal.h>
+#include <babeltrace/babeltrace.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <glib.h>
+
+#include "../fs-sink/fs-sink-ctf-meta.h"
+#include "columnar-format.h"
+
+struct columnar_sink_trace;
+
+struct columnar_sink_file {
+	FILE *fp;
+	GString *path;
+
+	/* Write buffer, flushed to `fp` when full */
+	uint8_t *buf;
+	size_t len;
+};
+
+struct columnar_sink_column {
+	GString *name;
+	enum columnar_column_type type;
+	struct columnar_sink_file data;
+
+	/* Only used by string and list columns */
+	struct columnar_sink_file offsets;
+
+	/*
+	 * Current end offset of `data` (bytes for a string column,
+	 * elements for a list column).
+	 */
+	uint64_t end_offset;
+};
+
+struct columnar_sink_table {
+	/* Weak */
+	struct columnar_sink_trace *trace;
+
+	/* Weak */
+	struct fs_sink_ctf_event_class *ec;
+
+	/* Table's directory */
+	GString *path;
+
+	/* True if the first column contains the events's timestamps */
+	bool has_timestamp;
+
+	/* Array of `struct columnar_sink_column *` (owned by this) */
+	GPtrArray *columns;
+
+	uint64_t row_count;
+
+	/*
+	 * True if a column file could not be created or written: the
+	 * schema file is not written for such a table.
+	 */
+	bool failed;
+};
+
+BT_HIDDEN
+struct columnar_sink_table *columnar_sink_table_create(
+		struct columnar_sink_trace *trace,
+		struct fs_sink_ctf_event_class *ec);
+
+BT_HIDDEN
+int columnar_sink_table_append_event(struct columnar_sink_table *table,
+		const bt_clock_snapshot *cs, const bt_event *event);
+
+BT_HIDDEN
+void columnar_sink_table_destroy(struct columnar_sink_table *table);
+
+#endif /* BABELTRACE_PLUGIN_CTF_COLUMNAR_SINK_COLUMNAR_SINK_TABLE_H */
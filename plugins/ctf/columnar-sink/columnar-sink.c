@@ -0,0 +1,498 @@
+/*
+ * Copyright 2019 - EfficiOS Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#define BT_LOG_TAG "PLUGIN-CTF-COLUMNAR-SINK"
+#include "logging.h"
+
+#include <babeltrace/babeltrace.h>
+#include <babeltrace/assert-internal.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <inttypes.h>
+#include <glib.h>
+
+#include "columnar-sink.h"
+#include "columnar-sink-table.h"
+#include "../fs-sink/fs-sink-ctf-meta.h"
+#include "../fs-sink/translate-trace-ir-to-ctf-ir.h"
+
+static
+const char * const in_port_name = "in";
+
+static
+bt_self_component_status configure_component(
+		struct columnar_sink_comp *columnar_sink,
+		const bt_value *params)
+{
+	bt_self_component_status status = BT_SELF_COMPONENT_STATUS_OK;
+	const bt_value *value;
+
+	value = bt_value_map_borrow_entry_value_const(params, "path");
+	if (!value) {
+		BT_LOGE_STR("Missing mandatory `path` parameter.");
+		status = BT_SELF_COMPONENT_STATUS_ERROR;
+		goto end;
+	}
+
+	if (!bt_value_is_string(value)) {
+		BT_LOGE_STR("`path` parameter: expecting a string.");
+		status = BT_SELF_COMPONENT_STATUS_ERROR;
+		goto end;
+	}
+
+	g_string_assign(columnar_sink->output_dir_path,
+		bt_value_string_get(value));
+	value = bt_value_map_borrow_entry_value_const(params, "quiet");
+	if (value) {
+		if (!bt_value_is_bool(value)) {
+			BT_LOGE_STR("`quiet` parameter: expecting a boolean.");
+			status = BT_SELF_COMPONENT_STATUS_ERROR;
+			goto end;
+		}
+
+		columnar_sink->quiet = (bool) bt_value_bool_get(value);
+	}
+
+end:
+	return status;
+}
+
+static
+void destroy_columnar_sink_trace(struct columnar_sink_trace *trace)
+{
+	if (!trace) {
+		goto end;
+	}
+
+	if (trace->ir_trace_destruction_listener_id != UINT64_C(-1)) {
+		/*
+		 * Remove the destruction listener, otherwise it could
+		 * be called in the future, and its private data is this
+		 * trace object which won't exist anymore.
+		 */
+		(void) bt_trace_remove_destruction_listener(trace->ir_trace,
+			trace->ir_trace_destruction_listener_id);
+		trace->ir_trace_destruction_listener_id = UINT64_C(-1);
+	}
+
+	if (trace->tables) {
+		/* This flushes the tables and writes their schema files */
+		g_hash_table_destroy(trace->tables);
+		trace->tables = NULL;
+
+		if (!trace->columnar_sink->quiet) {
+			printf("Created columnar tables in `%s`.\n",
+				trace->path->str);
+		}
+	}
+
+	if (trace->path) {
+		g_string_free(trace->path, TRUE);
+		trace->path = NULL;
+	}
+
+	fs_sink_ctf_trace_class_destroy(trace->tc);
+	trace->tc = NULL;
+	g_free(trace);
+
+end:
+	return;
+}
+
+static
+void ir_trace_destruction_listener(const bt_trace *ir_trace, void *data)
+{
+	struct columnar_sink_trace *trace = data;
+
+	/*
+	 * Prevent bt_trace_remove_destruction_listener() from being
+	 * called in destroy_columnar_sink_trace(), which is called by
+	 * g_hash_table_remove() below.
+	 */
+	trace->ir_trace_destruction_listener_id = UINT64_C(-1);
+	g_hash_table_remove(trace->columnar_sink->traces, ir_trace);
+}
+
+static
+GString *make_trace_path(struct columnar_sink_comp *columnar_sink,
+		const bt_trace *ir_trace)
+{
+	const char *trace_name = bt_trace_get_name(ir_trace);
+	GString *base = g_string_new(columnar_sink->output_dir_path->str);
+	GString *path;
+	unsigned int suffix = 0;
+	const char *ch;
+
+	BT_ASSERT(base);
+	g_string_append_c(base, '/');
+
+	if (!trace_name || strlen(trace_name) == 0 ||
+			strcmp(trace_name, ".") == 0 ||
+			strcmp(trace_name, "..") == 0) {
+		trace_name = "trace";
+	}
+
+	for (ch = trace_name; *ch != '\0'; ch++) {
+		g_string_append_c(base, *ch == '/' ? '_' : *ch);
+	}
+
+	path = g_string_new(base->str);
+	BT_ASSERT(path);
+
+	while (g_file_test(path->str, G_FILE_TEST_EXISTS)) {
+		g_string_printf(path, "%s-%u", base->str, suffix);
+		suffix++;
+	}
+
+	g_string_free(base, TRUE);
+	return path;
+}
+
+static
+struct columnar_sink_trace *create_columnar_sink_trace(
+		struct columnar_sink_comp *columnar_sink,
+		const bt_trace *ir_trace)
+{
+	int ret;
+	struct columnar_sink_trace *trace =
+		g_new0(struct columnar_sink_trace, 1);
+	bt_trace_status trace_status;
+
+	if (!trace) {
+		goto end;
+	}
+
+	trace->columnar_sink = columnar_sink;
+	trace->ir_trace = ir_trace;
+	trace->ir_trace_destruction_listener_id = UINT64_C(-1);
+	trace->tc = translate_trace_class_trace_ir_to_ctf_ir(
+		bt_trace_borrow_class_const(ir_trace));
+	if (!trace->tc) {
+		goto error;
+	}
+
+	trace->path = make_trace_path(columnar_sink, ir_trace);
+	ret = g_mkdir_with_parents(trace->path->str, 0755);
+	if (ret) {
+		BT_LOGE_ERRNO("Cannot create directories for trace directory",
+			": path=\"%s\"", trace->path->str);
+		goto error;
+	}
+
+	trace->tables = g_hash_table_new_full(g_direct_hash, g_direct_equal,
+		NULL, (GDestroyNotify) columnar_sink_table_destroy);
+	BT_ASSERT(trace->tables);
+	trace_status = bt_trace_add_destruction_listener(ir_trace,
+		ir_trace_destruction_listener, trace,
+		&trace->ir_trace_destruction_listener_id);
+	if (trace_status) {
+		goto error;
+	}
+
+	g_hash_table_insert(columnar_sink->traces, (gpointer) ir_trace,
+		trace);
+	goto end;
+
+error:
+	destroy_columnar_sink_trace(trace);
+	trace = NULL;
+
+end:
+	return trace;
+}
+
+static
+void destroy_columnar_sink_comp(struct columnar_sink_comp *columnar_sink)
+{
+	if (!columnar_sink) {
+		goto end;
+	}
+
+	if (columnar_sink->traces) {
+		g_hash_table_destroy(columnar_sink->traces);
+		columnar_sink->traces = NULL;
+	}
+
+	if (columnar_sink->output_dir_path) {
+		g_string_free(columnar_sink->output_dir_path, TRUE);
+		columnar_sink->output_dir_path = NULL;
+	}
+
+	BT_SELF_COMPONENT_PORT_INPUT_MESSAGE_ITERATOR_PUT_REF_AND_RESET(
+		columnar_sink->upstream_iter);
+	g_free(columnar_sink);
+
+end:
+	return;
+}
+
+BT_HIDDEN
+bt_self_component_status ctf_columnar_sink_init(
+		bt_self_component_sink *self_comp, const bt_value *params,
+		void *init_method_data)
+{
+	bt_self_component_status status = BT_SELF_COMPONENT_STATUS_OK;
+	struct columnar_sink_comp *columnar_sink = NULL;
+
+	columnar_sink = g_new0(struct columnar_sink_comp, 1);
+	if (!columnar_sink) {
+		BT_LOGE_STR("Failed to allocate one CTF columnar sink structure.");
+		status = BT_SELF_COMPONENT_STATUS_NOMEM;
+		goto end;
+	}
+
+	columnar_sink->output_dir_path = g_string_new(NULL);
+	columnar_sink->self_comp = self_comp;
+	status = configure_component(columnar_sink, params);
+	if (status != BT_SELF_COMPONENT_STATUS_OK) {
+		/* configure_component() logs errors */
+		goto end;
+	}
+
+	if (g_mkdir_with_parents(columnar_sink->output_dir_path->str, 0755)) {
+		BT_LOGE_ERRNO("Cannot create directories for output directory",
+			": output-dir-path=\"%s\"",
+			columnar_sink->output_dir_path->str);
+		status = BT_SELF_COMPONENT_STATUS_ERROR;
+		goto end;
+	}
+
+	columnar_sink->traces = g_hash_table_new_full(g_direct_hash,
+		g_direct_equal, NULL,
+		(GDestroyNotify) destroy_columnar_sink_trace);
+	if (!columnar_sink->traces) {
+		BT_LOGE_STR("Failed to allocate one GHashTable.");
+		status = BT_SELF_COMPONENT_STATUS_NOMEM;
+		goto end;
+	}
+
+	status = bt_self_component_sink_add_input_port(self_comp, in_port_name,
+		NULL, NULL);
+	if (status != BT_SELF_COMPONENT_STATUS_OK) {
+		goto end;
+	}
+
+	bt_self_component_set_data(
+		bt_self_component_sink_as_self_component(self_comp),
+		columnar_sink);
+
+end:
+	if (status != BT_SELF_COMPONENT_STATUS_OK) {
+		destroy_columnar_sink_comp(columnar_sink);
+	}
+
+	return status;
+}
+
+static inline
+struct columnar_sink_table *borrow_table(
+		struct columnar_sink_comp *columnar_sink,
+		const bt_event *ir_event)
+{
+	int ret;
+	const bt_stream *ir_stream = bt_event_borrow_stream_const(ir_event);
+	const bt_trace *ir_trace = bt_stream_borrow_trace_const(ir_stream);
+	const bt_event_class *ir_ec = bt_event_borrow_class_const(ir_event);
+	struct columnar_sink_trace *trace;
+	struct columnar_sink_table *table = NULL;
+	struct fs_sink_ctf_stream_class *sc = NULL;
+	struct fs_sink_ctf_event_class *ec = NULL;
+
+	trace = g_hash_table_lookup(columnar_sink->traces, ir_trace);
+	if (unlikely(!trace)) {
+		trace = create_columnar_sink_trace(columnar_sink, ir_trace);
+		if (!trace) {
+			goto end;
+		}
+	}
+
+	table = g_hash_table_lookup(trace->tables, ir_ec);
+	if (likely(table)) {
+		goto end;
+	}
+
+	ret = try_translate_stream_class_trace_ir_to_ctf_ir(trace->tc,
+		bt_stream_borrow_class_const(ir_stream), &sc);
+	if (ret) {
+		goto end;
+	}
+
+	ret = try_translate_event_class_trace_ir_to_ctf_ir(sc, ir_ec, &ec);
+	if (ret) {
+		goto end;
+	}
+
+	BT_ASSERT(ec);
+	table = columnar_sink_table_create(trace, ec);
+	if (!table) {
+		goto end;
+	}
+
+	g_hash_table_insert(trace->tables, (gpointer) ir_ec, table);
+
+end:
+	return table;
+}
+
+static inline
+bt_self_component_status handle_event_msg(
+		struct columnar_sink_comp *columnar_sink,
+		const bt_message *msg)
+{
+	bt_self_component_status status = BT_SELF_COMPONENT_STATUS_OK;
+	const bt_event *ir_event = bt_message_event_borrow_event_const(msg);
+	struct columnar_sink_table *table;
+	const bt_clock_snapshot *cs = NULL;
+
+	table = borrow_table(columnar_sink, ir_event);
+	if (unlikely(!table)) {
+		status = BT_SELF_COMPONENT_STATUS_ERROR;
+		goto end;
+	}
+
+	if (table->has_timestamp) {
+		cs = bt_message_event_borrow_default_clock_snapshot_const(msg);
+	}
+
+	if (unlikely(columnar_sink_table_append_event(table, cs, ir_event))) {
+		status = BT_SELF_COMPONENT_STATUS_ERROR;
+		goto end;
+	}
+
+end:
+	return status;
+}
+
+static inline
+void put_messages(bt_message_array_const msgs, uint64_t count)
+{
+	uint64_t i;
+
+	for (i = 0; i < count; i++) {
+		BT_MESSAGE_PUT_REF_AND_RESET(msgs[i]);
+	}
+}
+
+BT_HIDDEN
+bt_self_component_status ctf_columnar_sink_consume(
+		bt_self_component_sink *self_comp)
+{
+	bt_self_component_status status = BT_SELF_COMPONENT_STATUS_OK;
+	struct columnar_sink_comp *columnar_sink;
+	bt_message_iterator_status it_status;
+	uint64_t msg_count = 0;
+	bt_message_array_const msgs;
+
+	columnar_sink = bt_self_component_get_data(
+			bt_self_component_sink_as_self_component(self_comp));
+	BT_ASSERT(columnar_sink);
+	BT_ASSERT(columnar_sink->upstream_iter);
+
+	/* Consume messages */
+	it_status = bt_self_component_port_input_message_iterator_next(
+		columnar_sink->upstream_iter, &msgs, &msg_count);
+	if (it_status < 0) {
+		status = BT_SELF_COMPONENT_STATUS_ERROR;
+		goto end;
+	}
+
+	switch (it_status) {
+	case BT_MESSAGE_ITERATOR_STATUS_OK:
+	{
+		uint64_t i;
+
+		for (i = 0; i < msg_count; i++) {
+			const bt_message *msg = msgs[i];
+
+			BT_ASSERT(msg);
+
+			/* Only event messages have rows */
+			if (bt_message_get_type(msg) == BT_MESSAGE_TYPE_EVENT) {
+				status = handle_event_msg(columnar_sink, msg);
+			}
+
+			BT_MESSAGE_PUT_REF_AND_RESET(msgs[i]);
+
+			if (status != BT_SELF_COMPONENT_STATUS_OK) {
+				BT_LOGE("Failed to handle message: "
+					"generated columnar tables could be "
+					"incomplete: output-dir-path=\"%s\"",
+					columnar_sink->output_dir_path->str);
+				goto error;
+			}
+		}
+
+		break;
+	}
+	case BT_MESSAGE_ITERATOR_STATUS_AGAIN:
+		status = BT_SELF_COMPONENT_STATUS_AGAIN;
+		break;
+	case BT_MESSAGE_ITERATOR_STATUS_END:
+		status = BT_SELF_COMPONENT_STATUS_END;
+		break;
+	case BT_MESSAGE_ITERATOR_STATUS_NOMEM:
+		status = BT_SELF_COMPONENT_STATUS_NOMEM;
+		break;
+	default:
+		break;
+	}
+
+	goto end;
+
+error:
+	BT_ASSERT(status != BT_SELF_COMPONENT_STATUS_OK);
+	put_messages(msgs, msg_count);
+
+end:
+	return status;
+}
+
+BT_HIDDEN
+bt_self_component_status ctf_columnar_sink_graph_is_configured(
+		bt_self_component_sink *self_comp)
+{
+	bt_self_component_status status = BT_SELF_COMPONENT_STATUS_OK;
+	struct columnar_sink_comp *columnar_sink = bt_self_component_get_data(
+			bt_self_component_sink_as_self_component(self_comp));
+
+	columnar_sink->upstream_iter =
+		bt_self_component_port_input_message_iterator_create(
+			bt_self_component_sink_borrow_input_port_by_name(
+				self_comp, in_port_name));
+	if (!columnar_sink->upstream_iter) {
+		status = BT_SELF_COMPONENT_STATUS_NOMEM;
+		goto end;
+	}
+
+end:
+	return status;
+}
+
+BT_HIDDEN
+void ctf_columnar_sink_finalize(bt_self_component_sink *self_comp)
+{
+	struct columnar_sink_comp *columnar_sink = bt_self_component_get_data(
+			bt_self_component_sink_as_self_component(self_comp));
+
+	destroy_columnar_sink_comp(columnar_sink);
+}
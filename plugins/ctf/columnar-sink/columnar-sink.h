@@ -0,0 +1,97 @@
+#ifndef BABELTRACE_PLUGIN_CTF_COLUMNAR_SINK_COLUMNAR_SINK_H
+#define BABELTRACE_PLUGIN_CTF_COLUMNAR_SINK_COLUMNAR_SINK_H
+
+/*
+ * Copyright 2019 - EfficiOS Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <babeltrace/babeltrace-internal.h>
+#include <babeltrace/babeltrace.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <glib.h>
+
+#include "../fs-sink/fs-sink-ctf-meta.h"
+
+struct columnar_sink_comp {
+	bt_self_component_sink *self_comp;
+
+	/* Owned by this */
+	bt_self_component_port_input_message_iterator *upstream_iter;
+
+	/* Base output directory path */
+	GString *output_dir_path;
+
+	bool quiet;
+
+	/*
+	 * Hash table of `const bt_trace *` (weak) to
+	 * `struct columnar_sink_trace *` (owned by hash table).
+	 */
+	GHashTable *traces;
+};
+
+struct columnar_sink_trace {
+	struct columnar_sink_comp *columnar_sink;
+
+	/*
+	 * Owned by this: the field class walk of `sink.ctf.fs` is
+	 * reused to validate the trace IR classes and to find the
+	 * column layout of each event class.
+	 */
+	struct fs_sink_ctf_trace_class *tc;
+
+	/*
+	 * Weak: like in `sink.ctf.fs`, a trace destruction listener
+	 * destroys this object when the trace IR trace is destroyed.
+	 */
+	const bt_trace *ir_trace;
+
+	uint64_t ir_trace_destruction_listener_id;
+
+	/* Trace's directory */
+	GString *path;
+
+	/*
+	 * Hash table of `const bt_event_class *` (weak) to
+	 * `struct columnar_sink_table *` (owned by hash table).
+	 */
+	GHashTable *tables;
+};
+
+BT_HIDDEN
+bt_self_component_status ctf_columnar_sink_init(
+		bt_self_component_sink *component,
+		const bt_value *params,
+		void *init_method_data);
+
+BT_HIDDEN
+bt_self_component_status ctf_columnar_sink_consume(
+		bt_self_component_sink *component);
+
+BT_HIDDEN
+bt_self_component_status ctf_columnar_sink_graph_is_configured(
+		bt_self_component_sink *component);
+
+BT_HIDDEN
+void ctf_columnar_sink_finalize(bt_self_component_sink *component);
+
+#endif /* BABELTRACE_PLUGIN_CTF_COLUMNAR_SINK_COLUMNAR_SINK_H */
@@ -146,6 +146,11 @@ int update_stream_class_default_clock_class(
 		struct ctf_event_class *event_class =
 			stream_class->event_classes->pdata[i];
 
+		if (event_class->is_translated) {
+			/* Already checked when decoding a previous chunk */
+			continue;
+		}
+
 		ret = find_mapped_clock_class(event_class->spec_context_fc,
 			&clock_class);
 		if (ret) {
@@ -84,9 +84,41 @@ end:
 	return;
 }
 
+/* Projection state of a field class */
+enum projection_state {
+	/* Keep the field class and all its descendants */
+	PROJECTION_STATE_KEEP,
+
+	/* Keep only the selected descendants of the field class */
+	PROJECTION_STATE_PATH,
+
+	/* Drop the field class unless another field class depends on it */
+	PROJECTION_STATE_DROP,
+};
+
+static
+enum projection_state child_projection_state(
+		enum projection_state parent_state,
+		struct ctf_field_class *child_fc, GHashTable *projected_fcs)
+{
+	gpointer value;
+
+	if (parent_state != PROJECTION_STATE_PATH) {
+		return parent_state;
+	}
+
+	if (!g_hash_table_lookup_extended(projected_fcs, child_fc, NULL,
+			&value)) {
+		return PROJECTION_STATE_DROP;
+	}
+
+	return (enum projection_state) GPOINTER_TO_INT(value);
+}
+
 static
 void update_field_class_in_ir(struct ctf_field_class *fc,
-		GHashTable *ft_dependents)
+		GHashTable *ft_dependents, GHashTable *projected_fcs,
+		enum projection_state state)
 {
 	int64_t i;
 
@@ -104,11 +136,13 @@ void update_field_class_in_ir(struct ctf_field_class *fc,
 		 * Conditions to be in trace IR; one of:
 		 *
 		 * 1. Does NOT have a mapped clock class AND does not
-		 *    have a special meaning.
+		 *    have a special meaning AND is not dropped by the
+		 *    projection.
 		 * 2. Another field class depends on it.
 		 */
 		if ((!int_fc->mapped_clock_class &&
-				int_fc->meaning == CTF_FIELD_CLASS_MEANING_NONE) ||
+				int_fc->meaning == CTF_FIELD_CLASS_MEANING_NONE &&
+				state != PROJECTION_STATE_DROP) ||
 				bt_g_hash_table_contains(ft_dependents, fc)) {
 			fc->in_ir = true;
 		}
@@ -123,7 +157,8 @@ void update_field_class_in_ir(struct ctf_field_class *fc,
 		 * Make it part of IR if it's empty because it was
 		 * originally empty.
 		 */
-		if (struct_fc->members->len == 0) {
+		if (struct_fc->members->len == 0 &&
+				state != PROJECTION_STATE_DROP) {
 			fc->in_ir = true;
 		}
 
@@ -133,7 +168,10 @@ void update_field_class_in_ir(struct ctf_field_class *fc,
 				ctf_field_class_struct_borrow_member_by_index(
 					struct_fc, i);
 
-			update_field_class_in_ir(named_fc->fc, ft_dependents);
+			update_field_class_in_ir(named_fc->fc, ft_dependents,
+				projected_fcs,
+				child_projection_state(state, named_fc->fc,
+					projected_fcs));
 
 			if (named_fc->fc->in_ir) {
 				/* At least one member is part of IR */
@@ -159,7 +197,10 @@ void update_field_class_in_ir(struct ctf_field_class *fc,
 				ctf_field_class_variant_borrow_option_by_index(
 					var_fc, i);
 
-			update_field_class_in_ir(named_fc->fc, ft_dependents);
+			update_field_class_in_ir(named_fc->fc, ft_dependents,
+				projected_fcs,
+				child_projection_state(state, named_fc->fc,
+					projected_fcs));
 
 			if (named_fc->fc->in_ir) {
 				/* At least one option is part of IR */
@@ -198,7 +239,10 @@ void update_field_class_in_ir(struct ctf_field_class *fc,
 	{
 		struct ctf_field_class_array_base *array_fc = (void *) fc;
 
-		update_field_class_in_ir(array_fc->elem_fc, ft_dependents);
+		update_field_class_in_ir(array_fc->elem_fc, ft_dependents,
+			projected_fcs,
+			child_projection_state(state, array_fc->elem_fc,
+				projected_fcs));
 		fc->in_ir = array_fc->elem_fc->in_ir;
 
 		if (fc->type == CTF_FIELD_CLASS_TYPE_ARRAY) {
@@ -232,7 +276,10 @@ void update_field_class_in_ir(struct ctf_field_class *fc,
 		break;
 	}
 	default:
-		fc->in_ir = true;
+		if (state != PROJECTION_STATE_DROP) {
+			fc->in_ir = true;
+		}
+
 		break;
 	}
 
@@ -240,22 +287,126 @@ end:
 	return;
 }
 
+static
+void insert_projected_fc(GHashTable *projected_fcs,
+		struct ctf_field_class *fc, enum projection_state state)
+{
+	gpointer value;
+
+	if (state == PROJECTION_STATE_PATH &&
+			g_hash_table_lookup_extended(projected_fcs, fc, NULL,
+				&value)) {
+		/* Never downgrade an already kept field class */
+		return;
+	}
+
+	g_hash_table_insert(projected_fcs, fc, GINT_TO_POINTER(state));
+}
+
+/*
+ * Adds the field classes on the path `path` (e.g. `payload.args.fd`)
+ * of the event class `ec` to `projected_fcs`.
+ *
+ * The first path element is the scope name: `payload` or
+ * `specific-context`. Array and sequence field classes are
+ * transparent: their element field class is implicitly part of the
+ * path.
+ *
+ * Returns `false`, leaving `projected_fcs` as is, if `path` does not
+ * exist.
+ */
+static
+bool add_projected_field_path(struct ctf_event_class *ec,
+		const char *path, GHashTable *projected_fcs)
+{
+	gchar **elems = g_strsplit(path, ".", 0);
+	GPtrArray *path_fcs = g_ptr_array_new();
+	struct ctf_field_class *fc;
+	bool added = false;
+	guint i;
+
+	BT_ASSERT(path_fcs);
+
+	if (strcmp(elems[0], "payload") == 0) {
+		fc = ec->payload_fc;
+	} else if (strcmp(elems[0], "specific-context") == 0) {
+		fc = ec->spec_context_fc;
+	} else {
+		BT_LOGW("Ignoring projected field path with unknown scope: "
+			"ec-name=\"%s\", path=\"%s\"", ec->name->str, path);
+		goto end;
+	}
+
+	for (i = 1; fc && elems[i]; i++) {
+		struct ctf_named_field_class *named_fc = NULL;
+
+		g_ptr_array_add(path_fcs, fc);
+
+		while (fc->type == CTF_FIELD_CLASS_TYPE_ARRAY ||
+				fc->type == CTF_FIELD_CLASS_TYPE_SEQUENCE) {
+			fc = ((struct ctf_field_class_array_base *) fc)->elem_fc;
+			g_ptr_array_add(path_fcs, fc);
+		}
+
+		if (fc->type == CTF_FIELD_CLASS_TYPE_STRUCT) {
+			named_fc = ctf_field_class_struct_borrow_member_by_name(
+				(void *) fc, elems[i]);
+		} else if (fc->type == CTF_FIELD_CLASS_TYPE_VARIANT) {
+			named_fc = ctf_field_class_variant_borrow_option_by_name(
+				(void *) fc, elems[i]);
+		}
+
+		fc = named_fc ? named_fc->fc : NULL;
+	}
+
+	if (!fc) {
+		BT_LOGW("Ignoring unknown projected field path: "
+			"ec-name=\"%s\", path=\"%s\"", ec->name->str, path);
+		goto end;
+	}
+
+	/* Only select the ancestors once the whole path exists */
+	for (i = 0; i < path_fcs->len; i++) {
+		insert_projected_fc(projected_fcs, path_fcs->pdata[i],
+			PROJECTION_STATE_PATH);
+	}
+
+	insert_projected_fc(projected_fcs, fc, PROJECTION_STATE_KEEP);
+	added = true;
+
+end:
+	g_ptr_array_free(path_fcs, TRUE);
+	g_strfreev(elems);
+	return added;
+}
+
 /*
  * Scopes and field classes are processed in reverse order because we need
  * to know if a given integer field class has dependents (sequence or
  * variant field classes) when we reach it. Dependents can only be located
  * after the length/tag field class in the metadata tree.
+ *
+ * `projection`, if not `NULL`, is a map value of which the keys are
+ * event class names and the values are arrays of field paths (see
+ * add_projected_field_path()). The specific context and payload field
+ * classes of a named event class which are not on one of its field
+ * paths are not part of IR, unless another field class which is part
+ * of IR depends on them.
  */
 BT_HIDDEN
-int ctf_trace_class_update_in_ir(struct ctf_trace_class *ctf_tc)
+int ctf_trace_class_update_in_ir(struct ctf_trace_class *ctf_tc,
+		const bt_value *projection)
 {
 	int ret = 0;
 	uint64_t i;
 
 	GHashTable *ft_dependents = g_hash_table_new(g_direct_hash,
 		g_direct_equal);
+	GHashTable *projected_fcs = g_hash_table_new(g_direct_hash,
+		g_direct_equal);
 
 	BT_ASSERT(ft_dependents);
+	BT_ASSERT(projected_fcs);
 
 	for (i = 0; i < ctf_tc->stream_classes->len; i++) {
 		struct ctf_stream_class *sc = ctf_tc->stream_classes->pdata[i];
@@ -263,23 +414,72 @@ int ctf_trace_class_update_in_ir(struct ctf_trace_class *ctf_tc)
 
 		for (j = 0; j < sc->event_classes->len; j++) {
 			struct ctf_event_class *ec = sc->event_classes->pdata[j];
+			enum projection_state state = PROJECTION_STATE_KEEP;
+			const bt_value *paths = NULL;
 
 			if (ec->is_translated) {
 				continue;
 			}
 
-			update_field_class_in_ir(ec->payload_fc, ft_dependents);
+			if (projection) {
+				paths = bt_value_map_borrow_entry_value_const(
+					projection, ec->name->str);
+			}
+
+			if (paths) {
+				uint64_t added_count = 0;
+				uint64_t k;
+
+				BT_ASSERT(bt_value_is_array(paths));
+				g_hash_table_remove_all(projected_fcs);
+
+				for (k = 0; k < bt_value_array_get_size(paths);
+						k++) {
+					const bt_value *path =
+						bt_value_array_borrow_element_by_index_const(
+							paths, k);
+
+					BT_ASSERT(bt_value_is_string(path));
+					if (add_projected_field_path(ec,
+							bt_value_string_get(path),
+							projected_fcs)) {
+						added_count++;
+					}
+				}
+
+				/*
+				 * Unknown field paths are ignored: without
+				 * any existing one, keep all the fields.
+				 */
+				if (added_count > 0) {
+					state = PROJECTION_STATE_PATH;
+				}
+
+				BT_LOGD("Projecting event class's fields: "
+					"ec-name=\"%s\", ec-id=%" PRIu64 ", "
+					"path-count=%" PRIu64,
+					ec->name->str, ec->id, added_count);
+			}
+
+			update_field_class_in_ir(ec->payload_fc, ft_dependents,
+				projected_fcs,
+				child_projection_state(state, ec->payload_fc,
+					projected_fcs));
 			update_field_class_in_ir(ec->spec_context_fc,
-				ft_dependents);
+				ft_dependents, projected_fcs,
+				child_projection_state(state,
+					ec->spec_context_fc, projected_fcs));
 		}
 
 		if (!sc->is_translated) {
 			update_field_class_in_ir(sc->event_common_context_fc,
-				ft_dependents);
+				ft_dependents, projected_fcs,
+				PROJECTION_STATE_KEEP);
 			force_update_field_class_in_ir(sc->event_header_fc,
 				false);
 			update_field_class_in_ir(sc->packet_context_fc,
-				ft_dependents);
+				ft_dependents, projected_fcs,
+				PROJECTION_STATE_KEEP);
 		}
 	}
 
@@ -288,6 +488,7 @@ int ctf_trace_class_update_in_ir(struct ctf_trace_class *ctf_tc)
 			false);
 	}
 
+	g_hash_table_destroy(projected_fcs);
 	g_hash_table_destroy(ft_dependents);
 	return ret;
 }
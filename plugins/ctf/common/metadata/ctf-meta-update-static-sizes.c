@@ -0,0 +1,186 @@
+/*
+ * Copyright 2019 - EfficiOS Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#define BT_LOG_TAG "PLUGIN-CTF-METADATA-META-UPDATE-STATIC-SIZES"
+#include "logging.h"
+
+#include <babeltrace/babeltrace.h>
+#include <babeltrace/babeltrace-internal.h>
+#include <babeltrace/assert-internal.h>
+#include <babeltrace/align-internal.h>
+#include <glib.h>
+#include <stdint.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include "ctf-meta-visitors.h"
+
+/*
+ * Returns the static size (bits) of a field described by `fc`, or -1
+ * if this size depends on the data, or if decoding such a field has a
+ * side effect (updating a clock value or storing a value for a
+ * subsequent sequence length or variant tag).
+ *
+ * The returned size is only valid when the field starts at a position
+ * which is aligned according to `fc`'s alignment, which is always the
+ * case for a dynamic scope field.
+ */
+static
+int64_t field_class_static_size(struct ctf_field_class *fc)
+{
+	int64_t size = -1;
+	uint64_t i;
+
+	switch (fc->type) {
+	case CTF_FIELD_CLASS_TYPE_INT:
+	case CTF_FIELD_CLASS_TYPE_ENUM:
+	{
+		struct ctf_field_class_int *int_fc = (void *) fc;
+
+		if (int_fc->meaning != CTF_FIELD_CLASS_MEANING_NONE ||
+				int_fc->mapped_clock_class ||
+				int_fc->storing_index >= 0) {
+			goto end;
+		}
+
+		size = (int64_t) int_fc->base.size;
+		break;
+	}
+	case CTF_FIELD_CLASS_TYPE_FLOAT:
+	{
+		struct ctf_field_class_float *float_fc = (void *) fc;
+
+		size = (int64_t) float_fc->base.size;
+		break;
+	}
+	case CTF_FIELD_CLASS_TYPE_STRUCT:
+	{
+		struct ctf_field_class_struct *struct_fc = (void *) fc;
+		uint64_t offset = 0;
+
+		for (i = 0; i < struct_fc->members->len; i++) {
+			struct ctf_named_field_class *named_fc =
+				ctf_field_class_struct_borrow_member_by_index(
+					struct_fc, i);
+			int64_t member_size =
+				field_class_static_size(named_fc->fc);
+
+			if (member_size < 0) {
+				goto end;
+			}
+
+			offset = ALIGN(offset,
+				(uint64_t) named_fc->fc->alignment);
+			offset += (uint64_t) member_size;
+		}
+
+		size = (int64_t) offset;
+		break;
+	}
+	case CTF_FIELD_CLASS_TYPE_ARRAY:
+	{
+		struct ctf_field_class_array *array_fc = (void *) fc;
+		struct ctf_field_class *elem_fc = array_fc->base.elem_fc;
+		int64_t elem_size;
+		uint64_t stride;
+
+		if (array_fc->meaning != CTF_FIELD_CLASS_MEANING_NONE) {
+			goto end;
+		}
+
+		elem_size = field_class_static_size(elem_fc);
+		if (elem_size < 0) {
+			goto end;
+		}
+
+		if (array_fc->length == 0) {
+			size = 0;
+			goto end;
+		}
+
+		/*
+		 * Each element is aligned, but the array itself does
+		 * not end with padding.
+		 */
+		stride = ALIGN((uint64_t) elem_size,
+			(uint64_t) elem_fc->alignment);
+		size = (int64_t) ((array_fc->length - 1) * stride +
+			(uint64_t) elem_size);
+		break;
+	}
+	default:
+		/* Strings, sequences, and variants are dynamic */
+		break;
+	}
+
+end:
+	return size;
+}
+
+static
+int64_t scope_static_size(struct ctf_field_class *fc)
+{
+	if (!fc) {
+		return -1;
+	}
+
+	return field_class_static_size(fc);
+}
+
+BT_HIDDEN
+int ctf_trace_class_update_static_sizes(struct ctf_trace_class *ctf_tc)
+{
+	uint64_t i;
+
+	for (i = 0; i < ctf_tc->stream_classes->len; i++) {
+		uint64_t j;
+		struct ctf_stream_class *sc = ctf_tc->stream_classes->pdata[i];
+
+		if (!sc->is_translated) {
+			sc->event_common_context_static_size =
+				scope_static_size(sc->event_common_context_fc);
+		}
+
+		for (j = 0; j < sc->event_classes->len; j++) {
+			struct ctf_event_class *ec =
+				sc->event_classes->pdata[j];
+
+			if (ec->is_translated) {
+				continue;
+			}
+
+			ec->spec_context_static_size =
+				scope_static_size(ec->spec_context_fc);
+			ec->payload_static_size =
+				scope_static_size(ec->payload_fc);
+			BT_LOGV("Updated event class's static sizes: "
+				"ec-name=\"%s\", ec-id=%" PRIu64 ", "
+				"spec-context-size=%" PRId64 ", "
+				"payload-size=%" PRId64,
+				ec->name->str, ec->id,
+				ec->spec_context_static_size,
+				ec->payload_static_size);
+		}
+	}
+
+	return 0;
+}
@@ -32,7 +32,8 @@ int ctf_trace_class_update_default_clock_classes(
 		struct ctf_trace_class *ctf_tc);
 
 BT_HIDDEN
-int ctf_trace_class_update_in_ir(struct ctf_trace_class *ctf_tc);
+int ctf_trace_class_update_in_ir(struct ctf_trace_class *ctf_tc,
+		const bt_value *projection);
 
 BT_HIDDEN
 int ctf_trace_class_update_meanings(struct ctf_trace_class *ctf_tc);
@@ -43,6 +44,9 @@ int ctf_trace_class_update_text_array_sequence(struct ctf_trace_class *ctf_tc);
 BT_HIDDEN
 int ctf_trace_class_update_value_storing_indexes(struct ctf_trace_class *ctf_tc);
 
+BT_HIDDEN
+int ctf_trace_class_update_static_sizes(struct ctf_trace_class *ctf_tc);
+
 BT_HIDDEN
 int ctf_trace_class_validate(struct ctf_trace_class *ctf_tc);
 
@@ -20,6 +20,7 @@
 #include <babeltrace/assert-internal.h>
 #include <glib.h>
 #include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 
 enum ctf_field_class_type {
@@ -182,6 +183,25 @@ struct ctf_field_class_variant {
 	/* Array of `struct ctf_field_class_variant_range` */
 	GArray *ranges;
 
+	/*
+	 * Option lookup index, built from `ranges` by
+	 * ctf_field_class_variant_set_tag_field_class() when its ranges
+	 * are disjoint (otherwise `sorted_ranges` is `NULL` and
+	 * ctf_field_class_variant_find_option_index() scans `ranges`).
+	 *
+	 * `sorted_ranges` is `ranges` sorted by lower bound, where the
+	 * bounds are ordered keys (see ctf_field_class_variant_tag_key()).
+	 *
+	 * If the keys span at most `CTF_VARIANT_DENSE_MAX_SPAN` values,
+	 * `dense_options` is also set: the element at `key - dense_base`
+	 * is the selected option's index plus one, or 0 if no option
+	 * maps this key.
+	 */
+	GArray *sorted_ranges;
+	uint32_t *dense_options;
+	uint64_t dense_base;
+	uint64_t dense_len;
+
 	/* Weak */
 	struct ctf_field_class_enum *tag_fc;
 };
@@ -221,6 +241,20 @@ struct ctf_event_class {
 	/* Owned by this */
 	struct ctf_field_class *payload_fc;
 
+	/*
+	 * Static sizes (bits) of the specific context and payload
+	 * fields, or -1 if they are not static (see
+	 * ctf_trace_class_update_static_sizes()).
+	 */
+	int64_t spec_context_static_size;
+	int64_t payload_static_size;
+
+	/*
+	 * True if the message iterator must skip the events of this
+	 * class without creating any message.
+	 */
+	bool is_skipped;
+
 	/* Weak, set during translation */
 	bt_event_class *ir_ec;
 };
@@ -238,6 +272,13 @@ struct ctf_stream_class {
 	/* Owned by this */
 	struct ctf_field_class *event_common_context_fc;
 
+	/*
+	 * Static size (bits) of the event common context field, or -1
+	 * if it is not static (see
+	 * ctf_trace_class_update_static_sizes()).
+	 */
+	int64_t event_common_context_static_size;
+
 	/* Array of `struct ctf_event_class *`, owned by this */
 	GPtrArray *event_classes;
 
@@ -247,6 +288,14 @@ struct ctf_stream_class {
 	 */
 	GHashTable *event_classes_by_id;
 
+	/*
+	 * True if this stream class has at least one event class and
+	 * all its event classes are skipped (see
+	 * `struct ctf_event_class`): the message iterator can then
+	 * skip the whole content of a packet.
+	 */
+	bool all_event_classes_skipped;
+
 	/* Weak */
 	struct ctf_clock_class *default_clock_class;
 
@@ -287,6 +336,13 @@ struct ctf_trace_class {
 	/* Array of `struct ctf_stream_class *` */
 	GPtrArray *stream_classes;
 
+	/*
+	 * Hash table mapping stream class IDs (`uint64_t *`, pointing
+	 * to the stream class's `id` member) to
+	 * `struct ctf_stream_class *`, weak.
+	 */
+	GHashTable *stream_classes_by_id;
+
 	/* Array of `struct ctf_trace_class_env_entry` */
 	GArray *env_entries;
 
@@ -608,6 +664,12 @@ void _ctf_field_class_variant_destroy(struct ctf_field_class_variant *fc)
 		g_array_free(fc->ranges, TRUE);
 	}
 
+	if (fc->sorted_ranges) {
+		g_array_free(fc->sorted_ranges, TRUE);
+	}
+
+	g_free(fc->dense_options);
+
 	if (fc->tag_ref) {
 		g_string_free(fc->tag_ref, TRUE);
 	}
@@ -845,6 +907,199 @@ void ctf_field_class_variant_append_option(struct ctf_field_class_variant *fc,
 	named_fc->fc = option_fc;
 }
 
+#define CTF_VARIANT_DENSE_MAX_SPAN	4096
+
+/*
+ * Maps a variant tag value to a key of which the unsigned order is the
+ * order of the tag field class's values.
+ */
+static inline
+uint64_t ctf_field_class_variant_tag_key(struct ctf_field_class_variant *fc,
+		uint64_t tag)
+{
+	return fc->tag_fc->base.is_signed ? tag ^ (UINT64_C(1) << 63) : tag;
+}
+
+static inline
+int ctf_field_class_variant_compare_ranges(const void *a, const void *b)
+{
+	const struct ctf_field_class_variant_range *range_a = a;
+	const struct ctf_field_class_variant_range *range_b = b;
+
+	if (range_a->range.lower.u < range_b->range.lower.u) {
+		return -1;
+	} else if (range_a->range.lower.u > range_b->range.lower.u) {
+		return 1;
+	}
+
+	return 0;
+}
+
+static inline
+void ctf_field_class_variant_build_range_index(
+		struct ctf_field_class_variant *fc)
+{
+	uint64_t i;
+	struct ctf_field_class_variant_range *first, *last;
+
+	if (fc->sorted_ranges) {
+		g_array_free(fc->sorted_ranges, TRUE);
+		fc->sorted_ranges = NULL;
+	}
+
+	g_free(fc->dense_options);
+	fc->dense_options = NULL;
+	fc->dense_base = 0;
+	fc->dense_len = 0;
+
+	if (fc->ranges->len == 0) {
+		goto end;
+	}
+
+	fc->sorted_ranges = g_array_sized_new(FALSE, FALSE,
+		sizeof(struct ctf_field_class_variant_range), fc->ranges->len);
+	BT_ASSERT(fc->sorted_ranges);
+
+	for (i = 0; i < fc->ranges->len; i++) {
+		struct ctf_field_class_variant_range range =
+			g_array_index(fc->ranges,
+				struct ctf_field_class_variant_range, i);
+
+		range.range.lower.u = ctf_field_class_variant_tag_key(fc,
+			range.range.lower.u);
+		range.range.upper.u = ctf_field_class_variant_tag_key(fc,
+			range.range.upper.u);
+		g_array_append_val(fc->sorted_ranges, range);
+	}
+
+	qsort(fc->sorted_ranges->data, fc->sorted_ranges->len,
+		sizeof(struct ctf_field_class_variant_range),
+		ctf_field_class_variant_compare_ranges);
+
+	for (i = 1; i < fc->sorted_ranges->len; i++) {
+		struct ctf_field_class_variant_range *prev_range =
+			&g_array_index(fc->sorted_ranges,
+				struct ctf_field_class_variant_range, i - 1);
+		struct ctf_field_class_variant_range *range =
+			&g_array_index(fc->sorted_ranges,
+				struct ctf_field_class_variant_range, i);
+
+		if (range->range.lower.u <= prev_range->range.upper.u) {
+			/*
+			 * Overlapping ranges: the first matching range
+			 * in `ranges` wins, so keep the linear scan.
+			 */
+			g_array_free(fc->sorted_ranges, TRUE);
+			fc->sorted_ranges = NULL;
+			goto end;
+		}
+	}
+
+	first = &g_array_index(fc->sorted_ranges,
+		struct ctf_field_class_variant_range, 0);
+	last = &g_array_index(fc->sorted_ranges,
+		struct ctf_field_class_variant_range,
+		fc->sorted_ranges->len - 1);
+
+	if (last->range.upper.u - first->range.lower.u >=
+			CTF_VARIANT_DENSE_MAX_SPAN) {
+		goto end;
+	}
+
+	fc->dense_base = first->range.lower.u;
+	fc->dense_len = last->range.upper.u - first->range.lower.u + 1;
+	fc->dense_options = g_new0(uint32_t, fc->dense_len);
+	BT_ASSERT(fc->dense_options);
+
+	for (i = 0; i < fc->sorted_ranges->len; i++) {
+		struct ctf_field_class_variant_range *range =
+			&g_array_index(fc->sorted_ranges,
+				struct ctf_field_class_variant_range, i);
+		const uint64_t base = range->range.lower.u - fc->dense_base;
+		uint64_t n;
+
+		/*
+		 * Count the keys instead of comparing them to the upper
+		 * value, which can be UINT64_MAX.
+		 */
+		for (n = 0; n <= range->range.upper.u - range->range.lower.u;
+				n++) {
+			fc->dense_options[base + n] =
+				(uint32_t) range->option_index + 1;
+		}
+	}
+
+end:
+	return;
+}
+
+/*
+ * Returns the index of the option which the tag value `tag` selects,
+ * or -1 if there's none.
+ */
+static inline
+int64_t ctf_field_class_variant_find_option_index(
+		struct ctf_field_class_variant *fc, uint64_t tag)
+{
+	int64_t option_index = -1;
+	uint64_t key;
+
+	BT_ASSERT(fc->tag_fc);
+
+	if (!fc->sorted_ranges) {
+		uint64_t i;
+
+		for (i = 0; i < fc->ranges->len; i++) {
+			struct ctf_field_class_variant_range *range =
+				&g_array_index(fc->ranges,
+					struct ctf_field_class_variant_range, i);
+
+			if (fc->tag_fc->base.is_signed ?
+					((int64_t) tag >= range->range.lower.i &&
+					(int64_t) tag <= range->range.upper.i) :
+					(tag >= range->range.lower.u &&
+					tag <= range->range.upper.u)) {
+				option_index = (int64_t) range->option_index;
+				break;
+			}
+		}
+
+		goto end;
+	}
+
+	key = ctf_field_class_variant_tag_key(fc, tag);
+
+	if (fc->dense_options) {
+		if (key - fc->dense_base < fc->dense_len) {
+			option_index = (int64_t)
+				fc->dense_options[key - fc->dense_base] - 1;
+		}
+	} else {
+		uint64_t low = 0;
+		uint64_t high = fc->sorted_ranges->len;
+
+		while (low < high) {
+			uint64_t mid = low + (high - low) / 2;
+			struct ctf_field_class_variant_range *range =
+				&g_array_index(fc->sorted_ranges,
+					struct ctf_field_class_variant_range,
+					mid);
+
+			if (key < range->range.lower.u) {
+				high = mid;
+			} else if (key > range->range.upper.u) {
+				low = mid + 1;
+			} else {
+				option_index = (int64_t) range->option_index;
+				break;
+			}
+		}
+	}
+
+end:
+	return option_index;
+}
+
 static inline
 void ctf_field_class_variant_set_tag_field_class(
 		struct ctf_field_class_variant *fc,
@@ -878,6 +1133,8 @@ void ctf_field_class_variant_set_tag_field_class(
 			}
 		}
 	}
+
+	ctf_field_class_variant_build_range_index(fc);
 }
 
 static inline
@@ -1276,6 +1533,23 @@ struct ctf_field_class_variant *_ctf_field_class_variant_copy(
 		g_array_append_val(copy_fc->ranges, *range);
 	}
 
+	if (fc->sorted_ranges) {
+		copy_fc->sorted_ranges = g_array_sized_new(FALSE, FALSE,
+			sizeof(struct ctf_field_class_variant_range),
+			fc->sorted_ranges->len);
+		BT_ASSERT(copy_fc->sorted_ranges);
+		g_array_append_vals(copy_fc->sorted_ranges,
+			fc->sorted_ranges->data, fc->sorted_ranges->len);
+	}
+
+	if (fc->dense_options) {
+		copy_fc->dense_options = g_memdup(fc->dense_options,
+			fc->dense_len * sizeof(*fc->dense_options));
+		BT_ASSERT(copy_fc->dense_options);
+		copy_fc->dense_base = fc->dense_base;
+		copy_fc->dense_len = fc->dense_len;
+	}
+
 	ctf_field_path_copy_content(&copy_fc->tag_path, &fc->tag_path);
 	g_string_assign(copy_fc->tag_ref, fc->tag_ref->str);
 	copy_fc->stored_tag_index = fc->stored_tag_index;
@@ -1382,6 +1656,8 @@ struct ctf_event_class *ctf_event_class_create(void)
 	ec->emf_uri = g_string_new(NULL);
 	BT_ASSERT(ec->emf_uri);
 	ec->log_level = -1;
+	ec->spec_context_static_size = -1;
+	ec->payload_static_size = -1;
 	return ec;
 }
 
@@ -1417,6 +1693,7 @@ struct ctf_stream_class *ctf_stream_class_create(void)
 	sc->event_classes_by_id = g_hash_table_new(g_direct_hash,
 		g_direct_equal);
 	BT_ASSERT(sc->event_classes_by_id);
+	sc->event_common_context_static_size = -1;
 	return sc;
 }
 
@@ -1528,6 +1805,9 @@ struct ctf_trace_class *ctf_trace_class_create(void)
 	tc->stream_classes = g_ptr_array_new_with_free_func(
 		(GDestroyNotify) ctf_stream_class_destroy);
 	BT_ASSERT(tc->stream_classes);
+	tc->stream_classes_by_id = g_hash_table_new(g_int64_hash,
+		g_int64_equal);
+	BT_ASSERT(tc->stream_classes_by_id);
 	tc->env_entries = g_array_new(FALSE, TRUE,
 		sizeof(struct ctf_trace_class_env_entry));
 	return tc;
@@ -1546,6 +1826,10 @@ void ctf_trace_class_destroy(struct ctf_trace_class *tc)
 		g_ptr_array_free(tc->clock_classes, TRUE);
 	}
 
+	if (tc->stream_classes_by_id) {
+		g_hash_table_destroy(tc->stream_classes_by_id);
+	}
+
 	if (tc->stream_classes) {
 		g_ptr_array_free(tc->stream_classes, TRUE);
 	}
@@ -1591,26 +1875,20 @@ void ctf_trace_class_append_env_entry(struct ctf_trace_class *tc,
 	entry->value.i = i_value;
 }
 
+static inline
+void ctf_trace_class_append_stream_class(struct ctf_trace_class *tc,
+		struct ctf_stream_class *sc)
+{
+	g_ptr_array_add(tc->stream_classes, sc);
+	g_hash_table_insert(tc->stream_classes_by_id, &sc->id, sc);
+}
+
 static inline
 struct ctf_stream_class *ctf_trace_class_borrow_stream_class_by_id(
 		struct ctf_trace_class *tc, uint64_t id)
 {
-	uint64_t i;
-	struct ctf_stream_class *ret_sc = NULL;
-
 	BT_ASSERT(tc);
-
-	for (i = 0; i < tc->stream_classes->len; i++) {
-		struct ctf_stream_class *sc = tc->stream_classes->pdata[i];
-
-		if (sc->id == id) {
-			ret_sc = sc;
-			goto end;
-		}
-	}
-
-end:
-	return ret_sc;
+	return g_hash_table_lookup(tc->stream_classes_by_id, &id);
 }
 
 static inline
@@ -37,11 +37,23 @@ extern
 int yydebug;
 
 struct ctf_metadata_decoder {
+	/*
+	 * Kept from one chunk to the other so that a chunk can use the
+	 * types which previous chunks declared.
+	 */
+	struct ctf_scanner *scanner;
+
 	struct ctf_visitor_generate_ir *visitor;
 	uint8_t uuid[16];
 	bool is_uuid_set;
 	int bo;
 	struct ctf_metadata_decoder_config config;
+
+	/*
+	 * Only the first chunk of a plain text metadata stream starts
+	 * with the signature comment (`CTF major.minor`).
+	 */
+	bool has_checked_plaintext_signature;
 };
 
 struct packet_header {
@@ -356,6 +368,7 @@ struct ctf_metadata_decoder *ctf_metadata_decoder_create(
 	struct ctf_metadata_decoder_config default_config = {
 		.clock_class_offset_s = 0,
 		.clock_class_offset_ns = 0,
+		.projection = NULL,
 	};
 
 	if (!config) {
@@ -382,6 +395,15 @@ struct ctf_metadata_decoder *ctf_metadata_decoder_create(
 		goto end;
 	}
 
+	mdec->scanner = ctf_scanner_alloc();
+	if (!mdec->scanner) {
+		BT_LOGE("Cannot allocate a metadata lexical scanner: "
+			"mdec-addr=%p", mdec);
+		ctf_metadata_decoder_destroy(mdec);
+		mdec = NULL;
+		goto end;
+	}
+
 	BT_LOGD("Creating CTF metadata decoder: "
 		"clock-class-offset-s=%" PRId64 ", "
 		"clock-class-offset-ns=%" PRId64 ", addr=%p",
@@ -400,6 +422,11 @@ void ctf_metadata_decoder_destroy(struct ctf_metadata_decoder *mdec)
 	}
 
 	BT_LOGD("Destroying CTF metadata decoder: addr=%p", mdec);
+
+	if (mdec->scanner) {
+		ctf_scanner_free(mdec->scanner);
+	}
+
 	ctf_visitor_generate_ir_destroy(mdec->visitor);
 	g_free(mdec);
 }
@@ -411,7 +438,6 @@ enum ctf_metadata_decoder_status ctf_metadata_decoder_decode(
 	enum ctf_metadata_decoder_status status =
 		CTF_METADATA_DECODER_STATUS_OK;
 	int ret;
-	struct ctf_scanner *scanner = NULL;
 	char *buf = NULL;
 	bool close_fp = false;
 
@@ -442,7 +468,7 @@ enum ctf_metadata_decoder_status ctf_metadata_decoder_decode(
 			status = CTF_METADATA_DECODER_STATUS_ERROR;
 			goto end;
 		}
-	} else {
+	} else if (!mdec->has_checked_plaintext_signature) {
 		unsigned int major, minor;
 		ssize_t nr_items;
 		const long init_pos = ftell(fp);
@@ -478,23 +504,29 @@ enum ctf_metadata_decoder_status ctf_metadata_decoder_decode(
 			status = CTF_METADATA_DECODER_STATUS_ERROR;
 			goto end;
 		}
+
+		mdec->has_checked_plaintext_signature = true;
 	}
 
 	if (BT_LOG_ON_VERBOSE) {
 		yydebug = 1;
 	}
 
-	/* Allocate a scanner and append the metadata text content */
-	scanner = ctf_scanner_alloc();
-	if (!scanner) {
-		BT_LOGE("Cannot allocate a metadata lexical scanner: "
+	/*
+	 * Parse the metadata text content into a new AST: the blocks of
+	 * the previous chunks are already part of the visitor's trace
+	 * class, so only the new blocks need to be visited.
+	 */
+	ret = ctf_scanner_reset_ast(mdec->scanner);
+	if (ret) {
+		BT_LOGE("Cannot reset the metadata lexical scanner's AST: "
 			"mdec-addr=%p", mdec);
 		status = CTF_METADATA_DECODER_STATUS_ERROR;
 		goto end;
 	}
 
 	BT_ASSERT(fp);
-	ret = ctf_scanner_append_ast(scanner, fp);
+	ret = ctf_scanner_append_ast(mdec->scanner, fp);
 	if (ret) {
 		BT_LOGE("Cannot create the metadata AST out of the metadata text: "
 			"mdec-addr=%p", mdec);
@@ -502,7 +534,7 @@ enum ctf_metadata_decoder_status ctf_metadata_decoder_decode(
 		goto end;
 	}
 
-	ret = ctf_visitor_semantic_check(0, &scanner->ast->root);
+	ret = ctf_visitor_semantic_check(0, &mdec->scanner->ast->root);
 	if (ret) {
 		BT_LOGE("Validation of the metadata semantics failed: "
 			"mdec-addr=%p", mdec);
@@ -511,7 +543,7 @@ enum ctf_metadata_decoder_status ctf_metadata_decoder_decode(
 	}
 
 	ret = ctf_visitor_generate_ir_visit_node(mdec->visitor,
-		&scanner->ast->root);
+		&mdec->scanner->ast->root);
 	switch (ret) {
 	case 0:
 		/* Success */
@@ -529,10 +561,6 @@ enum ctf_metadata_decoder_status ctf_metadata_decoder_decode(
 	}
 
 end:
-	if (scanner) {
-		ctf_scanner_free(scanner);
-	}
-
 	yydebug = 0;
 
 	if (fp && close_fp) {
@@ -556,6 +584,34 @@ bt_trace_class *ctf_metadata_decoder_get_ir_trace_class(
 	return ctf_visitor_generate_ir_get_ir_trace_class(mdec->visitor);
 }
 
+static
+uint64_t list_length(struct bt_list_head *head)
+{
+	struct bt_list_head *pos;
+	uint64_t length = 0;
+
+	bt_list_for_each(pos, head) {
+		length++;
+	}
+
+	return length;
+}
+
+BT_HIDDEN
+uint64_t ctf_metadata_decoder_get_last_chunk_node_count(
+		struct ctf_metadata_decoder *mdec)
+{
+	struct ctf_node *root = &mdec->scanner->ast->root;
+
+	return list_length(&root->u.root.declaration_list) +
+		list_length(&root->u.root.trace) +
+		list_length(&root->u.root.env) +
+		list_length(&root->u.root.stream) +
+		list_length(&root->u.root.event) +
+		list_length(&root->u.root.clock) +
+		list_length(&root->u.root.callsite);
+}
+
 BT_HIDDEN
 struct ctf_trace_class *ctf_metadata_decoder_borrow_ctf_trace_class(
 		struct ctf_metadata_decoder *mdec)
@@ -36,6 +36,14 @@ enum ctf_metadata_decoder_status {
 struct ctf_metadata_decoder_config {
 	int64_t clock_class_offset_s;
 	int64_t clock_class_offset_ns;
+
+	/*
+	 * Event field projection (weak, can be `NULL`): map value of
+	 * which the keys are event class names and the values are
+	 * arrays of field paths to keep in the translated event
+	 * classes. See ctf_trace_class_update_in_ir().
+	 */
+	const bt_value *projection;
 };
 
 /*
@@ -67,6 +75,11 @@ void ctf_metadata_decoder_destroy(
  *
  * The metadata can be packetized or not.
  *
+ * Only the new chunk is parsed: it can use the types which the chunks
+ * previously decoded by this decoder declared at the root level, so
+ * that the cost of this function does not grow with the size of the
+ * metadata decoded so far.
+ *
  * The metadata chunk needs to be complete and scannable, that is,
  * zero or more complete top-level blocks. If it's incomplete, this
  * function returns `CTF_METADATA_DECODER_STATUS_INCOMPLETE`. If this
@@ -91,6 +104,15 @@ BT_HIDDEN
 bt_trace_class *ctf_metadata_decoder_get_ir_trace_class(
 		struct ctf_metadata_decoder *mdec);
 
+/*
+ * Returns the number of top-level nodes (blocks and root declarations)
+ * of the AST which the last call to ctf_metadata_decoder_decode()
+ * parsed and visited.
+ */
+BT_HIDDEN
+uint64_t ctf_metadata_decoder_get_last_chunk_node_count(
+		struct ctf_metadata_decoder *mdec);
+
 BT_HIDDEN
 struct ctf_trace_class *ctf_metadata_decoder_borrow_ctf_trace_class(
 		struct ctf_metadata_decoder *mdec);
@@ -305,7 +305,7 @@ static void init_scope(struct ctf_scanner_scope *scope,
 {
 	scope->parent = parent;
 	scope->classes = g_hash_table_new_full(g_str_hash, g_str_equal,
-					     NULL, NULL);
+					     g_free, NULL);
 }
 
 static void finalize_scope(struct ctf_scanner_scope *scope)
@@ -367,7 +367,12 @@ static void add_type(struct ctf_scanner *scanner, char *id)
 		scanner, id);
 	if (lookup_type(scanner->cs, id))
 		return;
-	g_hash_table_insert(scanner->cs->classes, id, id);
+	/*
+	 * Copy the name: the root scope outlives the object stack of
+	 * the AST (see ctf_scanner_reset_ast()).
+	 */
+	g_hash_table_insert(scanner->cs->classes, g_strdup(id),
+		GINT_TO_POINTER(1));
 }
 
 static struct ctf_node *make_node(struct ctf_scanner *scanner,
@@ -963,11 +968,11 @@ do {								\
 	YYERROR;						\
 } while (0)
 
-static struct ctf_ast *ctf_ast_alloc(struct ctf_scanner *scanner)
+static struct ctf_ast *ctf_ast_alloc(struct objstack *objstack)
 {
 	struct ctf_ast *ast;
 
-	ast = objstack_alloc(scanner->objstack, sizeof(*ast));
+	ast = objstack_alloc(objstack, sizeof(*ast));
 	if (!ast)
 		return NULL;
 	ast->root.type = NODE_ROOT;
@@ -989,6 +994,34 @@ int ctf_scanner_append_ast(struct ctf_scanner *scanner, FILE *input)
 	return yyparse(scanner, scanner->scanner);
 }
 
+int ctf_scanner_reset_ast(struct ctf_scanner *scanner)
+{
+	struct objstack *objstack;
+	struct ctf_ast *ast;
+
+	/*
+	 * Allocate the new AST first: on failure, the scanner keeps its
+	 * current (valid) objstack and AST.
+	 */
+	objstack = objstack_create();
+	if (!objstack)
+		return -1;
+	ast = ctf_ast_alloc(objstack);
+	if (!ast) {
+		objstack_destroy(objstack);
+		return -1;
+	}
+
+	/* Scopes left open by a failed parse */
+	while (scanner->cs != &scanner->root_scope)
+		pop_scope(scanner);
+
+	objstack_destroy(scanner->objstack);
+	scanner->objstack = objstack;
+	scanner->ast = ast;
+	return 0;
+}
+
 struct ctf_scanner *ctf_scanner_alloc(void)
 {
 	struct ctf_scanner *scanner;
@@ -1006,7 +1039,7 @@ struct ctf_scanner *ctf_scanner_alloc(void)
 	scanner->objstack = objstack_create();
 	if (!scanner->objstack)
 		goto cleanup_lexer;
-	scanner->ast = ctf_ast_alloc(scanner);
+	scanner->ast = ctf_ast_alloc(scanner->objstack);
 	if (!scanner->ast)
 		goto cleanup_objstack;
 	init_scope(&scanner->root_scope, NULL);
@@ -43,6 +43,13 @@ struct ctf_scanner *ctf_scanner_alloc(void);
 void ctf_scanner_free(struct ctf_scanner *scanner);
 int ctf_scanner_append_ast(struct ctf_scanner *scanner, FILE *input);
 
+/*
+ * Frees the current AST of `scanner` and replaces it with an empty one,
+ * keeping the names of the types declared in the root scope so far so
+ * that the next appended text can use them.
+ */
+int ctf_scanner_reset_ast(struct ctf_scanner *scanner);
+
 static inline
 struct ctf_ast *ctf_scanner_get_ast(struct ctf_scanner *scanner)
 {
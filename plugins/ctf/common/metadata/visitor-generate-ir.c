@@ -3484,7 +3484,7 @@ int visit_event_decl(struct ctx *ctx, struct ctf_node *node)
 			stream_class = ctf_stream_class_create();
 			BT_ASSERT(stream_class);
 			stream_class->id = stream_id;
-			g_ptr_array_add(ctx->ctf_tc->stream_classes,
+			ctf_trace_class_append_stream_class(ctx->ctf_tc,
 				stream_class);
 			break;
 		case 1:
@@ -3948,7 +3948,7 @@ int visit_stream_decl(struct ctx *ctx, struct ctf_node *node)
 		goto error;
 	}
 
-	g_ptr_array_add(ctx->ctf_tc->stream_classes, stream_class);
+	ctf_trace_class_append_stream_class(ctx->ctf_tc, stream_class);
 	stream_class = NULL;
 	goto end;
 
@@ -5040,7 +5040,8 @@ int ctf_visitor_generate_ir_visit_node(struct ctf_visitor_generate_ir *visitor,
 		 * to create IR fields anyway, so we leave all the
 		 * `in_ir` members false.
 		 */
-		ret = ctf_trace_class_update_in_ir(ctx->ctf_tc);
+		ret = ctf_trace_class_update_in_ir(ctx->ctf_tc,
+			ctx->decoder_config.projection);
 		if (ret) {
 			ret = -EINVAL;
 			goto end;
@@ -5054,6 +5055,13 @@ int ctf_visitor_generate_ir_visit_node(struct ctf_visitor_generate_ir *visitor,
 		goto end;
 	}
 
+	/* Update static sizes of event dynamic scopes */
+	ret = ctf_trace_class_update_static_sizes(ctx->ctf_tc);
+	if (ret) {
+		ret = -EINVAL;
+		goto end;
+	}
+
 	/* Validate what we have so far */
 	ret = ctf_trace_class_validate(ctx->ctf_tc);
 	if (ret) {
@@ -32,6 +32,7 @@
 #include <stddef.h>
 #include <stdbool.h>
 #include <babeltrace/assert-internal.h>
+#include <babeltrace/align-internal.h>
 #include <string.h>
 #include <babeltrace/babeltrace.h>
 #include <babeltrace/common-internal.h>
@@ -97,6 +98,7 @@ enum state {
 	STATE_DSCOPE_EVENT_SPEC_CONTEXT_CONTINUE,
 	STATE_DSCOPE_EVENT_PAYLOAD_BEGIN,
 	STATE_DSCOPE_EVENT_PAYLOAD_CONTINUE,
+	STATE_SKIP_EVENT_DSCOPE,
 	STATE_EMIT_MSG_EVENT,
 	STATE_SKIP_PACKET_PADDING,
 	STATE_EMIT_MSG_PACKET_END_MULTI,
@@ -148,10 +150,16 @@ struct bt_msg_iter {
 	 */
 	bool done_filling_string;
 
-	/* Trace and classes */
-	/* True to set IR fields */
+	/*
+	 * True to set IR fields while decoding the current dynamic
+	 * scope.
+	 */
 	bool set_ir_fields;
 
+	/* Decoding level */
+	enum bt_msg_iter_decode_level decode_level;
+
+	/* Trace and classes */
 	struct {
 		struct ctf_trace_class *tc;
 		struct ctf_stream_class *sc;
@@ -184,6 +192,18 @@ struct bt_msg_iter {
 	/* Current state */
 	enum state state;
 
+	/*
+	 * Event dynamic scope or packet content skipping
+	 * (STATE_SKIP_EVENT_DSCOPE).
+	 */
+	struct {
+		/* Remaining bits to skip */
+		size_t bits;
+
+		/* State to switch to once all the bits are skipped */
+		enum state done_state;
+	} skip;
+
 	/* Current medium buffer data */
 	struct {
 		/* Last address provided by medium */
@@ -218,6 +238,12 @@ struct bt_msg_iter {
 	/* Current content size (bits) (-1 if unknown) */
 	int64_t cur_exp_packet_content_size;
 
+	/*
+	 * Offset, within the current packet, of the end of its context
+	 * field (bits) (-1 if unknown).
+	 */
+	int64_t cur_packet_events_offset;
+
 	/* Current stream class ID */
 	int64_t cur_stream_class_id;
 
@@ -292,6 +318,8 @@ const char *state_string(enum state state)
 		return "STATE_DSCOPE_EVENT_PAYLOAD_BEGIN";
 	case STATE_DSCOPE_EVENT_PAYLOAD_CONTINUE:
 		return "STATE_DSCOPE_EVENT_PAYLOAD_CONTINUE";
+	case STATE_SKIP_EVENT_DSCOPE:
+		return "STATE_SKIP_EVENT_DSCOPE";
 	case STATE_EMIT_MSG_EVENT:
 		return "STATE_EMIT_MSG_EVENT";
 	case STATE_SKIP_PACKET_PADDING:
@@ -557,7 +585,13 @@ enum bt_msg_iter_status read_dscope_begin_state(
 	enum bt_bfcr_status bfcr_status;
 	size_t consumed_bits;
 
+	/*
+	 * A dynamic scope field class which is part of IR always has
+	 * a corresponding dynamic scope field, unless the caller does
+	 * not want the IR fields to be set.
+	 */
 	notit->cur_dscope_field = dscope_field;
+	notit->set_ir_fields = dscope_field != NULL;
 	BT_LOGV("Starting BFCR: notit-addr=%p, bfcr-addr=%p, fc-addr=%p",
 		notit, notit->bfcr, dscope_fc);
 	consumed_bits = bt_bfcr_start(notit->bfcr, dscope_fc,
@@ -644,6 +678,95 @@ end:
 	return status;
 }
 
+/*
+ * Returns whether or not the message iterator must only find the size
+ * of the current event's dynamic scope fields, without setting any IR
+ * field: either the decoding level does not require them, or the
+ * current event is skipped.
+ */
+static inline
+bool skip_event_dscopes(struct bt_msg_iter *notit)
+{
+	return notit->decode_level == BT_MSG_ITER_DECODE_LEVEL_EVENT_HEADER ||
+		notit->meta.ec->is_skipped;
+}
+
+/*
+ * Returns the state following the decoding of the current event's
+ * payload field: emit the event message, or decode the next event
+ * header if the current event is skipped.
+ */
+static inline
+enum state event_end_state(struct bt_msg_iter *notit)
+{
+	return notit->meta.ec->is_skipped ? STATE_DSCOPE_EVENT_HEADER_BEGIN :
+		STATE_EMIT_MSG_EVENT;
+}
+
+/*
+ * Begins decoding an event dynamic scope field which the current
+ * decoding level does not require, or which belongs to a skipped
+ * event, without setting any IR field.
+ *
+ * If the dynamic scope field has a static size, the message iterator
+ * jumps over it without involving the BFCR at all. Otherwise, the
+ * BFCR still decodes it because its size, as well as any clock value,
+ * sequence length, or variant tag which it contains, is only known
+ * once it's decoded.
+ */
+static
+enum bt_msg_iter_status skip_event_dscope_begin_state(
+		struct bt_msg_iter *notit,
+		struct ctf_field_class *dscope_fc, int64_t static_size,
+		enum state done_state, enum state continue_state)
+{
+	enum bt_msg_iter_status status = BT_MSG_ITER_STATUS_OK;
+
+	if (static_size >= 0) {
+		size_t at = packet_at(notit);
+
+		notit->skip.bits = ALIGN(at, (size_t) dscope_fc->alignment) -
+			at + (size_t) static_size;
+		notit->skip.done_state = done_state;
+		notit->state = STATE_SKIP_EVENT_DSCOPE;
+		BT_LOGV("Skipping static event dynamic scope field: "
+			"notit-addr=%p, fc-addr=%p, size=%zu",
+			notit, dscope_fc, notit->skip.bits);
+		goto end;
+	}
+
+	status = read_dscope_begin_state(notit, dscope_fc, done_state,
+		continue_state, NULL);
+
+end:
+	return status;
+}
+
+static
+enum bt_msg_iter_status skip_event_dscope_state(struct bt_msg_iter *notit)
+{
+	enum bt_msg_iter_status status = BT_MSG_ITER_STATUS_OK;
+
+	while (notit->skip.bits > 0) {
+		size_t bits_to_consume;
+
+		status = buf_ensure_available_bits(notit);
+		if (status != BT_MSG_ITER_STATUS_OK) {
+			goto end;
+		}
+
+		bits_to_consume = MIN(buf_available_bits(notit),
+			notit->skip.bits);
+		buf_consume_bits(notit, bits_to_consume);
+		notit->skip.bits -= bits_to_consume;
+	}
+
+	notit->state = notit->skip.done_state;
+
+end:
+	return status;
+}
+
 static
 void release_event_dscopes(struct bt_msg_iter *notit)
 {
@@ -906,7 +1029,8 @@ enum bt_msg_iter_status read_packet_context_begin_state(
 
 	BT_ASSERT(!notit->packet_context_field);
 
-	if (packet_context_fc->in_ir) {
+	if (packet_context_fc->in_ir && notit->decode_level !=
+			BT_MSG_ITER_DECODE_LEVEL_PACKET_PROPERTIES) {
 		/*
 		 * Create free packet context field from stream class.
 		 * This field is going to be moved to the packet once we
@@ -1016,6 +1140,8 @@ enum bt_msg_iter_status after_packet_context_state(struct bt_msg_iter *notit)
 		goto end;
 	}
 
+	notit->cur_packet_events_offset = (int64_t) packet_at(notit);
+
 	if (notit->stream) {
 		/*
 		 * Stream exists, which means we already emitted at
@@ -1081,6 +1207,26 @@ enum bt_msg_iter_status read_event_header_begin_state(struct bt_msg_iter *notit)
 
 	release_event_dscopes(notit);
 	BT_ASSERT(notit->meta.sc);
+
+	/*
+	 * If all the event classes of this stream class are skipped,
+	 * jump over the whole packet content, provided that the packet
+	 * end time does not depend on the last event's time.
+	 */
+	if (notit->meta.sc->all_event_classes_skipped &&
+			notit->cur_exp_packet_content_size >= 0 &&
+			(!notit->meta.sc->default_clock_class ||
+			notit->snapshots.end_clock != UINT64_C(-1))) {
+		notit->skip.bits = notit->cur_exp_packet_content_size -
+			packet_at(notit);
+		notit->skip.done_state = STATE_DSCOPE_EVENT_HEADER_BEGIN;
+		notit->state = STATE_SKIP_EVENT_DSCOPE;
+		BT_LOGV("Skipping packet content: notit-addr=%p, "
+			"stream-class-id=%" PRId64 ", size=%zu",
+			notit, notit->meta.sc->id, notit->skip.bits);
+		goto end;
+	}
+
 	event_header_fc = notit->meta.sc->event_header_fc;
 	if (!event_header_fc) {
 		notit->state = STATE_AFTER_EVENT_HEADER;
@@ -1225,6 +1371,15 @@ enum bt_msg_iter_status after_event_header_state(
 		goto end;
 	}
 
+	if (notit->meta.ec->is_skipped) {
+		BT_LOGV("Skipping event: notit-addr=%p, "
+			"event-class-name=\"%s\", event-class-id=%" PRId64,
+			notit, notit->meta.ec->name->str, notit->meta.ec->id);
+		notit->event = NULL;
+		notit->state = STATE_DSCOPE_EVENT_COMMON_CONTEXT_BEGIN;
+		goto end;
+	}
+
 	status = set_current_event_message(notit);
 	if (status != BT_MSG_ITER_STATUS_OK) {
 		goto end;
@@ -1252,6 +1407,15 @@ enum bt_msg_iter_status read_event_common_context_begin_state(
 		goto end;
 	}
 
+	if (skip_event_dscopes(notit)) {
+		status = skip_event_dscope_begin_state(notit,
+			event_common_context_fc,
+			notit->meta.sc->event_common_context_static_size,
+			STATE_DSCOPE_EVENT_SPEC_CONTEXT_BEGIN,
+			STATE_DSCOPE_EVENT_COMMON_CONTEXT_CONTINUE);
+		goto end;
+	}
+
 	if (event_common_context_fc->in_ir) {
 		BT_ASSERT(!notit->dscopes.event_common_context);
 		notit->dscopes.event_common_context =
@@ -1305,6 +1469,15 @@ enum bt_msg_iter_status read_event_spec_context_begin_state(
 		goto end;
 	}
 
+	if (skip_event_dscopes(notit)) {
+		status = skip_event_dscope_begin_state(notit,
+			event_spec_context_fc,
+			notit->meta.ec->spec_context_static_size,
+			STATE_DSCOPE_EVENT_PAYLOAD_BEGIN,
+			STATE_DSCOPE_EVENT_SPEC_CONTEXT_CONTINUE);
+		goto end;
+	}
+
 	if (event_spec_context_fc->in_ir) {
 		BT_ASSERT(!notit->dscopes.event_spec_context);
 		notit->dscopes.event_spec_context =
@@ -1357,7 +1530,15 @@ enum bt_msg_iter_status read_event_payload_begin_state(
 
 	event_payload_fc = notit->meta.ec->payload_fc;
 	if (!event_payload_fc) {
-		notit->state = STATE_EMIT_MSG_EVENT;
+		notit->state = event_end_state(notit);
+		goto end;
+	}
+
+	if (skip_event_dscopes(notit)) {
+		status = skip_event_dscope_begin_state(notit,
+			event_payload_fc, notit->meta.ec->payload_static_size,
+			event_end_state(notit),
+			STATE_DSCOPE_EVENT_PAYLOAD_CONTINUE);
 		goto end;
 	}
 
@@ -1400,7 +1581,7 @@ static
 enum bt_msg_iter_status read_event_payload_continue_state(
 		struct bt_msg_iter *notit)
 {
-	return read_dscope_continue_state(notit, STATE_EMIT_MSG_EVENT);
+	return read_dscope_continue_state(notit, event_end_state(notit));
 }
 
 static
@@ -1632,6 +1813,9 @@ enum bt_msg_iter_status handle_state(struct bt_msg_iter *notit)
 	case STATE_DSCOPE_EVENT_PAYLOAD_CONTINUE:
 		status = read_event_payload_continue_state(notit);
 		break;
+	case STATE_SKIP_EVENT_DSCOPE:
+		status = skip_event_dscope_state(notit);
+		break;
 	case STATE_EMIT_MSG_EVENT:
 		notit->state = STATE_DSCOPE_EVENT_HEADER_BEGIN;
 		break;
@@ -1695,6 +1879,7 @@ void bt_msg_iter_reset_for_next_stream_file(struct bt_msg_iter *notit)
 	notit->state = STATE_INIT;
 	notit->cur_exp_packet_content_size = -1;
 	notit->cur_exp_packet_total_size = -1;
+	notit->cur_packet_events_offset = -1;
 	notit->cur_packet_offset = -1;
 	notit->cur_event_class_id = -1;
 	notit->snapshots.beginning_clock = UINT64_C(-1);
@@ -1771,6 +1956,7 @@ int bt_msg_iter_switch_packet(struct bt_msg_iter *notit)
 
 	notit->cur_exp_packet_content_size = -1;
 	notit->cur_exp_packet_total_size = -1;
+	notit->cur_packet_events_offset = -1;
 	notit->cur_stream_class_id = -1;
 	notit->cur_event_class_id = -1;
 	notit->cur_data_stream_id = -1;
@@ -1941,7 +2127,7 @@ update_def_clock:
 			(uint64_t) int_fc->storing_index) = value;
 	}
 
-	if (unlikely(!fc->in_ir)) {
+	if (unlikely(!fc->in_ir || !notit->set_ir_fields)) {
 		goto end;
 	}
 
@@ -1978,7 +2164,7 @@ enum bt_bfcr_status bfcr_unsigned_int_char_cb(uint64_t value,
 	BT_ASSERT(!int_fc->mapped_clock_class);
 	BT_ASSERT(int_fc->storing_index < 0);
 
-	if (unlikely(!fc->in_ir)) {
+	if (unlikely(!fc->in_ir || !notit->set_ir_fields)) {
 		goto end;
 	}
 
@@ -2030,7 +2216,7 @@ enum bt_bfcr_status bfcr_signed_int_cb(int64_t value,
 			(uint64_t) int_fc->storing_index) = (uint64_t) value;
 	}
 
-	if (unlikely(!fc->in_ir)) {
+	if (unlikely(!fc->in_ir || !notit->set_ir_fields)) {
 		goto end;
 	}
 
@@ -2061,7 +2247,7 @@ enum bt_bfcr_status bfcr_floating_point_cb(double value,
 		"fc-type=%d, fc-in-ir=%d, value=%f",
 		notit, notit->bfcr, fc, fc->type, fc->in_ir, value);
 
-	if (unlikely(!fc->in_ir)) {
+	if (unlikely(!fc->in_ir || !notit->set_ir_fields)) {
 		goto end;
 	}
 
@@ -2090,7 +2276,7 @@ enum bt_bfcr_status bfcr_string_begin_cb(
 		"fc-type=%d, fc-in-ir=%d",
 		notit, notit->bfcr, fc, fc->type, fc->in_ir);
 
-	if (unlikely(!fc->in_ir)) {
+	if (unlikely(!fc->in_ir || !notit->set_ir_fields)) {
 		goto end;
 	}
 
@@ -2128,7 +2314,7 @@ enum bt_bfcr_status bfcr_string_cb(const char *value,
 		notit, notit->bfcr, fc, fc->type, fc->in_ir,
 		len);
 
-	if (unlikely(!fc->in_ir)) {
+	if (unlikely(!fc->in_ir || !notit->set_ir_fields)) {
 		goto end;
 	}
 
@@ -2160,7 +2346,7 @@ enum bt_bfcr_status bfcr_string_end_cb(
 		"fc-type=%d, fc-in-ir=%d",
 		notit, notit->bfcr, fc, fc->type, fc->in_ir);
 
-	if (unlikely(!fc->in_ir)) {
+	if (unlikely(!fc->in_ir || !notit->set_ir_fields)) {
 		goto end;
 	}
 
@@ -2185,7 +2371,7 @@ enum bt_bfcr_status bfcr_compound_begin_cb(
 		"fc-type=%d, fc-in-ir=%d",
 		notit, notit->bfcr, fc, fc->type, fc->in_ir);
 
-	if (!fc->in_ir) {
+	if (!fc->in_ir || !notit->set_ir_fields) {
 		goto end;
 	}
 
@@ -2238,7 +2424,7 @@ enum bt_bfcr_status bfcr_compound_end_cb(
 		"fc-type=%d, fc-in-ir=%d",
 		notit, notit->bfcr, fc, fc->type, fc->in_ir);
 
-	if (!fc->in_ir) {
+	if (!fc->in_ir || !notit->set_ir_fields) {
 		goto end;
 	}
 
@@ -2286,6 +2472,11 @@ int64_t bfcr_get_sequence_length_cb(struct ctf_field_class *fc, void *data)
 
 	length = (uint64_t) g_array_index(notit->stored_values, uint64_t,
 		seq_fc->stored_length_index);
+
+	if (unlikely(!fc->in_ir || !notit->set_ir_fields)) {
+		goto end;
+	}
+
 	seq_field = stack_top(notit->stack)->base;
 	BT_ASSERT(seq_field);
 
@@ -2307,6 +2498,7 @@ int64_t bfcr_get_sequence_length_cb(struct ctf_field_class *fc, void *data)
 		}
 	}
 
+end:
 	return length;
 }
 
@@ -2315,8 +2507,7 @@ struct ctf_field_class *bfcr_borrow_variant_selected_field_class_cb(
 		struct ctf_field_class *fc, void *data)
 {
 	int ret;
-	uint64_t i;
-	int64_t option_index = -1;
+	int64_t option_index;
 	struct bt_msg_iter *notit = data;
 	struct ctf_field_class_variant *var_fc = (void *) fc;
 	struct ctf_named_field_class *selected_option = NULL;
@@ -2330,34 +2521,9 @@ struct ctf_field_class *bfcr_borrow_variant_selected_field_class_cb(
 	tag.u = g_array_index(notit->stored_values, uint64_t,
 		var_fc->stored_tag_index);
 
-	/*
-	 * Check each range to find the selected option's index.
-	 */
-	if (var_fc->tag_fc->base.is_signed) {
-		for (i = 0; i < var_fc->ranges->len; i++) {
-			struct ctf_field_class_variant_range *range =
-				ctf_field_class_variant_borrow_range_by_index(
-					var_fc, i);
-
-			if (tag.i >= range->range.lower.i &&
-					tag.i <= range->range.upper.i) {
-				option_index = (int64_t) range->option_index;
-				break;
-			}
-		}
-	} else {
-		for (i = 0; i < var_fc->ranges->len; i++) {
-			struct ctf_field_class_variant_range *range =
-				ctf_field_class_variant_borrow_range_by_index(
-					var_fc, i);
-
-			if (tag.u >= range->range.lower.u &&
-					tag.u <= range->range.upper.u) {
-				option_index = (int64_t) range->option_index;
-				break;
-			}
-		}
-	}
+	/* Find the selected option's index */
+	option_index = ctf_field_class_variant_find_option_index(var_fc,
+		tag.u);
 
 	if (option_index < 0) {
 		BT_LOGW("Cannot find variant field class's option: "
@@ -2369,7 +2535,7 @@ struct ctf_field_class *bfcr_borrow_variant_selected_field_class_cb(
 	selected_option = ctf_field_class_variant_borrow_option_by_index(
 		var_fc, (uint64_t) option_index);
 
-	if (selected_option->fc->in_ir) {
+	if (selected_option->fc->in_ir && notit->set_ir_fields) {
 		bt_field *var_field = stack_top(notit->stack)->base;
 
 		ret = bt_field_variant_select_option_field(
@@ -2782,6 +2948,8 @@ enum bt_msg_iter_status bt_msg_iter_get_next_message(
 
 	BT_ASSERT(notit);
 	BT_ASSERT(message);
+	BT_ASSERT(notit->decode_level !=
+		BT_MSG_ITER_DECODE_LEVEL_PACKET_PROPERTIES);
 	notit->msg_iter = msg_iter;
 	notit->set_stream = true;
 	BT_LOGV("Getting next message: notit-addr=%p", notit);
@@ -3018,17 +3186,27 @@ enum bt_msg_iter_status bt_msg_iter_get_packet_properties(
 		goto end;
 	}
 
+	bt_msg_iter_get_cur_packet_properties(notit, props);
+
+end:
+	return status;
+}
+
+BT_HIDDEN
+void bt_msg_iter_get_cur_packet_properties(struct bt_msg_iter *notit,
+		struct bt_msg_iter_packet_properties *props)
+{
+	BT_ASSERT(notit);
+	BT_ASSERT(props);
 	props->exp_packet_total_size = notit->cur_exp_packet_total_size;
 	props->exp_packet_content_size = notit->cur_exp_packet_content_size;
+	props->events_offset = notit->cur_packet_events_offset;
 	props->stream_class_id = (uint64_t) notit->cur_stream_class_id;
 	props->data_stream_id = notit->cur_data_stream_id;
 	props->snapshots.discarded_events = notit->snapshots.discarded_events;
 	props->snapshots.packets = notit->snapshots.packets;
 	props->snapshots.beginning_clock = notit->snapshots.beginning_clock;
 	props->snapshots.end_clock = notit->snapshots.end_clock;
-
-end:
-	return status;
 }
 
 BT_HIDDEN
@@ -3044,3 +3222,11 @@ void bt_msg_iter_set_emit_stream_end_message(struct bt_msg_iter *notit,
 {
 	notit->emit_stream_end_msg = val;
 }
+
+BT_HIDDEN
+void bt_msg_iter_set_decode_level(struct bt_msg_iter *notit,
+		enum bt_msg_iter_decode_level decode_level)
+{
+	BT_ASSERT(notit);
+	notit->decode_level = decode_level;
+}
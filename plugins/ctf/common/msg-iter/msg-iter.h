@@ -120,6 +120,42 @@ enum bt_msg_iter_seek_whence {
 	BT_MSG_ITER_SEEK_WHENCE_SET,
 };
 
+/**
+ * CTF message iterator decoding levels.
+ */
+enum bt_msg_iter_decode_level {
+	/**
+	 * Decode all the fields and set all the IR fields of the
+	 * emitted messages (default).
+	 */
+	BT_MSG_ITER_DECODE_LEVEL_ALL,
+
+	/**
+	 * Only decode what's needed to emit the same messages: the
+	 * packet header, packet context, and event header fields, as
+	 * well as the event context and payload fields which are
+	 * needed to find the size of an event, or which contain a
+	 * clock value.
+	 *
+	 * The event common context, specific context, and payload
+	 * fields of the emitted event messages are left unset. A
+	 * dynamic scope field with a static size (see
+	 * ctf_trace_class_update_static_sizes()) is not decoded at
+	 * all.
+	 */
+	BT_MSG_ITER_DECODE_LEVEL_EVENT_HEADER,
+
+	/**
+	 * Only decode the packet header and context fields, without
+	 * creating any IR field, to get packet properties.
+	 *
+	 * With this decoding level, you can only call
+	 * bt_msg_iter_get_packet_properties(), not
+	 * bt_msg_iter_get_next_message().
+	 */
+	BT_MSG_ITER_DECODE_LEVEL_PACKET_PROPERTIES,
+};
+
 /**
  * Medium operations.
  *
@@ -291,6 +327,13 @@ enum bt_msg_iter_status bt_msg_iter_get_next_message(
 struct bt_msg_iter_packet_properties {
 	int64_t exp_packet_total_size;
 	int64_t exp_packet_content_size;
+
+	/*
+	 * Offset, within the packet, of the end of the packet context
+	 * field (bits), or -1 if unknown.
+	 */
+	int64_t events_offset;
+
 	uint64_t stream_class_id;
 	int64_t data_stream_id;
 
@@ -307,6 +350,18 @@ enum bt_msg_iter_status bt_msg_iter_get_packet_properties(
 		struct bt_msg_iter *notit,
 		struct bt_msg_iter_packet_properties *props);
 
+/*
+ * Like bt_msg_iter_get_packet_properties(), but only returns the
+ * properties of the current packet as decoded so far, without
+ * decoding anything.
+ *
+ * Call this after the iterator emits the packet beginning message of a
+ * packet and before it emits its packet end message.
+ */
+BT_HIDDEN
+void bt_msg_iter_get_cur_packet_properties(struct bt_msg_iter *notit,
+		struct bt_msg_iter_packet_properties *props);
+
 BT_HIDDEN
 void bt_msg_iter_set_medops_data(struct bt_msg_iter *notit,
 		void *medops_data);
@@ -339,6 +394,15 @@ BT_HIDDEN
 void bt_msg_iter_set_emit_stream_end_message(struct bt_msg_iter *notit,
 		bool val);
 
+/*
+ * Sets the decoding level of the iterator (see
+ * `enum bt_msg_iter_decode_level`). The decoding level is not
+ * modified by bt_msg_iter_reset().
+ */
+BT_HIDDEN
+void bt_msg_iter_set_decode_level(struct bt_msg_iter *notit,
+		enum bt_msg_iter_decode_level decode_level);
+
 static inline
 const char *bt_msg_iter_medium_status_string(
 		enum bt_msg_iter_medium_status status)
@@ -0,0 +1,211 @@
+/*
+ * Copyright 2019 - EfficiOS Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#define BT_LOG_TAG "PLUGIN-CTF-UTILS-SRC-PACKET"
+#include "logging.h"
+
+#include <babeltrace/babeltrace.h>
+#include <babeltrace/assert-internal.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <glib.h>
+
+#include "src-packet.h"
+
+/*
+ * Packet registry: maps `const bt_packet *` to
+ * `struct ctf_src_packet *` (owned).
+ *
+ * Different graphs can run in different threads: protect it with
+ * `registry_lock`.
+ */
+static GHashTable *registry;
+static pthread_mutex_t registry_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static
+void destroy_src_packet(struct ctf_src_packet *src_packet)
+{
+	if (!src_packet) {
+		return;
+	}
+
+	if (src_packet->path) {
+		g_string_free(src_packet->path, TRUE);
+	}
+
+	if (src_packet->event_msgs) {
+		g_ptr_array_free(src_packet->event_msgs, TRUE);
+	}
+
+	g_free(src_packet);
+}
+
+BT_HIDDEN
+struct ctf_src_packet *ctf_src_packet_register(const bt_packet *packet,
+		const char *path)
+{
+	struct ctf_src_packet *src_packet = g_new0(struct ctf_src_packet, 1);
+
+	BT_ASSERT(packet);
+	BT_ASSERT(path);
+
+	if (!src_packet) {
+		BT_LOGE_STR("Failed to allocate one source packet reference.");
+		goto end;
+	}
+
+	src_packet->path = g_string_new(path);
+	if (!src_packet->path) {
+		BT_LOGE_STR("Failed to allocate a GString.");
+		goto error;
+	}
+
+	src_packet->event_msgs = g_ptr_array_new();
+	if (!src_packet->event_msgs) {
+		BT_LOGE_STR("Failed to allocate a GPtrArray.");
+		goto error;
+	}
+
+	pthread_mutex_lock(&registry_lock);
+
+	if (!registry) {
+		registry = g_hash_table_new_full(g_direct_hash,
+			g_direct_equal, NULL,
+			(GDestroyNotify) destroy_src_packet);
+		if (!registry) {
+			pthread_mutex_unlock(&registry_lock);
+			BT_LOGE_STR("Failed to allocate a GHashTable.");
+			goto error;
+		}
+	}
+
+	if (!g_hash_table_lookup(registry, packet)) {
+		/* Otherwise keep the existing reference */
+		bt_packet_get_ref(packet);
+	}
+
+	g_hash_table_insert(registry, (gpointer) packet, src_packet);
+
+	pthread_mutex_unlock(&registry_lock);
+	BT_LOGV("Registered source packet: packet-addr=%p, path=\"%s\"",
+		packet, path);
+	goto end;
+
+error:
+	destroy_src_packet(src_packet);
+	src_packet = NULL;
+
+end:
+	return src_packet;
+}
+
+BT_HIDDEN
+void ctf_src_packet_unregister(const bt_packet *packet)
+{
+	bool removed = false;
+
+	BT_ASSERT(packet);
+	pthread_mutex_lock(&registry_lock);
+
+	if (registry) {
+		removed = g_hash_table_remove(registry, packet);
+	}
+
+	pthread_mutex_unlock(&registry_lock);
+
+	if (removed) {
+		BT_LOGV("Unregistered source packet: packet-addr=%p", packet);
+		bt_packet_put_ref(packet);
+	}
+}
+
+BT_HIDDEN
+bool ctf_src_packet_get(const bt_packet *packet,
+		struct ctf_src_packet *src_packet)
+{
+	struct ctf_src_packet *reg_src_packet = NULL;
+	GString *path;
+
+	BT_ASSERT(packet);
+	BT_ASSERT(src_packet);
+	BT_ASSERT(src_packet->path);
+	pthread_mutex_lock(&registry_lock);
+
+	if (!registry) {
+		goto end;
+	}
+
+	reg_src_packet = g_hash_table_lookup(registry, packet);
+	if (!reg_src_packet) {
+		goto end;
+	}
+
+	path = src_packet->path;
+	*src_packet = *reg_src_packet;
+	src_packet->path = path;
+	src_packet->event_msgs = NULL;
+	g_string_assign(src_packet->path, reg_src_packet->path->str);
+
+end:
+	pthread_mutex_unlock(&registry_lock);
+	return reg_src_packet != NULL;
+}
+
+BT_HIDDEN
+bool ctf_src_packet_has_event_msgs(const bt_packet *packet,
+		const bt_message * const *msgs, uint64_t count)
+{
+	struct ctf_src_packet *reg_src_packet = NULL;
+	bool has_event_msgs = false;
+	uint64_t i;
+
+	BT_ASSERT(packet);
+	BT_ASSERT(msgs || count == 0);
+	pthread_mutex_lock(&registry_lock);
+
+	if (!registry) {
+		goto end;
+	}
+
+	reg_src_packet = g_hash_table_lookup(registry, packet);
+	if (!reg_src_packet || !reg_src_packet->is_complete ||
+			reg_src_packet->event_msgs->len != count) {
+		goto end;
+	}
+
+	for (i = 0; i < count; i++) {
+		if (reg_src_packet->event_msgs->pdata[i] != msgs[i]) {
+			BT_LOGD("Event message differs from the source packet's: "
+				"packet-addr=%p, index=%" PRIu64 ", "
+				"src-msg-addr=%p, msg-addr=%p", packet, i,
+				reg_src_packet->event_msgs->pdata[i], msgs[i]);
+			goto end;
+		}
+	}
+
+	has_event_msgs = true;
+
+end:
+	pthread_mutex_unlock(&registry_lock);
+	return has_event_msgs;
+}
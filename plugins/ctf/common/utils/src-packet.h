@@ -0,0 +1,140 @@
+#ifndef CTF_UTILS_SRC_PACKET_H
+#define CTF_UTILS_SRC_PACKET_H
+
+/*
+ * Babeltrace - CTF source packet references
+ *
+ * Copyright 2019 - EfficiOS Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * A CTF source component message iterator registers each packet
+ * object it creates for a packet which it decodes from a data stream
+ * file. The registered reference indicates where the packet's bytes
+ * are, so that a CTF sink component which receives all the messages
+ * of this packet unchanged can copy its events as is instead of
+ * serializing them again (see fs-sink-passthrough.h).
+ *
+ * A packet is only registered while its source message iterator
+ * holds a reference on it: the registry owns a reference on the packet
+ * object so that the same address cannot designate another packet.
+ *
+ * A filter component can drop, add, reorder, or replace the event
+ * messages of a registered packet, so the reference also records the
+ * event messages which the source emitted for it: the consumer only
+ * uses the reference of a packet when `is_complete` is true and it
+ * received exactly these event messages, in the same order (see
+ * ctf_src_packet_has_event_msgs()).
+ */
+
+#include <babeltrace/babeltrace.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <glib.h>
+
+/*
+ * Maximum number of event messages which a source packet reference
+ * records: the source stops updating the reference of a packet having
+ * more events, so that it never becomes complete.
+ */
+#define CTF_SRC_PACKET_MAX_EVENT_MSGS	65536
+
+struct ctf_stream_class;
+
+struct ctf_src_packet {
+	/* Path of the data stream file which contains the packet */
+	GString *path;
+
+	/* Offset of the packet within the data stream file (bytes) */
+	uint64_t offset;
+
+	/*
+	 * Offset, within the packet, of the end of the packet context
+	 * field, which is where the first event's padding starts
+	 * (bits).
+	 */
+	uint64_t events_offset;
+
+	/* Content size of the packet (bits) */
+	uint64_t content_size;
+
+	/*
+	 * Weak: class of the packet's stream. Valid as long as the
+	 * source component exists.
+	 */
+	struct ctf_stream_class *sc;
+
+	/*
+	 * Weak: event messages emitted for this packet so far, in
+	 * order. Only the registry and the registering source message
+	 * iterator access this array: ctf_src_packet_get() does not
+	 * copy it.
+	 */
+	GPtrArray *event_msgs;
+
+	/*
+	 * True if the packet end message is emitted and the source
+	 * emitted one event message for each event of the packet.
+	 */
+	bool is_complete;
+};
+
+/*
+ * Registers `packet`, which the caller decodes from the data stream
+ * file `path`, getting a reference on `packet`.
+ *
+ * Returns the registered reference, which the caller updates while it
+ * emits the messages of this packet, or `NULL` on error.
+ */
+BT_HIDDEN
+struct ctf_src_packet *ctf_src_packet_register(const bt_packet *packet,
+		const char *path);
+
+/*
+ * Unregisters `packet`, putting the registry's reference on it.
+ */
+BT_HIDDEN
+void ctf_src_packet_unregister(const bt_packet *packet);
+
+/*
+ * Copies the registered reference of `packet`, if any, to
+ * `*src_packet`, of which `path` must be an existing string.
+ *
+ * Returns `true` if `packet` is registered.
+ */
+BT_HIDDEN
+bool ctf_src_packet_get(const bt_packet *packet,
+		struct ctf_src_packet *src_packet);
+
+/*
+ * Returns whether or not `packet` is registered, its reference is
+ * complete, and the source emitted exactly the `count` event messages
+ * `msgs` for it, in this order.
+ *
+ * The caller must hold a reference on each message of `msgs`: a
+ * message which the caller holds cannot be recycled to designate
+ * another event.
+ */
+BT_HIDDEN
+bool ctf_src_packet_has_event_msgs(const bt_packet *packet,
+		const bt_message * const *msgs, uint64_t count);
+
+#endif /* CTF_UTILS_SRC_PACKET_H */
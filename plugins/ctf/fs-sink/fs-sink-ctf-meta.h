@@ -105,6 +105,8 @@ struct fs_sink_ctf_field_class_sequence {
 };
 
 struct fs_sink_ctf_stream_class;
+struct ctf_stream_class;
+struct ctf_event_class;
 
 struct fs_sink_ctf_event_class {
 	/* Weak */
@@ -118,6 +120,21 @@ struct fs_sink_ctf_event_class {
 
 	/* Owned by this */
 	struct fs_sink_ctf_field_class *payload_fc;
+
+	/*
+	 * Owned by this: serialization program of this event class
+	 * (array of `struct fs_sink_stream_ser_op`, see
+	 * fs-sink-stream.c), or `NULL` if not compiled yet.
+	 */
+	GArray *ser_ops;
+
+	/*
+	 * Weak: source event class last compared to this one for
+	 * packet passthrough (see fs-sink-passthrough.h), or `NULL`,
+	 * and whether or not their events have the same layout.
+	 */
+	struct ctf_event_class *passthrough_src_ec;
+	bool passthrough_is_compatible;
 };
 
 struct fs_sink_ctf_trace_class;
@@ -148,6 +165,15 @@ struct fs_sink_ctf_stream_class {
 	 * `struct fs_sink_ctf_event_class *` (weak)
 	 */
 	GHashTable *event_classes_from_ir;
+
+	/*
+	 * Weak: source stream class last compared to this one for
+	 * packet passthrough (see fs-sink-passthrough.h), or `NULL`,
+	 * and whether or not their event headers and common contexts
+	 * have the same layout.
+	 */
+	struct ctf_stream_class *passthrough_src_sc;
+	bool passthrough_is_compatible;
 };
 
 struct fs_sink_ctf_trace_class {
@@ -705,6 +731,12 @@ void fs_sink_ctf_event_class_destroy(struct fs_sink_ctf_event_class *ec)
 	ec->spec_context_fc = NULL;
 	fs_sink_ctf_field_class_destroy(ec->payload_fc);
 	ec->payload_fc = NULL;
+
+	if (ec->ser_ops) {
+		g_array_free(ec->ser_ops, TRUE);
+		ec->ser_ops = NULL;
+	}
+
 	g_free(ec);
 }
 
@@ -0,0 +1,341 @@
+/*
+ * Copyright 2019 - EfficiOS Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#define BT_LOG_TAG "PLUGIN-CTF-FS-SINK-PASSTHROUGH"
+#include "logging.h"
+
+#include <babeltrace/babeltrace.h>
+#include <babeltrace/assert-internal.h>
+#include <babeltrace/ctfser-internal.h>
+#include <babeltrace/endian-internal.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <errno.h>
+#include <unistd.h>
+#include <glib.h>
+
+#include "fs-sink-ctf-meta.h"
+#include "fs-sink-passthrough.h"
+#include "../common/metadata/ctf-meta.h"
+#include "../common/utils/src-packet.h"
+
+static inline
+bool bit_arrays_are_compatible(struct fs_sink_ctf_field_class_bit_array *fc,
+		struct ctf_field_class_bit_array *src_fc)
+{
+	enum ctf_byte_order native_bo = BYTE_ORDER == LITTLE_ENDIAN ?
+		CTF_BYTE_ORDER_LITTLE : CTF_BYTE_ORDER_BIG;
+
+	/* A `sink.ctf.fs` component writes in the native byte order */
+	return fc->size == src_fc->size && src_fc->byte_order == native_bo;
+}
+
+static
+bool field_classes_are_compatible(struct fs_sink_ctf_field_class *fc,
+		struct ctf_field_class *src_fc)
+{
+	bool is_compatible = false;
+	uint64_t i;
+
+	if (!fc || !src_fc) {
+		is_compatible = !fc && !src_fc;
+		goto end;
+	}
+
+	/*
+	 * A field class which is not part of the trace IR has no
+	 * translated counterpart: the source field has more bytes.
+	 */
+	if (!src_fc->in_ir || fc->alignment != src_fc->alignment) {
+		goto end;
+	}
+
+	switch (fc->type) {
+	case FS_SINK_CTF_FIELD_CLASS_TYPE_INT:
+	{
+		struct fs_sink_ctf_field_class_int *int_fc = (void *) fc;
+		struct ctf_field_class_int *src_int_fc = (void *) src_fc;
+
+		if (src_fc->type != CTF_FIELD_CLASS_TYPE_INT &&
+				src_fc->type != CTF_FIELD_CLASS_TYPE_ENUM) {
+			goto end;
+		}
+
+		is_compatible = bit_arrays_are_compatible((void *) int_fc,
+			(void *) src_int_fc) &&
+			int_fc->is_signed == src_int_fc->is_signed;
+		break;
+	}
+	case FS_SINK_CTF_FIELD_CLASS_TYPE_FLOAT:
+		is_compatible = src_fc->type == CTF_FIELD_CLASS_TYPE_FLOAT &&
+			bit_arrays_are_compatible((void *) fc, (void *) src_fc);
+		break;
+	case FS_SINK_CTF_FIELD_CLASS_TYPE_STRING:
+		is_compatible = src_fc->type == CTF_FIELD_CLASS_TYPE_STRING;
+		break;
+	case FS_SINK_CTF_FIELD_CLASS_TYPE_STRUCT:
+	{
+		struct fs_sink_ctf_field_class_struct *struct_fc = (void *) fc;
+		struct ctf_field_class_struct *src_struct_fc = (void *) src_fc;
+
+		if (src_fc->type != CTF_FIELD_CLASS_TYPE_STRUCT ||
+				struct_fc->members->len !=
+				src_struct_fc->members->len) {
+			goto end;
+		}
+
+		for (i = 0; i < struct_fc->members->len; i++) {
+			if (!field_classes_are_compatible(
+					fs_sink_ctf_field_class_struct_borrow_member_by_index(
+						struct_fc, i)->fc,
+					ctf_field_class_struct_borrow_member_by_index(
+						src_struct_fc, i)->fc)) {
+				goto end;
+			}
+		}
+
+		is_compatible = true;
+		break;
+	}
+	case FS_SINK_CTF_FIELD_CLASS_TYPE_ARRAY:
+	{
+		struct fs_sink_ctf_field_class_array *array_fc = (void *) fc;
+		struct ctf_field_class_array *src_array_fc = (void *) src_fc;
+
+		is_compatible = src_fc->type == CTF_FIELD_CLASS_TYPE_ARRAY &&
+			array_fc->length == src_array_fc->length &&
+			field_classes_are_compatible(array_fc->base.elem_fc,
+				src_array_fc->base.elem_fc);
+		break;
+	}
+	case FS_SINK_CTF_FIELD_CLASS_TYPE_SEQUENCE:
+	{
+		struct fs_sink_ctf_field_class_sequence *seq_fc = (void *) fc;
+		struct ctf_field_class_sequence *src_seq_fc = (void *) src_fc;
+
+		/* The component writes a length field before the field */
+		is_compatible = src_fc->type == CTF_FIELD_CLASS_TYPE_SEQUENCE &&
+			!seq_fc->length_is_before &&
+			field_classes_are_compatible(seq_fc->base.elem_fc,
+				src_seq_fc->base.elem_fc);
+		break;
+	}
+	case FS_SINK_CTF_FIELD_CLASS_TYPE_VARIANT:
+	{
+		struct fs_sink_ctf_field_class_variant *var_fc = (void *) fc;
+		struct ctf_field_class_variant *src_var_fc = (void *) src_fc;
+
+		/* The component writes a tag field before the field */
+		if (src_fc->type != CTF_FIELD_CLASS_TYPE_VARIANT ||
+				var_fc->tag_is_before ||
+				var_fc->options->len != src_var_fc->options->len) {
+			goto end;
+		}
+
+		for (i = 0; i < var_fc->options->len; i++) {
+			if (!field_classes_are_compatible(
+					fs_sink_ctf_field_class_variant_borrow_option_by_index(
+						var_fc, i)->fc,
+					ctf_field_class_variant_borrow_option_by_index(
+						src_var_fc, i)->fc)) {
+				goto end;
+			}
+		}
+
+		is_compatible = true;
+		break;
+	}
+	default:
+		abort();
+	}
+
+end:
+	return is_compatible;
+}
+
+/*
+ * A `sink.ctf.fs` component writes an event header field which
+ * contains a 64-bit event class ID and, if the stream class has a
+ * default clock class, a 64-bit timestamp (see
+ * translate-ctf-ir-to-tsdl.c).
+ */
+static
+bool event_header_is_compatible(struct fs_sink_ctf_stream_class *sc,
+		struct ctf_stream_class *src_sc)
+{
+	struct ctf_field_class_struct *src_fc = (void *) src_sc->event_header_fc;
+	uint64_t member_count = sc->default_clock_class ? 2 : 1;
+	bool is_compatible = false;
+	uint64_t i;
+
+	if (!src_fc || src_fc->base.type != CTF_FIELD_CLASS_TYPE_STRUCT ||
+			src_fc->base.alignment != 8 ||
+			src_fc->members->len != member_count) {
+		goto end;
+	}
+
+	for (i = 0; i < member_count; i++) {
+		struct ctf_field_class_int *int_fc = (void *)
+			ctf_field_class_struct_borrow_member_by_index(
+				src_fc, i)->fc;
+		struct fs_sink_ctf_field_class_bit_array u64_fc = {
+			.size = 64,
+		};
+
+		if (int_fc->base.base.type != CTF_FIELD_CLASS_TYPE_INT &&
+				int_fc->base.base.type != CTF_FIELD_CLASS_TYPE_ENUM) {
+			goto end;
+		}
+
+		if (int_fc->base.base.alignment != 8 || int_fc->is_signed ||
+				!bit_arrays_are_compatible(&u64_fc,
+					&int_fc->base)) {
+			goto end;
+		}
+
+		if (i == 0 && int_fc->meaning !=
+				CTF_FIELD_CLASS_MEANING_EVENT_CLASS_ID) {
+			goto end;
+		}
+
+		if (i == 1 && (int_fc->meaning != CTF_FIELD_CLASS_MEANING_NONE ||
+				!int_fc->mapped_clock_class)) {
+			goto end;
+		}
+	}
+
+	is_compatible = true;
+
+end:
+	return is_compatible;
+}
+
+BT_HIDDEN
+bool fs_sink_passthrough_stream_class_is_compatible(
+		struct fs_sink_ctf_stream_class *sc,
+		struct ctf_stream_class *src_sc)
+{
+	if (unlikely(sc->passthrough_src_sc != src_sc)) {
+		sc->passthrough_src_sc = src_sc;
+		sc->passthrough_is_compatible = src_sc &&
+			src_sc->ir_sc == sc->ir_sc &&
+			event_header_is_compatible(sc, src_sc) &&
+			field_classes_are_compatible(
+				sc->event_common_context_fc,
+				src_sc->event_common_context_fc);
+		BT_LOGD("Compared source stream class for packet passthrough: "
+			"sc-id=%" PRIu64 ", is-compatible=%d",
+			bt_stream_class_get_id(sc->ir_sc),
+			sc->passthrough_is_compatible);
+	}
+
+	return sc->passthrough_is_compatible;
+}
+
+BT_HIDDEN
+bool fs_sink_passthrough_event_class_is_compatible(
+		struct fs_sink_ctf_event_class *ec,
+		struct ctf_stream_class *src_sc)
+{
+	struct ctf_event_class *src_ec =
+		ctf_stream_class_borrow_event_class_by_id(src_sc,
+			bt_event_class_get_id(ec->ir_ec));
+
+	if (unlikely(!src_ec)) {
+		return false;
+	}
+
+	if (unlikely(ec->passthrough_src_ec != src_ec)) {
+		ec->passthrough_src_ec = src_ec;
+		ec->passthrough_is_compatible = !src_ec->is_skipped &&
+			src_ec->ir_ec == ec->ir_ec &&
+			field_classes_are_compatible(ec->spec_context_fc,
+				src_ec->spec_context_fc) &&
+			field_classes_are_compatible(ec->payload_fc,
+				src_ec->payload_fc);
+		BT_LOGD("Compared source event class for packet passthrough: "
+			"ec-id=%" PRIu64 ", is-compatible=%d",
+			bt_event_class_get_id(ec->ir_ec),
+			ec->passthrough_is_compatible);
+	}
+
+	return ec->passthrough_is_compatible;
+}
+
+BT_HIDDEN
+int fs_sink_passthrough_copy_events(struct bt_ctfser *ctfser, int fd,
+		const struct ctf_src_packet *src_packet)
+{
+	const uint64_t offset_bits =
+		bt_ctfser_get_offset_in_current_packet_bits(ctfser);
+	const uint64_t size_bits =
+		src_packet->content_size - src_packet->events_offset;
+	const uint64_t size = size_bits / 8;
+	const uint64_t file_offset =
+		src_packet->offset + src_packet->events_offset / 8;
+	uint64_t copied = 0;
+	uint8_t *addr;
+	int ret;
+
+	BT_ASSERT(offset_bits % 8 == 0);
+	BT_ASSERT(src_packet->events_offset % 8 == 0);
+	BT_ASSERT(size_bits % 8 == 0);
+	ret = bt_ctfser_reserve_in_current_packet(ctfser, size_bits);
+	if (ret) {
+		goto end;
+	}
+
+	/* Only valid once the packet has enough space */
+	addr = bt_ctfser_get_cur_packet_addr(ctfser) + offset_bits / 8;
+
+	while (copied < size) {
+		ssize_t read_len = pread(fd, addr + copied, size - copied,
+			(off_t) (file_offset + copied));
+
+		if (read_len < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+
+			BT_LOGE_ERRNO("Cannot read source packet's events",
+				": path=\"%s\", offset=%" PRIu64,
+				src_packet->path->str, file_offset + copied);
+			ret = -1;
+			goto end;
+		} else if (read_len == 0) {
+			BT_LOGE("Unexpected end of data stream file: "
+				"path=\"%s\", offset=%" PRIu64,
+				src_packet->path->str, file_offset + copied);
+			ret = -1;
+			goto end;
+		}
+
+		copied += (uint64_t) read_len;
+	}
+
+	bt_ctfser_set_offset_in_current_packet_bits(ctfser,
+		offset_bits + size_bits);
+
+end:
+	return ret;
+}
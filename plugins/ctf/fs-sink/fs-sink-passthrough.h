@@ -0,0 +1,77 @@
+#ifndef BABELTRACE_PLUGIN_CTF_FS_SINK_FS_SINK_PASSTHROUGH_H
+#define BABELTRACE_PLUGIN_CTF_FS_SINK_FS_SINK_PASSTHROUGH_H
+
+/*
+ * Copyright 2019 - EfficiOS Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * Packet passthrough: when a `sink.ctf.fs` component receives all the
+ * messages of a packet which a `src.ctf.fs` component decoded from a
+ * data stream file (see ../common/utils/src-packet.h), and the source
+ * and translated stream and event classes have the same event layout,
+ * the component copies the events of the source packet as is instead
+ * of serializing each event message.
+ *
+ * The component still writes the packet header and context fields
+ * itself.
+ */
+
+#include <babeltrace/babeltrace-internal.h>
+#include <babeltrace/ctfser-internal.h>
+#include <stdbool.h>
+
+#include "fs-sink-ctf-meta.h"
+#include "../common/utils/src-packet.h"
+
+/*
+ * Returns whether or not the event header and common context fields
+ * of the source stream class `src_sc` have the same layout as the ones
+ * which a `sink.ctf.fs` component writes for the stream class `sc`.
+ */
+BT_HIDDEN
+bool fs_sink_passthrough_stream_class_is_compatible(
+		struct fs_sink_ctf_stream_class *sc,
+		struct ctf_stream_class *src_sc);
+
+/*
+ * Returns whether or not the specific context and payload fields of
+ * the event class of `src_sc` having the same ID as `ec` have the same
+ * layout as the ones which a `sink.ctf.fs` component writes for `ec`.
+ */
+BT_HIDDEN
+bool fs_sink_passthrough_event_class_is_compatible(
+		struct fs_sink_ctf_event_class *ec,
+		struct ctf_stream_class *src_sc);
+
+/*
+ * Copies the events of the source packet `src_packet` from the opened
+ * data stream file `fd` to the current offset of the current packet of
+ * `ctfser`, and advances this offset.
+ *
+ * The current offset within the current packet of `ctfser` and the
+ * events offset of `src_packet` must be multiples of 8.
+ */
+BT_HIDDEN
+int fs_sink_passthrough_copy_events(struct bt_ctfser *ctfser, int fd,
+		const struct ctf_src_packet *src_packet);
+
+#endif /* BABELTRACE_PLUGIN_CTF_FS_SINK_FS_SINK_PASSTHROUGH_H */
@@ -26,6 +26,11 @@
 #include <babeltrace/babeltrace.h>
 #include <stdio.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <inttypes.h>
+#include <fcntl.h>
+#include <unistd.h>
 #include <glib.h>
 #include <babeltrace/assert-internal.h>
 #include <babeltrace/ctfser-internal.h>
@@ -33,6 +38,7 @@
 
 #include "fs-sink-trace.h"
 #include "fs-sink-stream.h"
+#include "fs-sink-passthrough.h"
 #include "translate-trace-ir-to-ctf-ir.h"
 
 BT_HIDDEN
@@ -50,6 +56,26 @@ void fs_sink_stream_destroy(struct fs_sink_stream *stream)
 	}
 
 	bt_packet_put_ref(stream->packet_state.packet);
+
+	if (stream->passthrough.event_msgs) {
+		g_ptr_array_free(stream->passthrough.event_msgs, TRUE);
+		stream->passthrough.event_msgs = NULL;
+	}
+
+	if (stream->passthrough.src_packet.path) {
+		g_string_free(stream->passthrough.src_packet.path, TRUE);
+		stream->passthrough.src_packet.path = NULL;
+	}
+
+	if (stream->passthrough.fd >= 0) {
+		(void) close(stream->passthrough.fd);
+	}
+
+	if (stream->passthrough.fd_path) {
+		g_string_free(stream->passthrough.fd_path, TRUE);
+		stream->passthrough.fd_path = NULL;
+	}
+
 	g_free(stream);
 
 end:
@@ -117,7 +143,7 @@ GString *make_unique_stream_file_name(struct fs_sink_trace *trace,
 
 	BT_ASSERT(name);
 
-	while (stream_file_name_exists(trace, name->str) &&
+	while (stream_file_name_exists(trace, name->str) ||
 			strcmp(name->str, "metadata") == 0) {
 		g_string_printf(name, "%s-%u", san_base->str, suffix);
 		suffix++;
@@ -155,6 +181,17 @@ struct fs_sink_stream *fs_sink_stream_create(struct fs_sink_trace *trace,
 
 	stream->trace = trace;
 	stream->ir_stream = ir_stream;
+	stream->passthrough.fd = -1;
+	stream->passthrough.event_msgs = g_ptr_array_new_with_free_func(
+		(GDestroyNotify) bt_message_put_ref);
+	stream->passthrough.src_packet.path = g_string_new(NULL);
+	stream->passthrough.fd_path = g_string_new(NULL);
+	if (!stream->passthrough.event_msgs ||
+			!stream->passthrough.src_packet.path ||
+			!stream->passthrough.fd_path) {
+		goto error;
+	}
+
 	stream->packet_state.beginning_cs = UINT64_C(-1);
 	stream->packet_state.end_cs = UINT64_C(-1);
 	stream->prev_packet_state.end_cs = UINT64_C(-1);
@@ -376,29 +413,514 @@ int write_field(struct fs_sink_stream *stream,
 	return ret;
 }
 
+/*
+ * Serialization programs
+ * ~~~~~~~~~~~~~~~~~~~~~~
+ *
+ * Writing an event field by field means aligning, checking the space
+ * left in the current packet, and dispatching on the field class's
+ * type for each field. Most of this work only depends on the event
+ * class, so the first time the stream writes an event of a given
+ * class, it compiles the event header, common context, specific
+ * context, and payload field classes to a flat array of operations
+ * (`ser_ops` member of `struct fs_sink_ctf_event_class`).
+ *
+ * A run operation covers consecutive fixed-size fields (integers and
+ * real numbers, possibly within nested structures) of which the
+ * alignment is not greater than the alignment of the run's first
+ * field: the offsets of those fields from the beginning of the run,
+ * padding included, are static. Executing a run operation aligns once
+ * and makes sure the current packet has enough space once; the
+ * following fixed-size field operations then write their field at its
+ * precomputed offset.
+ *
+ * The other fields (strings, arrays, sequences, and variants) end the
+ * current run: a field operation writes them with write_field().
+ */
+
+/* Maximum depth of the field stack while executing a program */
+#define SER_MAX_DEPTH	16
+
+enum fs_sink_stream_ser_op_type {
+	/* Beginning of a run */
+	FS_SINK_STREAM_SER_OP_TYPE_RUN,
+
+	/* Fixed-size fields (within a run) */
+	FS_SINK_STREAM_SER_OP_TYPE_EVENT_CLASS_ID,
+	FS_SINK_STREAM_SER_OP_TYPE_TIME,
+	FS_SINK_STREAM_SER_OP_TYPE_INT,
+	FS_SINK_STREAM_SER_OP_TYPE_FLOAT,
+
+	/* Push a scope's root structure field on the field stack */
+	FS_SINK_STREAM_SER_OP_TYPE_ENTER_SCOPE,
+
+	/* Push a member structure field on the field stack */
+	FS_SINK_STREAM_SER_OP_TYPE_ENTER_STRUCT,
+
+	/* Pop the field stack */
+	FS_SINK_STREAM_SER_OP_TYPE_LEAVE_STRUCT,
+
+	/* Write a member field with write_field() */
+	FS_SINK_STREAM_SER_OP_TYPE_FIELD,
+};
+
+enum fs_sink_stream_ser_scope {
+	FS_SINK_STREAM_SER_SCOPE_COMMON_CONTEXT,
+	FS_SINK_STREAM_SER_SCOPE_SPECIFIC_CONTEXT,
+	FS_SINK_STREAM_SER_SCOPE_PAYLOAD,
+};
+
+struct fs_sink_stream_ser_op {
+	enum fs_sink_stream_ser_op_type type;
+
+	/* Run: alignment (bits) */
+	unsigned int alignment;
+
+	/*
+	 * Run: size (bits), padding included.
+	 *
+	 * Fixed-size field: size of the field (bits).
+	 */
+	uint64_t size;
+
+	/* Fixed-size field: offset from the beginning of the run (bits) */
+	uint64_t offset_in_run;
+
+	/*
+	 * Integer, real number, member structure, and field: index of
+	 * the member within the structure field on top of the field
+	 * stack.
+	 *
+	 * Scope: `enum fs_sink_stream_ser_scope`.
+	 *
+	 * Event class ID: the ID.
+	 */
+	uint64_t index;
+
+	/* Integer: whether or not it's signed */
+	bool is_signed;
+
+	/* Field: weak */
+	struct fs_sink_ctf_field_class *fc;
+};
+
+struct ser_compiler {
+	/* Weak */
+	GArray *ops;
+
+	/* Whether or not `run_op_index` is the index of the current run */
+	bool in_run;
+	guint run_op_index;
+
+	/* Depth of the field stack when executing the current operation */
+	uint64_t depth;
+};
+
 static inline
-int write_event_header(struct fs_sink_stream *stream,
-		const bt_clock_snapshot *cs, struct fs_sink_ctf_event_class *ec)
+struct fs_sink_stream_ser_op *ser_compiler_append_op(
+		struct ser_compiler *compiler,
+		enum fs_sink_stream_ser_op_type type)
 {
-	int ret;
+	struct fs_sink_stream_ser_op op = {
+		.type = type,
+	};
 
-	/* Event class ID */
-	ret = bt_ctfser_write_byte_aligned_unsigned_int(&stream->ctfser,
-		bt_event_class_get_id(ec->ir_ec), 8, 64, BYTE_ORDER);
-	if (unlikely(ret)) {
+	g_array_append_val(compiler->ops, op);
+	return &g_array_index(compiler->ops, struct fs_sink_stream_ser_op,
+		compiler->ops->len - 1);
+}
+
+/*
+ * Aligns the offset of the next field of the current run to
+ * `alignment` bits, starting a new run if this offset cannot be static.
+ */
+static
+void ser_compiler_align(struct ser_compiler *compiler,
+		unsigned int alignment)
+{
+	struct fs_sink_stream_ser_op *run_op;
+
+	if (compiler->in_run) {
+		run_op = &g_array_index(compiler->ops,
+			struct fs_sink_stream_ser_op, compiler->run_op_index);
+
+		if (alignment <= run_op->alignment) {
+			run_op->size = ALIGN(run_op->size, alignment);
+			goto end;
+		}
+	}
+
+	run_op = ser_compiler_append_op(compiler,
+		FS_SINK_STREAM_SER_OP_TYPE_RUN);
+	run_op->alignment = alignment;
+	compiler->in_run = true;
+	compiler->run_op_index = compiler->ops->len - 1;
+
+end:
+	return;
+}
+
+static
+struct fs_sink_stream_ser_op *ser_compiler_append_fixed_size_field_op(
+		struct ser_compiler *compiler,
+		enum fs_sink_stream_ser_op_type type,
+		unsigned int alignment, uint64_t size, uint64_t index)
+{
+	struct fs_sink_stream_ser_op *run_op;
+	struct fs_sink_stream_ser_op *op;
+	uint64_t offset_in_run;
+
+	ser_compiler_align(compiler, alignment);
+	run_op = &g_array_index(compiler->ops, struct fs_sink_stream_ser_op,
+		compiler->run_op_index);
+	offset_in_run = run_op->size;
+	run_op->size += size;
+
+	/* Appending can move `run_op` */
+	op = ser_compiler_append_op(compiler, type);
+	op->size = size;
+	op->offset_in_run = offset_in_run;
+	op->index = index;
+	return op;
+}
+
+static
+void ser_compiler_compile_struct_members(struct ser_compiler *compiler,
+		struct fs_sink_ctf_field_class_struct *fc);
+
+static
+void ser_compiler_compile_member(struct ser_compiler *compiler,
+		struct fs_sink_ctf_field_class *fc, uint64_t index)
+{
+	struct fs_sink_stream_ser_op *op;
+
+	switch (fc->type) {
+	case FS_SINK_CTF_FIELD_CLASS_TYPE_INT:
+	{
+		struct fs_sink_ctf_field_class_int *int_fc = (void *) fc;
+
+		op = ser_compiler_append_fixed_size_field_op(compiler,
+			FS_SINK_STREAM_SER_OP_TYPE_INT, fc->alignment,
+			int_fc->base.size, index);
+		op->is_signed = int_fc->is_signed;
 		goto end;
 	}
+	case FS_SINK_CTF_FIELD_CLASS_TYPE_FLOAT:
+	{
+		struct fs_sink_ctf_field_class_float *float_fc = (void *) fc;
 
-	/* Time */
-	if (stream->sc->default_clock_class) {
-		BT_ASSERT(cs);
-		ret = bt_ctfser_write_byte_aligned_unsigned_int(&stream->ctfser,
-			bt_clock_snapshot_get_value(cs), 8, 64, BYTE_ORDER);
-		if (unlikely(ret)) {
+		ser_compiler_append_fixed_size_field_op(compiler,
+			FS_SINK_STREAM_SER_OP_TYPE_FLOAT, fc->alignment,
+			float_fc->base.size, index);
+		goto end;
+	}
+	case FS_SINK_CTF_FIELD_CLASS_TYPE_STRUCT:
+		if (compiler->depth == SER_MAX_DEPTH) {
+			/* Too deep: write it as a whole */
+			break;
+		}
+
+		ser_compiler_align(compiler, fc->alignment);
+		op = ser_compiler_append_op(compiler,
+			FS_SINK_STREAM_SER_OP_TYPE_ENTER_STRUCT);
+		op->index = index;
+		compiler->depth++;
+		ser_compiler_compile_struct_members(compiler, (void *) fc);
+		ser_compiler_append_op(compiler,
+			FS_SINK_STREAM_SER_OP_TYPE_LEAVE_STRUCT);
+		compiler->depth--;
+		goto end;
+	default:
+		break;
+	}
+
+	/* Field of which the size is not static: end the current run */
+	op = ser_compiler_append_op(compiler, FS_SINK_STREAM_SER_OP_TYPE_FIELD);
+	op->index = index;
+	op->fc = fc;
+	compiler->in_run = false;
+
+end:
+	return;
+}
+
+static
+void ser_compiler_compile_struct_members(struct ser_compiler *compiler,
+		struct fs_sink_ctf_field_class_struct *fc)
+{
+	uint64_t i;
+
+	for (i = 0; i < fc->members->len; i++) {
+		ser_compiler_compile_member(compiler,
+			fs_sink_ctf_field_class_struct_borrow_member_by_index(
+				fc, i)->fc, i);
+	}
+}
+
+static
+void ser_compiler_compile_scope(struct ser_compiler *compiler,
+		struct fs_sink_ctf_field_class *fc,
+		enum fs_sink_stream_ser_scope scope)
+{
+	struct fs_sink_stream_ser_op *op;
+
+	if (!fc) {
+		goto end;
+	}
+
+	BT_ASSERT(fc->type == FS_SINK_CTF_FIELD_CLASS_TYPE_STRUCT);
+	BT_ASSERT(compiler->depth == 0);
+	ser_compiler_align(compiler, fc->alignment);
+	op = ser_compiler_append_op(compiler,
+		FS_SINK_STREAM_SER_OP_TYPE_ENTER_SCOPE);
+	op->index = (uint64_t) scope;
+	compiler->depth++;
+	ser_compiler_compile_struct_members(compiler, (void *) fc);
+	ser_compiler_append_op(compiler,
+		FS_SINK_STREAM_SER_OP_TYPE_LEAVE_STRUCT);
+	compiler->depth--;
+
+end:
+	return;
+}
+
+/*
+ * Compiles the serialization program of the event class `ec`.
+ */
+static
+void compile_ser_ops(struct fs_sink_ctf_event_class *ec)
+{
+	struct ser_compiler compiler = {
+		.ops = g_array_new(FALSE, FALSE,
+			sizeof(struct fs_sink_stream_ser_op)),
+	};
+
+	BT_ASSERT(compiler.ops);
+
+	/* Header: see translate-ctf-ir-to-tsdl.c */
+	ser_compiler_append_fixed_size_field_op(&compiler,
+		FS_SINK_STREAM_SER_OP_TYPE_EVENT_CLASS_ID, 8, 64,
+		bt_event_class_get_id(ec->ir_ec));
+
+	if (ec->sc->default_clock_class) {
+		ser_compiler_append_fixed_size_field_op(&compiler,
+			FS_SINK_STREAM_SER_OP_TYPE_TIME, 8, 64, 0);
+	}
+
+	ser_compiler_compile_scope(&compiler, ec->sc->event_common_context_fc,
+		FS_SINK_STREAM_SER_SCOPE_COMMON_CONTEXT);
+	ser_compiler_compile_scope(&compiler, ec->spec_context_fc,
+		FS_SINK_STREAM_SER_SCOPE_SPECIFIC_CONTEXT);
+	ser_compiler_compile_scope(&compiler, ec->payload_fc,
+		FS_SINK_STREAM_SER_SCOPE_PAYLOAD);
+	BT_LOGD("Compiled event class's serialization program: "
+		"ec-id=%" PRIu64 ", op-count=%u",
+		bt_event_class_get_id(ec->ir_ec), compiler.ops->len);
+	ec->ser_ops = compiler.ops;
+}
+
+/*
+ * Writes the `size_bits`-bit unsigned integer `value` at
+ * `offset_bits` bits from `addr`, of which the space is already
+ * reserved.
+ */
+static inline
+void write_unsigned_int_at(uint8_t *addr, uint64_t offset_bits,
+		unsigned int size_bits, uint64_t value)
+{
+	if (likely(offset_bits % 8 == 0)) {
+		uint8_t *at = addr + offset_bits / 8;
+
+		switch (size_bits) {
+		case 8:
+		{
+			uint8_t v = (uint8_t) value;
+
+			memcpy(at, &v, sizeof(v));
 			goto end;
 		}
+		case 16:
+		{
+			uint16_t v = (uint16_t) value;
+
+			memcpy(at, &v, sizeof(v));
+			goto end;
+		}
+		case 32:
+		{
+			uint32_t v = (uint32_t) value;
+
+			memcpy(at, &v, sizeof(v));
+			goto end;
+		}
+		case 64:
+		{
+			uint64_t v = value;
+
+			memcpy(at, &v, sizeof(v));
+			goto end;
+		}
+		default:
+			break;
+		}
+	}
+
+	if (BYTE_ORDER == LITTLE_ENDIAN) {
+		bt_bitfield_write_le(addr, uint8_t, offset_bits, size_bits,
+			value);
+	} else {
+		bt_bitfield_write_be(addr, uint8_t, offset_bits, size_bits,
+			value);
+	}
+
+end:
+	return;
+}
+
+static inline
+uint64_t real_field_bits(const bt_field *field, uint64_t size_bits)
+{
+	double val = bt_field_real_get_value(field);
+	uint64_t bits;
+
+	if (size_bits == 32) {
+		union {
+			uint32_t u;
+			float f;
+		} u32f;
+
+		u32f.f = (float) val;
+		bits = (uint64_t) u32f.u;
+	} else {
+		union {
+			uint64_t u;
+			double f;
+		} u64f;
+
+		u64f.f = val;
+		bits = u64f.u;
+	}
+
+	return bits;
+}
+
+static
+int write_event_with_ser_ops(struct fs_sink_stream *stream,
+		const bt_clock_snapshot *cs, const bt_event *event,
+		GArray *ops)
+{
+	int ret = 0;
+	const bt_field *stack[SER_MAX_DEPTH];
+	uint64_t depth = 0;
+	uint8_t *run_addr = NULL;
+	uint64_t run_offset = 0;
+	guint i;
+
+	for (i = 0; i < ops->len; i++) {
+		struct fs_sink_stream_ser_op *op = &g_array_index(ops,
+			struct fs_sink_stream_ser_op, i);
+		const bt_field *field;
+
+		switch (op->type) {
+		case FS_SINK_STREAM_SER_OP_TYPE_RUN:
+			ret = bt_ctfser_align_offset_in_current_packet(
+				&stream->ctfser, op->alignment);
+			if (unlikely(ret)) {
+				goto end;
+			}
+
+			ret = bt_ctfser_reserve_in_current_packet(
+				&stream->ctfser, op->size);
+			if (unlikely(ret)) {
+				goto end;
+			}
+
+			/* Valid until the next field operation */
+			run_addr = bt_ctfser_get_cur_packet_addr(
+				&stream->ctfser);
+			run_offset = bt_ctfser_get_offset_in_current_packet_bits(
+				&stream->ctfser);
+			bt_ctfser_set_offset_in_current_packet_bits(
+				&stream->ctfser, run_offset + op->size);
+			break;
+		case FS_SINK_STREAM_SER_OP_TYPE_EVENT_CLASS_ID:
+			write_unsigned_int_at(run_addr,
+				run_offset + op->offset_in_run, op->size,
+				op->index);
+			break;
+		case FS_SINK_STREAM_SER_OP_TYPE_TIME:
+			BT_ASSERT(cs);
+			write_unsigned_int_at(run_addr,
+				run_offset + op->offset_in_run, op->size,
+				bt_clock_snapshot_get_value(cs));
+			break;
+		case FS_SINK_STREAM_SER_OP_TYPE_INT:
+			field = bt_field_structure_borrow_member_field_by_index_const(
+				stack[depth - 1], op->index);
+
+			/* Same low-order bits when signed */
+			write_unsigned_int_at(run_addr,
+				run_offset + op->offset_in_run, op->size,
+				op->is_signed ?
+				(uint64_t) bt_field_signed_integer_get_value(field) :
+				bt_field_unsigned_integer_get_value(field));
+			break;
+		case FS_SINK_STREAM_SER_OP_TYPE_FLOAT:
+			field = bt_field_structure_borrow_member_field_by_index_const(
+				stack[depth - 1], op->index);
+			write_unsigned_int_at(run_addr,
+				run_offset + op->offset_in_run, op->size,
+				real_field_bits(field, op->size));
+			break;
+		case FS_SINK_STREAM_SER_OP_TYPE_ENTER_SCOPE:
+			switch (op->index) {
+			case FS_SINK_STREAM_SER_SCOPE_COMMON_CONTEXT:
+				field = bt_event_borrow_common_context_field_const(
+					event);
+				break;
+			case FS_SINK_STREAM_SER_SCOPE_SPECIFIC_CONTEXT:
+				field = bt_event_borrow_specific_context_field_const(
+					event);
+				break;
+			case FS_SINK_STREAM_SER_SCOPE_PAYLOAD:
+				field = bt_event_borrow_payload_field_const(
+					event);
+				break;
+			default:
+				abort();
+			}
+
+			BT_ASSERT(field);
+			BT_ASSERT(depth == 0);
+			stack[depth] = field;
+			depth++;
+			break;
+		case FS_SINK_STREAM_SER_OP_TYPE_ENTER_STRUCT:
+			BT_ASSERT(depth < SER_MAX_DEPTH);
+			stack[depth] = bt_field_structure_borrow_member_field_by_index_const(
+				stack[depth - 1], op->index);
+			depth++;
+			break;
+		case FS_SINK_STREAM_SER_OP_TYPE_LEAVE_STRUCT:
+			BT_ASSERT(depth > 0);
+			depth--;
+			break;
+		case FS_SINK_STREAM_SER_OP_TYPE_FIELD:
+			ret = write_field(stream, op->fc,
+				bt_field_structure_borrow_member_field_by_index_const(
+					stack[depth - 1], op->index));
+			if (unlikely(ret)) {
+				goto end;
+			}
+
+			break;
+		default:
+			abort();
+		}
 	}
 
+	BT_ASSERT(depth == 0);
+
 end:
 	return ret;
 }
@@ -408,49 +930,217 @@ int fs_sink_stream_write_event(struct fs_sink_stream *stream,
 		const bt_clock_snapshot *cs, const bt_event *event,
 		struct fs_sink_ctf_event_class *ec)
 {
-	int ret;
-	const bt_field *field;
+	BT_ASSERT(ec->sc == stream->sc);
 
-	/* Header */
-	ret = write_event_header(stream, cs, ec);
-	if (unlikely(ret)) {
-		goto end;
+	if (unlikely(!ec->ser_ops)) {
+		compile_ser_ops(ec);
 	}
 
-	/* Common context */
-	if (stream->sc->event_common_context_fc) {
-		field = bt_event_borrow_common_context_field_const(event);
-		BT_ASSERT(field);
-		ret = write_struct_field(stream,
-			(void *) stream->sc->event_common_context_fc,
-			field, true);
+	return write_event_with_ser_ops(stream, cs, event, ec->ser_ops);
+}
+
+/*
+ * Maximum number of event messages which a stream holds for a packet:
+ * beyond this, it writes them and the rest of the packet's events. A
+ * source packet reference does not record more.
+ */
+#define PASSTHROUGH_MAX_EVENT_MSGS	CTF_SRC_PACKET_MAX_EVENT_MSGS
+
+/*
+ * Stops holding the event messages of the current packet, writing the
+ * held ones.
+ */
+static
+int passthrough_stop(struct fs_sink_stream *stream)
+{
+	int ret = 0;
+	guint i;
+
+	stream->passthrough.is_active = false;
+
+	for (i = 0; i < stream->passthrough.event_msgs->len; i++) {
+		const bt_message *msg =
+			stream->passthrough.event_msgs->pdata[i];
+		const bt_event *event = bt_message_event_borrow_event_const(msg);
+		struct fs_sink_ctf_event_class *ec = g_hash_table_lookup(
+			stream->sc->event_classes_from_ir,
+			bt_event_borrow_class_const(event));
+		const bt_clock_snapshot *cs = NULL;
+
+		BT_ASSERT(ec);
+
+		if (stream->sc->default_clock_class) {
+			cs = bt_message_event_borrow_default_clock_snapshot_const(
+				msg);
+		}
+
+		ret = fs_sink_stream_write_event(stream, cs, event, ec);
 		if (unlikely(ret)) {
 			goto end;
 		}
 	}
 
-	/* Specific context */
-	if (ec->spec_context_fc) {
-		field = bt_event_borrow_specific_context_field_const(event);
-		BT_ASSERT(field);
-		ret = write_struct_field(stream, (void *) ec->spec_context_fc,
-			field, true);
-		if (unlikely(ret)) {
+end:
+	g_ptr_array_set_size(stream->passthrough.event_msgs, 0);
+	return ret;
+}
+
+static
+void passthrough_try_start(struct fs_sink_stream *stream)
+{
+	struct ctf_src_packet *src_packet = &stream->passthrough.src_packet;
+
+	BT_ASSERT(!stream->passthrough.is_active);
+	BT_ASSERT(stream->passthrough.event_msgs->len == 0);
+	stream->passthrough.events_offset =
+		bt_ctfser_get_offset_in_current_packet_bits(&stream->ctfser);
+
+	if (!ctf_src_packet_get(stream->packet_state.packet, src_packet)) {
+		goto end;
+	}
+
+	/*
+	 * The fields of a `sink.ctf.fs` component are aligned to 1 or
+	 * 8 bits: the source and written events have the same padding
+	 * if both start on a byte boundary.
+	 */
+	if (src_packet->events_offset % 8 != 0 ||
+			src_packet->content_size % 8 != 0 ||
+			stream->passthrough.events_offset % 8 != 0) {
+		goto end;
+	}
+
+	if (!fs_sink_passthrough_stream_class_is_compatible(stream->sc,
+			src_packet->sc)) {
+		goto end;
+	}
+
+	stream->passthrough.is_active = true;
+
+end:
+	return;
+}
+
+static
+int passthrough_open_file(struct fs_sink_stream *stream)
+{
+	const char *path = stream->passthrough.src_packet.path->str;
+	int ret = 0;
+
+	if (stream->passthrough.fd >= 0) {
+		if (strcmp(stream->passthrough.fd_path->str, path) == 0) {
 			goto end;
 		}
+
+		(void) close(stream->passthrough.fd);
+		stream->passthrough.fd = -1;
+	}
+
+	stream->passthrough.fd = open(path, O_RDONLY);
+	if (stream->passthrough.fd < 0) {
+		BT_LOGW_ERRNO("Cannot open source data stream file",
+			": path=\"%s\"", path);
+		ret = -1;
+		goto end;
 	}
 
-	/* Specific context */
-	if (ec->payload_fc) {
-		field = bt_event_borrow_payload_field_const(event);
-		BT_ASSERT(field);
-		ret = write_struct_field(stream, (void *) ec->payload_fc,
-			field, true);
+	g_string_assign(stream->passthrough.fd_path, path);
+
+end:
+	return ret;
+}
+
+/*
+ * Copies the events of the current packet's source packet if the
+ * held event messages are exactly the ones which the source emitted
+ * for it, in the same order, or writes the held event messages
+ * otherwise.
+ */
+static
+int passthrough_finish(struct fs_sink_stream *stream)
+{
+	struct ctf_src_packet *src_packet = &stream->passthrough.src_packet;
+	GPtrArray *event_msgs = stream->passthrough.event_msgs;
+	int ret;
+
+	BT_ASSERT(stream->passthrough.is_active);
+
+	/*
+	 * A filter component between the source and this component can
+	 * drop, add, reorder, or replace event messages, keeping their
+	 * packet: the source packet's bytes are then not the events of
+	 * the held messages.
+	 */
+	if (!ctf_src_packet_get(stream->packet_state.packet, src_packet) ||
+			!ctf_src_packet_has_event_msgs(
+				stream->packet_state.packet,
+				(const bt_message * const *) event_msgs->pdata,
+				event_msgs->len)) {
+		BT_LOGD("Not copying source packet's events: "
+			"stream-file-name=%s, event-msg-count=%u",
+			stream->file_name->str, event_msgs->len);
+		goto stop;
+	}
+
+	BT_ASSERT(bt_ctfser_get_offset_in_current_packet_bits(
+		&stream->ctfser) == stream->passthrough.events_offset);
+
+	if (passthrough_open_file(stream)) {
+		goto stop;
+	}
+
+	ret = fs_sink_passthrough_copy_events(&stream->ctfser,
+		stream->passthrough.fd, src_packet);
+	if (ret) {
+		/* The offset is unchanged on failure */
+		BT_LOGW("Cannot copy source packet's events: "
+			"writing them instead: stream-file-name=%s",
+			stream->file_name->str);
+		goto stop;
+	}
+
+	stream->passthrough.is_active = false;
+	g_ptr_array_set_size(event_msgs, 0);
+	goto end;
+
+stop:
+	ret = passthrough_stop(stream);
+
+end:
+	return ret;
+}
+
+BT_HIDDEN
+int fs_sink_stream_write_event_msg(struct fs_sink_stream *stream,
+		const bt_message *msg, struct fs_sink_ctf_event_class *ec)
+{
+	const bt_clock_snapshot *cs = NULL;
+	int ret = 0;
+
+	if (stream->passthrough.is_active) {
+		if (likely(stream->passthrough.event_msgs->len <
+				PASSTHROUGH_MAX_EVENT_MSGS &&
+				fs_sink_passthrough_event_class_is_compatible(
+					ec, stream->passthrough.src_packet.sc))) {
+			bt_message_get_ref(msg);
+			g_ptr_array_add(stream->passthrough.event_msgs,
+				(gpointer) msg);
+			goto end;
+		}
+
+		ret = passthrough_stop(stream);
 		if (unlikely(ret)) {
 			goto end;
 		}
 	}
 
+	if (stream->sc->default_clock_class) {
+		cs = bt_message_event_borrow_default_clock_snapshot_const(msg);
+	}
+
+	ret = fs_sink_stream_write_event(stream, cs,
+		bt_message_event_borrow_event_const(msg), ec);
+
 end:
 	return ret;
 }
@@ -600,6 +1290,7 @@ int fs_sink_stream_open_packet(struct fs_sink_stream *stream,
 	}
 
 	stream->packet_state.is_open = true;
+	passthrough_try_start(stream);
 
 end:
 	return ret;
@@ -613,6 +1304,13 @@ int fs_sink_stream_close_packet(struct fs_sink_stream *stream,
 
 	BT_ASSERT(stream->packet_state.is_open);
 
+	if (stream->passthrough.is_active) {
+		ret = passthrough_finish(stream);
+		if (ret) {
+			goto end;
+		}
+	}
+
 	if (cs) {
 		stream->packet_state.end_cs = bt_clock_snapshot_get_value(cs);
 	}
@@ -31,6 +31,7 @@
 #include <stdint.h>
 
 #include "fs-sink-ctf-meta.h"
+#include "../common/utils/src-packet.h"
 
 struct fs_sink_trace;
 
@@ -79,6 +80,30 @@ struct fs_sink_stream {
 	} discarded_packets_state;
 
 	bool in_discarded_events_range;
+
+	/*
+	 * Packet passthrough (see fs-sink-passthrough.h): while
+	 * `is_active` is true, the stream holds the event messages of
+	 * the current packet instead of writing them, and copies the
+	 * events of the source packet as is when it closes the packet
+	 * if it got all of them.
+	 */
+	struct {
+		bool is_active;
+
+		/* Source packet of the current packet (`path` owned) */
+		struct ctf_src_packet src_packet;
+
+		/* Offset of the current packet's first event (bits) */
+		uint64_t events_offset;
+
+		/* Held event messages (owned by this) */
+		GPtrArray *event_msgs;
+
+		/* Opened data stream file `fd_path`, or -1 */
+		int fd;
+		GString *fd_path;
+	} passthrough;
 };
 
 BT_HIDDEN
@@ -93,6 +118,15 @@ int fs_sink_stream_write_event(struct fs_sink_stream *stream,
 		const bt_clock_snapshot *cs, const bt_event *event,
 		struct fs_sink_ctf_event_class *ec);
 
+/*
+ * Writes the event of the event message `msg`, of which the class is
+ * `ec`, or holds `msg` to copy the events of the current packet's
+ * source packet instead.
+ */
+BT_HIDDEN
+int fs_sink_stream_write_event_msg(struct fs_sink_stream *stream,
+		const bt_message *msg, struct fs_sink_ctf_event_class *ec);
+
 BT_HIDDEN
 int fs_sink_stream_open_packet(struct fs_sink_stream *stream,
 		const bt_clock_snapshot *cs, const bt_packet *packet);
@@ -270,7 +270,6 @@ bt_self_component_status handle_event_msg(struct fs_sink_comp *fs_sink,
 	const bt_stream *ir_stream = bt_event_borrow_stream_const(ir_event);
 	struct fs_sink_stream *stream;
 	struct fs_sink_ctf_event_class *ec = NULL;
-	const bt_clock_snapshot *cs = NULL;
 
 	stream = borrow_stream(fs_sink, ir_stream);
 	if (unlikely(!stream)) {
@@ -286,13 +285,7 @@ bt_self_component_status handle_event_msg(struct fs_sink_comp *fs_sink,
 	}
 
 	BT_ASSERT(ec);
-
-	if (stream->sc->default_clock_class) {
-		cs = bt_message_event_borrow_default_clock_snapshot_const(
-			msg);
-	}
-
-	ret = fs_sink_stream_write_event(stream, cs, ir_event, ec);
+	ret = fs_sink_stream_write_event_msg(stream, msg, ec);
 	if (unlikely(ret)) {
 		status = BT_SELF_COMPONENT_STATUS_ERROR;
 		goto end;
@@ -30,12 +30,16 @@
 #include <glib.h>
 #include <inttypes.h>
 #include <babeltrace/compat/mman-internal.h>
+#include <unistd.h>
+#include <errno.h>
 #include <babeltrace/endian-internal.h>
 #include <babeltrace/babeltrace.h>
 #include <babeltrace/common-internal.h>
 #include "file.h"
 #include "metadata.h"
 #include "../common/msg-iter/msg-iter.h"
+#include "../common/metadata/ctf-meta.h"
+#include "../common/utils/src-packet.h"
 #include <babeltrace/assert-internal.h>
 #include "data-stream-file.h"
 #include <string.h>
@@ -74,6 +78,75 @@ end:
 	return ret;
 }
 
+/*
+ * Returns the length of the next mapping of `ds_file`, which starts at
+ * its current mapping offset.
+ *
+ * If the rest of the file is too long to be mapped at once and the
+ * file has an index, the mapping ends at the end of the last packet
+ * which fits in `mmap_max_len` bytes, or at the end of the packet
+ * containing the request offset if this packet alone does not fit.
+ */
+static
+size_t mmap_window_len(struct ctf_fs_ds_file *ds_file)
+{
+	const uint64_t remaining_len = ds_file->file->size -
+		ds_file->mmap_offset;
+	const uint64_t request_pos = ds_file->mmap_offset +
+		ds_file->request_offset;
+	uint64_t max_end;
+	uint64_t end = 0;
+	GArray *entries;
+	guint low, high;
+
+	if (remaining_len <= ds_file->mmap_max_len || !ds_file->index) {
+		goto fixed_len;
+	}
+
+	max_end = ds_file->mmap_offset + ds_file->mmap_max_len;
+
+	/* Find the packet containing the request offset */
+	entries = ds_file->index->entries;
+	low = 0;
+	high = entries->len;
+
+	while (low < high) {
+		guint mid = low + (high - low) / 2;
+		struct ctf_fs_ds_index_entry *entry = &g_array_index(entries,
+			struct ctf_fs_ds_index_entry, mid);
+
+		if (entry->offset + entry->packet_size <= request_pos) {
+			low = mid + 1;
+		} else {
+			high = mid;
+		}
+	}
+
+	/* Add the following packets which fit */
+	for (; low < entries->len; low++) {
+		struct ctf_fs_ds_index_entry *entry = &g_array_index(entries,
+			struct ctf_fs_ds_index_entry, low);
+		uint64_t packet_end = entry->offset + entry->packet_size;
+
+		if (end != 0 && packet_end > max_end) {
+			break;
+		}
+
+		end = packet_end;
+	}
+
+	if (end <= request_pos || end > (uint64_t) ds_file->file->size ||
+			end - ds_file->mmap_offset > SIZE_MAX) {
+		/* Not covered by the index, or cannot be mapped at once */
+		goto fixed_len;
+	}
+
+	return end - ds_file->mmap_offset;
+
+fixed_len:
+	return MIN(remaining_len, ds_file->mmap_max_len);
+}
+
 static
 enum bt_msg_iter_medium_status ds_file_mmap_next(
 		struct ctf_fs_ds_file *ds_file)
@@ -83,21 +156,24 @@ enum bt_msg_iter_medium_status ds_file_mmap_next(
 
 	/* Unmap old region */
 	if (ds_file->mmap_addr) {
+		const off_t next_offset = ds_file->mmap_offset +
+			ds_file->mmap_len;
+
 		if (ds_file_munmap(ds_file)) {
 			goto error;
 		}
 
 		/*
-		 * mmap_len is guaranteed to be page-aligned except on the
-		 * last mapping where it may not be possible (since the file's
-		 * size itself may not be a page multiple).
+		 * A mapping which ends on a packet boundary is not
+		 * necessarily page-aligned: the next one starts at the
+		 * beginning of the page containing this boundary.
 		 */
-		ds_file->mmap_offset += ds_file->mmap_len;
-		ds_file->request_offset = 0;
+		ds_file->mmap_offset = next_offset - (next_offset %
+			bt_common_get_page_size());
+		ds_file->request_offset = next_offset - ds_file->mmap_offset;
 	}
 
-	ds_file->mmap_len = MIN(ds_file->file->size - ds_file->mmap_offset,
-			ds_file->mmap_max_len);
+	ds_file->mmap_len = mmap_window_len(ds_file);
 	if (ds_file->mmap_len == 0) {
 		ret = BT_MSG_ITER_MEDIUM_STATUS_EOF;
 		goto end;
@@ -139,7 +215,8 @@ enum bt_msg_iter_medium_status medop_request_bytes(
 	/* Check if we have at least one memory-mapped byte left */
 	if (remaining_mmap_bytes(ds_file) == 0) {
 		/* Are we at the end of the file? */
-		if (ds_file->mmap_offset >= ds_file->file->size) {
+		if (ds_file->mmap_offset + (off_t) ds_file->mmap_len >=
+				ds_file->file->size) {
 			BT_LOGD("Reached end of file \"%s\" (%p)",
 				ds_file->file->path->str, ds_file->file->fp);
 			status = BT_MSG_ITER_MEDIUM_STATUS_EOF;
@@ -256,6 +333,208 @@ struct bt_msg_iter_medium_ops ctf_fs_ds_file_medops = {
 	.seek = medop_seek,
 };
 
+/*
+ * Size of the buffer of a packet properties probe, that is, the
+ * maximum number of bytes it reads at once. This is enough for the
+ * packet header and context fields of the vast majority of traces: a
+ * larger packet context only means more reads.
+ */
+#define CTF_FS_DS_PROBE_BUF_SIZE	4096
+
+struct ctf_fs_ds_probe {
+	/* Weak */
+	struct ctf_fs_metadata *metadata;
+
+	/* Owned by this */
+	struct bt_msg_iter *msg_iter;
+
+	/* Weak: data stream file being probed */
+	struct ctf_fs_file *file;
+
+	/* Offset, within `file`, of the next bytes to read */
+	off_t offset;
+
+	uint8_t buf[CTF_FS_DS_PROBE_BUF_SIZE];
+};
+
+static
+enum bt_msg_iter_medium_status probe_medop_request_bytes(
+		size_t request_sz, uint8_t **buffer_addr,
+		size_t *buffer_sz, void *data)
+{
+	enum bt_msg_iter_medium_status status =
+		BT_MSG_ITER_MEDIUM_STATUS_OK;
+	struct ctf_fs_ds_probe *probe = data;
+	size_t len;
+	ssize_t read_len;
+
+	BT_ASSERT(probe->file);
+
+	if (request_sz == 0) {
+		goto end;
+	}
+
+	if (probe->offset >= probe->file->size) {
+		BT_LOGD("Reached end of file \"%s\" (%p)",
+			probe->file->path->str, probe->file->fp);
+		status = BT_MSG_ITER_MEDIUM_STATUS_EOF;
+		goto end;
+	}
+
+	len = MIN(request_sz, sizeof(probe->buf));
+	len = MIN(len, probe->file->size - probe->offset);
+
+	do {
+		read_len = pread(fileno(probe->file->fp), probe->buf, len,
+			probe->offset);
+	} while (read_len < 0 && errno == EINTR);
+
+	if (read_len < 0) {
+		BT_LOGE_ERRNO("Cannot read file",
+			": file-path=\"%s\", offset=%jd, size=%zu",
+			probe->file->path->str, (intmax_t) probe->offset, len);
+		status = BT_MSG_ITER_MEDIUM_STATUS_ERROR;
+		goto end;
+	}
+
+	if (read_len == 0) {
+		/* File was truncated since we opened it */
+		status = BT_MSG_ITER_MEDIUM_STATUS_EOF;
+		goto end;
+	}
+
+	*buffer_addr = probe->buf;
+	*buffer_sz = (size_t) read_len;
+	probe->offset += read_len;
+
+end:
+	return status;
+}
+
+static
+bt_stream *probe_medop_borrow_stream(bt_stream_class *stream_class,
+		int64_t stream_id, void *data)
+{
+	/* bt_msg_iter_get_packet_properties() never needs a stream */
+	return NULL;
+}
+
+static
+enum bt_msg_iter_medium_status probe_medop_seek(
+		enum bt_msg_iter_seek_whence whence, off_t offset, void *data)
+{
+	enum bt_msg_iter_medium_status ret =
+		BT_MSG_ITER_MEDIUM_STATUS_OK;
+	struct ctf_fs_ds_probe *probe = data;
+
+	BT_ASSERT(probe->file);
+
+	if (whence != BT_MSG_ITER_SEEK_WHENCE_SET ||
+			offset < 0 || offset > probe->file->size) {
+		BT_LOGE("Invalid medium seek request: whence=%d, offset=%jd, "
+			"file-size=%jd", (int) whence, offset,
+			probe->file->size);
+		ret = BT_MSG_ITER_MEDIUM_STATUS_INVAL;
+		goto end;
+	}
+
+	probe->offset = offset;
+
+end:
+	return ret;
+}
+
+static
+struct bt_msg_iter_medium_ops ctf_fs_ds_probe_medops = {
+	.request_bytes = probe_medop_request_bytes,
+	.borrow_stream = probe_medop_borrow_stream,
+	.seek = probe_medop_seek,
+};
+
+BT_HIDDEN
+struct ctf_fs_ds_probe *ctf_fs_ds_probe_create(
+		struct ctf_fs_metadata *metadata)
+{
+	struct ctf_fs_ds_probe *probe = g_new0(struct ctf_fs_ds_probe, 1);
+
+	if (!probe) {
+		BT_LOGE_STR("Failed to allocate a packet properties probe.");
+		goto error;
+	}
+
+	probe->metadata = metadata;
+	probe->msg_iter = bt_msg_iter_create(metadata->tc,
+		CTF_FS_DS_PROBE_BUF_SIZE, ctf_fs_ds_probe_medops, probe);
+	if (!probe->msg_iter) {
+		BT_LOGE_STR("Cannot create a CTF message iterator.");
+		goto error;
+	}
+
+	bt_msg_iter_set_decode_level(probe->msg_iter,
+		BT_MSG_ITER_DECODE_LEVEL_PACKET_PROPERTIES);
+	goto end;
+
+error:
+	ctf_fs_ds_probe_destroy(probe);
+	probe = NULL;
+
+end:
+	return probe;
+}
+
+BT_HIDDEN
+void ctf_fs_ds_probe_destroy(struct ctf_fs_ds_probe *probe)
+{
+	if (!probe) {
+		return;
+	}
+
+	if (probe->msg_iter) {
+		bt_msg_iter_destroy(probe->msg_iter);
+	}
+
+	g_free(probe);
+}
+
+BT_HIDDEN
+int ctf_fs_ds_probe_packet_properties(struct ctf_fs_ds_probe *probe,
+		struct ctf_fs_file *file, off_t offset,
+		struct bt_msg_iter_packet_properties *props)
+{
+	int ret = 0;
+	enum bt_msg_iter_status iter_status;
+
+	BT_ASSERT(probe);
+	BT_ASSERT(file);
+	BT_ASSERT(file->fp);
+	probe->file = file;
+
+	/* This also resets the message iterator */
+	iter_status = bt_msg_iter_seek(probe->msg_iter, offset);
+	if (iter_status != BT_MSG_ITER_STATUS_OK) {
+		goto error;
+	}
+
+	iter_status = bt_msg_iter_get_packet_properties(probe->msg_iter,
+		props);
+	if (iter_status != BT_MSG_ITER_STATUS_OK) {
+		goto error;
+	}
+
+	goto end;
+
+error:
+	BT_LOGD("Cannot read packet's header and context fields: "
+		"file-path=\"%s\", offset=%jd, status=%s",
+		file->path->str, (intmax_t) offset,
+		bt_msg_iter_status_string(iter_status));
+	ret = -1;
+
+end:
+	probe->file = NULL;
+	return ret;
+}
+
 static
 struct ctf_fs_ds_index *ctf_fs_ds_index_create(size_t length)
 {
@@ -301,7 +580,7 @@ int convert_cycles_to_ns(struct ctf_clock_class *clock_class,
 
 static
 struct ctf_fs_ds_index *build_index_from_idx_file(
-		struct ctf_fs_ds_file *ds_file)
+		struct ctf_fs_ds_probe *probe, struct ctf_fs_file *file)
 {
 	int ret;
 	gchar *directory = NULL;
@@ -322,14 +601,14 @@ struct ctf_fs_ds_index *build_index_from_idx_file(
 	struct bt_msg_iter_packet_properties props;
 
 	BT_LOGD("Building index from .idx file of stream file %s",
-			ds_file->file->path->str);
-	ret = bt_msg_iter_get_packet_properties(ds_file->msg_iter, &props);
+			file->path->str);
+	ret = ctf_fs_ds_probe_packet_properties(probe, file, 0, &props);
 	if (ret) {
 		BT_LOGD_STR("Cannot read first packet's header and context fields.");
 		goto error;
 	}
 
-	sc = ctf_trace_class_borrow_stream_class_by_id(ds_file->metadata->tc,
+	sc = ctf_trace_class_borrow_stream_class_by_id(probe->metadata->tc,
 		props.stream_class_id);
 	BT_ASSERT(sc);
 	if (!sc->default_clock_class) {
@@ -338,17 +617,17 @@ struct ctf_fs_ds_index *build_index_from_idx_file(
 	}
 
 	/* Look for index file in relative path index/name.idx. */
-	basename = g_path_get_basename(ds_file->file->path->str);
+	basename = g_path_get_basename(file->path->str);
 	if (!basename) {
 		BT_LOGE("Cannot get the basename of datastream file %s",
-				ds_file->file->path->str);
+				file->path->str);
 		goto error;
 	}
 
-	directory = g_path_get_dirname(ds_file->file->path->str);
+	directory = g_path_get_dirname(file->path->str);
 	if (!directory) {
 		BT_LOGE("Cannot get dirname of datastream file %s",
-				ds_file->file->path->str);
+				file->path->str);
 		goto error;
 	}
 
@@ -461,10 +740,10 @@ struct ctf_fs_ds_index *build_index_from_idx_file(
 	}
 
 	/* Validate that the index addresses the complete stream. */
-	if (ds_file->file->size != total_packets_size) {
+	if (file->size != total_packets_size) {
 		BT_LOGW("Invalid LTTng trace index file; indexed size != stream file size: "
 			"file-size=%" PRIu64 ", total-packets-size=%" PRIu64,
-			ds_file->file->size, total_packets_size);
+			file->size, total_packets_size);
 		goto error;
 	}
 end:
@@ -486,14 +765,14 @@ error:
 
 static
 int init_index_entry(struct ctf_fs_ds_index_entry *entry,
-		struct ctf_fs_ds_file *ds_file,
+		struct ctf_trace_class *tc,
 		struct bt_msg_iter_packet_properties *props,
 		off_t packet_size, off_t packet_offset)
 {
 	int ret = 0;
 	struct ctf_stream_class *sc;
 
-	sc = ctf_trace_class_borrow_stream_class_by_id(ds_file->metadata->tc,
+	sc = ctf_trace_class_borrow_stream_class_by_id(tc,
 		props->stream_class_id);
 	BT_ASSERT(sc);
 	BT_ASSERT(packet_offset >= 0);
@@ -532,14 +811,13 @@ end:
 
 static
 struct ctf_fs_ds_index *build_index_from_stream_file(
-		struct ctf_fs_ds_file *ds_file)
+		struct ctf_fs_ds_probe *probe, struct ctf_fs_file *file)
 {
 	int ret;
 	struct ctf_fs_ds_index *index = NULL;
-	enum bt_msg_iter_status iter_status = BT_MSG_ITER_STATUS_OK;
 	off_t current_packet_offset_bytes = 0;
 
-	BT_LOGD("Indexing stream file %s", ds_file->file->path->str);
+	BT_LOGD("Indexing stream file %s", file->path->str);
 
 	index = ctf_fs_ds_index_create(0);
 	if (!index) {
@@ -554,23 +832,17 @@ struct ctf_fs_ds_index *build_index_from_stream_file(
 		if (current_packet_offset_bytes < 0) {
 			BT_LOGE_STR("Cannot get the current packet's offset.");
 			goto error;
-		} else if (current_packet_offset_bytes > ds_file->file->size) {
+		} else if (current_packet_offset_bytes > file->size) {
 			BT_LOGE_STR("Unexpected current packet's offset (larger than file).");
 			goto error;
-		} else if (current_packet_offset_bytes == ds_file->file->size) {
+		} else if (current_packet_offset_bytes == file->size) {
 			/* No more data */
 			break;
 		}
 
-		iter_status = bt_msg_iter_seek(ds_file->msg_iter,
-				current_packet_offset_bytes);
-		if (iter_status != BT_MSG_ITER_STATUS_OK) {
-			goto error;
-		}
-
-		iter_status = bt_msg_iter_get_packet_properties(
-			ds_file->msg_iter, &props);
-		if (iter_status != BT_MSG_ITER_STATUS_OK) {
+		ret = ctf_fs_ds_probe_packet_properties(probe, file,
+			current_packet_offset_bytes, &props);
+		if (ret) {
 			goto error;
 		}
 
@@ -578,18 +850,18 @@ struct ctf_fs_ds_index *build_index_from_stream_file(
 			current_packet_size_bytes =
 				(uint64_t) props.exp_packet_total_size / 8;
 		} else {
-			current_packet_size_bytes = ds_file->file->size;
+			current_packet_size_bytes = file->size;
 		}
 
 		if (current_packet_offset_bytes + current_packet_size_bytes >
-				ds_file->file->size) {
+				file->size) {
 			BT_LOGW("Invalid packet size reported in file: stream=\"%s\", "
 					"packet-offset=%jd, packet-size-bytes=%jd, "
 					"file-size=%jd",
-					ds_file->file->path->str,
+					file->path->str,
 					current_packet_offset_bytes,
 					current_packet_size_bytes,
-					ds_file->file->size);
+					file->size);
 			goto error;
 		}
 
@@ -604,16 +876,12 @@ struct ctf_fs_ds_index *build_index_from_stream_file(
 			goto error;
 		}
 
-		ret = init_index_entry(entry, ds_file, &props,
+		ret = init_index_entry(entry, probe->metadata->tc, &props,
 			current_packet_size_bytes, current_packet_offset_bytes);
 		if (ret) {
 			goto error;
 		}
-	} while (iter_status == BT_MSG_ITER_STATUS_OK);
-
-	if (iter_status != BT_MSG_ITER_STATUS_OK) {
-		goto error;
-	}
+	} while (true);
 
 end:
 	return index;
@@ -624,6 +892,73 @@ error:
 	goto end;
 }
 
+static
+bool trace_class_has_skipped_event_classes(struct ctf_trace_class *tc)
+{
+	bool has_skipped = false;
+	uint64_t i, j;
+
+	for (i = 0; i < tc->stream_classes->len; i++) {
+		struct ctf_stream_class *sc = tc->stream_classes->pdata[i];
+
+		for (j = 0; j < sc->event_classes->len; j++) {
+			struct ctf_event_class *ec = sc->event_classes->pdata[j];
+
+			if (ec->is_skipped) {
+				has_skipped = true;
+				goto end;
+			}
+		}
+	}
+
+end:
+	return has_skipped;
+}
+
+/*
+ * Returns the maximum length of a data stream file mapping.
+ *
+ * The `BABELTRACE_SRC_CTF_FS_MMAP_MAX_LEN` environment variable, meant
+ * for the tests, overrides it (rounded down to a multiple of the page
+ * size, but at least one page), so that the windowed mappings which
+ * only 32-bit systems need can be exercised on any system.
+ */
+static
+size_t get_mmap_max_len(size_t page_size)
+{
+	const char *var = getenv("BABELTRACE_SRC_CTF_FS_MMAP_MAX_LEN");
+	size_t max_len;
+
+	if (var) {
+		char *endptr;
+		const guint64 val = g_ascii_strtoull(var, &endptr, 10);
+
+		if (*var != '\0' && *endptr == '\0' && val <= SIZE_MAX) {
+			max_len = MAX((size_t) val - ((size_t) val % page_size),
+				page_size);
+			BT_LOGD("Using overridden maximum mapping length: "
+				"len=%zu", max_len);
+			goto end;
+		}
+
+		BT_LOGW("Ignoring invalid `BABELTRACE_SRC_CTF_FS_MMAP_MAX_LEN` "
+			"environment variable: value=\"%s\"", var);
+	}
+
+	if (sizeof(size_t) >= sizeof(uint64_t)) {
+		/*
+		 * Enough address space to map the whole file at once:
+		 * no packet straddles two mappings.
+		 */
+		max_len = SIZE_MAX - (SIZE_MAX % page_size);
+	} else {
+		max_len = page_size * 2048;
+	}
+
+end:
+	return max_len;
+}
+
 BT_HIDDEN
 struct ctf_fs_ds_file *ctf_fs_ds_file_create(
 		struct ctf_fs_trace *ctf_fs_trace,
@@ -660,8 +995,10 @@ struct ctf_fs_ds_file *ctf_fs_ds_file_create(
 		goto error;
 	}
 
-	ds_file->mmap_max_len = page_size * 2048;
+	ds_file->has_skipped_event_classes = trace_class_has_skipped_event_classes(
+		ds_file->metadata->tc);
 
+	ds_file->mmap_max_len = get_mmap_max_len(page_size);
 	goto end;
 
 error:
@@ -675,18 +1012,18 @@ end:
 
 BT_HIDDEN
 struct ctf_fs_ds_index *ctf_fs_ds_file_build_index(
-		struct ctf_fs_ds_file *ds_file)
+		struct ctf_fs_ds_probe *probe, struct ctf_fs_file *file)
 {
 	struct ctf_fs_ds_index *index;
 
-	index = build_index_from_idx_file(ds_file);
+	index = build_index_from_idx_file(probe, file);
 	if (index) {
 		goto end;
 	}
 
 	BT_LOGD("Failed to build index from .index file; "
 		"falling back to stream indexing.");
-	index = build_index_from_stream_file(ds_file);
+	index = build_index_from_stream_file(probe, file);
 end:
 	return index;
 }
@@ -708,6 +1045,116 @@ void ctf_fs_ds_file_destroy(struct ctf_fs_ds_file *ds_file)
 	g_free(ds_file);
 }
 
+/*
+ * Maximum number of source packets which a message iterator keeps
+ * registered: the downstream component needs the reference of a
+ * packet until it gets its packet end message, which can be a few
+ * packets later when a muxer or a batch of messages is in between.
+ */
+#define MAX_SRC_PACKETS	4
+
+BT_HIDDEN
+void ctf_fs_ds_unregister_src_packets(GQueue *src_packets,
+		guint keep_count)
+{
+	while (g_queue_get_length(src_packets) > keep_count) {
+		ctf_src_packet_unregister(g_queue_pop_head(src_packets));
+	}
+}
+
+/*
+ * Registers the packet of the packet beginning message `msg` as a
+ * source packet if its events can be copied as is from the current
+ * data stream file.
+ */
+static
+void register_src_packet(struct ctf_fs_ds_file *ds_file,
+		const bt_message *msg)
+{
+	const bt_packet *packet =
+		bt_message_packet_beginning_borrow_packet_const(msg);
+	struct ctf_fs_ds_index_entry *index_entry;
+	struct bt_msg_iter_packet_properties props;
+	struct ctf_src_packet *src_packet;
+
+	if (!ds_file->src_packets || !ds_file->index ||
+			ds_file->has_skipped_event_classes ||
+			ds_file->packet_index >= ds_file->index->entries->len) {
+		goto end;
+	}
+
+	index_entry = &g_array_index(ds_file->index->entries,
+		struct ctf_fs_ds_index_entry, ds_file->packet_index);
+	bt_msg_iter_get_cur_packet_properties(ds_file->msg_iter, &props);
+
+	/* Make sure the index entry is this packet's */
+	if (props.exp_packet_total_size !=
+			(int64_t) (index_entry->packet_size * 8) ||
+			props.exp_packet_content_size < 0 ||
+			props.events_offset < 0 ||
+			props.events_offset > props.exp_packet_content_size) {
+		goto end;
+	}
+
+	src_packet = ctf_src_packet_register(packet,
+		ds_file->file->path->str);
+	if (!src_packet) {
+		goto end;
+	}
+
+	src_packet->offset = index_entry->offset;
+	src_packet->events_offset = (uint64_t) props.events_offset;
+	src_packet->content_size = (uint64_t) props.exp_packet_content_size;
+	src_packet->sc = ctf_trace_class_borrow_stream_class_by_id(
+		ds_file->metadata->tc, props.stream_class_id);
+	g_queue_push_tail(ds_file->src_packets, (gpointer) packet);
+	ctf_fs_ds_unregister_src_packets(ds_file->src_packets,
+		MAX_SRC_PACKETS);
+	ds_file->cur_src_packet = src_packet;
+
+end:
+	return;
+}
+
+static
+void update_src_packet(struct ctf_fs_ds_file *ds_file,
+		const bt_message *msg)
+{
+	switch (bt_message_get_type(msg)) {
+	case BT_MESSAGE_TYPE_PACKET_BEGINNING:
+		ds_file->cur_src_packet = NULL;
+		register_src_packet(ds_file, msg);
+		ds_file->packet_index++;
+		break;
+	case BT_MESSAGE_TYPE_EVENT:
+		if (!ds_file->cur_src_packet) {
+			break;
+		}
+
+		if (ds_file->cur_src_packet->event_msgs->len ==
+				CTF_SRC_PACKET_MAX_EVENT_MSGS) {
+			/* Never complete: not worth recording */
+			g_ptr_array_set_size(
+				ds_file->cur_src_packet->event_msgs, 0);
+			ds_file->cur_src_packet = NULL;
+			break;
+		}
+
+		g_ptr_array_add(ds_file->cur_src_packet->event_msgs,
+			(gpointer) msg);
+		break;
+	case BT_MESSAGE_TYPE_PACKET_END:
+		if (ds_file->cur_src_packet) {
+			ds_file->cur_src_packet->is_complete = true;
+			ds_file->cur_src_packet = NULL;
+		}
+
+		break;
+	default:
+		break;
+	}
+}
+
 BT_HIDDEN
 bt_self_message_iterator_status ctf_fs_ds_file_next(
 		struct ctf_fs_ds_file *ds_file,
@@ -725,6 +1172,7 @@ bt_self_message_iterator_status ctf_fs_ds_file_next(
 		break;
 	case BT_MSG_ITER_STATUS_OK:
 		status = BT_SELF_MESSAGE_ITERATOR_STATUS_OK;
+		update_src_packet(ds_file, *msg);
 		break;
 	case BT_MSG_ITER_STATUS_AGAIN:
 		/*
@@ -36,6 +36,7 @@ struct ctf_fs_component;
 struct ctf_fs_file;
 struct ctf_fs_trace;
 struct ctf_fs_ds_file;
+struct ctf_fs_ds_probe;
 
 struct ctf_fs_ds_index_entry {
 	/* Position, in bytes, of the packet from the beginning of the file. */
@@ -104,9 +105,18 @@ struct ctf_fs_ds_file {
 
 	void *mmap_addr;
 
+	/*
+	 * Weak, can be `NULL`: packet index of this file.
+	 *
+	 * When it is set, each mapping ends on a packet boundary, so
+	 * that no packet straddles two mappings.
+	 */
+	struct ctf_fs_ds_index *index;
+
 	/*
 	 * Max length of chunk to mmap() when updating the current mapping.
-	 * This value must be page-aligned.
+	 * This value must be page-aligned. A mapping can be longer to
+	 * contain a whole packet which is longer than this.
 	 */
 	size_t mmap_max_len;
 
@@ -123,6 +133,29 @@ struct ctf_fs_ds_file {
 	off_t request_offset;
 
 	bool end_reached;
+
+	/*
+	 * Weak, can be `NULL`: queue of the packets (`const bt_packet *`)
+	 * which this file registers as source packets (see
+	 * ../common/utils/src-packet.h), oldest first.
+	 *
+	 * The queue belongs to the message iterator so that the packets
+	 * of this file remain registered after it's destroyed, until
+	 * the downstream component gets their packet end messages.
+	 */
+	GQueue *src_packets;
+
+	/* Weak: registered reference of the current packet, or `NULL` */
+	struct ctf_src_packet *cur_src_packet;
+
+	/* Number of packet beginning messages returned so far */
+	uint64_t packet_index;
+
+	/*
+	 * True if the message iterator skips the events of some event
+	 * classes: the events of a packet then cannot be copied as is.
+	 */
+	bool has_skipped_event_classes;
 };
 
 BT_HIDDEN
@@ -140,9 +173,45 @@ bt_self_message_iterator_status ctf_fs_ds_file_next(
 		struct ctf_fs_ds_file *ds_file,
 		bt_message **msg);
 
+/*
+ * Unregisters the oldest source packets of `src_packets` (see
+ * `struct ctf_fs_ds_file`) until it contains `keep_count` packets
+ * or fewer.
+ */
+BT_HIDDEN
+void ctf_fs_ds_unregister_src_packets(GQueue *src_packets,
+		guint keep_count);
+
+/*
+ * Creates a packet properties probe for the data stream files of a
+ * trace described by `metadata`.
+ *
+ * A probe reads the packet header and context fields of a given packet
+ * of a data stream file with a single, small read, without creating
+ * any trace IR object, and reuses the same decoder for all the files
+ * of a trace. Use it instead of a CTF message iterator when you only
+ * need the properties of packets (discovering and indexing the data
+ * stream files).
+ */
+BT_HIDDEN
+struct ctf_fs_ds_probe *ctf_fs_ds_probe_create(
+		struct ctf_fs_metadata *metadata);
+
+BT_HIDDEN
+void ctf_fs_ds_probe_destroy(struct ctf_fs_ds_probe *probe);
+
+/*
+ * Reads the properties of the packet located at `offset` bytes within
+ * the opened data stream file `file`.
+ */
+BT_HIDDEN
+int ctf_fs_ds_probe_packet_properties(struct ctf_fs_ds_probe *probe,
+		struct ctf_fs_file *file, off_t offset,
+		struct bt_msg_iter_packet_properties *props);
+
 BT_HIDDEN
 struct ctf_fs_ds_index *ctf_fs_ds_file_build_index(
-		struct ctf_fs_ds_file *ds_file);
+		struct ctf_fs_ds_probe *probe, struct ctf_fs_file *file);
 
 BT_HIDDEN
 void ctf_fs_ds_index_destroy(struct ctf_fs_ds_index *index);
@@ -66,8 +66,13 @@ int msg_iter_data_set_current_ds_file(struct ctf_fs_msg_iter_data *msg_iter_data
 		ds_file_info->path->str);
 	if (!msg_iter_data->ds_file) {
 		ret = -1;
+		goto end;
 	}
 
+	msg_iter_data->ds_file->index = ds_file_info->index;
+	msg_iter_data->ds_file->src_packets = msg_iter_data->src_packets;
+
+end:
 	return ret;
 }
 
@@ -81,6 +86,11 @@ void ctf_fs_msg_iter_data_destroy(
 
 	ctf_fs_ds_file_destroy(msg_iter_data->ds_file);
 
+	if (msg_iter_data->src_packets) {
+		ctf_fs_ds_unregister_src_packets(msg_iter_data->src_packets, 0);
+		g_queue_free(msg_iter_data->src_packets);
+	}
+
 	if (msg_iter_data->msg_iter) {
 		bt_msg_iter_destroy(msg_iter_data->msg_iter);
 	}
@@ -259,16 +269,36 @@ bt_self_message_iterator_status ctf_fs_iterator_init(
 	}
 
 	msg_iter_data->pc_msg_iter = self_msg_iter;
+	/*
+	 * No maximum buffer size: the medium returns the rest of its
+	 * current mapping, which ends on a packet boundary, so that the
+	 * decoder gets whole packets in a single buffer.
+	 */
 	msg_iter_data->msg_iter = bt_msg_iter_create(
 		port_data->ds_file_group->ctf_fs_trace->metadata->tc,
-		bt_common_get_page_size() * 8,
-		ctf_fs_ds_file_medops, NULL);
+		SIZE_MAX, ctf_fs_ds_file_medops, NULL);
 	if (!msg_iter_data->msg_iter) {
 		BT_LOGE_STR("Cannot create a CTF message iterator.");
 		ret = BT_SELF_MESSAGE_ITERATOR_STATUS_NOMEM;
 		goto error;
 	}
 
+	if (port_data->ctf_fs->skip_event_fields) {
+		bt_msg_iter_set_decode_level(msg_iter_data->msg_iter,
+			BT_MSG_ITER_DECODE_LEVEL_EVENT_HEADER);
+	} else {
+		/*
+		 * The events of a packet are only the same as its bytes
+		 * when their fields are decoded.
+		 */
+		msg_iter_data->src_packets = g_queue_new();
+		if (!msg_iter_data->src_packets) {
+			BT_LOGE_STR("Failed to allocate a GQueue.");
+			ret = BT_SELF_MESSAGE_ITERATOR_STATUS_NOMEM;
+			goto error;
+		}
+	}
+
 	msg_iter_data->ds_file_group = port_data->ds_file_group;
 	if (ctf_fs_iterator_reset(msg_iter_data)) {
 		ret = BT_SELF_MESSAGE_ITERATOR_STATUS_ERROR;
@@ -307,6 +337,11 @@ void ctf_fs_destroy(struct ctf_fs_component *ctf_fs)
 		g_ptr_array_free(ctf_fs->port_data, TRUE);
 	}
 
+	BT_VALUE_PUT_REF_AND_RESET(ctf_fs->metadata_config.projection);
+	BT_VALUE_PUT_REF_AND_RESET(
+		ctf_fs->metadata_config.allowed_event_class_names);
+	BT_VALUE_PUT_REF_AND_RESET(
+		ctf_fs->metadata_config.denied_event_class_names);
 	g_free(ctf_fs);
 }
 
@@ -332,6 +367,10 @@ void ctf_fs_trace_destroy(struct ctf_fs_trace *ctf_fs_trace)
 		return;
 	}
 
+	if (ctf_fs_trace->ds_file_groups_by_id) {
+		g_hash_table_destroy(ctf_fs_trace->ds_file_groups_by_id);
+	}
+
 	if (ctf_fs_trace->ds_file_groups) {
 		g_ptr_array_free(ctf_fs_trace->ds_file_groups, TRUE);
 	}
@@ -584,49 +623,108 @@ end:
 	return ds_file_group;
 }
 
-/* Replace by g_ptr_array_insert when we depend on glib >= 2.40. */
+/*
+ * GHashFunc and GEqualFunc of a data stream file group, based on its
+ * stream class ID and stream instance ID.
+ */
+
 static
-void array_insert(GPtrArray *array, gpointer element, size_t pos)
+guint ds_file_group_hash(gconstpointer v)
 {
-	size_t original_array_len = array->len;
+	const struct ctf_fs_ds_file_group *ds_file_group = v;
+	uint64_t hash = ds_file_group->sc->id * UINT64_C(0x9e3779b97f4a7c15) ^
+		ds_file_group->stream_id;
+
+	return (guint) (hash ^ (hash >> 32));
+}
+
+static
+gboolean ds_file_group_equal(gconstpointer a, gconstpointer b)
+{
+	const struct ctf_fs_ds_file_group *ds_file_group_a = a;
+	const struct ctf_fs_ds_file_group *ds_file_group_b = b;
+
+	return ds_file_group_a->sc->id == ds_file_group_b->sc->id &&
+		ds_file_group_a->stream_id == ds_file_group_b->stream_id;
+}
+
+/*
+ * Adds `ds_file_group` to the data stream file groups of
+ * `ctf_fs_trace`, indexing it by ID if it has a stream instance ID.
+ */
+
+static
+void ctf_fs_trace_add_ds_file_group(struct ctf_fs_trace *ctf_fs_trace,
+		struct ctf_fs_ds_file_group *ds_file_group)
+{
+	g_ptr_array_add(ctf_fs_trace->ds_file_groups, ds_file_group);
+
+	if (ds_file_group->stream_id != UINT64_C(-1)) {
+		g_hash_table_insert(ctf_fs_trace->ds_file_groups_by_id,
+			ds_file_group, ds_file_group);
+	}
+}
+
+/*
+ * Finds the data stream file group of `ctf_fs_trace` having the stream
+ * class ID of `sc` and the stream instance ID `stream_id`.
+ */
+
+static
+struct ctf_fs_ds_file_group *ctf_fs_trace_borrow_ds_file_group_by_id(
+		struct ctf_fs_trace *ctf_fs_trace, struct ctf_stream_class *sc,
+		uint64_t stream_id)
+{
+	struct ctf_fs_ds_file_group key = {
+		.sc = sc,
+		.stream_id = stream_id,
+	};
+
+	BT_ASSERT(stream_id != UINT64_C(-1));
+	return g_hash_table_lookup(ctf_fs_trace->ds_file_groups_by_id, &key);
+}
+
+/* GCompareFunc to sort data stream file infos by beginning time. */
 
-	/* Allocate an unused element at the end of the array. */
-	g_ptr_array_add(array, NULL);
+static
+gint compare_ds_file_infos_by_begin_ns(gconstpointer a, gconstpointer b)
+{
+	const struct ctf_fs_ds_file_info *ds_file_info_a =
+		*((const struct ctf_fs_ds_file_info **) a);
+	const struct ctf_fs_ds_file_info *ds_file_info_b =
+		*((const struct ctf_fs_ds_file_info **) b);
+	gint ret = 0;
 
-	/* If we are not inserting at the end, move the elements by one. */
-	if (pos < original_array_len) {
-		memmove(&(array->pdata[pos + 1]),
-			&(array->pdata[pos]),
-			(original_array_len - pos) * sizeof(gpointer));
+	if (ds_file_info_a->begin_ns < ds_file_info_b->begin_ns) {
+		ret = -1;
+	} else if (ds_file_info_a->begin_ns > ds_file_info_b->begin_ns) {
+		ret = 1;
 	}
 
-	/* Insert the value. */
-	array->pdata[pos] = element;
+	return ret;
 }
 
 /*
- * Insert ds_file_info in ds_file_group's list of ds_file_infos at the right
- * place to keep it sorted.
+ * Sorts the data stream file infos of each data stream file group of
+ * `ctf_fs_trace` by beginning time.
+ *
+ * Data stream file infos are appended to their group as they are
+ * found: sorting each group once at the end is O(n log n) instead of
+ * O(n^2) for sorted insertions.
  */
 
 static
-void ds_file_group_insert_ds_file_info_sorted(
-		struct ctf_fs_ds_file_group *ds_file_group,
-		struct ctf_fs_ds_file_info *ds_file_info)
+void ctf_fs_trace_sort_ds_file_groups(struct ctf_fs_trace *ctf_fs_trace)
 {
 	guint i;
 
-	/* Find the spot where to insert this ds_file_info. */
-	for (i = 0; i < ds_file_group->ds_file_infos->len; i++) {
-		struct ctf_fs_ds_file_info *other_ds_file_info =
-			g_ptr_array_index(ds_file_group->ds_file_infos, i);
+	for (i = 0; i < ctf_fs_trace->ds_file_groups->len; i++) {
+		struct ctf_fs_ds_file_group *ds_file_group =
+			g_ptr_array_index(ctf_fs_trace->ds_file_groups, i);
 
-		if (ds_file_info->begin_ns < other_ds_file_info->begin_ns) {
-			break;
-		}
+		g_ptr_array_sort(ds_file_group->ds_file_infos,
+			compare_ds_file_infos_by_begin_ns);
 	}
-
-	array_insert(ds_file_group->ds_file_infos, ds_file_info, i);
 }
 
 /*
@@ -650,8 +748,7 @@ int ctf_fs_ds_file_group_add_ds_file_info(
 		goto error;
 	}
 
-	ds_file_group_insert_ds_file_info_sorted(ds_file_group, ds_file_info);
-
+	g_ptr_array_add(ds_file_group->ds_file_infos, ds_file_info);
 	ds_file_info = NULL;
 	goto end;
 
@@ -665,41 +762,26 @@ end:
 
 static
 int add_ds_file_to_ds_file_group(struct ctf_fs_trace *ctf_fs_trace,
-		const char *path)
+		struct ctf_fs_ds_probe *probe, struct ctf_fs_file *file)
 {
 	int64_t stream_instance_id = -1;
 	int64_t begin_ns = -1;
 	struct ctf_fs_ds_file_group *ds_file_group = NULL;
 	bool add_group = false;
 	int ret;
-	size_t i;
-	struct ctf_fs_ds_file *ds_file = NULL;
+	const char *path = file->path->str;
 	struct ctf_fs_ds_index *index = NULL;
-	struct bt_msg_iter *msg_iter = NULL;
 	struct ctf_stream_class *sc = NULL;
 	struct bt_msg_iter_packet_properties props;
 
-	msg_iter = bt_msg_iter_create(ctf_fs_trace->metadata->tc,
-		bt_common_get_page_size() * 8, ctf_fs_ds_file_medops, NULL);
-	if (!msg_iter) {
-		BT_LOGE_STR("Cannot create a CTF message iterator.");
-		goto error;
-	}
-
-	ds_file = ctf_fs_ds_file_create(ctf_fs_trace, NULL, msg_iter,
-		NULL, path);
-	if (!ds_file) {
-		goto error;
-	}
-
-	ret = bt_msg_iter_get_packet_properties(ds_file->msg_iter, &props);
+	ret = ctf_fs_ds_probe_packet_properties(probe, file, 0, &props);
 	if (ret) {
 		BT_LOGE("Cannot get stream file's first packet's header and context fields (`%s`).",
 			path);
 		goto error;
 	}
 
-	sc = ctf_trace_class_borrow_stream_class_by_id(ds_file->metadata->tc,
+	sc = ctf_trace_class_borrow_stream_class_by_id(ctf_fs_trace->metadata->tc,
 		props.stream_class_id);
 	BT_ASSERT(sc);
 	stream_instance_id = props.data_stream_id;
@@ -718,10 +800,9 @@ int add_ds_file_to_ds_file_group(struct ctf_fs_trace *ctf_fs_trace,
 		}
 	}
 
-	index = ctf_fs_ds_file_build_index(ds_file);
+	index = ctf_fs_ds_file_build_index(probe, file);
 	if (!index) {
-		BT_LOGW("Failed to index CTF stream file \'%s\'",
-			ds_file->file->path->str);
+		BT_LOGW("Failed to index CTF stream file \'%s\'", path);
 	}
 
 	if (begin_ns == -1) {
@@ -747,6 +828,7 @@ int add_ds_file_to_ds_file_group(struct ctf_fs_trace *ctf_fs_trace,
 			goto error;
 		}
 
+		add_group = true;
 		ret = ctf_fs_ds_file_group_add_ds_file_info(ds_file_group,
 			path, begin_ns, index);
 		/* Ownership of index is transferred. */
@@ -755,7 +837,6 @@ int add_ds_file_to_ds_file_group(struct ctf_fs_trace *ctf_fs_trace,
 			goto error;
 		}
 
-		add_group = true;
 		goto end;
 	}
 
@@ -763,19 +844,8 @@ int add_ds_file_to_ds_file_group(struct ctf_fs_trace *ctf_fs_trace,
 	BT_ASSERT(begin_ns != -1);
 
 	/* Find an existing stream file group with this ID */
-	for (i = 0; i < ctf_fs_trace->ds_file_groups->len; i++) {
-		ds_file_group = g_ptr_array_index(
-			ctf_fs_trace->ds_file_groups, i);
-
-		if (ds_file_group->sc == sc &&
-				ds_file_group->stream_id ==
-				stream_instance_id) {
-			break;
-		}
-
-		ds_file_group = NULL;
-	}
-
+	ds_file_group = ctf_fs_trace_borrow_ds_file_group_by_id(ctf_fs_trace,
+		sc, stream_instance_id);
 	if (!ds_file_group) {
 		ds_file_group = ctf_fs_ds_file_group_create(ctf_fs_trace,
 			sc, stream_instance_id);
@@ -796,19 +866,17 @@ int add_ds_file_to_ds_file_group(struct ctf_fs_trace *ctf_fs_trace,
 	goto end;
 
 error:
-	ctf_fs_ds_file_group_destroy(ds_file_group);
+	if (add_group) {
+		/* Existing groups belong to the trace */
+		ctf_fs_ds_file_group_destroy(ds_file_group);
+	}
+
 	ds_file_group = NULL;
 	ret = -1;
 
 end:
 	if (add_group && ds_file_group) {
-		g_ptr_array_add(ctf_fs_trace->ds_file_groups, ds_file_group);
-	}
-
-	ctf_fs_ds_file_destroy(ds_file);
-
-	if (msg_iter) {
-		bt_msg_iter_destroy(msg_iter);
+		ctf_fs_trace_add_ds_file_group(ctf_fs_trace, ds_file_group);
 	}
 
 	ctf_fs_ds_index_destroy(index);
@@ -822,6 +890,13 @@ int create_ds_file_groups(struct ctf_fs_trace *ctf_fs_trace)
 	const char *basename;
 	GError *error = NULL;
 	GDir *dir = NULL;
+	struct ctf_fs_ds_probe *probe = NULL;
+
+	/* One probe reads the first packets of all the stream files */
+	probe = ctf_fs_ds_probe_create(ctf_fs_trace->metadata);
+	if (!probe) {
+		goto error;
+	}
 
 	/* Check each file in the path directory, except specific ones */
 	dir = g_dir_open(ctf_fs_trace->path->str, 0, &error);
@@ -880,8 +955,7 @@ int create_ds_file_groups(struct ctf_fs_trace *ctf_fs_trace)
 			continue;
 		}
 
-		ret = add_ds_file_to_ds_file_group(ctf_fs_trace,
-			file->path->str);
+		ret = add_ds_file_to_ds_file_group(ctf_fs_trace, probe, file);
 		if (ret) {
 			BT_LOGE("Cannot add stream file `%s` to stream file group",
 				file->path->str);
@@ -892,12 +966,15 @@ int create_ds_file_groups(struct ctf_fs_trace *ctf_fs_trace)
 		ctf_fs_file_destroy(file);
 	}
 
+	ctf_fs_trace_sort_ds_file_groups(ctf_fs_trace);
 	goto end;
 
 error:
 	ret = -1;
 
 end:
+	ctf_fs_ds_probe_destroy(probe);
+
 	if (dir) {
 		g_dir_close(dir);
 		dir = NULL;
@@ -993,6 +1070,12 @@ struct ctf_fs_trace *ctf_fs_trace_create(bt_self_component_source *self_comp,
 		goto error;
 	}
 
+	ctf_fs_trace->ds_file_groups_by_id = g_hash_table_new(
+		ds_file_group_hash, ds_file_group_equal);
+	if (!ctf_fs_trace->ds_file_groups_by_id) {
+		goto error;
+	}
+
 	ret = ctf_fs_metadata_set_trace_class(self_comp,
 		ctf_fs_trace, metadata_config);
 	if (ret) {
@@ -1350,8 +1433,9 @@ unsigned int metadata_count_stream_and_event_classes(struct ctf_fs_trace *trace)
 }
 
 /*
- * Merge the src ds_file_group into dest.  This consists of merging their
- * ds_file_infos, making sure to keep the result sorted.
+ * Merge the src ds_file_group into dest.  This consists of moving src's
+ * ds_file_infos to dest: the caller sorts the result once all the
+ * groups are merged.
  */
 
 static
@@ -1366,7 +1450,7 @@ void merge_ctf_fs_ds_file_groups(struct ctf_fs_ds_file_group *dest, struct ctf_f
 		/* Ownership of the ds_file_info is transferred to dest. */
 		g_ptr_array_index(src->ds_file_infos, i) = NULL;
 
-		ds_file_group_insert_ds_file_info_sorted(dest, ds_file_info);
+		g_ptr_array_add(dest->ds_file_infos, ds_file_info);
 	}
 }
 
@@ -1378,47 +1462,25 @@ void merge_matching_ctf_fs_ds_file_groups(
 		struct ctf_fs_trace *src_trace)
 {
 
-	GPtrArray *dest = dest_trace->ds_file_groups;
 	GPtrArray *src = src_trace->ds_file_groups;
 	guint s_i;
 
-	/*
-	 * Save the initial length of dest: we only want to check against the
-	 * original elements in the inner loop.
-	 */
-	const guint dest_len = dest->len;
-
 	for (s_i = 0; s_i < src->len; s_i++) {
 		struct ctf_fs_ds_file_group *src_group = g_ptr_array_index(src, s_i);
 		struct ctf_fs_ds_file_group *dest_group = NULL;
 
-		/* A stream instance without ID can't match a stream in the other trace.  */
+		/*
+		 * A stream instance without ID can't match a stream in the
+		 * other trace.
+		 *
+		 * If the two groups have the same stream instance id and
+		 * belong to the same stream class (stream instance ids are
+		 * per-stream class), they represent the same stream
+		 * instance.
+		 */
 		if (src_group->stream_id != -1) {
-			guint d_i;
-
-			/* Let's search for a matching ds_file_group in the destination.  */
-			for (d_i = 0; d_i < dest_len; d_i++) {
-				struct ctf_fs_ds_file_group *candidate_dest = g_ptr_array_index(dest, d_i);
-
-				/* Can't match a stream instance without ID.  */
-				if (candidate_dest->stream_id == -1) {
-					continue;
-				}
-
-				/*
-				 * If the two groups have the same stream instance id
-				 * and belong to the same stream class (stream instance
-				 * ids are per-stream class), they represent the same
-				 * stream instance.
-				 */
-				if (candidate_dest->stream_id != src_group->stream_id ||
-						candidate_dest->sc->id != src_group->sc->id) {
-					continue;
-				}
-
-				dest_group = candidate_dest;
-				break;
-			}
+			dest_group = ctf_fs_trace_borrow_ds_file_group_by_id(
+				dest_trace, src_group->sc, src_group->stream_id);
 		}
 
 		/*
@@ -1434,8 +1496,8 @@ void merge_matching_ctf_fs_ds_file_groups(
 
 			dest_group = ctf_fs_ds_file_group_create(dest_trace, sc,
 				src_group->stream_id);
-
-			g_ptr_array_add(dest_trace->ds_file_groups, dest_group);
+			BT_ASSERT(dest_group);
+			ctf_fs_trace_add_ds_file_group(dest_trace, dest_group);
 		}
 
 		BT_ASSERT(dest_group);
@@ -1501,6 +1563,9 @@ void merge_ctf_fs_traces(struct ctf_fs_trace **traces, unsigned int num_traces)
 		traces[i] = NULL;
 	}
 
+	/* Sort the data stream file infos of the merged groups. */
+	ctf_fs_trace_sort_ds_file_groups(winner);
+
 	/* Use the string representation of the UUID as the trace name. */
 	bt_uuid_unparse(winner->metadata->tc->uuid, uuid_str);
 	g_string_printf(winner->name, "%s", uuid_str);
@@ -1706,6 +1771,152 @@ end:
 	return ret;
 }
 
+/*
+ * Converts the `projection` parameter (array of
+ * `EVENT-CLASS-NAME:FIELD-PATH` strings) to a map value of which the
+ * keys are event class names and the values are arrays of field paths,
+ * as expected by the metadata decoder.
+ *
+ * Returns `NULL` if `projection_param` is invalid.
+ */
+static
+bt_value *create_projection(const bt_value *projection_param)
+{
+	bt_value *projection = NULL;
+	uint64_t i;
+
+	if (!bt_value_is_array(projection_param)) {
+		BT_LOGE("`projection` parameter: expecting an array value: "
+			"type=%s", bt_common_value_type_string(
+				bt_value_get_type(projection_param)));
+		goto error;
+	}
+
+	projection = bt_value_map_create();
+	if (!projection) {
+		BT_LOGE_STR("Failed to create a map value.");
+		goto error;
+	}
+
+	for (i = 0; i < bt_value_array_get_size(projection_param); i++) {
+		const bt_value *elem =
+			bt_value_array_borrow_element_by_index_const(
+				projection_param, i);
+		const char *elem_str;
+		const char *sep;
+		const char *path;
+		bt_value *paths;
+		gchar *ec_name;
+
+		if (!bt_value_is_string(elem)) {
+			BT_LOGE("`projection` parameter: expecting a string value: "
+				"index=%" PRIu64 ", type=%s", i,
+				bt_common_value_type_string(
+					bt_value_get_type(elem)));
+			goto error;
+		}
+
+		/*
+		 * An event class name can contain `:` (e.g.
+		 * `my_provider:my_event`), but a field path cannot.
+		 */
+		elem_str = bt_value_string_get(elem);
+		sep = strrchr(elem_str, ':');
+		if (!sep || sep == elem_str) {
+			BT_LOGE("`projection` parameter: expecting "
+				"`EVENT-CLASS-NAME:FIELD-PATH`: "
+				"index=%" PRIu64 ", value=\"%s\"", i, elem_str);
+			goto error;
+		}
+
+		path = sep + 1;
+		if (strcmp(path, "payload") != 0 &&
+				strcmp(path, "specific-context") != 0 &&
+				!g_str_has_prefix(path, "payload.") &&
+				!g_str_has_prefix(path, "specific-context.")) {
+			BT_LOGE("`projection` parameter: field path must start "
+				"with `payload` or `specific-context`: "
+				"index=%" PRIu64 ", value=\"%s\"", i, elem_str);
+			goto error;
+		}
+
+		ec_name = g_strndup(elem_str, sep - elem_str);
+		BT_ASSERT(ec_name);
+		paths = bt_value_map_borrow_entry_value(projection, ec_name);
+		if (!paths) {
+			if (bt_value_map_insert_empty_array_entry(projection,
+					ec_name)) {
+				BT_LOGE_STR("Failed to insert a map value entry.");
+				g_free(ec_name);
+				goto error;
+			}
+
+			paths = bt_value_map_borrow_entry_value(projection,
+				ec_name);
+		}
+
+		g_free(ec_name);
+		BT_ASSERT(paths);
+
+		if (bt_value_array_append_string_element(paths, path)) {
+			BT_LOGE_STR("Failed to append a string value.");
+			goto error;
+		}
+	}
+
+	goto end;
+
+error:
+	BT_VALUE_PUT_REF_AND_RESET(projection);
+
+end:
+	return projection;
+}
+
+/*
+ * Reads the optional event class name array parameter named
+ * `param_name` into `*names`.
+ *
+ * Returns false if the parameter is invalid.
+ */
+static
+bool read_event_class_names_parameter(const bt_value *params,
+		const char *param_name, const bt_value **names)
+{
+	const bt_value *value;
+	uint64_t i;
+
+	value = bt_value_map_borrow_entry_value_const(params, param_name);
+	if (!value) {
+		return true;
+	}
+
+	if (!bt_value_is_array(value)) {
+		BT_LOGE("`%s` parameter: expecting an array value: type=%s",
+			param_name, bt_common_value_type_string(
+				bt_value_get_type(value)));
+		return false;
+	}
+
+	for (i = 0; i < bt_value_array_get_size(value); i++) {
+		const bt_value *elem =
+			bt_value_array_borrow_element_by_index_const(value, i);
+
+		if (!bt_value_is_string(elem)) {
+			BT_LOGE("`%s` parameter: expecting a string value: "
+				"index=%" PRIu64 ", type=%s", param_name, i,
+				bt_common_value_type_string(
+					bt_value_get_type(elem)));
+			return false;
+		}
+	}
+
+	BT_VALUE_PUT_REF_AND_RESET(*names);
+	*names = value;
+	bt_value_get_ref(value);
+	return true;
+}
+
 bool read_src_fs_parameters(const bt_value *params,
 		const bt_value **paths, struct ctf_fs_component *ctf_fs) {
 	bool ret;
@@ -1741,6 +1952,37 @@ bool read_src_fs_parameters(const bt_value *params,
 			bt_value_signed_integer_get(value);
 	}
 
+	/* skip-event-fields parameter */
+	value = bt_value_map_borrow_entry_value_const(params,
+		"skip-event-fields");
+	if (value) {
+		if (!bt_value_is_bool(value)) {
+			BT_LOGE("skip-event-fields must be a boolean");
+			goto error;
+		}
+		ctf_fs->skip_event_fields = (bool) bt_value_bool_get(value);
+	}
+
+	/* allow-event-classes and deny-event-classes parameters */
+	if (!read_event_class_names_parameter(params, "allow-event-classes",
+			&ctf_fs->metadata_config.allowed_event_class_names)) {
+		goto error;
+	}
+
+	if (!read_event_class_names_parameter(params, "deny-event-classes",
+			&ctf_fs->metadata_config.denied_event_class_names)) {
+		goto error;
+	}
+
+	/* projection parameter */
+	value = bt_value_map_borrow_entry_value_const(params, "projection");
+	if (value) {
+		BT_VALUE_PUT_REF_AND_RESET(ctf_fs->metadata_config.projection);
+		ctf_fs->metadata_config.projection = create_projection(value);
+		if (!ctf_fs->metadata_config.projection) {
+			goto error;
+		}
+	}
 
 	ret = true;
 	goto end;
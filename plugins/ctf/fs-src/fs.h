@@ -77,6 +77,12 @@ struct ctf_fs_component {
 	GPtrArray *traces;
 
 	struct ctf_fs_metadata_config metadata_config;
+
+	/*
+	 * True to leave the event context and payload fields unset
+	 * (`skip-event-fields` parameter).
+	 */
+	bool skip_event_fields;
 };
 
 struct ctf_fs_trace {
@@ -89,6 +95,15 @@ struct ctf_fs_trace {
 	/* Array of struct ctf_fs_ds_file_group *, owned by this */
 	GPtrArray *ds_file_groups;
 
+	/*
+	 * Hash table of struct ctf_fs_ds_file_group * (weak, keys and
+	 * values) indexed by stream class ID and stream instance ID.
+	 *
+	 * This only contains the groups of `ds_file_groups` which have
+	 * a stream instance ID.
+	 */
+	GHashTable *ds_file_groups_by_id;
+
 	/* Owned by this */
 	GString *path;
 
@@ -104,7 +119,9 @@ struct ctf_fs_ds_file_group {
 	 * Array of struct ctf_fs_ds_file_info, owned by this.
 	 *
 	 * This is an _ordered_ array of data stream file infos which
-	 * belong to this group (a single stream instance).
+	 * belong to this group (a single stream instance). It is only
+	 * sorted once all the trace's data stream files are found
+	 * (see ctf_fs_trace_sort_ds_file_groups()).
 	 *
 	 * You can call ctf_fs_ds_file_create() with one of those paths
 	 * and the trace IR stream below.
@@ -147,6 +164,13 @@ struct ctf_fs_msg_iter_data {
 
 	/* Owned by this */
 	struct bt_msg_iter *msg_iter;
+
+	/*
+	 * Owned by this: packets which the data stream files of this
+	 * iterator register as source packets, or `NULL` to register
+	 * none (see `struct ctf_fs_ds_file`).
+	 */
+	GQueue *src_packets;
 };
 
 BT_HIDDEN
@@ -210,6 +234,12 @@ void ctf_fs_destroy(struct ctf_fs_component *ctf_fs);
  *  - The mandatory `paths` parameter is returned in `*paths`.
  *  - The optional `clock-class-offset-s` and `clock-class-offset-ns`, if
  *    present, are recorded in the `ctf_fs` structure.
+ *  - The optional `skip-event-fields`, if present, is recorded in the
+ *    `ctf_fs` structure.
+ *  - The optional `projection`, if present, is converted to a map and
+ *    recorded in the `ctf_fs` structure.
+ *  - The optional `allow-event-classes` and `deny-event-classes`, if
+ *    present, are recorded in the `ctf_fs` structure.
  *
  * Return true on success, false if any parameter didn't pass validation.
  */
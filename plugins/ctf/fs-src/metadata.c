@@ -27,6 +27,8 @@
 #include <stdint.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <string.h>
+#include <inttypes.h>
 #include <babeltrace/assert-internal.h>
 #include <glib.h>
 #include <babeltrace/compat/uuid-internal.h>
@@ -37,6 +39,7 @@
 #include "file.h"
 #include "metadata.h"
 #include "../common/metadata/decoder.h"
+#include "../common/metadata/ctf-meta.h"
 
 #define BT_LOG_TAG "PLUGIN-CTF-FS-METADATA-SRC"
 #include "logging.h"
@@ -86,6 +89,72 @@ end:
 	return file;
 }
 
+static
+bool event_class_names_contains(const bt_value *names, const char *name)
+{
+	uint64_t i;
+
+	for (i = 0; i < bt_value_array_get_size(names); i++) {
+		const bt_value *elem =
+			bt_value_array_borrow_element_by_index_const(names, i);
+
+		if (strcmp(bt_value_string_get(elem), name) == 0) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/*
+ * Marks the event classes of `tc` which `config` filters out as
+ * skipped, as well as the stream classes of which all the event
+ * classes are skipped.
+ */
+static
+void update_skipped_event_classes(struct ctf_trace_class *tc,
+		struct ctf_fs_metadata_config *config)
+{
+	uint64_t i;
+
+	if (!config || (!config->allowed_event_class_names &&
+			!config->denied_event_class_names)) {
+		return;
+	}
+
+	for (i = 0; i < tc->stream_classes->len; i++) {
+		struct ctf_stream_class *sc = tc->stream_classes->pdata[i];
+		uint64_t j;
+
+		sc->all_event_classes_skipped = sc->event_classes->len > 0;
+
+		for (j = 0; j < sc->event_classes->len; j++) {
+			struct ctf_event_class *ec =
+				sc->event_classes->pdata[j];
+
+			ec->is_skipped =
+				(config->allowed_event_class_names &&
+				!event_class_names_contains(
+					config->allowed_event_class_names,
+					ec->name->str)) ||
+				(config->denied_event_class_names &&
+				event_class_names_contains(
+					config->denied_event_class_names,
+					ec->name->str));
+
+			if (!ec->is_skipped) {
+				sc->all_event_classes_skipped = false;
+			}
+
+			BT_LOGD("Updated event class's skipping: "
+				"sc-id=%" PRIu64 ", ec-id=%" PRIu64 ", "
+				"ec-name=\"%s\", is-skipped=%d",
+				sc->id, ec->id, ec->name->str,
+				ec->is_skipped);
+		}
+	}
+}
+
 BT_HIDDEN
 int ctf_fs_metadata_set_trace_class(
 		bt_self_component_source *self_comp,
@@ -97,6 +166,7 @@ int ctf_fs_metadata_set_trace_class(
 	struct ctf_metadata_decoder_config decoder_config = {
 		.clock_class_offset_s = config ? config->clock_class_offset_s : 0,
 		.clock_class_offset_ns = config ? config->clock_class_offset_ns : 0,
+		.projection = config ? config->projection : NULL,
 	};
 
 	file = get_file(ctf_fs_trace->path->str);
@@ -129,6 +199,7 @@ int ctf_fs_metadata_set_trace_class(
 		ctf_metadata_decoder_borrow_ctf_trace_class(
 			ctf_fs_trace->metadata->decoder);
 	BT_ASSERT(ctf_fs_trace->metadata->tc);
+	update_skipped_event_classes(ctf_fs_trace->metadata->tc, config);
 
 end:
 	ctf_fs_file_destroy(file);
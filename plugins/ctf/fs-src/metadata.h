@@ -36,6 +36,16 @@ struct ctf_fs_metadata;
 struct ctf_fs_metadata_config {
 	int64_t clock_class_offset_s;
 	int64_t clock_class_offset_ns;
+
+	/* Owned by this, `NULL` if not projecting event fields */
+	const bt_value *projection;
+
+	/*
+	 * Arrays of event class names of which to keep or skip the
+	 * events (owned by this, `NULL` if not filtering).
+	 */
+	const bt_value *allowed_event_class_names;
+	const bt_value *denied_event_class_names;
 };
 
 BT_HIDDEN
@@ -226,6 +226,12 @@ struct lttng_live_stream_iterator *lttng_live_stream_iterator_create(
 			stream_iter->viewer_stream_id);
 	g_ptr_array_add(trace->stream_iterators, stream_iter);
 
+	/* A new stream iterator needs a current message. */
+	g_ptr_array_add(session->lttng_live_msg_iter->pending_stream_iters,
+		stream_iter);
+	lttng_live_queue_index_prefetch(session->lttng_live_msg_iter,
+		stream_iter);
+
 	/* Track the number of active stream iterator. */
 	session->lttng_live_msg_iter->active_stream_iter++;
 
@@ -260,6 +266,9 @@ void lttng_live_stream_iterator_destroy(
 	}
 
 	bt_message_put_ref(stream_iter->current_msg);
+	lttng_live_unqueue_index_prefetch(
+		stream_iter->trace->session->lttng_live_msg_iter, stream_iter);
+	g_free(stream_iter->prefetched_buf);
 
 	/* Track the number of active stream iterator. */
 	stream_iter->trace->session->lttng_live_msg_iter->active_stream_iter--;
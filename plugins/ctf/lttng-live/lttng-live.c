@@ -51,6 +51,7 @@
 #define SESS_NOT_FOUND_ACTION_CONTINUE_STR  "continue"
 #define SESS_NOT_FOUND_ACTION_FAIL_STR	    "fail"
 #define SESS_NOT_FOUND_ACTION_END_STR	    "end"
+#define MAX_REQUESTS_IN_FLIGHT_PARAM	    "max-requests-in-flight"
 
 #define print_dbg(fmt, ...)	BT_LOGD(fmt, ## __VA_ARGS__)
 
@@ -297,6 +298,19 @@ void lttng_live_msg_iter_destroy(struct lttng_live_msg_iter *lttng_live_msg_iter
 		g_ptr_array_free(lttng_live_msg_iter->sessions, TRUE);
 	}
 
+	if (lttng_live_msg_iter->ready_stream_iters) {
+		g_ptr_array_free(lttng_live_msg_iter->ready_stream_iters, TRUE);
+	}
+
+	if (lttng_live_msg_iter->pending_stream_iters) {
+		g_ptr_array_free(lttng_live_msg_iter->pending_stream_iters,
+			TRUE);
+	}
+
+	if (lttng_live_msg_iter->index_prefetch_queue) {
+		g_queue_free(lttng_live_msg_iter->index_prefetch_queue);
+	}
+
 	BT_OBJECT_PUT_REF_AND_RESET(lttng_live_msg_iter->viewer_connection);
 	BT_ASSERT(lttng_live_msg_iter->lttng_live_comp);
 	BT_ASSERT(lttng_live_msg_iter->lttng_live_comp->has_msg_iter);
@@ -897,209 +911,280 @@ end:
 	return live_status;
 }
 
+static inline
+bool ready_stream_iter_is_before(GPtrArray *heap, guint a, guint b)
+{
+	struct lttng_live_stream_iterator *stream_iter_a =
+		g_ptr_array_index(heap, a);
+	struct lttng_live_stream_iterator *stream_iter_b =
+		g_ptr_array_index(heap, b);
+
+	return stream_iter_a->current_msg_ts_ns <
+		stream_iter_b->current_msg_ts_ns;
+}
+
+static inline
+void ready_stream_iters_swap(GPtrArray *heap, guint a, guint b)
+{
+	gpointer tmp = heap->pdata[a];
+
+	heap->pdata[a] = heap->pdata[b];
+	heap->pdata[b] = tmp;
+}
+
+/*
+ * Adds a live stream iterator having a current message to the heap of
+ * ready live stream iterators.
+ */
 static
-enum lttng_live_iterator_status next_stream_iterator_for_trace(
-		struct lttng_live_msg_iter *lttng_live_msg_iter,
-		struct lttng_live_trace *live_trace,
-		struct lttng_live_stream_iterator **candidate_stream_iter)
+void ready_stream_iters_push(struct lttng_live_msg_iter *lttng_live_msg_iter,
+		struct lttng_live_stream_iterator *stream_iter)
 {
-	struct lttng_live_stream_iterator *curr_candidate_stream_iter = NULL;
-	enum lttng_live_iterator_status stream_iter_status;;
-	int64_t curr_candidate_msg_ts = INT64_MAX;
-	uint64_t stream_iter_idx;
+	GPtrArray *heap = lttng_live_msg_iter->ready_stream_iters;
+	guint i;
 
-	BT_ASSERT(live_trace);
-	BT_ASSERT(live_trace->stream_iterators);
-	/*
-	 * Update the current message of every stream iterators of this trace.
-	 * The current msg of every stream must have a timestamp equal or
-	 * larger than the last message returned by this iterator. We must
-	 * ensure monotonicity.
-	 */
-	stream_iter_idx = 0;
-	while (stream_iter_idx < live_trace->stream_iterators->len) {
-		bool stream_iter_is_ended = false;
-		struct lttng_live_stream_iterator *stream_iter =
-			g_ptr_array_index(live_trace->stream_iterators,
-					stream_iter_idx);
+	BT_ASSERT(stream_iter->current_msg);
+	g_ptr_array_add(heap, stream_iter);
+	i = heap->len - 1;
 
-		/*
-		 * Find if there is are now current message for this stream
-		 * iterator get it.
-		 */
-		while (!stream_iter->current_msg) {
-			bt_message *msg = NULL;
-			int64_t curr_msg_ts_ns = INT64_MAX;
-			stream_iter_status = lttng_live_iterator_next_on_stream(
-					lttng_live_msg_iter, stream_iter, &msg);
-
-			BT_LOGD("live stream iterator returned status :%s",
-					print_live_iterator_status(stream_iter_status));
-			if (stream_iter_status == LTTNG_LIVE_ITERATOR_STATUS_END) {
-				stream_iter_is_ended = true;
-				break;
-			}
+	while (i > 0) {
+		guint parent = (i - 1) / 2;
 
-			if (stream_iter_status != LTTNG_LIVE_ITERATOR_STATUS_OK) {
-				goto end;
-			}
+		if (!ready_stream_iter_is_before(heap, i, parent)) {
+			break;
+		}
 
-			BT_ASSERT(msg);
+		ready_stream_iters_swap(heap, i, parent);
+		i = parent;
+	}
+}
 
-			/*
-			 * Get the timestamp in nanoseconds from origin of this
-			 * messsage.
-			 */
-			live_get_msg_ts_ns(stream_iter, lttng_live_msg_iter,
-				msg, lttng_live_msg_iter->last_msg_ts_ns,
-				&curr_msg_ts_ns);
+/*
+ * Removes and returns the ready live stream iterator of which the
+ * current message has the smallest timestamp, or NULL if there's no
+ * ready live stream iterator.
+ */
+static
+struct lttng_live_stream_iterator *ready_stream_iters_pop(
+		struct lttng_live_msg_iter *lttng_live_msg_iter)
+{
+	GPtrArray *heap = lttng_live_msg_iter->ready_stream_iters;
+	struct lttng_live_stream_iterator *stream_iter;
+	guint i = 0;
 
-			/*
-			 * Check if the message of the current live stream
-			 * iterator occured at the exact same time or after the
-			 * last message returned by this component's message
-			 * iterator. If not, we return an error.
-			 */
-			if (curr_msg_ts_ns >= lttng_live_msg_iter->last_msg_ts_ns) {
-				stream_iter->current_msg = msg;
-				stream_iter->current_msg_ts_ns = curr_msg_ts_ns;
-			} else {
-				/*
-				 * We received a message in the past. To ensure
-				 * monotonicity, we can't send it forward.
-				 */
-				BT_LOGE("Message's timestamp is less than "
-					"lttng-live's message iterator's last "
-					"returned timestamp: "
-					"lttng-live-msg-iter-addr=%p, ts=%" PRId64 ", "
-					"last-msg-ts=%" PRId64,
-					lttng_live_msg_iter, curr_msg_ts_ns,
-					lttng_live_msg_iter->last_msg_ts_ns);
-				stream_iter_status = LTTNG_LIVE_ITERATOR_STATUS_ERROR;
-				goto end;
-			}
+	if (heap->len == 0) {
+		stream_iter = NULL;
+		goto end;
+	}
+
+	stream_iter = g_ptr_array_index(heap, 0);
+	heap->pdata[0] = heap->pdata[heap->len - 1];
+	g_ptr_array_set_size(heap, heap->len - 1);
+
+	while (true) {
+		guint left = 2 * i + 1;
+		guint right = left + 1;
+		guint smallest = i;
+
+		if (left < heap->len &&
+				ready_stream_iter_is_before(heap, left, smallest)) {
+			smallest = left;
 		}
 
-		if (!stream_iter_is_ended &&
-				stream_iter->current_msg_ts_ns <= curr_candidate_msg_ts) {
-			/*
-			 * Update the current best candidate message for the
-			 * stream iterator of thise live trace to be forwarded
-			 * downstream.
-			 */
-			curr_candidate_msg_ts = stream_iter->current_msg_ts_ns;
-			curr_candidate_stream_iter = stream_iter;
+		if (right < heap->len &&
+				ready_stream_iter_is_before(heap, right, smallest)) {
+			smallest = right;
 		}
 
-		if (stream_iter_is_ended) {
-			/*
-			 * The live stream iterator is ENDed. We remove that
-			 * iterator from the list and we restart the iteration
-			 * at the beginning of the live stream iterator array
-			 * to because the removal will shuffle the array.
-			 */
-			g_ptr_array_remove_index_fast(live_trace->stream_iterators,
-				stream_iter_idx);
-			stream_iter_idx = 0;
-		} else {
-			stream_iter_idx++;
+		if (smallest == i) {
+			break;
 		}
+
+		ready_stream_iters_swap(heap, i, smallest);
+		i = smallest;
 	}
 
-	if (curr_candidate_stream_iter) {
-		*candidate_stream_iter = curr_candidate_stream_iter;
-		stream_iter_status = LTTNG_LIVE_ITERATOR_STATUS_OK;
-	} else {
+end:
+	return stream_iter;
+}
+
+/*
+ * Gets the next message of a live stream iterator without a current
+ * message and makes it its current message.
+ *
+ * The current message of every stream must have a timestamp equal or
+ * larger than the last message returned by this iterator. We must
+ * ensure monotonicity.
+ */
+static
+enum lttng_live_iterator_status next_msg_for_stream_iterator(
+		struct lttng_live_msg_iter *lttng_live_msg_iter,
+		struct lttng_live_stream_iterator *stream_iter)
+{
+	enum lttng_live_iterator_status stream_iter_status =
+		LTTNG_LIVE_ITERATOR_STATUS_OK;
+
+	while (!stream_iter->current_msg) {
+		bt_message *msg = NULL;
+		int64_t curr_msg_ts_ns = INT64_MAX;
+		stream_iter_status = lttng_live_iterator_next_on_stream(
+				lttng_live_msg_iter, stream_iter, &msg);
+
+		BT_LOGD("live stream iterator returned status :%s",
+				print_live_iterator_status(stream_iter_status));
+		if (stream_iter_status != LTTNG_LIVE_ITERATOR_STATUS_OK) {
+			goto end;
+		}
+
+		BT_ASSERT(msg);
+
 		/*
-		 * The only case where we don't have a candidate for this trace
-		 * is if we reached the end of all the iterators.
+		 * Get the timestamp in nanoseconds from origin of this
+		 * messsage.
 		 */
-		BT_ASSERT(live_trace->stream_iterators->len == 0);
-		stream_iter_status = LTTNG_LIVE_ITERATOR_STATUS_END;
+		live_get_msg_ts_ns(stream_iter, lttng_live_msg_iter,
+			msg, lttng_live_msg_iter->last_msg_ts_ns,
+			&curr_msg_ts_ns);
+
+		/*
+		 * Check if the message of the current live stream
+		 * iterator occured at the exact same time or after the
+		 * last message returned by this component's message
+		 * iterator. If not, we return an error.
+		 */
+		if (curr_msg_ts_ns >= lttng_live_msg_iter->last_msg_ts_ns) {
+			stream_iter->current_msg = msg;
+			stream_iter->current_msg_ts_ns = curr_msg_ts_ns;
+		} else {
+			/*
+			 * We received a message in the past. To ensure
+			 * monotonicity, we can't send it forward.
+			 */
+			BT_LOGE("Message's timestamp is less than "
+				"lttng-live's message iterator's last "
+				"returned timestamp: "
+				"lttng-live-msg-iter-addr=%p, ts=%" PRId64 ", "
+				"last-msg-ts=%" PRId64,
+				lttng_live_msg_iter, curr_msg_ts_ns,
+				lttng_live_msg_iter->last_msg_ts_ns);
+			bt_message_put_ref(msg);
+			stream_iter_status = LTTNG_LIVE_ITERATOR_STATUS_ERROR;
+			goto end;
+		}
 	}
 
 end:
 	return stream_iter_status;
 }
 
+/*
+ * Gets a current message for every pending live stream iterator and
+ * moves them to the heap of ready live stream iterators.
+ *
+ * Getting a message can add new live stream iterators to the pending
+ * ones: they are handled by the same loop. A live stream iterator which
+ * is ENDed is removed from its trace (which destroys it).
+ *
+ * Only the live stream iterators which were ready and got their current
+ * message sent downstream since the last call, as well as the new,
+ * quiescent, and no-data ones, are pending: the others keep their
+ * position in the heap.
+ */
 static
-enum lttng_live_iterator_status next_stream_iterator_for_session(
-		struct lttng_live_msg_iter *lttng_live_msg_iter,
-		struct lttng_live_session *session,
-		struct lttng_live_stream_iterator **candidate_session_stream_iter)
+enum lttng_live_iterator_status refill_pending_stream_iterators(
+		struct lttng_live_msg_iter *lttng_live_msg_iter)
 {
-	enum lttng_live_iterator_status stream_iter_status;
-	uint64_t trace_idx = 0;
-	int64_t curr_candidate_msg_ts = INT64_MAX;
-	struct lttng_live_stream_iterator *curr_candidate_stream_iter = NULL;
+	GPtrArray *pending = lttng_live_msg_iter->pending_stream_iters;
+	enum lttng_live_iterator_status stream_iter_status =
+		LTTNG_LIVE_ITERATOR_STATUS_OK;
 
-	/*
-	 * Make sure we are attached to the session and look for new streams
-	 * and metadata.
-	 */
-	stream_iter_status = lttng_live_get_session(lttng_live_msg_iter, session);
-	if (stream_iter_status != LTTNG_LIVE_ITERATOR_STATUS_OK &&
-			stream_iter_status != LTTNG_LIVE_ITERATOR_STATUS_CONTINUE &&
-			stream_iter_status != LTTNG_LIVE_ITERATOR_STATUS_END) {
-		goto end;
+	while (pending->len > 0) {
+		struct lttng_live_stream_iterator *stream_iter =
+			g_ptr_array_index(pending, pending->len - 1);
+
+		/*
+		 * Take the live stream iterator out of the pending ones
+		 * first: getting its next message can add new pending
+		 * live stream iterators.
+		 */
+		g_ptr_array_remove_index(pending, pending->len - 1);
+		stream_iter_status = next_msg_for_stream_iterator(
+			lttng_live_msg_iter, stream_iter);
+		switch (stream_iter_status) {
+		case LTTNG_LIVE_ITERATOR_STATUS_OK:
+			ready_stream_iters_push(lttng_live_msg_iter,
+				stream_iter);
+			break;
+		case LTTNG_LIVE_ITERATOR_STATUS_END:
+			/*
+			 * The live stream iterator is ENDed. We remove
+			 * that iterator from its trace; an empty trace
+			 * is removed by remove_ended_traces_and_sessions().
+			 */
+			g_ptr_array_remove_fast(
+				stream_iter->trace->stream_iterators,
+				stream_iter);
+			stream_iter_status = LTTNG_LIVE_ITERATOR_STATUS_OK;
+			break;
+		default:
+			/* Try again on the next call. */
+			g_ptr_array_add(pending, stream_iter);
+			goto end;
+		}
 	}
 
-	BT_ASSERT(session->traces);
+end:
+	return stream_iter_status;
+}
+
+/*
+ * Removes the traces of which all the live stream iterators are ENDed
+ * (or which never had a live stream iterator in the first place), and
+ * then the closed sessions without traces.
+ */
+static
+void remove_ended_traces_and_sessions(
+		struct lttng_live_msg_iter *lttng_live_msg_iter)
+{
+	uint64_t session_idx = 0;
 
 	/*
 	 * Use while loops here rather then for loops so we can restart the
 	 * iteration if an element is removed from the array during the
 	 * looping.
 	 */
-	while (trace_idx < session->traces->len) {
-		bool trace_is_ended = false;
-		struct lttng_live_stream_iterator *stream_iter;
-		struct lttng_live_trace *trace =
-			g_ptr_array_index(session->traces, trace_idx);
-
-		stream_iter_status = next_stream_iterator_for_trace(
-			lttng_live_msg_iter, trace, &stream_iter);
-		if (stream_iter_status == LTTNG_LIVE_ITERATOR_STATUS_END) {
-			/*
-			 * All the live stream iterators for this trace are
-			 * ENDed. Remove the trace from this session.
-			 */
-			trace_is_ended = true;
-		} else if (stream_iter_status != LTTNG_LIVE_ITERATOR_STATUS_OK) {
-			goto end;
-		}
+	while (session_idx < lttng_live_msg_iter->sessions->len) {
+		struct lttng_live_session *session =
+			g_ptr_array_index(lttng_live_msg_iter->sessions,
+				session_idx);
+		uint64_t trace_idx = 0;
 
-		if (!trace_is_ended) {
-			BT_ASSERT(stream_iter);
+		while (trace_idx < session->traces->len) {
+			struct lttng_live_trace *trace =
+				g_ptr_array_index(session->traces, trace_idx);
 
-			if (stream_iter->current_msg_ts_ns <= curr_candidate_msg_ts) {
-				curr_candidate_msg_ts = stream_iter->current_msg_ts_ns;
-				curr_candidate_stream_iter = stream_iter;
+			if (trace->stream_iterators->len == 0) {
+				g_ptr_array_remove_index_fast(session->traces,
+					trace_idx);
+				trace_idx = 0;
+			} else {
+				trace_idx++;
 			}
-			trace_idx++;
+		}
+
+		if (session->closed && session->traces->len == 0) {
+			/*
+			 * Remove the session from the list and restart the
+			 * iteration at the beginning of the array since the
+			 * removal shuffle the elements of the array.
+			 */
+			g_ptr_array_remove_index_fast(
+				lttng_live_msg_iter->sessions, session_idx);
+			session_idx = 0;
 		} else {
-			g_ptr_array_remove_index_fast(session->traces, trace_idx);
-			trace_idx = 0;
+			session_idx++;
 		}
 	}
-	if (curr_candidate_stream_iter) {
-		*candidate_session_stream_iter = curr_candidate_stream_iter;
-		stream_iter_status = LTTNG_LIVE_ITERATOR_STATUS_OK;
-	} else {
-		/*
-		 * The only cases where we don't have a candidate for this
-		 * trace is:
-		 *  1. if we reached the end of all the iterators of all the
-		 *  traces of this session,
-		 *  2. if we never had live stream iterator in the first place.
-		 *
-		 * In either cases, we return END.
-		 */
-		BT_ASSERT(session->traces->len == 0);
-		stream_iter_status = LTTNG_LIVE_ITERATOR_STATUS_END;
-	}
-end:
-	return stream_iter_status;
 }
 
 static inline
@@ -1166,82 +1251,63 @@ bt_self_message_iterator_status lttng_live_msg_iter_next(
 	/*
 	 * Here the muxing of message is done.
 	 *
-	 * We need to iterate over all the streams of all the traces of all the
-	 * viewer sessions in order to get the message with the smallest
-	 * timestamp. In this case, a session is a viewer session and there is
-	 * one viewer session per consumer daemon. (UST 32bit, UST 64bit and/or
-	 * kernel). Each viewer session can have multiple traces, for example,
-	 * 64bit UST viewer sessions could have multiple per-pid traces.
-	 *
-	 * We iterate over the streams of each traces to update and see what is
-	 * their next message's timestamp. From those timestamps, we select the
-	 * message with the smallest timestamp as the best candidate message
-	 * for that trace and do the same thing across all the sessions.
+	 * We need the message with the smallest timestamp amongst the
+	 * streams of all the traces of all the viewer sessions. In this case,
+	 * a session is a viewer session and there is one viewer session per
+	 * consumer daemon. (UST 32bit, UST 64bit and/or kernel). Each viewer
+	 * session can have multiple traces, for example, 64bit UST viewer
+	 * sessions could have multiple per-pid traces.
 	 *
-	 * We then compare the timestamp of best candidate message of all the
-	 * sessions to pick the message with the smallest timestamp and we
-	 * return it.
+	 * Each live stream iterator having a current message is in a heap
+	 * keyed by the timestamp of this message. The other ones (new,
+	 * quiescent, and no-data streams, and the one of which the current
+	 * message was just sent downstream) are pending: we get their next
+	 * message before choosing one, as any of them could have the
+	 * smallest timestamp. Only the pending live stream iterators are
+	 * visited, so that choosing a message does not depend on the total
+	 * number of streams.
 	 */
 	while (*count < capacity) {
-		struct lttng_live_stream_iterator *next_stream_iter = NULL,
-						  *candidate_stream_iter = NULL;
-		int64_t next_msg_ts_ns = INT64_MAX;
+		struct lttng_live_stream_iterator *next_stream_iter;
 
 		BT_ASSERT(lttng_live_msg_iter->sessions);
-		session_idx = 0;
+
 		/*
-		 * Use a while loop instead of a for loop so we can restart the
-		 * iteration if we remove an element. We can safely call
-		 * next_stream_iterator_for_session() multiple times on the
-		 * same session as we only fetch a new message if there is no
-		 * current next message for each live stream iterator.
-		 * If all live stream iterator of that session already have a
-		 * current next message, the function will simply exit return
-		 * the same candidate live stream iterator every time.
+		 * Make sure we are attached to the sessions and look for new
+		 * streams and metadata.
 		 */
-		while (session_idx < lttng_live_msg_iter->sessions->len) {
+		for (session_idx = 0;
+				session_idx < lttng_live_msg_iter->sessions->len;
+				session_idx++) {
 			struct lttng_live_session *session =
 				g_ptr_array_index(lttng_live_msg_iter->sessions,
 					session_idx);
 
-			/* Find the best candidate message to send downstream. */
-			stream_iter_status = next_stream_iterator_for_session(
-				lttng_live_msg_iter, session,
-				&candidate_stream_iter);
-
-			/* If we receive an END status, it means that either:
-			 * - Those traces never had active streams (UST with no
-			 *   data produced yet),
-			 * - All live stream iterators have ENDed.*/
-			if (stream_iter_status == LTTNG_LIVE_ITERATOR_STATUS_END) {
-				if (session->closed && session->traces->len == 0) {
-					/*
-					 * Remove the session from the list and restart the
-					 * iteration at the beginning of the array since the
-					 * removal shuffle the elements of the array.
-					 */
-					g_ptr_array_remove_index_fast(
-						lttng_live_msg_iter->sessions,
-						session_idx);
-					session_idx = 0;
-				} else {
-					session_idx++;
-				}
-				continue;
-			}
-
-			if (stream_iter_status != LTTNG_LIVE_ITERATOR_STATUS_OK) {
+			stream_iter_status = lttng_live_get_session(
+				lttng_live_msg_iter, session);
+			if (stream_iter_status != LTTNG_LIVE_ITERATOR_STATUS_OK &&
+					stream_iter_status != LTTNG_LIVE_ITERATOR_STATUS_CONTINUE &&
+					stream_iter_status != LTTNG_LIVE_ITERATOR_STATUS_END) {
 				goto end;
 			}
+		}
 
-			if (candidate_stream_iter->current_msg_ts_ns <= next_msg_ts_ns) {
-				next_msg_ts_ns = candidate_stream_iter->current_msg_ts_ns;
-				next_stream_iter = candidate_stream_iter;
-			}
-
-			session_idx++;
+		stream_iter_status = refill_pending_stream_iterators(
+			lttng_live_msg_iter);
+		if (stream_iter_status != LTTNG_LIVE_ITERATOR_STATUS_OK) {
+			goto end;
 		}
 
+		/*
+		 * If a trace has no more live stream iterator, it means that
+		 * either:
+		 * - It never had active streams (UST with no data produced
+		 *   yet),
+		 * - All its live stream iterators have ENDed.
+		 */
+		remove_ended_traces_and_sessions(lttng_live_msg_iter);
+
+		next_stream_iter = ready_stream_iters_pop(lttng_live_msg_iter);
 		if (!next_stream_iter) {
 			stream_iter_status = LTTNG_LIVE_ITERATOR_STATUS_AGAIN;
 			goto end;
@@ -1261,8 +1327,11 @@ bt_self_message_iterator_status lttng_live_msg_iter_next(
 		(*count)++;
 
 		/* Update the last timestamp in nanoseconds sent downstream. */
-		lttng_live_msg_iter->last_msg_ts_ns = next_msg_ts_ns;
+		lttng_live_msg_iter->last_msg_ts_ns =
+			next_stream_iter->current_msg_ts_ns;
 		next_stream_iter->current_msg_ts_ns = INT64_MAX;
+		g_ptr_array_add(lttng_live_msg_iter->pending_stream_iters,
+			next_stream_iter);
 
 		stream_iter_status = LTTNG_LIVE_ITERATOR_STATUS_OK;
 	}
@@ -1338,6 +1407,12 @@ bt_self_message_iterator_status lttng_live_msg_iter_init(
 	lttng_live_msg_iter->sessions = g_ptr_array_new_with_free_func(
 		(GDestroyNotify) lttng_live_destroy_session);
 	BT_ASSERT(lttng_live_msg_iter->sessions);
+	lttng_live_msg_iter->ready_stream_iters = g_ptr_array_new();
+	BT_ASSERT(lttng_live_msg_iter->ready_stream_iters);
+	lttng_live_msg_iter->pending_stream_iters = g_ptr_array_new();
+	BT_ASSERT(lttng_live_msg_iter->pending_stream_iters);
+	lttng_live_msg_iter->index_prefetch_queue = g_queue_new();
+	BT_ASSERT(lttng_live_msg_iter->index_prefetch_queue);
 
 	lttng_live_msg_iter->viewer_connection =
 		live_viewer_connection_create(lttng_live->params.url->str, false,
@@ -1552,6 +1627,22 @@ struct lttng_live_component *lttng_live_component_create(const bt_value *params)
 			SESSION_NOT_FOUND_ACTION_CONTINUE;
 	}
 
+	value = bt_value_map_borrow_entry_value_const(params,
+		MAX_REQUESTS_IN_FLIGHT_PARAM);
+	if (value) {
+		if (!bt_value_is_signed_integer(value) ||
+				bt_value_signed_integer_get(value) <= 0) {
+			BT_LOGE("`%s` parameter must be a strictly positive "
+				"integer.", MAX_REQUESTS_IN_FLIGHT_PARAM);
+			goto error;
+		}
+
+		lttng_live->params.max_requests_in_flight =
+			(uint64_t) bt_value_signed_integer_get(value);
+	} else {
+		lttng_live->params.max_requests_in_flight = 1;
+	}
+
 	goto end;
 
 error:
@@ -38,6 +38,7 @@
 #include "../common/msg-iter/msg-iter.h"
 
 #include "viewer-connection.h"
+#include "lttng-viewer-abi.h"
 
 struct lttng_live_component;
 struct lttng_live_session;
@@ -116,6 +117,29 @@ struct lttng_live_stream_iterator {
 
 	/* Owned by this. */
 	GString *name;
+
+	/*
+	 * Link of this stream iterator within the index prefetch queue
+	 * of its message iterator, or NULL if it's not in this queue.
+	 */
+	GList *index_prefetch_link;
+
+	/*
+	 * Reply to a GET_NEXT_INDEX request sent ahead of time for this
+	 * stream, valid if `has_prefetched_index` is true. The next
+	 * lttng_live_get_next_index() call for this stream uses it
+	 * instead of sending a request.
+	 */
+	struct lttng_viewer_index prefetched_index;
+	bool has_prefetched_index;
+
+	/*
+	 * Beginning of a packet received ahead of time: `prefetched_len`
+	 * bytes at offset `prefetched_offset`. Owned by this.
+	 */
+	uint8_t *prefetched_buf;
+	uint64_t prefetched_offset;
+	uint64_t prefetched_len;
 };
 
 struct lttng_live_metadata {
@@ -190,6 +214,7 @@ struct lttng_live_component {
 	struct {
 		GString *url;
 		enum session_not_found_action sess_not_found_act;
+		uint64_t max_requests_in_flight;
 	} params;
 
 	size_t max_query_size;
@@ -217,6 +242,29 @@ struct lttng_live_msg_iter {
 	/* Number of live stream iterator this message iterator has.*/
 	uint64_t active_stream_iter;
 
+	/*
+	 * Array of pointers to struct lttng_live_stream_iterator (weak
+	 * references) having a current message, organized as a min-heap
+	 * on the timestamp of this current message.
+	 */
+	GPtrArray *ready_stream_iters;
+
+	/*
+	 * Array of pointers to struct lttng_live_stream_iterator (weak
+	 * references) without a current message. New, quiescent and
+	 * no-data live stream iterators are parked here until they get a
+	 * message from the relay daemon or until they end.
+	 */
+	GPtrArray *pending_stream_iters;
+
+	/*
+	 * Queue of pointers to struct lttng_live_stream_iterator (weak
+	 * references) of which the next index can be requested ahead of
+	 * time, along with the index of another stream, when the
+	 * `max-requests-in-flight` parameter is greater than 1.
+	 */
+	GQueue *index_prefetch_queue;
+
 	/* Timestamp in nanosecond of the last message sent downstream. */
 	int64_t last_msg_ts_ns;
 };
@@ -286,6 +334,12 @@ enum bt_msg_iter_medium_status lttng_live_get_stream_bytes(
 		struct lttng_live_msg_iter *lttng_live_msg_iter,
 		struct lttng_live_stream_iterator *stream, uint8_t *buf,
 		uint64_t offset, uint64_t req_len, uint64_t *recv_len);
+void lttng_live_queue_index_prefetch(
+		struct lttng_live_msg_iter *lttng_live_msg_iter,
+		struct lttng_live_stream_iterator *stream);
+void lttng_live_unqueue_index_prefetch(
+		struct lttng_live_msg_iter *lttng_live_msg_iter,
+		struct lttng_live_stream_iterator *stream);
 void lttng_live_add_stream_iterator(struct lttng_live_msg_iter *lttng_live_msg_iter,
 		struct lttng_live_stream_iterator *stream_iter);
 void lttng_live_remove_stream_iterator(struct lttng_live_msg_iter *lttng_live_msg_iter,
@@ -46,6 +46,21 @@
 #include "data-stream.h"
 #include "metadata.h"
 
+/*
+ * Maximum number of bytes at the beginning of a packet which are
+ * requested ahead of time along with its index.
+ */
+#define PREFETCH_PACKET_DATA_SIZE	4096
+
+/* Beginning of a packet to request ahead of time. */
+struct packet_data_prefetch {
+	/* Weak reference. */
+	struct lttng_live_stream_iterator *stream;
+
+	uint64_t offset;
+	uint32_t len;
+};
+
 static
 ssize_t lttng_live_recv(struct live_viewer_connection *viewer_connection,
 		void *buf, size_t len)
@@ -1104,60 +1119,371 @@ void lttng_index_to_packet_index(struct lttng_viewer_index *lindex,
 }
 
 BT_HIDDEN
-enum lttng_live_iterator_status lttng_live_get_next_index(
+void lttng_live_queue_index_prefetch(
 		struct lttng_live_msg_iter *lttng_live_msg_iter,
-		struct lttng_live_stream_iterator *stream,
-		struct packet_index *index)
+		struct lttng_live_stream_iterator *stream)
+{
+	GQueue *queue = lttng_live_msg_iter->index_prefetch_queue;
+
+	if (lttng_live_msg_iter->lttng_live_comp->params.max_requests_in_flight <= 1 ||
+			stream->index_prefetch_link ||
+			stream->has_prefetched_index) {
+		return;
+	}
+
+	g_queue_push_tail(queue, stream);
+	stream->index_prefetch_link = g_queue_peek_tail_link(queue);
+}
+
+BT_HIDDEN
+void lttng_live_unqueue_index_prefetch(
+		struct lttng_live_msg_iter *lttng_live_msg_iter,
+		struct lttng_live_stream_iterator *stream)
+{
+	if (!stream->index_prefetch_link) {
+		return;
+	}
+
+	g_queue_delete_link(lttng_live_msg_iter->index_prefetch_queue,
+		stream->index_prefetch_link);
+	stream->index_prefetch_link = NULL;
+}
+
+/*
+ * Sends `len` bytes of `buf`, which can contain many requests, going on
+ * after partial sends.
+ */
+static
+int send_requests(struct live_viewer_connection *viewer_connection,
+		const char *buf, size_t len)
+{
+	size_t sent = 0;
+
+	while (sent < len) {
+		ssize_t ret_len = lttng_live_send(viewer_connection,
+			buf + sent, len - sent);
+
+		if (ret_len == BT_SOCKET_ERROR) {
+			BT_LOGE("Error sending requests: %s",
+				bt_socket_errormsg());
+			goto error;
+		}
+
+		sent += ret_len;
+	}
+
+	return 0;
+
+error:
+	return -1;
+}
+
+/*
+ * Requests the first bytes of the packets of the `count` streams of
+ * `prefetches` at once and keeps them for the following
+ * lttng_live_get_stream_bytes() calls.
+ *
+ * Failing to get the data of a stream is not an error: this stream
+ * simply requests it again when it needs it.
+ */
+static
+int prefetch_packet_data(struct lttng_live_msg_iter *lttng_live_msg_iter,
+		struct packet_data_prefetch *prefetches, size_t count)
 {
-	struct lttng_viewer_cmd cmd;
-	struct lttng_viewer_get_next_index rq;
-	ssize_t ret_len;
-	struct lttng_viewer_index rp;
-	uint32_t flags, status;
-	enum lttng_live_iterator_status retstatus =
-			LTTNG_LIVE_ITERATOR_STATUS_OK;
 	struct live_viewer_connection *viewer_connection =
 			lttng_live_msg_iter->viewer_connection;
-	struct lttng_live_trace *trace = stream->trace;
-	const size_t cmd_buf_len = sizeof(cmd) + sizeof(rq);
-	char cmd_buf[cmd_buf_len];
-	struct lttng_live_component *lttng_live =
-		lttng_live_msg_iter->lttng_live_comp;
+	const size_t rq_len = sizeof(struct lttng_viewer_cmd) +
+		sizeof(struct lttng_viewer_get_packet);
+	char *cmd_buf;
+	size_t i;
+	int ret = 0;
 
-	cmd.cmd = htobe32(LTTNG_VIEWER_GET_NEXT_INDEX);
-	cmd.data_size = htobe64((uint64_t) sizeof(rq));
-	cmd.cmd_version = htobe32(0);
+	cmd_buf = g_new(char, count * rq_len);
+	if (!cmd_buf) {
+		goto error;
+	}
 
+	for (i = 0; i < count; i++) {
+		struct lttng_viewer_cmd cmd;
+		struct lttng_viewer_get_packet rq;
 
-	memset(&rq, 0, sizeof(rq));
-	rq.stream_id = htobe64(stream->viewer_stream_id);
+		cmd.cmd = htobe32(LTTNG_VIEWER_GET_PACKET);
+		cmd.data_size = htobe64((uint64_t) sizeof(rq));
+		cmd.cmd_version = htobe32(0);
+		memset(&rq, 0, sizeof(rq));
+		rq.stream_id = htobe64(prefetches[i].stream->viewer_stream_id);
+		rq.offset = htobe64(prefetches[i].offset);
+		rq.len = htobe32(prefetches[i].len);
+		memcpy(cmd_buf + i * rq_len, &cmd, sizeof(cmd));
+		memcpy(cmd_buf + i * rq_len + sizeof(cmd), &rq, sizeof(rq));
+	}
 
-	/*
-	 * Merge the cmd and connection request to prevent a write-write
-	 * sequence on the TCP socket. Otherwise, a delayed ACK will prevent the
-	 * second write to be performed quickly in presence of Nagle's algorithm.
-	 */
-	memcpy(cmd_buf, &cmd, sizeof(cmd));
-	memcpy(cmd_buf + sizeof(cmd), &rq, sizeof(rq));
-	ret_len = lttng_live_send(viewer_connection, &cmd_buf, cmd_buf_len);
-	if (ret_len == BT_SOCKET_ERROR) {
-		BT_LOGE("Error sending get_next_index request: %s",
+	if (send_requests(viewer_connection, cmd_buf, count * rq_len)) {
+		goto error;
+	}
+
+	for (i = 0; i < count; i++) {
+		struct lttng_live_stream_iterator *stream = prefetches[i].stream;
+		struct lttng_viewer_trace_packet rp;
+		ssize_t ret_len;
+		uint32_t len;
+
+		stream->prefetched_len = 0;
+		ret_len = lttng_live_recv(viewer_connection, &rp, sizeof(rp));
+		if (ret_len == 0) {
+			BT_LOGI("Remote side has closed connection");
+			goto error;
+		}
+		if (ret_len == BT_SOCKET_ERROR) {
+			BT_LOGE("Error receiving get_data response: %s",
+				bt_socket_errormsg());
+			goto error;
+		}
+		BT_ASSERT(ret_len == sizeof(rp));
+
+		if (be32toh(rp.status) != LTTNG_VIEWER_GET_PACKET_OK) {
+			BT_LOGD("Cannot prefetch packet data: stream-id=%" PRIu64
+				", status=%" PRIu32, stream->viewer_stream_id,
+				be32toh(rp.status));
+			continue;
+		}
+
+		len = be32toh(rp.len);
+		if (len > prefetches[i].len) {
+			BT_LOGE("get_data_packet: expected at most %" PRIu32
+				" bytes, received %" PRIu32,
+				prefetches[i].len, len);
+			goto error;
+		}
+
+		if (len == 0) {
+			continue;
+		}
+
+		if (!stream->prefetched_buf) {
+			stream->prefetched_buf =
+				g_new(uint8_t, PREFETCH_PACKET_DATA_SIZE);
+			if (!stream->prefetched_buf) {
+				goto error;
+			}
+		}
+
+		ret_len = lttng_live_recv(viewer_connection,
+			stream->prefetched_buf, len);
+		if (ret_len == 0) {
+			BT_LOGI("Remote side has closed connection");
+			goto error;
+		}
+		if (ret_len == BT_SOCKET_ERROR) {
+			BT_LOGE("Error receiving trace packet: %s",
 				bt_socket_errormsg());
+			goto error;
+		}
+		BT_ASSERT(ret_len == len);
+		stream->prefetched_offset = prefetches[i].offset;
+		stream->prefetched_len = len;
+	}
+
+	goto end;
+
+error:
+	ret = -1;
+
+end:
+	g_free(cmd_buf);
+	return ret;
+}
+
+/*
+ * Requests the next index of `stream` and sets `rp` to the reply.
+ *
+ * With a `max-requests-in-flight` parameter greater than 1, the
+ * requests of queued streams are sent along with the one of `stream`
+ * before receiving any reply, followed by the requests of the
+ * beginning of the packets of those indexes. Their replies are kept
+ * for the next lttng_live_get_next_index() call of each stream, except
+ * the "retry" and "inactive" ones: those don't change the relay
+ * daemon's state and are only meaningful now, so such a stream sends
+ * its own request later.
+ */
+static
+int request_next_indexes(struct lttng_live_msg_iter *lttng_live_msg_iter,
+		struct lttng_live_stream_iterator *stream,
+		struct lttng_viewer_index *rp)
+{
+	struct live_viewer_connection *viewer_connection =
+			lttng_live_msg_iter->viewer_connection;
+	GQueue *queue = lttng_live_msg_iter->index_prefetch_queue;
+	uint64_t max_requests =
+		lttng_live_msg_iter->lttng_live_comp->params.max_requests_in_flight;
+	const size_t rq_len = sizeof(struct lttng_viewer_cmd) +
+		sizeof(struct lttng_viewer_get_next_index);
+	GPtrArray *streams;
+	struct packet_data_prefetch *prefetches = NULL;
+	size_t prefetch_count = 0;
+	char *cmd_buf = NULL;
+	guint i;
+	int ret = 0;
+
+	BT_ASSERT(!stream->index_prefetch_link);
+	streams = g_ptr_array_new();
+	if (!streams) {
 		goto error;
 	}
 
-	BT_ASSERT(ret_len == cmd_buf_len);
-	ret_len = lttng_live_recv(viewer_connection, &rp, sizeof(rp));
-	if (ret_len == 0) {
-		BT_LOGI("Remote side has closed connection");
+	g_ptr_array_add(streams, stream);
+
+	while (streams->len < max_requests && !g_queue_is_empty(queue)) {
+		struct lttng_live_stream_iterator *other_stream =
+			g_queue_pop_head(queue);
+
+		other_stream->index_prefetch_link = NULL;
+		if (other_stream->state == LTTNG_LIVE_STREAM_EOF ||
+				other_stream->has_prefetched_index) {
+			continue;
+		}
+
+		g_ptr_array_add(streams, other_stream);
+	}
+
+	cmd_buf = g_new(char, streams->len * rq_len);
+	if (!cmd_buf) {
 		goto error;
 	}
-	if (ret_len == BT_SOCKET_ERROR) {
-		BT_LOGE("Error receiving get_next_index response: %s",
-				bt_socket_errormsg());
+
+	for (i = 0; i < streams->len; i++) {
+		struct lttng_live_stream_iterator *cur_stream =
+			g_ptr_array_index(streams, i);
+		struct lttng_viewer_cmd cmd;
+		struct lttng_viewer_get_next_index rq;
+
+		cmd.cmd = htobe32(LTTNG_VIEWER_GET_NEXT_INDEX);
+		cmd.data_size = htobe64((uint64_t) sizeof(rq));
+		cmd.cmd_version = htobe32(0);
+		memset(&rq, 0, sizeof(rq));
+		rq.stream_id = htobe64(cur_stream->viewer_stream_id);
+
+		/*
+		 * Merge the cmd and connection request to prevent a
+		 * write-write sequence on the TCP socket. Otherwise, a
+		 * delayed ACK will prevent the second write to be performed
+		 * quickly in presence of Nagle's algorithm.
+		 */
+		memcpy(cmd_buf + i * rq_len, &cmd, sizeof(cmd));
+		memcpy(cmd_buf + i * rq_len + sizeof(cmd), &rq, sizeof(rq));
+	}
+
+	if (send_requests(viewer_connection, cmd_buf, streams->len * rq_len)) {
 		goto error;
 	}
-	BT_ASSERT(ret_len == sizeof(rp));
+
+	if (max_requests > 1) {
+		prefetches = g_new(struct packet_data_prefetch, streams->len);
+		if (!prefetches) {
+			goto error;
+		}
+	}
+
+	for (i = 0; i < streams->len; i++) {
+		struct lttng_live_stream_iterator *cur_stream =
+			g_ptr_array_index(streams, i);
+		struct lttng_viewer_index cur_rp;
+		ssize_t ret_len;
+		uint64_t packet_len;
+
+		ret_len = lttng_live_recv(viewer_connection, &cur_rp,
+			sizeof(cur_rp));
+		if (ret_len == 0) {
+			BT_LOGI("Remote side has closed connection");
+			goto error;
+		}
+		if (ret_len == BT_SOCKET_ERROR) {
+			BT_LOGE("Error receiving get_next_index response: %s",
+					bt_socket_errormsg());
+			goto error;
+		}
+		BT_ASSERT(ret_len == sizeof(cur_rp));
+
+		if (i == 0) {
+			*rp = cur_rp;
+		} else {
+			switch (be32toh(cur_rp.status)) {
+			case LTTNG_VIEWER_INDEX_RETRY:
+			case LTTNG_VIEWER_INDEX_INACTIVE:
+				continue;
+			default:
+				cur_stream->prefetched_index = cur_rp;
+				cur_stream->has_prefetched_index = true;
+				break;
+			}
+		}
+
+		if (!prefetches ||
+				be32toh(cur_rp.status) != LTTNG_VIEWER_INDEX_OK ||
+				(be32toh(cur_rp.flags) & LTTNG_VIEWER_FLAG_NEW_METADATA)) {
+			continue;
+		}
+
+		packet_len = be64toh(cur_rp.packet_size) / CHAR_BIT;
+		packet_len = MIN(packet_len, PREFETCH_PACKET_DATA_SIZE);
+		packet_len = MIN(packet_len, cur_stream->buflen);
+		if (packet_len == 0) {
+			continue;
+		}
+
+		prefetches[prefetch_count].stream = cur_stream;
+		prefetches[prefetch_count].offset = be64toh(cur_rp.offset);
+		prefetches[prefetch_count].len = (uint32_t) packet_len;
+		prefetch_count++;
+	}
+
+	if (prefetch_count > 0) {
+		if (prefetch_packet_data(lttng_live_msg_iter, prefetches,
+				prefetch_count)) {
+			goto error;
+		}
+	}
+
+	goto end;
+
+error:
+	ret = -1;
+
+end:
+	if (streams) {
+		g_ptr_array_free(streams, TRUE);
+	}
+
+	g_free(cmd_buf);
+	g_free(prefetches);
+	return ret;
+}
+
+BT_HIDDEN
+enum lttng_live_iterator_status lttng_live_get_next_index(
+		struct lttng_live_msg_iter *lttng_live_msg_iter,
+		struct lttng_live_stream_iterator *stream,
+		struct packet_index *index)
+{
+	struct lttng_viewer_index rp;
+	uint32_t flags, status;
+	enum lttng_live_iterator_status retstatus =
+			LTTNG_LIVE_ITERATOR_STATUS_OK;
+	struct lttng_live_trace *trace = stream->trace;
+	struct lttng_live_component *lttng_live =
+		lttng_live_msg_iter->lttng_live_comp;
+
+	if (stream->has_prefetched_index) {
+		BT_LOGD("get_next_index: using prefetched reply: "
+			"stream-id=%" PRIu64, stream->viewer_stream_id);
+		rp = stream->prefetched_index;
+		stream->has_prefetched_index = false;
+	} else {
+		lttng_live_unqueue_index_prefetch(lttng_live_msg_iter, stream);
+		if (request_next_indexes(lttng_live_msg_iter, stream, &rp)) {
+			goto error;
+		}
+	}
 
 	flags = be32toh(rp.flags);
 	status = be32toh(rp.status);
@@ -1205,6 +1531,9 @@ enum lttng_live_iterator_status lttng_live_get_next_index(
 			BT_LOGD("get_next_index: new streams needed");
 			lttng_live_need_new_streams(lttng_live_msg_iter);
 		}
+
+		/* The next index can be requested ahead of time. */
+		lttng_live_queue_index_prefetch(lttng_live_msg_iter, stream);
 		break;
 	}
 	case LTTNG_VIEWER_INDEX_RETRY:
@@ -1265,6 +1594,16 @@ enum bt_msg_iter_medium_status lttng_live_get_stream_bytes(
 
 	BT_LOGD("lttng_live_get_stream_bytes: offset=%" PRIu64 ", req_len=%" PRIu64,
 			offset, req_len);
+	if (stream->prefetched_len > 0 && stream->prefetched_offset == offset &&
+			stream->prefetched_len <= req_len) {
+		BT_LOGD("get_data_packet: using prefetched data, packet size : %" PRIu64,
+			stream->prefetched_len);
+		memcpy(buf, stream->prefetched_buf, stream->prefetched_len);
+		*recv_len = stream->prefetched_len;
+		stream->prefetched_len = 0;
+		goto end;
+	}
+
 	cmd.cmd = htobe32(LTTNG_VIEWER_GET_PACKET);
 	cmd.data_size = htobe64((uint64_t) sizeof(rq));
 	cmd.cmd_version = htobe32(0);
@@ -30,6 +30,7 @@
 
 #include "fs-src/fs.h"
 #include "fs-sink/fs-sink.h"
+#include "columnar-sink/columnar-sink.h"
 #include "lttng-live/lttng-live.h"
 
 #ifndef BT_BUILT_IN_PLUGINS
@@ -64,6 +65,16 @@ BT_PLUGIN_SINK_COMPONENT_CLASS_GRAPH_IS_CONFIGURED_METHOD(fs,
 	ctf_fs_sink_graph_is_configured);
 BT_PLUGIN_SINK_COMPONENT_CLASS_DESCRIPTION(fs, "Write CTF traces to the file system.");
 
+/* ctf.columnar sink */
+BT_PLUGIN_SINK_COMPONENT_CLASS(columnar, ctf_columnar_sink_consume);
+BT_PLUGIN_SINK_COMPONENT_CLASS_INIT_METHOD(columnar, ctf_columnar_sink_init);
+BT_PLUGIN_SINK_COMPONENT_CLASS_FINALIZE_METHOD(columnar,
+	ctf_columnar_sink_finalize);
+BT_PLUGIN_SINK_COMPONENT_CLASS_GRAPH_IS_CONFIGURED_METHOD(columnar,
+	ctf_columnar_sink_graph_is_configured);
+BT_PLUGIN_SINK_COMPONENT_CLASS_DESCRIPTION(columnar,
+	"Write events as columnar tables to the file system.");
+
 /* ctf.lttng-live source */
 BT_PLUGIN_SOURCE_COMPONENT_CLASS_WITH_ID(auto, lttng_live, "lttng-live",
 	lttng_live_msg_iter_next);
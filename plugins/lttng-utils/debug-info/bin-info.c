@@ -35,6 +35,7 @@
 #include <inttypes.h>
 #include <libgen.h>
 #include <math.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -57,6 +58,118 @@
 #define ADDR_STR_LEN 20
 #define BUILD_ID_NOTE_NAME "GNU"
 
+struct bin_info_loader {
+	pthread_t *threads;
+	unsigned int thread_count;
+
+	/* Protects the members below and the bins' `load_state`. */
+	pthread_mutex_t lock;
+	/* Signaled when bins are queued or when the workers must quit. */
+	pthread_cond_t work_cond;
+	/* Signaled when a worker is done loading a bin. */
+	pthread_cond_t done_cond;
+	/* Bins added, but not submitted to the workers yet. */
+	GQueue deferred;
+	/* Bins waiting for a worker. */
+	GQueue queue;
+	bool quit;
+
+	/*
+	 * Serializes the accesses to the file descriptor caches of the
+	 * bins added to this loader.
+	 */
+	pthread_mutex_t fd_cache_lock;
+};
+
+static
+struct bt_fd_cache_handle *bin_info_get_fd_cache_handle(struct bin_info *bin,
+		const char *path)
+{
+	struct bt_fd_cache_handle *handle;
+
+	if (bin->loader) {
+		pthread_mutex_lock(&bin->loader->fd_cache_lock);
+	}
+
+	handle = bt_fd_cache_get_handle(bin->fd_cache, path);
+
+	if (bin->loader) {
+		pthread_mutex_unlock(&bin->loader->fd_cache_lock);
+	}
+
+	return handle;
+}
+
+static
+void bin_info_put_fd_cache_handle(struct bin_info *bin,
+		struct bt_fd_cache_handle *handle)
+{
+	if (bin->loader) {
+		pthread_mutex_lock(&bin->loader->fd_cache_lock);
+	}
+
+	bt_fd_cache_put_handle(bin->fd_cache, handle);
+
+	if (bin->loader) {
+		pthread_mutex_unlock(&bin->loader->fd_cache_lock);
+	}
+}
+
+/*
+ * Takes `bin` back from its loader's workers, if any, waiting for a
+ * worker which is loading it to finish.
+ *
+ * If `keep_scheduled` is true and `bin` is not loaded yet, it is
+ * deferred again, to be loaded after the next
+ * bin_info_loader_start_deferred(); otherwise it's removed from its
+ * loader's queues and the caller loads what it needs itself.
+ */
+static
+void bin_info_take_from_loader(struct bin_info *bin, bool keep_scheduled)
+{
+	struct bin_info_loader *loader = bin->loader;
+
+	if (!loader) {
+		return;
+	}
+
+	pthread_mutex_lock(&loader->lock);
+
+	if (bin->load_state == BIN_INFO_LOAD_STATE_RUNNING) {
+		BT_LOGD("Waiting for a worker to load binary: path=\"%s\"",
+			bin->elf_path);
+
+		while (bin->load_state == BIN_INFO_LOAD_STATE_RUNNING) {
+			pthread_cond_wait(&loader->done_cond, &loader->lock);
+		}
+	}
+
+	switch (bin->load_state) {
+	case BIN_INFO_LOAD_STATE_QUEUED:
+		g_queue_remove(&loader->queue, bin);
+
+		if (keep_scheduled) {
+			g_queue_push_tail(&loader->deferred, bin);
+			bin->load_state = BIN_INFO_LOAD_STATE_DEFERRED;
+		} else {
+			bin->load_state = BIN_INFO_LOAD_STATE_NONE;
+		}
+
+		break;
+	case BIN_INFO_LOAD_STATE_DEFERRED:
+		if (!keep_scheduled) {
+			g_queue_remove(&loader->deferred, bin);
+			bin->load_state = BIN_INFO_LOAD_STATE_NONE;
+		}
+
+		break;
+	default:
+		break;
+	}
+
+	pthread_mutex_unlock(&loader->lock);
+}
+
 BT_HIDDEN
 int bin_info_init(void)
 {
@@ -122,6 +235,9 @@ error:
 	return NULL;
 }
 
+static
+void bin_info_dwarf_index_destroy(struct bin_info_dwarf_index *index);
+
 BT_HIDDEN
 void bin_info_destroy(struct bin_info *bin)
 {
@@ -129,6 +245,7 @@ void bin_info_destroy(struct bin_info *bin)
 		return;
 	}
 
+	bin_info_take_from_loader(bin, false);
 	dwarf_end(bin->dwarf_info);
 
 	g_free(bin->debug_info_dir);
@@ -139,8 +256,14 @@ void bin_info_destroy(struct bin_info *bin)
 
 	elf_end(bin->elf_file);
 
-	bt_fd_cache_put_handle(bin->fd_cache, bin->elf_handle);
-	bt_fd_cache_put_handle(bin->fd_cache, bin->dwarf_handle);
+	if (bin->elf_func_syms) {
+		g_array_free(bin->elf_func_syms, TRUE);
+	}
+
+	bin_info_dwarf_index_destroy(bin->dwarf_index);
+
+	bin_info_put_fd_cache_handle(bin, bin->elf_handle);
+	bin_info_put_fd_cache_handle(bin, bin->dwarf_handle);
 
 	g_free(bin);
 }
@@ -161,7 +284,7 @@ int bin_info_set_elf_file(struct bin_info *bin)
 		goto error;
 	}
 
-	elf_handle = bt_fd_cache_get_handle(bin->fd_cache, bin->elf_path);
+	elf_handle = bin_info_get_fd_cache_handle(bin, bin->elf_path);
 	if (!elf_handle) {
 		BT_LOGD("Failed to open %s", bin->elf_path);
 		goto error;
@@ -185,7 +308,7 @@ int bin_info_set_elf_file(struct bin_info *bin)
 	return 0;
 
 error:
-	bt_fd_cache_put_handle(bin->fd_cache, elf_handle);
+	bin_info_put_fd_cache_handle(bin, elf_handle);
 	elf_end(elf_file);
 	return -1;
 }
@@ -363,6 +486,8 @@ int bin_info_set_build_id(struct bin_info *bin, uint8_t *build_id,
 		goto error;
 	}
 
+	bin_info_take_from_loader(bin, true);
+
 	/* Set the build id. */
 	bin->build_id = g_new0(uint8_t, build_id_len);
 	if (!bin->build_id) {
@@ -404,6 +529,7 @@ int bin_info_set_debug_link(struct bin_info *bin, const char *filename,
 		goto error;
 	}
 
+	bin_info_take_from_loader(bin, true);
 	bin->dbg_link_filename = g_strdup(filename);
 	if (!bin->dbg_link_filename) {
 		goto error;
@@ -445,7 +571,7 @@ int bin_info_set_dwarf_info_from_path(struct bin_info *bin, char *path)
 		goto error;
 	}
 
-	dwarf_handle = bt_fd_cache_get_handle(bin->fd_cache, path);
+	dwarf_handle = bin_info_get_fd_cache_handle(bin, path);
 	if (!dwarf_handle) {
 		goto error;
 	}
@@ -481,7 +607,7 @@ int bin_info_set_dwarf_info_from_path(struct bin_info *bin, char *path)
 	return 0;
 
 error:
-	bt_fd_cache_put_handle(bin->fd_cache, dwarf_handle);
+	bin_info_put_fd_cache_handle(bin, dwarf_handle);
 	dwarf_end(dwarf_info);
 	g_free(dwarf_info);
 	free(cu);
@@ -600,7 +726,7 @@ int is_valid_debug_file(struct bin_info *bin, char *path, uint32_t crc)
 		goto end;
 	}
 
-	debug_handle = bt_fd_cache_get_handle(bin->fd_cache, path);
+	debug_handle = bin_info_get_fd_cache_handle(bin, path);
 	if (!debug_handle) {
 		goto end;
 	}
@@ -614,7 +740,7 @@ int is_valid_debug_file(struct bin_info *bin, char *path, uint32_t crc)
 	ret = (crc == _crc);
 
 end:
-	bt_fd_cache_put_handle(bin->fd_cache, debug_handle);
+	bin_info_put_fd_cache_handle(bin, debug_handle);
 	return ret;
 }
 
@@ -773,52 +899,45 @@ error:
 	return -1;
 }
 
+struct bin_info_elf_func_sym {
+	/* Symbol value (address). */
+	uint64_t addr;
+	/* Index of the section containing the symbol's name. */
+	size_t strtab_index;
+	/* Offset of the symbol's name within this section. */
+	size_t name_offset;
+	/* Position of the symbol within all the symbol tables. */
+	guint position;
+};
+
 /**
- * Try to find the symbol closest to an address within a given ELF
- * section.
- *
- * Only function symbols are taken into account. The symbol's address
- * must precede `addr`. A symbol with a closer address might exist
- * after `addr` but is irrelevant because it cannot encompass `addr`.
- *
- * On success, if found, the out parameters `sym` and `shdr` are
- * set. On failure or if none are found, they remain unchanged.
+ * Append the function symbols of a given ELF section to `syms`
+ * (array of `struct bin_info_elf_func_sym`) if this section is a symbol
+ * table of type `type`.
  *
- * @param scn		ELF section in which to look for the address
- * @param addr		Virtual memory address for which to find the
- *			nearest function symbol
- * @param sym		Out parameter, the nearest function symbol
- * @param shdr		Out parameter, the section header for scn
+ * @param scn		ELF section from which to read the symbols
+ * @param type		Type of the symbol tables to consider
+ *			(SHT_SYMTAB or SHT_DYNSYM)
+ * @param syms		Array to which to append the symbols
  * @returns		0 on success, -1 on failure
  */
 static
-int bin_info_get_nearest_symbol_from_section(Elf_Scn *scn, uint64_t addr,
-		GElf_Sym **sym, GElf_Shdr **shdr)
+int bin_info_append_func_syms_from_section(Elf_Scn *scn, GElf_Word type,
+		GArray *syms)
 {
-	int i;
+	size_t i;
 	size_t symbol_count;
 	Elf_Data *data = NULL;
-	GElf_Shdr *_shdr = NULL;
-	GElf_Sym *nearest_sym = NULL;
-
-	if (!scn || !sym || !shdr) {
-		goto error;
-	}
-
-	_shdr = g_new0(GElf_Shdr, 1);
-	if (!_shdr) {
-		goto error;
-	}
+	GElf_Shdr shdr;
 
-	_shdr = gelf_getshdr(scn, _shdr);
-	if (!_shdr) {
+	if (!gelf_getshdr(scn, &shdr)) {
 		goto error;
 	}
 
-	if (_shdr->sh_type != SHT_SYMTAB) {
+	if (shdr.sh_type != type || shdr.sh_entsize == 0) {
 		/*
-		 * We are only interested in symbol table (symtab)
-		 * sections, skip this one.
+		 * We are only interested in symbol tables of the
+		 * requested type, skip this one.
 		 */
 		goto end;
 	}
@@ -828,51 +947,164 @@ int bin_info_get_nearest_symbol_from_section(Elf_Scn *scn, uint64_t addr,
 		goto error;
 	}
 
-	symbol_count = _shdr->sh_size / _shdr->sh_entsize;
+	symbol_count = shdr.sh_size / shdr.sh_entsize;
 
 	for (i = 0; i < symbol_count; ++i) {
-		GElf_Sym *cur_sym = NULL;
+		GElf_Sym cur_sym;
+		struct bin_info_elf_func_sym func_sym;
 
-		cur_sym = g_new0(GElf_Sym, 1);
-		if (!cur_sym) {
-			goto error;
-		}
-		cur_sym = gelf_getsym(data, i, cur_sym);
-		if (!cur_sym) {
+		if (!gelf_getsym(data, i, &cur_sym)) {
 			goto error;
 		}
-		if (GELF_ST_TYPE(cur_sym->st_info) != STT_FUNC) {
+
+		if (GELF_ST_TYPE(cur_sym.st_info) != STT_FUNC) {
 			/* We're only interested in the functions. */
-			g_free(cur_sym);
 			continue;
 		}
 
-		if (cur_sym->st_value <= addr &&
-				(!nearest_sym ||
-				cur_sym->st_value > nearest_sym->st_value)) {
-			g_free(nearest_sym);
-			nearest_sym = cur_sym;
-		} else {
-			g_free(cur_sym);
-		}
+		func_sym.addr = cur_sym.st_value;
+		func_sym.strtab_index = shdr.sh_link;
+		func_sym.name_offset = cur_sym.st_name;
+		func_sym.position = syms->len;
+		g_array_append_val(syms, func_sym);
 	}
 
 end:
-	if (nearest_sym) {
-		*sym = nearest_sym;
-		*shdr = _shdr;
-	} else {
-		g_free(_shdr);
+	return 0;
+
+error:
+	return -1;
+}
+
+static
+gint compare_elf_func_syms(gconstpointer a, gconstpointer b)
+{
+	const struct bin_info_elf_func_sym *sym_a = a;
+	const struct bin_info_elf_func_sym *sym_b = b;
+
+	if (sym_a->addr < sym_b->addr) {
+		return -1;
+	} else if (sym_a->addr > sym_b->addr) {
+		return 1;
+	} else if (sym_a->position < sym_b->position) {
+		return -1;
+	} else if (sym_a->position > sym_b->position) {
+		return 1;
+	}
+
+	return 0;
+}
+
+/**
+ * Build the sorted array of the function symbols of a given
+ * executable's ELF file.
+ *
+ * The symbols come from the symbol table (symtab) sections or, if
+ * there are none (stripped executable), from the dynamic symbol table
+ * (dynsym) sections. When several symbols share the same address,
+ * only the first one found is kept.
+ *
+ * @param bin		bin_info instance for the executable
+ * @returns		0 on success, -1 on failure
+ */
+static
+int bin_info_build_elf_func_syms(struct bin_info *bin)
+{
+	static const GElf_Word types[] = { SHT_SYMTAB, SHT_DYNSYM };
+	GArray *syms = NULL;
+	size_t type_i;
+	guint i, kept = 0;
+
+	syms = g_array_new(FALSE, FALSE, sizeof(struct bin_info_elf_func_sym));
+	if (!syms) {
+		goto error;
+	}
+
+	for (type_i = 0; type_i < G_N_ELEMENTS(types) && syms->len == 0;
+			type_i++) {
+		Elf_Scn *scn = NULL;
+
+		while ((scn = elf_nextscn(bin->elf_file, scn))) {
+			if (bin_info_append_func_syms_from_section(scn,
+					types[type_i], syms)) {
+				goto error;
+			}
+		}
+	}
+
+	/*
+	 * g_array_sort() is not guaranteed to be stable: break ties
+	 * with the symbols' position to keep, as a linear scan would,
+	 * the first symbol of each address.
+	 */
+	g_array_sort(syms, compare_elf_func_syms);
+
+	for (i = 0; i < syms->len; i++) {
+		struct bin_info_elf_func_sym *sym = &g_array_index(syms,
+			struct bin_info_elf_func_sym, i);
+
+		if (kept > 0 && g_array_index(syms,
+				struct bin_info_elf_func_sym, kept - 1).addr ==
+				sym->addr) {
+			continue;
+		}
+
+		g_array_index(syms, struct bin_info_elf_func_sym, kept) = *sym;
+		kept++;
 	}
 
+	g_array_set_size(syms, kept);
+	bin->elf_func_syms = syms;
+	BT_LOGD("Built ELF function symbol table: elf-path=\"%s\", "
+		"symbol-count=%u", bin->elf_path, kept);
 	return 0;
 
 error:
-	g_free(nearest_sym);
-	g_free(_shdr);
+	if (syms) {
+		g_array_free(syms, TRUE);
+	}
+
 	return -1;
 }
 
+/**
+ * Find the function symbol closest to an address in a given
+ * executable.
+ *
+ * The symbol's address must precede `addr`. A symbol with a closer
+ * address might exist after `addr` but is irrelevant because it cannot
+ * encompass `addr`.
+ *
+ * @param bin		bin_info instance for the executable
+ * @param addr		Virtual memory address for which to find the
+ *			nearest function symbol
+ * @returns		Nearest function symbol, or NULL if none
+ */
+static
+const struct bin_info_elf_func_sym *bin_info_find_nearest_elf_func_sym(
+		struct bin_info *bin, uint64_t addr)
+{
+	const struct bin_info_elf_func_sym *nearest_sym = NULL;
+	guint low = 0;
+	guint high = bin->elf_func_syms->len;
+
+	/* Find the last symbol of which the address is <= `addr`. */
+	while (low < high) {
+		guint mid = low + (high - low) / 2;
+		const struct bin_info_elf_func_sym *sym = &g_array_index(
+			bin->elf_func_syms, struct bin_info_elf_func_sym, mid);
+
+		if (sym->addr <= addr) {
+			nearest_sym = sym;
+			low = mid + 1;
+		} else {
+			high = mid;
+		}
+	}
+
+	return nearest_sym;
+}
+
 /**
  * Get the name of the function containing a given address within an
  * executable using ELF symbols.
@@ -895,16 +1127,8 @@ static
 int bin_info_lookup_elf_function_name(struct bin_info *bin, uint64_t addr,
 		char **func_name)
 {
-	/*
-	 * TODO (possible optimisation): if an ELF has no symtab
-	 * section, it has been stripped. Therefore, it would be wise
-	 * to store a flag indicating the stripped status after the
-	 * first iteration to prevent subsequent ones.
-	 */
 	int ret = 0;
-	Elf_Scn *scn = NULL;
-	GElf_Sym *sym = NULL;
-	GElf_Shdr *shdr = NULL;
+	const struct bin_info_elf_func_sym *sym;
 	char *sym_name = NULL;
 
 	/* Set ELF file if it hasn't been accessed yet. */
@@ -916,45 +1140,536 @@ int bin_info_lookup_elf_function_name(struct bin_info *bin, uint64_t addr,
 		}
 	}
 
-	scn = elf_nextscn(bin->elf_file, scn);
-	if (!scn) {
-		goto error;
-	}
-
-	while (scn && !sym) {
-		ret = bin_info_get_nearest_symbol_from_section(
-				scn, addr, &sym, &shdr);
+	/*
+	 * Build the function symbol table once: this also remembers
+	 * that a stripped ELF file has no function symbols.
+	 */
+	if (!bin->elf_func_syms) {
+		ret = bin_info_build_elf_func_syms(bin);
 		if (ret) {
 			goto error;
 		}
-
-		scn = elf_nextscn(bin->elf_file, scn);
 	}
 
+	sym = bin_info_find_nearest_elf_func_sym(bin, addr);
 	if (sym) {
-		sym_name = elf_strptr(bin->elf_file, shdr->sh_link,
-				sym->st_name);
+		sym_name = elf_strptr(bin->elf_file, sym->strtab_index,
+				sym->name_offset);
 		if (!sym_name) {
+			ret = -1;
 			goto error;
 		}
 
-		ret = bin_info_append_offset_str(sym_name, sym->st_value, addr,
+		ret = bin_info_append_offset_str(sym_name, sym->addr, addr,
 						func_name);
 		if (ret) {
 			goto error;
 		}
 	}
 
-	g_free(shdr);
-	g_free(sym);
 	return 0;
 
 error:
-	g_free(shdr);
-	g_free(sym);
 	return ret;
 }
 
+/*
+ * Address range of a compile unit (CU) or of a subprogram DIE within a
+ * DWARF address range index.
+ */
+struct bin_info_addr_range {
+	/* Range is [low, high). */
+	uint64_t low;
+	uint64_t high;
+	/* Highest `high` of this range and of all the preceding ones. */
+	uint64_t max_high;
+	/* Position of the CU or DIE within the DWARF info. */
+	guint order;
+	/* Offset in bytes in the DWARF file to the DIE. */
+	Dwarf_Off die_offset;
+};
+
+struct bin_info_dwarf_index_cu {
+	/* Same as the members of `struct bt_dwarf_cu`. */
+	Dwarf_Off offset;
+	Dwarf_Off next_offset;
+	size_t header_size;
+	/*
+	 * Array of `struct bin_info_addr_range`: ranges of the
+	 * subprogram DIEs which are children of the CU's root DIE,
+	 * built on the first lookup within this CU. NULL until then.
+	 */
+	GArray *subprogram_ranges;
+};
+
+/*
+ * Address range index of the DWARF info of a bin_info.
+ *
+ * It is built once, on the first DWARF lookup, from the ranges of each
+ * CU's root DIE: a lookup only looks into the CUs which can contain the
+ * address instead of walking all the CUs. Within a CU, the ranges of
+ * the subprograms are indexed on the first lookup which needs them.
+ * Line table rows need no index of ours: libdw already finds a line
+ * within a CU with a binary search.
+ */
+struct bin_info_dwarf_index {
+	/* Array of `struct bin_info_dwarf_index_cu`, in DWARF order. */
+	GArray *cus;
+	/* Array of `struct bin_info_addr_range`, sorted (CU ranges). */
+	GArray *cu_ranges;
+	/*
+	 * Array of `guint`: indexes of the CUs of which the root DIE
+	 * has no address ranges, always looked into.
+	 */
+	GArray *unranged_cus;
+};
+
+static
+void bin_info_dwarf_index_destroy(struct bin_info_dwarf_index *index)
+{
+	if (!index) {
+		return;
+	}
+
+	if (index->cus) {
+		guint i;
+
+		for (i = 0; i < index->cus->len; i++) {
+			struct bin_info_dwarf_index_cu *cu = &g_array_index(
+				index->cus, struct bin_info_dwarf_index_cu, i);
+
+			if (cu->subprogram_ranges) {
+				g_array_free(cu->subprogram_ranges, TRUE);
+			}
+		}
+
+		g_array_free(index->cus, TRUE);
+	}
+
+	if (index->cu_ranges) {
+		g_array_free(index->cu_ranges, TRUE);
+	}
+
+	if (index->unranged_cus) {
+		g_array_free(index->unranged_cus, TRUE);
+	}
+
+	g_free(index);
+}
+
+/**
+ * Append the address ranges of a given DIE to an array of
+ * `struct bin_info_addr_range`.
+ *
+ * @param dwarf_die	DIE of which to append the ranges
+ * @param order		Position of the CU or DIE within the DWARF info
+ * @param ranges	Array to which to append the ranges
+ * @param appended	Out parameter, true if at least one range was
+ *			appended
+ * @returns		0 on success, -1 on failure
+ */
+static
+int bin_info_append_die_ranges(Dwarf_Die *dwarf_die, guint order,
+		GArray *ranges, bool *appended)
+{
+	ptrdiff_t offset = 0;
+	Dwarf_Addr base, start, end;
+
+	*appended = false;
+
+	while ((offset = dwarf_ranges(dwarf_die, offset, &base, &start,
+			&end)) > 0) {
+		struct bin_info_addr_range range;
+
+		if (start >= end) {
+			continue;
+		}
+
+		range.low = start;
+		range.high = end;
+		range.max_high = 0;
+		range.order = order;
+		range.die_offset = dwarf_dieoffset(dwarf_die);
+		g_array_append_val(ranges, range);
+		*appended = true;
+	}
+
+	return offset < 0 ? -1 : 0;
+}
+
+static
+gint compare_addr_ranges(gconstpointer a, gconstpointer b)
+{
+	const struct bin_info_addr_range *range_a = a;
+	const struct bin_info_addr_range *range_b = b;
+
+	if (range_a->low < range_b->low) {
+		return -1;
+	} else if (range_a->low > range_b->low) {
+		return 1;
+	}
+
+	return 0;
+}
+
+/**
+ * Sort an array of `struct bin_info_addr_range` and set the `max_high`
+ * member of each range.
+ *
+ * @param ranges	Array of ranges
+ */
+static
+void bin_info_sort_addr_ranges(GArray *ranges)
+{
+	uint64_t max_high = 0;
+	guint i;
+
+	g_array_sort(ranges, compare_addr_ranges);
+
+	for (i = 0; i < ranges->len; i++) {
+		struct bin_info_addr_range *range = &g_array_index(ranges,
+			struct bin_info_addr_range, i);
+
+		max_high = MAX(max_high, range->high);
+		range->max_high = max_high;
+	}
+}
+
+/**
+ * Find the ranges containing a given address within a sorted array of
+ * `struct bin_info_addr_range` (see bin_info_sort_addr_ranges()).
+ *
+ * @param ranges	Sorted array of ranges
+ * @param addr		Address to look for
+ * @param func		Function called with each range containing
+ *			`addr` (in no particular order) and `data`
+ * @param data		User data for `func`
+ */
+static
+void bin_info_foreach_addr_range_containing(GArray *ranges, uint64_t addr,
+		void (*func)(const struct bin_info_addr_range *, void *),
+		void *data)
+{
+	guint low = 0;
+	guint high = ranges->len;
+
+	/* Find the first range of which the low address is > `addr`. */
+	while (low < high) {
+		guint mid = low + (high - low) / 2;
+
+		if (g_array_index(ranges, struct bin_info_addr_range,
+				mid).low <= addr) {
+			low = mid + 1;
+		} else {
+			high = mid;
+		}
+	}
+
+	/*
+	 * All the preceding ranges start at or before `addr`: walk
+	 * them backwards as long as one of them can still end after
+	 * `addr`.
+	 */
+	while (low > 0) {
+		const struct bin_info_addr_range *range = &g_array_index(
+			ranges, struct bin_info_addr_range, low - 1);
+
+		if (range->max_high <= addr) {
+			break;
+		}
+
+		if (range->high > addr) {
+			func(range, data);
+		}
+
+		low--;
+	}
+}
+
+/**
+ * Build the DWARF address range index of a given bin_info, if it's
+ * not built yet.
+ *
+ * @param bin		bin_info instance
+ * @returns		0 on success, -1 on failure
+ */
+static
+int bin_info_build_dwarf_index(struct bin_info *bin)
+{
+	struct bin_info_dwarf_index *index = NULL;
+	struct bt_dwarf_cu *cu = NULL;
+	struct bt_dwarf_die *cu_die = NULL;
+	int ret;
+
+	if (bin->dwarf_index) {
+		return 0;
+	}
+
+	index = g_new0(struct bin_info_dwarf_index, 1);
+	if (!index) {
+		goto error;
+	}
+
+	index->cus = g_array_new(FALSE, FALSE,
+		sizeof(struct bin_info_dwarf_index_cu));
+	index->cu_ranges = g_array_new(FALSE, FALSE,
+		sizeof(struct bin_info_addr_range));
+	index->unranged_cus = g_array_new(FALSE, FALSE, sizeof(guint));
+	if (!index->cus || !index->cu_ranges || !index->unranged_cus) {
+		goto error;
+	}
+
+	cu = bt_dwarf_cu_create(bin->dwarf_info);
+	if (!cu) {
+		goto error;
+	}
+
+	while ((ret = bt_dwarf_cu_next(cu)) == 0) {
+		struct bin_info_dwarf_index_cu index_cu;
+		guint cu_index = index->cus->len;
+		bool has_ranges;
+
+		index_cu.offset = cu->offset;
+		index_cu.next_offset = cu->next_offset;
+		index_cu.header_size = cu->header_size;
+		index_cu.subprogram_ranges = NULL;
+		g_array_append_val(index->cus, index_cu);
+
+		cu_die = bt_dwarf_die_create(cu);
+		if (!cu_die) {
+			goto error;
+		}
+
+		if (bin_info_append_die_ranges(cu_die->dwarf_die, cu_index,
+				index->cu_ranges, &has_ranges)) {
+			goto error;
+		}
+
+		if (!has_ranges) {
+			g_array_append_val(index->unranged_cus, cu_index);
+		}
+
+		bt_dwarf_die_destroy(cu_die);
+		cu_die = NULL;
+	}
+
+	if (ret < 0) {
+		goto error;
+	}
+
+	bin_info_sort_addr_ranges(index->cu_ranges);
+	BT_LOGD("Built DWARF address range index: elf-path=\"%s\", "
+		"cu-count=%u, cu-range-count=%u, unranged-cu-count=%u",
+		bin->elf_path, index->cus->len, index->cu_ranges->len,
+		index->unranged_cus->len);
+	bin->dwarf_index = index;
+	bt_dwarf_cu_destroy(cu);
+	return 0;
+
+error:
+	bt_dwarf_die_destroy(cu_die);
+	bt_dwarf_cu_destroy(cu);
+	bin_info_dwarf_index_destroy(index);
+	return -1;
+}
+
+static
+void append_range_order(const struct bin_info_addr_range *range, void *data)
+{
+	GArray *orders = data;
+
+	g_array_append_val(orders, range->order);
+}
+
+static
+gint compare_orders(gconstpointer a, gconstpointer b)
+{
+	const guint order_a = *(const guint *) a;
+	const guint order_b = *(const guint *) b;
+
+	return order_a < order_b ? -1 : (order_a > order_b ? 1 : 0);
+}
+
+/**
+ * Get the indexes of the CUs which can contain a given address, in
+ * DWARF order, building the DWARF index of `bin` if needed.
+ *
+ * @param bin		bin_info instance
+ * @param addr		Address to look for
+ * @returns		Array of `guint` (CU indexes within the index) on
+ *			success, NULL on failure
+ */
+static
+GArray *bin_info_get_candidate_cus(struct bin_info *bin, uint64_t addr)
+{
+	GArray *cu_indexes = NULL;
+	guint i, kept = 0;
+
+	if (bin_info_build_dwarf_index(bin)) {
+		goto error;
+	}
+
+	cu_indexes = g_array_new(FALSE, FALSE, sizeof(guint));
+	if (!cu_indexes) {
+		goto error;
+	}
+
+	bin_info_foreach_addr_range_containing(bin->dwarf_index->cu_ranges,
+		addr, append_range_order, cu_indexes);
+	g_array_append_vals(cu_indexes, bin->dwarf_index->unranged_cus->data,
+		bin->dwarf_index->unranged_cus->len);
+	g_array_sort(cu_indexes, compare_orders);
+
+	/* A CU with many ranges could appear more than once */
+	for (i = 0; i < cu_indexes->len; i++) {
+		guint cu_index = g_array_index(cu_indexes, guint, i);
+
+		if (kept > 0 && g_array_index(cu_indexes, guint, kept - 1) ==
+				cu_index) {
+			continue;
+		}
+
+		g_array_index(cu_indexes, guint, kept) = cu_index;
+		kept++;
+	}
+
+	g_array_set_size(cu_indexes, kept);
+	return cu_indexes;
+
+error:
+	if (cu_indexes) {
+		g_array_free(cu_indexes, TRUE);
+	}
+
+	return NULL;
+}
+
+/**
+ * Set the position of a bt_dwarf_cu to a given CU of the DWARF index
+ * of `bin`.
+ *
+ * @param bin		bin_info instance
+ * @param cu_index	Index of the CU within the DWARF index
+ * @param cu		bt_dwarf_cu instance to set
+ */
+static
+void bin_info_set_cu_from_index(struct bin_info *bin, guint cu_index,
+		struct bt_dwarf_cu *cu)
+{
+	const struct bin_info_dwarf_index_cu *index_cu = &g_array_index(
+		bin->dwarf_index->cus, struct bin_info_dwarf_index_cu,
+		cu_index);
+
+	cu->offset = index_cu->offset;
+	cu->next_offset = index_cu->next_offset;
+	cu->header_size = index_cu->header_size;
+}
+
+static
+void keep_first_range(const struct bin_info_addr_range *range, void *data)
+{
+	const struct bin_info_addr_range **first_range = data;
+
+	if (!*first_range || range->order < (*first_range)->order) {
+		*first_range = range;
+	}
+}
+
+/**
+ * Find the first subprogram DIE, among the children of the root DIE
+ * of a given CU, which contains a given address.
+ *
+ * The CU's subprogram ranges are indexed on the first call for this
+ * CU.
+ *
+ * @param bin		bin_info instance
+ * @param cu		bt_dwarf_cu instance, positioned to the CU at
+ *			index `cu_index`
+ * @param cu_index	Index of the CU within the DWARF index
+ * @param addr		Address to look for
+ * @param die		Out parameter, the subprogram DIE if found,
+ *			else NULL
+ * @returns		0 on success, -1 on failure
+ */
+static
+int bin_info_find_cu_subprogram(struct bin_info *bin, struct bt_dwarf_cu *cu,
+		guint cu_index, uint64_t addr, struct bt_dwarf_die **die)
+{
+	struct bin_info_dwarf_index_cu *index_cu = &g_array_index(
+		bin->dwarf_index->cus, struct bin_info_dwarf_index_cu,
+		cu_index);
+	const struct bin_info_addr_range *first_range = NULL;
+	struct bt_dwarf_die *cur_die = NULL;
+	GArray *ranges = NULL;
+	int ret;
+
+	*die = NULL;
+
+	if (!index_cu->subprogram_ranges) {
+		guint order = 0;
+
+		ranges = g_array_new(FALSE, FALSE,
+			sizeof(struct bin_info_addr_range));
+		if (!ranges) {
+			goto error;
+		}
+
+		cur_die = bt_dwarf_die_create(cu);
+		if (!cur_die) {
+			goto error;
+		}
+
+		while ((ret = bt_dwarf_die_next(cur_die)) == 0) {
+			int tag;
+			bool has_ranges;
+
+			if (bt_dwarf_die_get_tag(cur_die, &tag)) {
+				goto error;
+			}
+
+			if (tag == DW_TAG_subprogram &&
+					bin_info_append_die_ranges(
+						cur_die->dwarf_die, order,
+						ranges, &has_ranges)) {
+				goto error;
+			}
+
+			order++;
+		}
+
+		if (ret < 0) {
+			goto error;
+		}
+
+		bt_dwarf_die_destroy(cur_die);
+		cur_die = NULL;
+		bin_info_sort_addr_ranges(ranges);
+		index_cu->subprogram_ranges = ranges;
+		ranges = NULL;
+	}
+
+	bin_info_foreach_addr_range_containing(index_cu->subprogram_ranges,
+		addr, keep_first_range, &first_range);
+	if (first_range) {
+		*die = bt_dwarf_die_create_at_offset(cu,
+			first_range->die_offset);
+		if (!*die) {
+			goto error;
+		}
+	}
+
+	return 0;
+
+error:
+	bt_dwarf_die_destroy(cur_die);
+
+	if (ranges) {
+		g_array_free(ranges, TRUE);
+	}
+
+	return -1;
+}
+
 /**
  * Get the name of the function containing a given address within a
  * given compile unit (CU).
@@ -962,50 +1677,32 @@ error:
  * If found, the out parameter `func_name` is set on success. On
  * failure, it remains unchanged.
  *
+ * @param bin		bin_info instance of which the DWARF index is built
  * @param cu		bt_dwarf_cu instance which may contain the address
+ * @param cu_index	Index of `cu` within the DWARF index of `bin`
  * @param addr		Virtual memory address for which to find the
  *			function name
  * @param func_name	Out parameter, the function name
  * @returns		0 on success, -1 on failure
  */
 static
-int bin_info_lookup_cu_function_name(struct bt_dwarf_cu *cu, uint64_t addr,
+int bin_info_lookup_cu_function_name(struct bin_info *bin,
+		struct bt_dwarf_cu *cu, guint cu_index, uint64_t addr,
 		char **func_name)
 {
 	int ret = 0;
-	bool found = false;
 	struct bt_dwarf_die *die = NULL;
 
 	if (!cu || !func_name) {
 		goto error;
 	}
 
-	die = bt_dwarf_die_create(cu);
-	if (!die) {
+	ret = bin_info_find_cu_subprogram(bin, cu, cu_index, addr, &die);
+	if (ret) {
 		goto error;
 	}
 
-	while (bt_dwarf_die_next(die) == 0) {
-		int tag;
-
-		ret = bt_dwarf_die_get_tag(die, &tag);
-		if (ret) {
-			goto error;
-		}
-
-		if (tag == DW_TAG_subprogram) {
-			ret = bt_dwarf_die_contains_addr(die, addr, &found);
-			if (ret) {
-				goto error;
-			}
-
-			if (found) {
-				break;
-			}
-		}
-	}
-
-	if (found) {
+	if (die) {
 		uint64_t low_addr = 0;
 		char *die_name = NULL;
 
@@ -1057,18 +1754,29 @@ int bin_info_lookup_dwarf_function_name(struct bin_info *bin, uint64_t addr,
 	int ret = 0;
 	char *_func_name = NULL;
 	struct bt_dwarf_cu *cu = NULL;
+	GArray *cu_indexes = NULL;
+	guint i;
 
 	if (!bin || !func_name) {
 		goto error;
 	}
 
+	cu_indexes = bin_info_get_candidate_cus(bin, addr);
+	if (!cu_indexes) {
+		goto error;
+	}
+
 	cu = bt_dwarf_cu_create(bin->dwarf_info);
 	if (!cu) {
 		goto error;
 	}
 
-	while (bt_dwarf_cu_next(cu) == 0) {
-		ret = bin_info_lookup_cu_function_name(cu, addr, &_func_name);
+	for (i = 0; i < cu_indexes->len; i++) {
+		guint cu_index = g_array_index(cu_indexes, guint, i);
+
+		bin_info_set_cu_from_index(bin, cu_index, cu);
+		ret = bin_info_lookup_cu_function_name(bin, cu, cu_index, addr,
+			&_func_name);
 		if (ret) {
 			goto error;
 		}
@@ -1084,10 +1792,15 @@ int bin_info_lookup_dwarf_function_name(struct bin_info *bin, uint64_t addr,
 		goto error;
 	}
 
+	g_array_free(cu_indexes, TRUE);
 	bt_dwarf_cu_destroy(cu);
 	return 0;
 
 error:
+	if (cu_indexes) {
+		g_array_free(cu_indexes, TRUE);
+	}
+
 	bt_dwarf_cu_destroy(cu);
 	return -1;
 }
@@ -1111,6 +1824,8 @@ int bin_info_lookup_function_name(struct bin_info *bin,
 		goto error;
 	}
 
+	bin_info_take_from_loader(bin, false);
+
 	/* Set DWARF info if it hasn't been accessed yet. */
 	if (!bin->dwarf_info && !bin->is_elf_only) {
 		ret = bin_info_set_dwarf_info(bin);
@@ -1280,14 +1995,17 @@ error:
  * the assumption that it is contained within an inline routine in a
  * function.
  *
+ * @param bin		bin_info instance of which the DWARF index is built
  * @param cu		bt_dwarf_cu instance in which to look for the address
+ * @param cu_index	Index of `cu` within the DWARF index of `bin`
  * @param addr		The address for which to look for
  * @param src_loc	Out parameter, the source location (filename and
  *			line number) for the address
  * @returns		0 on success, -1 on failure
  */
 static
-int bin_info_lookup_cu_src_loc_inl(struct bt_dwarf_cu *cu, uint64_t addr,
+int bin_info_lookup_cu_src_loc_inl(struct bin_info *bin,
+		struct bt_dwarf_cu *cu, guint cu_index, uint64_t addr,
 		struct source_location **src_loc)
 {
 	int ret = 0;
@@ -1299,44 +2017,22 @@ int bin_info_lookup_cu_src_loc_inl(struct bt_dwarf_cu *cu, uint64_t addr,
 		goto error;
 	}
 
-	die = bt_dwarf_die_create(cu);
-	if (!die) {
+	ret = bin_info_find_cu_subprogram(bin, cu, cu_index, addr, &die);
+	if (ret) {
 		goto error;
 	}
 
-	while (bt_dwarf_die_next(die) == 0) {
-		int tag;
-
-		ret = bt_dwarf_die_get_tag(die, &tag);
-		if (ret) {
+	if (die) {
+		/*
+		 * Try to find an inlined subroutine child of this DIE
+		 * containing addr.
+		 */
+		ret = bin_info_child_die_has_address(die, addr, &found);
+		if(ret) {
 			goto error;
 		}
-
-		if (tag == DW_TAG_subprogram) {
-			bool contains = false;
-
-			ret = bt_dwarf_die_contains_addr(die, addr, &contains);
-			if (ret) {
-				goto error;
-			}
-
-			if (contains) {
-				/*
-				 * Try to find an inlined subroutine
-				 * child of this DIE containing addr.
-				 */
-				ret = bin_info_child_die_has_address(die, addr,
-						&found);
-				if(ret) {
-					goto error;
-				}
-
-				goto end;
-			}
-		}
 	}
 
-end:
 	if (found) {
 		char *filename = NULL;
 		uint64_t line_no;
@@ -1460,15 +2156,18 @@ error:
  * On success, the out parameter `src_loc` is set if found. On
  * failure, it remains unchanged.
  *
+ * @param bin		bin_info instance of which the DWARF index is built
  * @param cu		bt_dwarf_cu instance for the compile unit which
  *			may contain the address
+ * @param cu_index	Index of `cu` within the DWARF index of `bin`
  * @param addr		Virtual memory address for which to find the
  *			source location
  * @param src_loc	Out parameter, the source location
  * @returns		0 on success, -1 on failure
  */
 static
-int bin_info_lookup_cu_src_loc(struct bt_dwarf_cu *cu, uint64_t addr,
+int bin_info_lookup_cu_src_loc(struct bin_info *bin, struct bt_dwarf_cu *cu,
+		guint cu_index, uint64_t addr,
 		struct source_location **src_loc)
 {
 	int ret = 0;
@@ -1478,7 +2177,8 @@ int bin_info_lookup_cu_src_loc(struct bt_dwarf_cu *cu, uint64_t addr,
 		goto error;
 	}
 
-	ret = bin_info_lookup_cu_src_loc_inl(cu, addr, &_src_loc);
+	ret = bin_info_lookup_cu_src_loc_inl(bin, cu, cu_index, addr,
+		&_src_loc);
 	if (ret) {
 		goto error;
 	}
@@ -1514,6 +2214,8 @@ int bin_info_lookup_source_location(struct bin_info *bin, uint64_t addr,
 {
 	struct bt_dwarf_cu *cu = NULL;
 	struct source_location *_src_loc = NULL;
+	GArray *cu_indexes = NULL;
+	guint i;
 
 	if (!bin || !src_loc) {
 		goto error;
@@ -1527,6 +2229,8 @@ int bin_info_lookup_source_location(struct bin_info *bin, uint64_t addr,
 		goto error;
 	}
 
+	bin_info_take_from_loader(bin, false);
+
 	/* Set DWARF info if it hasn't been accessed yet. */
 	if (!bin->dwarf_info && !bin->is_elf_only) {
 		if (bin_info_set_dwarf_info(bin)) {
@@ -1552,15 +2256,23 @@ int bin_info_lookup_source_location(struct bin_info *bin, uint64_t addr,
 		addr -= bin->low_addr;
 	}
 
+	cu_indexes = bin_info_get_candidate_cus(bin, addr);
+	if (!cu_indexes) {
+		goto error;
+	}
+
 	cu = bt_dwarf_cu_create(bin->dwarf_info);
 	if (!cu) {
 		goto error;
 	}
 
-	while (bt_dwarf_cu_next(cu) == 0) {
+	for (i = 0; i < cu_indexes->len; i++) {
+		guint cu_index = g_array_index(cu_indexes, guint, i);
 		int ret;
 
-		ret = bin_info_lookup_cu_src_loc(cu, addr, &_src_loc);
+		bin_info_set_cu_from_index(bin, cu_index, cu);
+		ret = bin_info_lookup_cu_src_loc(bin, cu, cu_index, addr,
+			&_src_loc);
 		if (ret) {
 			goto error;
 		}
@@ -1570,6 +2282,7 @@ int bin_info_lookup_source_location(struct bin_info *bin, uint64_t addr,
 		}
 	}
 
+	g_array_free(cu_indexes, TRUE);
 	bt_dwarf_cu_destroy(cu);
 	if (_src_loc) {
 		*src_loc = _src_loc;
@@ -1578,7 +2291,189 @@ int bin_info_lookup_source_location(struct bin_info *bin, uint64_t addr,
 	return 0;
 
 error:
+	if (cu_indexes) {
+		g_array_free(cu_indexes, TRUE);
+	}
+
 	source_location_destroy(_src_loc);
 	bt_dwarf_cu_destroy(cu);
 	return -1;
 }
+
+/*
+ * Loads the ELF or DWARF info of `bin` and builds its lookup index, as
+ * the first lookup would.
+ */
+static
+void bin_info_load(struct bin_info *bin)
+{
+	if (bin->build_id && !bin->file_build_id_matches) {
+		/* Lookups fail anyway */
+		return;
+	}
+
+	if (!bin->dwarf_info && !bin->is_elf_only) {
+		if (bin_info_set_dwarf_info(bin)) {
+			bin->is_elf_only = true;
+		}
+	}
+
+	if (bin->is_elf_only) {
+		if (!bin->elf_file && bin_info_set_elf_file(bin)) {
+			return;
+		}
+
+		if (!bin->elf_func_syms) {
+			(void) bin_info_build_elf_func_syms(bin);
+		}
+	} else {
+		(void) bin_info_build_dwarf_index(bin);
+	}
+}
+
+static
+void *bin_info_loader_thread(void *data)
+{
+	struct bin_info_loader *loader = data;
+
+	pthread_mutex_lock(&loader->lock);
+
+	while (true) {
+		struct bin_info *bin;
+
+		while (!loader->quit && g_queue_is_empty(&loader->queue)) {
+			pthread_cond_wait(&loader->work_cond, &loader->lock);
+		}
+
+		if (loader->quit) {
+			break;
+		}
+
+		bin = g_queue_pop_head(&loader->queue);
+		bin->load_state = BIN_INFO_LOAD_STATE_RUNNING;
+		pthread_mutex_unlock(&loader->lock);
+
+		BT_LOGD("Loading binary in the background: path=\"%s\"",
+			bin->elf_path);
+		bin_info_load(bin);
+
+		pthread_mutex_lock(&loader->lock);
+		bin->load_state = BIN_INFO_LOAD_STATE_NONE;
+		pthread_cond_broadcast(&loader->done_cond);
+	}
+
+	pthread_mutex_unlock(&loader->lock);
+	return NULL;
+}
+
+BT_HIDDEN
+struct bin_info_loader *bin_info_loader_create(unsigned int thread_count)
+{
+	struct bin_info_loader *loader;
+	unsigned int i;
+
+	BT_ASSERT(thread_count > 0);
+	loader = g_new0(struct bin_info_loader, 1);
+	if (!loader) {
+		goto error;
+	}
+
+	loader->threads = g_new0(pthread_t, thread_count);
+	if (!loader->threads) {
+		goto error;
+	}
+
+	pthread_mutex_init(&loader->lock, NULL);
+	pthread_mutex_init(&loader->fd_cache_lock, NULL);
+	pthread_cond_init(&loader->work_cond, NULL);
+	pthread_cond_init(&loader->done_cond, NULL);
+	g_queue_init(&loader->deferred);
+	g_queue_init(&loader->queue);
+
+	for (i = 0; i < thread_count; i++) {
+		int ret = pthread_create(&loader->threads[i], NULL,
+			bin_info_loader_thread, loader);
+
+		if (ret) {
+			BT_LOGE("Cannot create binary loader thread: %s",
+				g_strerror(ret));
+			goto error;
+		}
+
+		loader->thread_count++;
+	}
+
+	BT_LOGD("Created binary loader: thread-count=%u", thread_count);
+	return loader;
+
+error:
+	bin_info_loader_destroy(loader);
+	return NULL;
+}
+
+BT_HIDDEN
+void bin_info_loader_destroy(struct bin_info_loader *loader)
+{
+	unsigned int i;
+
+	if (!loader) {
+		return;
+	}
+
+	if (loader->threads) {
+		pthread_mutex_lock(&loader->lock);
+		BT_ASSERT(g_queue_is_empty(&loader->deferred));
+		BT_ASSERT(g_queue_is_empty(&loader->queue));
+		loader->quit = true;
+		pthread_cond_broadcast(&loader->work_cond);
+		pthread_mutex_unlock(&loader->lock);
+
+		for (i = 0; i < loader->thread_count; i++) {
+			pthread_join(loader->threads[i], NULL);
+		}
+
+		pthread_cond_destroy(&loader->done_cond);
+		pthread_cond_destroy(&loader->work_cond);
+		pthread_mutex_destroy(&loader->fd_cache_lock);
+		pthread_mutex_destroy(&loader->lock);
+		g_free(loader->threads);
+	}
+
+	g_free(loader);
+}
+
+BT_HIDDEN
+void bin_info_loader_add(struct bin_info_loader *loader,
+		struct bin_info *bin)
+{
+	BT_ASSERT(loader);
+	BT_ASSERT(bin);
+	BT_ASSERT(!bin->loader);
+	bin->loader = loader;
+	pthread_mutex_lock(&loader->lock);
+	g_queue_push_tail(&loader->deferred, bin);
+	bin->load_state = BIN_INFO_LOAD_STATE_DEFERRED;
+	pthread_mutex_unlock(&loader->lock);
+}
+
+BT_HIDDEN
+void bin_info_loader_start_deferred(struct bin_info_loader *loader)
+{
+	struct bin_info *bin;
+	bool submitted = false;
+
+	BT_ASSERT(loader);
+	pthread_mutex_lock(&loader->lock);
+
+	while ((bin = g_queue_pop_head(&loader->deferred))) {
+		g_queue_push_tail(&loader->queue, bin);
+		bin->load_state = BIN_INFO_LOAD_STATE_QUEUED;
+		submitted = true;
+	}
+
+	if (submitted) {
+		pthread_cond_broadcast(&loader->work_cond);
+	}
+
+	pthread_mutex_unlock(&loader->lock);
+}
@@ -29,6 +29,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <glib.h>
 #include <gelf.h>
 #include <elfutils/libdw.h>
 #include <babeltrace/babeltrace-internal.h>
@@ -40,6 +41,21 @@
 #define BUILD_ID_SUFFIX ".debug"
 #define BUILD_ID_PREFIX_DIR_LEN 2
 
+struct bin_info_dwarf_index;
+struct bin_info_loader;
+
+/* Background loading state of a bin_info (see bin_info_loader_add()). */
+enum bin_info_load_state {
+	/* Not scheduled, or already loaded. */
+	BIN_INFO_LOAD_STATE_NONE,
+	/* Added to a loader, but not submitted to its workers yet. */
+	BIN_INFO_LOAD_STATE_DEFERRED,
+	/* Waiting for a worker. */
+	BIN_INFO_LOAD_STATE_QUEUED,
+	/* Being loaded by a worker. */
+	BIN_INFO_LOAD_STATE_RUNNING,
+};
+
 struct bin_info {
 	/* Base virtual memory address. */
 	uint64_t low_addr;
@@ -65,17 +81,46 @@ struct bin_info {
 	struct bt_fd_cache_handle *dwarf_handle;
 	/* Configuration. */
 	gchar *debug_info_dir;
+	/*
+	 * The following flags are not bit fields: a loader worker can
+	 * set `is_elf_only` while the iterator's thread reads the other
+	 * ones.
+	 */
 	/* Denotes whether the executable is position independent code. */
-	bool is_pic:1;
+	bool is_pic;
 	/* Denotes whether the build id in the trace matches to one on disk. */
-	bool file_build_id_matches:1;
+	bool file_build_id_matches;
 	/*
 	 * Denotes whether the executable only has ELF symbols and no
 	 * DWARF info.
 	 */
-	bool is_elf_only:1;
+	bool is_elf_only;
 	/* Weak ref. Owned by the iterator. */
 	struct bt_fd_cache *fd_cache;
+	/*
+	 * Function symbols of the ELF file (array of
+	 * `struct bin_info_elf_func_sym`, see bin-info.c), sorted by
+	 * address, built on the first ELF function name lookup. NULL
+	 * until then; empty if the ELF file has no function symbols.
+	 */
+	GArray *elf_func_syms;
+	/*
+	 * Address range index of the DWARF info (see bin-info.c),
+	 * built on the first DWARF lookup. NULL until then.
+	 */
+	struct bin_info_dwarf_index *dwarf_index;
+	/*
+	 * Loader which loads the ELF and DWARF info of this bin_info in
+	 * the background, or NULL. Weak ref. Owned by the iterator.
+	 *
+	 * While `load_state` is BIN_INFO_LOAD_STATE_QUEUED or
+	 * BIN_INFO_LOAD_STATE_RUNNING, a worker owns the members above,
+	 * except the immutable ones and the build ID info: the bin_info
+	 * functions take it back first. `load_state` is protected by the
+	 * loader's lock.
+	 */
+	struct bin_info_loader *loader;
+	enum bin_info_load_state load_state;
 };
 
 struct source_location {
@@ -112,6 +157,55 @@ struct bin_info *bin_info_create(struct bt_fd_cache *fdc, const char *path,
 		uint64_t low_addr, uint64_t memsz, bool is_pic,
 		const char *debug_info_dir, const char *target_prefix);
 
+/**
+ * Create a loader which loads the ELF and DWARF info of bin_info
+ * instances in the background with `thread_count` worker threads.
+ *
+ * @param thread_count	Number of worker threads (at least 1)
+ * @returns		Pointer to the new loader on success,
+ *			NULL on failure.
+ */
+BT_HIDDEN
+struct bin_info_loader *bin_info_loader_create(unsigned int thread_count);
+
+/**
+ * Destroy the given loader, joining its worker threads.
+ *
+ * All the bin_info instances added to the loader must be destroyed
+ * first.
+ *
+ * @param loader	Loader to destroy
+ */
+BT_HIDDEN
+void bin_info_loader_destroy(struct bin_info_loader *loader);
+
+/**
+ * Add a bin_info instance to a loader.
+ *
+ * The loader doesn't start loading `bin` until the next call to
+ * bin_info_loader_start_deferred(), so that the build ID and debug
+ * link info of `bin`, which the trace usually provides right after
+ * the binary itself, can be set first without waiting for a worker.
+ *
+ * Once a bin_info is added to a loader, all its file descriptor cache
+ * accesses are serialized with the ones of the workers.
+ *
+ * @param loader	Loader
+ * @param bin		bin_info instance to load in the background
+ */
+BT_HIDDEN
+void bin_info_loader_add(struct bin_info_loader *loader,
+		struct bin_info *bin);
+
+/**
+ * Submit the bin_info instances added to a loader since the last call
+ * to its workers.
+ *
+ * @param loader	Loader
+ */
+BT_HIDDEN
+void bin_info_loader_start_deferred(struct bin_info_loader *loader);
+
 /**
  * Destroy the given bin_info instance
  *
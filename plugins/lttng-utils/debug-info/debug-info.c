@@ -30,6 +30,7 @@
 #include "logging.h"
 
 #include <glib.h>
+#include <unistd.h>
 #include <plugins-common.h>
 
 #include <babeltrace/assert-internal.h>
@@ -38,6 +39,7 @@
 
 #include "bin-info.h"
 #include "debug-info.h"
+#include "sym-cache.h"
 #include "trace-ir-data-copy.h"
 #include "trace-ir-mapping.h"
 #include "trace-ir-metadata-copy.h"
@@ -54,12 +56,15 @@
 #define IS_PIC_FIELD_NAME		"is_pic"
 #define MEMSZ_FIELD_NAME		"memsz"
 #define PATH_FIELD_NAME			"path"
+#define BIN_INFO_LOADER_MAX_THREADS	4
 
 struct debug_info_component {
 	gchar *arg_debug_dir;
 	gchar *arg_debug_info_field_name;
 	gchar *arg_target_prefix;
+	gchar *arg_cache_dir;
 	bt_bool arg_full_path;
+	bt_bool arg_background_loading;
 };
 
 struct debug_info_msg_iter {
@@ -73,6 +78,10 @@ struct debug_info_msg_iter {
 	GHashTable *debug_info_map;
 
 	struct bt_fd_cache fd_cache;
+	/* Persistent symbolization cache, or NULL if not enabled. */
+	struct sym_cache *sym_cache;
+	/* Background binary loader, or NULL if not enabled. */
+	struct bin_info_loader *bin_info_loader;
 };
 
 struct debug_info_source {
@@ -128,6 +137,9 @@ struct debug_info {
 	GQuark q_lib_load;
 	GQuark q_lib_unload;
 	struct bt_fd_cache *fd_cache; /* Weak ref. Owned by the iterator. */
+	struct sym_cache *sym_cache; /* Weak ref. Owned by the iterator. */
+	/* Weak ref. Owned by the iterator. */
+	struct bin_info_loader *bin_info_loader;
 };
 
 static
@@ -163,13 +175,96 @@ void debug_info_source_destroy(struct debug_info_source *debug_info_src)
 	g_free(debug_info_src);
 }
 
+static
+int debug_info_source_set_src_loc(struct debug_info_source *debug_info_src,
+		uint64_t line_no, const char *filename)
+{
+	debug_info_src->line_no = g_strdup_printf("%"PRId64, line_no);
+	if (!debug_info_src->line_no) {
+		BT_LOGD("Error occured when setting line_no field.");
+		goto error;
+	}
+
+	if (filename) {
+		debug_info_src->src_path = g_strdup(filename);
+		if (!debug_info_src->src_path) {
+			goto error;
+		}
+
+		debug_info_src->short_src_path = get_filename_from_path(
+				debug_info_src->src_path);
+	}
+
+	return 0;
+
+error:
+	return -1;
+}
+
+/*
+ * Returns whether or not the results of the lookups of `bin` can be
+ * found in and added to the symbolization cache.
+ *
+ * The cache is keyed by build ID, so that a result is only reused for
+ * the very same binary.
+ */
+static inline
+bool bin_can_use_sym_cache(struct bin_info *bin, struct sym_cache *sym_cache)
+{
+	return sym_cache && bin->build_id && bin->file_build_id_matches;
+}
+
+static inline
+uint64_t bin_sym_cache_addr(struct bin_info *bin, uint64_t ip)
+{
+	return bin->is_pic ? ip - bin->low_addr : ip;
+}
+
+/*
+ * Sets the function name and source location of `debug_info_src` from
+ * the symbolization cache, if it has an entry for `ip`.
+ */
+static
+int debug_info_source_set_from_sym_cache(
+		struct debug_info_source *debug_info_src,
+		struct bin_info *bin, uint64_t ip,
+		struct sym_cache *sym_cache, bool *found)
+{
+	struct sym_cache_entry entry;
+	int ret;
+
+	ret = sym_cache_lookup(sym_cache, bin->build_id, bin->build_id_len,
+		bin_sym_cache_addr(bin, ip), &entry, found);
+	if (ret || !*found) {
+		goto end;
+	}
+
+	if (entry.func_name) {
+		debug_info_src->func = g_strdup(entry.func_name);
+		if (!debug_info_src->func) {
+			ret = -1;
+			goto end;
+		}
+	}
+
+	if (entry.src_path) {
+		ret = debug_info_source_set_src_loc(debug_info_src,
+			entry.line_no, entry.src_path);
+	}
+
+end:
+	return ret;
+}
+
 static
 struct debug_info_source *debug_info_source_create_from_bin(
-		struct bin_info *bin, uint64_t ip)
+		struct bin_info *bin, uint64_t ip, struct sym_cache *sym_cache)
 {
 	int ret;
 	struct debug_info_source *debug_info_src = NULL;
 	struct source_location *src_loc = NULL;
+	uint64_t line_no = 0;
+	bool in_sym_cache = false;
 
 	debug_info_src = g_new0(struct debug_info_source, 1);
 
@@ -177,6 +272,19 @@ struct debug_info_source *debug_info_source_create_from_bin(
 		goto end;
 	}
 
+	if (bin_can_use_sym_cache(bin, sym_cache) &&
+			bin_info_has_address(bin, ip)) {
+		ret = debug_info_source_set_from_sym_cache(debug_info_src,
+			bin, ip, sym_cache, &in_sym_cache);
+		if (ret) {
+			goto error;
+		}
+	}
+
+	if (in_sym_cache) {
+		goto set_bin;
+	}
+
 	/* Lookup function name */
 	ret = bin_info_lookup_function_name(bin, ip, &debug_info_src->func);
 	if (ret) {
@@ -193,25 +301,35 @@ struct debug_info_source *debug_info_source_create_from_bin(
 	}
 
 	if (src_loc) {
-		debug_info_src->line_no =
-			g_strdup_printf("%"PRId64, src_loc->line_no);
-		if (!debug_info_src->line_no) {
-			BT_LOGD("Error occured when setting line_no field.");
+		line_no = src_loc->line_no;
+		ret = debug_info_source_set_src_loc(debug_info_src,
+			src_loc->line_no, src_loc->filename);
+		source_location_destroy(src_loc);
+		if (ret) {
 			goto error;
 		}
+	}
 
-		if (src_loc->filename) {
-			debug_info_src->src_path = g_strdup(src_loc->filename);
-			if (!debug_info_src->src_path) {
-				goto error;
-			}
-
-			debug_info_src->short_src_path = get_filename_from_path(
-					debug_info_src->src_path);
+	/*
+	 * Only cache results found with DWARF info: a binary of which
+	 * the separate debug info is installed later would otherwise
+	 * keep its ELF-only results.
+	 */
+	if (bin_can_use_sym_cache(bin, sym_cache) && !bin->is_elf_only) {
+		struct sym_cache_entry entry = {
+			.func_name = debug_info_src->func,
+			.src_path = debug_info_src->src_path,
+			.line_no = line_no,
+		};
+
+		if (sym_cache_add(sym_cache, bin->build_id, bin->build_id_len,
+				bin_sym_cache_addr(bin, ip), &entry)) {
+			BT_LOGD("Failed to add symbolization cache entry: "
+				"ip=%#" PRIx64, ip);
 		}
-		source_location_destroy(src_loc);
 	}
 
+set_bin:
 	if (bin->elf_path) {
 		debug_info_src->bin_path = g_strdup(bin->elf_path);
 		if (!debug_info_src->bin_path) {
@@ -440,7 +558,8 @@ bool event_has_payload_field(const bt_event *event,
 
 static
 struct debug_info_source *proc_debug_info_sources_get_entry(
-		struct proc_debug_info_sources *proc_dbg_info_src, uint64_t ip)
+		struct proc_debug_info_sources *proc_dbg_info_src, uint64_t ip,
+		struct sym_cache *sym_cache)
 {
 	struct debug_info_source *debug_info_src = NULL;
 	gpointer key = g_new0(uint64_t, 1);
@@ -479,7 +598,8 @@ struct debug_info_source *proc_debug_info_sources_get_entry(
 		 * a caching policy), and entries should be prunned when
 		 * libraries are unmapped.
 		 */
-		debug_info_src = debug_info_source_create_from_bin(bin, ip);
+		debug_info_src = debug_info_source_create_from_bin(bin, ip,
+			sym_cache);
 		if (debug_info_src) {
 			g_hash_table_insert(
 					proc_dbg_info_src->ip_to_debug_info_src,
@@ -508,7 +628,8 @@ struct debug_info_source *debug_info_query(struct debug_info *debug_info,
 		goto end;
 	}
 
-	dbg_info_src = proc_debug_info_sources_get_entry(proc_dbg_info_src, ip);
+	dbg_info_src = proc_debug_info_sources_get_entry(proc_dbg_info_src, ip,
+		debug_info->sym_cache);
 
 end:
 	return dbg_info_src;
@@ -516,7 +637,9 @@ end:
 
 static
 struct debug_info *debug_info_create(struct debug_info_component *comp,
-		const bt_trace *trace, struct bt_fd_cache *fdc)
+		const bt_trace *trace, struct bt_fd_cache *fdc,
+		struct sym_cache *sym_cache,
+		struct bin_info_loader *bin_info_loader)
 {
 	int ret;
 	struct debug_info *debug_info;
@@ -545,6 +668,8 @@ struct debug_info *debug_info_create(struct debug_info_component *comp,
 
 	debug_info->input_trace = trace;
 	debug_info->fd_cache = fdc;
+	debug_info->sym_cache = sym_cache;
+	debug_info->bin_info_loader = bin_info_loader;
 
 end:
 	return debug_info;
@@ -759,6 +884,10 @@ void handle_bin_info_event(struct debug_info *debug_info,
 		goto end;
 	}
 
+	if (debug_info->bin_info_loader) {
+		bin_info_loader_add(debug_info->bin_info_loader, bin);
+	}
+
 	g_hash_table_insert(proc_dbg_info_src->baddr_to_bin_info, key, bin);
 	/* Ownership passed to ht. */
 	key = NULL;
@@ -848,8 +977,12 @@ void trace_debug_info_remove_func(const bt_trace *in_trace, void *data)
 	}
 }
 
+/*
+ * Returns whether or not `event` describes a binary (its load, build ID,
+ * or debug link).
+ */
 static
-void handle_event_statedump(struct debug_info_msg_iter *debug_it,
+bool handle_event_statedump(struct debug_info_msg_iter *debug_it,
 		const bt_event *event)
 {
 	const bt_event_class *event_class;
@@ -857,6 +990,7 @@ void handle_event_statedump(struct debug_info_msg_iter *debug_it,
 	GQuark q_event_name;
 	const bt_trace *trace;
 	struct debug_info *debug_info;
+	bool describes_bin = true;
 
 	BT_ASSERT(debug_it);
 	BT_ASSERT(event);
@@ -871,7 +1005,9 @@ void handle_event_statedump(struct debug_info_msg_iter *debug_it,
 	debug_info = g_hash_table_lookup(debug_it->debug_info_map, trace);
 	if (!debug_info) {
 		debug_info = debug_info_create(debug_it->debug_info_component,
-				trace, &debug_it->fd_cache);
+				trace, &debug_it->fd_cache,
+				debug_it->sym_cache,
+				debug_it->bin_info_loader);
 		g_hash_table_insert(debug_it->debug_info_map, (gpointer) trace,
 				debug_info);
 		bt_trace_add_destruction_listener(trace,
@@ -899,6 +1035,7 @@ void handle_event_statedump(struct debug_info_msg_iter *debug_it,
 	} else if (q_event_name == debug_info->q_statedump_start) {
 		/* Start state dump */
 		handle_event_statedump_start(debug_info, event);
+		describes_bin = false;
 	} else if (q_event_name == debug_info->q_statedump_debug_link) {
 		/* Debug link info */
 		handle_event_statedump_debug_link(debug_info, event);
@@ -907,9 +1044,12 @@ void handle_event_statedump(struct debug_info_msg_iter *debug_it,
 		handle_event_statedump_build_id(debug_info, event);
 	} else if (q_event_name == debug_info-> q_lib_unload) {
 		handle_event_lib_unload(debug_info, event);
+		describes_bin = false;
+	} else {
+		describes_bin = false;
 	}
 
-	return;
+	return describes_bin;
 }
 
 static
@@ -922,6 +1062,7 @@ void destroy_debug_info_comp(struct debug_info_component *debug_info)
 	g_free(debug_info->arg_debug_dir);
 	g_free(debug_info->arg_debug_info_field_name);
 	g_free(debug_info->arg_target_prefix);
+	g_free(debug_info->arg_cache_dir);
 	g_free(debug_info);
 }
 
@@ -1168,10 +1309,15 @@ end:
 	return;
 }
 
+/*
+ * Returns whether or not `in_event` is a statedump event describing a
+ * binary (see handle_event_statedump()).
+ */
 static
-void update_event_statedump_if_needed(struct debug_info_msg_iter *debug_it,
+bool update_event_statedump_if_needed(struct debug_info_msg_iter *debug_it,
 		const bt_event *in_event)
 {
+	bool describes_bin = false;
 	const bt_field *event_common_ctx;
 	const bt_field_class *event_common_ctx_fc;
 	const bt_event_class *in_event_class = bt_event_borrow_class_const(in_event);
@@ -1193,11 +1339,12 @@ void update_event_statedump_if_needed(struct debug_info_msg_iter *debug_it,
 		if (strncmp(in_event_name, LTTNG_UST_STATEDUMP_PREFIX,
 				strlen(LTTNG_UST_STATEDUMP_PREFIX)) == 0) {
 			/* Handle statedump events. */
-			handle_event_statedump(debug_it, in_event);
+			describes_bin = handle_event_statedump(debug_it,
+				in_event);
 		}
 	}
 end:
-	return;
+	return describes_bin;
 }
 
 static
@@ -1219,7 +1366,15 @@ bt_message *handle_event_message(struct debug_info_msg_iter *debug_it,
 	const bt_event_class *in_event_class =
 		bt_event_borrow_class_const(in_event);
 
-	update_event_statedump_if_needed(debug_it, in_event);
+	if (!update_event_statedump_if_needed(debug_it, in_event) &&
+			debug_it->bin_info_loader) {
+		/*
+		 * The events describing the binaries added since the
+		 * last event of another kind are done: start loading
+		 * those binaries.
+		 */
+		bin_info_loader_start_deferred(debug_it->bin_info_loader);
+	}
 
 	out_event_class = trace_ir_mapping_borrow_mapped_event_class(
 			debug_it->ir_maps, in_event_class);
@@ -1740,6 +1895,23 @@ int init_from_params(struct debug_info_component *debug_info_component,
 		debug_info_component->arg_target_prefix = NULL;
 	}
 
+	value = bt_value_map_borrow_entry_value_const(params, "cache-dir");
+	if (value) {
+		debug_info_component->arg_cache_dir =
+			g_strdup(bt_value_string_get(value));
+	} else {
+		debug_info_component->arg_cache_dir = NULL;
+	}
+
+	value = bt_value_map_borrow_entry_value_const(params,
+		"background-loading");
+	if (value) {
+		debug_info_component->arg_background_loading =
+			bt_value_bool_get(value);
+	} else {
+		debug_info_component->arg_background_loading = BT_FALSE;
+	}
+
 	value = bt_value_map_borrow_entry_value_const(params, "full-path");
 	if (value) {
 		debug_info_component->arg_full_path = bt_value_bool_get(value);
@@ -1920,7 +2092,11 @@ void debug_info_msg_iter_destroy(struct debug_info_msg_iter *debug_info_msg_iter
 		g_hash_table_destroy(debug_info_msg_iter->debug_info_map);
 	}
 
+	/* After the bin_info instances, which it can be loading */
+	bin_info_loader_destroy(debug_info_msg_iter->bin_info_loader);
+
 	bt_fd_cache_fini(&debug_info_msg_iter->fd_cache);
+	sym_cache_destroy(debug_info_msg_iter->sym_cache);
 	g_free(debug_info_msg_iter);
 
 end:
@@ -1998,6 +2174,26 @@ bt_self_message_iterator_status debug_info_msg_iter_init(
 		goto error;
 	}
 
+	if (debug_info_msg_iter->debug_info_component->arg_cache_dir) {
+		debug_info_msg_iter->sym_cache = sym_cache_create(
+			debug_info_msg_iter->debug_info_component->arg_cache_dir);
+		if (!debug_info_msg_iter->sym_cache) {
+			status = BT_SELF_MESSAGE_ITERATOR_STATUS_NOMEM;
+			goto error;
+		}
+	}
+
+	if (debug_info_msg_iter->debug_info_component->arg_background_loading) {
+		long cpu_count = sysconf(_SC_NPROCESSORS_ONLN);
+
+		debug_info_msg_iter->bin_info_loader = bin_info_loader_create(
+			CLAMP(cpu_count, 1, BIN_INFO_LOADER_MAX_THREADS));
+		if (!debug_info_msg_iter->bin_info_loader) {
+			status = BT_SELF_MESSAGE_ITERATOR_STATUS_ERROR;
+			goto error;
+		}
+	}
+
 	bt_self_message_iterator_set_data(self_msg_iter, debug_info_msg_iter);
 	debug_info_msg_iter->input_iterator = self_msg_iter;
 
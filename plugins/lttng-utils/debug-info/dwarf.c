@@ -82,8 +82,9 @@ end:
 	return ret;
 }
 
-BT_HIDDEN
-struct bt_dwarf_die *bt_dwarf_die_create(struct bt_dwarf_cu *cu)
+static
+struct bt_dwarf_die *create_die_at_offset(struct bt_dwarf_cu *cu,
+		Dwarf_Off die_offset, unsigned int depth)
 {
 	Dwarf_Die *dwarf_die = NULL;
 	struct bt_dwarf_die *die = NULL;
@@ -97,8 +98,7 @@ struct bt_dwarf_die *bt_dwarf_die_create(struct bt_dwarf_cu *cu)
 		goto error;
 	}
 
-	dwarf_die = dwarf_offdie(cu->dwarf_info, cu->offset + cu->header_size,
-			dwarf_die);
+	dwarf_die = dwarf_offdie(cu->dwarf_info, die_offset, dwarf_die);
 	if (!dwarf_die) {
 		goto error;
 	}
@@ -110,7 +110,7 @@ struct bt_dwarf_die *bt_dwarf_die_create(struct bt_dwarf_cu *cu)
 
 	die->cu = cu;
 	die->dwarf_die = dwarf_die;
-	die->depth = 0;
+	die->depth = depth;
 
 	return die;
 
@@ -120,6 +120,23 @@ error:
 	return NULL;
 }
 
+BT_HIDDEN
+struct bt_dwarf_die *bt_dwarf_die_create(struct bt_dwarf_cu *cu)
+{
+	if (!cu) {
+		return NULL;
+	}
+
+	return create_die_at_offset(cu, cu->offset + cu->header_size, 0);
+}
+
+BT_HIDDEN
+struct bt_dwarf_die *bt_dwarf_die_create_at_offset(struct bt_dwarf_cu *cu,
+		Dwarf_Off die_offset)
+{
+	return create_die_at_offset(cu, die_offset, 1);
+}
+
 BT_HIDDEN
 void bt_dwarf_die_destroy(struct bt_dwarf_die *die)
 {
@@ -111,6 +111,20 @@ int bt_dwarf_cu_next(struct bt_dwarf_cu *cu);
 BT_HIDDEN
 struct bt_dwarf_die *bt_dwarf_die_create(struct bt_dwarf_cu *cu);
 
+/**
+ * Instantiate a structure to access the debug information entry (DIE)
+ * located at `die_offset` in the DWARF file, which must be a child of
+ * the root DIE of the compile unit `cu`.
+ *
+ * @param cu		bt_dwarf_cu instance
+ * @param die_offset	Offset in bytes in the DWARF file to the DIE
+ * @returns		Pointer to the new bt_dwarf_die on success,
+ *			NULL on failure.
+ */
+BT_HIDDEN
+struct bt_dwarf_die *bt_dwarf_die_create_at_offset(struct bt_dwarf_cu *cu,
+		Dwarf_Off die_offset);
+
 /**
  * Destroy the given bt_dwarf_die instance.
  *
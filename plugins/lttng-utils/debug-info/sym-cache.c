@@ -0,0 +1,687 @@
+/*
+ * sym-cache.c
+ *
+ * Babeltrace - Persistent Symbolization Cache
+ *
+ * Copyright 2019 - EfficiOS Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#define BT_LOG_TAG "PLUGIN-CTF-LTTNG-UTILS-DEBUG-INFO-FLT-SYM-CACHE"
+#include "logging.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#include <babeltrace/assert-internal.h>
+
+#include "sym-cache.h"
+
+#define SYM_CACHE_FILE_MAGIC		"BTSYMCCH"
+#define SYM_CACHE_FILE_VERSION		1
+#define SYM_CACHE_FILE_BYTE_ORDER	0x01020304
+#define SYM_CACHE_FILE_SUFFIX		".symcache"
+#define SYM_CACHE_RECORD_ALIGN		8
+
+struct sym_cache_file_header {
+	char magic[8];
+	uint32_t version;
+	/* SYM_CACHE_FILE_BYTE_ORDER, in the byte order of the writer. */
+	uint32_t byte_order;
+};
+
+/*
+ * A record is followed by the function name and the source file name
+ * (each one including its null character, if any) and padded to a
+ * multiple of SYM_CACHE_RECORD_ALIGN bytes.
+ */
+struct sym_cache_record {
+	/* Size of the record, including this header and the padding. */
+	uint32_t size;
+	/* Checksum of the record, from `addr` to the end of the padding. */
+	uint32_t checksum;
+	uint64_t addr;
+	uint64_t line_no;
+	/* Lengths, including the null character, of the strings (0: none). */
+	uint32_t func_name_len;
+	uint32_t src_path_len;
+};
+
+struct sym_cache_file {
+	gchar *path;
+	/* Read-only mapping of the file as it was when loaded, or NULL. */
+	void *map;
+	size_t map_size;
+	/* Records added by this process (`struct sym_cache_record *`). */
+	GPtrArray *added_records;
+	/*
+	 * Address (pointer to the `addr` member of a record) to
+	 * `const struct sym_cache_record *`, within `map` or
+	 * `added_records`.
+	 */
+	GHashTable *records;
+	/* File descriptor used to append records, or -1 if not open yet. */
+	int append_fd;
+	/* The file is not a valid cache file: never append to it. */
+	bool is_unusable;
+};
+
+struct sym_cache {
+	gchar *dir;
+	/* Build ID as an hexadecimal string to `struct sym_cache_file *`. */
+	GHashTable *files;
+};
+
+static
+uint32_t sym_cache_record_checksum(const struct sym_cache_record *record)
+{
+	const uint8_t *byte = (const uint8_t *) &record->addr;
+	const uint8_t *end = (const uint8_t *) record + record->size;
+	uint32_t hash = UINT32_C(2166136261);
+
+	/* 32-bit FNV-1a */
+	for (; byte < end; byte++) {
+		hash ^= *byte;
+		hash *= UINT32_C(16777619);
+	}
+
+	return hash;
+}
+
+static inline
+const char *sym_cache_record_func_name(const struct sym_cache_record *record)
+{
+	return record->func_name_len == 0 ? NULL :
+		(const char *) (record + 1);
+}
+
+static inline
+const char *sym_cache_record_src_path(const struct sym_cache_record *record)
+{
+	return record->src_path_len == 0 ? NULL :
+		(const char *) (record + 1) + record->func_name_len;
+}
+
+/*
+ * Returns whether or not `record`, of which at most `avail` bytes are
+ * available, is a complete and valid record.
+ */
+static
+bool sym_cache_record_is_valid(const struct sym_cache_record *record,
+		size_t avail)
+{
+	const char *str;
+
+	if (avail < sizeof(*record) || record->size < sizeof(*record) ||
+			record->size > avail ||
+			record->size % SYM_CACHE_RECORD_ALIGN != 0) {
+		return false;
+	}
+
+	if ((uint64_t) sizeof(*record) + record->func_name_len +
+			record->src_path_len > record->size) {
+		return false;
+	}
+
+	if (sym_cache_record_checksum(record) != record->checksum) {
+		return false;
+	}
+
+	str = sym_cache_record_func_name(record);
+	if (str && str[record->func_name_len - 1] != '\0') {
+		return false;
+	}
+
+	str = sym_cache_record_src_path(record);
+	if (str && str[record->src_path_len - 1] != '\0') {
+		return false;
+	}
+
+	return true;
+}
+
+static
+void sym_cache_file_destroy(struct sym_cache_file *file)
+{
+	if (!file) {
+		return;
+	}
+
+	if (file->records) {
+		g_hash_table_destroy(file->records);
+	}
+
+	if (file->added_records) {
+		g_ptr_array_free(file->added_records, TRUE);
+	}
+
+	if (file->map) {
+		if (munmap(file->map, file->map_size)) {
+			BT_LOGE("Cannot unmap symbolization cache file: "
+				"path=\"%s\", %s", file->path,
+				g_strerror(errno));
+		}
+	}
+
+	if (file->append_fd >= 0) {
+		if (close(file->append_fd)) {
+			BT_LOGE("Cannot close symbolization cache file: "
+				"path=\"%s\", %s", file->path,
+				g_strerror(errno));
+		}
+	}
+
+	g_free(file->path);
+	g_free(file);
+}
+
+static
+bool sym_cache_file_header_is_valid(const struct sym_cache_file_header *header)
+{
+	return memcmp(header->magic, SYM_CACHE_FILE_MAGIC,
+			sizeof(header->magic)) == 0 &&
+		header->version == SYM_CACHE_FILE_VERSION &&
+		header->byte_order == SYM_CACHE_FILE_BYTE_ORDER;
+}
+
+/*
+ * Maps the existing cache file, if any, and indexes its records.
+ *
+ * A missing or empty file is not an error: it's created when the first
+ * record is appended.
+ */
+static
+int sym_cache_file_load(struct sym_cache_file *file)
+{
+	struct stat st;
+	size_t offset;
+	int fd;
+	int ret = 0;
+
+	fd = open(file->path, O_RDONLY);
+	if (fd < 0) {
+		if (errno == ENOENT) {
+			goto end;
+		}
+
+		BT_LOGW("Cannot open symbolization cache file: "
+			"path=\"%s\", %s", file->path, g_strerror(errno));
+		goto error;
+	}
+
+	if (fstat(fd, &st)) {
+		BT_LOGW("Cannot get the size of the symbolization cache file: "
+			"path=\"%s\", %s", file->path, g_strerror(errno));
+		goto error;
+	}
+
+	if (st.st_size < (off_t) sizeof(struct sym_cache_file_header)) {
+		/* Still being created by another process */
+		goto end;
+	}
+
+	file->map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	if (file->map == MAP_FAILED) {
+		file->map = NULL;
+		BT_LOGW("Cannot map symbolization cache file: "
+			"path=\"%s\", %s", file->path, g_strerror(errno));
+		goto error;
+	}
+
+	file->map_size = st.st_size;
+
+	if (!sym_cache_file_header_is_valid(file->map)) {
+		BT_LOGW("Invalid symbolization cache file header: path=\"%s\"",
+			file->path);
+		goto error;
+	}
+
+	offset = sizeof(struct sym_cache_file_header);
+
+	while (offset < file->map_size) {
+		const struct sym_cache_record *record =
+			(const void *) ((const char *) file->map + offset);
+
+		if (!sym_cache_record_is_valid(record,
+				file->map_size - offset)) {
+			const size_t invalid_offset = offset;
+
+			/*
+			 * A record which a process did not finish to write,
+			 * for example: skip to the next valid record, which
+			 * starts at a multiple of the record alignment.
+			 */
+			do {
+				offset += SYM_CACHE_RECORD_ALIGN;
+				record = (const void *)
+					((const char *) file->map + offset);
+			} while (offset < file->map_size &&
+				!sym_cache_record_is_valid(record,
+					file->map_size - offset));
+
+			BT_LOGW("Skipping invalid data in symbolization cache "
+				"file: path=\"%s\", offset=%zu, size=%zu",
+				file->path, invalid_offset,
+				offset - invalid_offset);
+			continue;
+		}
+
+		if (!g_hash_table_contains(file->records, &record->addr)) {
+			g_hash_table_insert(file->records,
+				(gpointer) &record->addr, (gpointer) record);
+		}
+
+		offset += record->size;
+	}
+
+	BT_LOGD("Loaded symbolization cache file: path=\"%s\", "
+		"record-count=%u", file->path,
+		g_hash_table_size(file->records));
+	goto end;
+
+error:
+	file->is_unusable = true;
+	ret = -1;
+
+end:
+	if (fd >= 0) {
+		if (close(fd)) {
+			BT_LOGE("Cannot close symbolization cache file: "
+				"path=\"%s\", %s", file->path,
+				g_strerror(errno));
+		}
+	}
+
+	return ret;
+}
+
+static
+int write_all(int fd, const void *buf, size_t len)
+{
+	const char *cur = buf;
+
+	while (len > 0) {
+		ssize_t written = write(fd, cur, len);
+
+		if (written < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+
+			return -1;
+		}
+
+		cur += written;
+		len -= written;
+	}
+
+	return 0;
+}
+
+/*
+ * Appends `record` to the cache file, creating the cache directory and
+ * the file if needed.
+ *
+ * The file is locked exclusively while appending so that records of
+ * concurrent processes never interleave.
+ */
+static
+int sym_cache_file_append(struct sym_cache *cache, struct sym_cache_file *file,
+		const struct sym_cache_record *record)
+{
+	struct stat st;
+	bool locked = false;
+	int ret = 0;
+
+	if (file->is_unusable) {
+		goto end;
+	}
+
+	if (file->append_fd < 0) {
+		if (g_mkdir_with_parents(cache->dir, 0755)) {
+			BT_LOGW("Cannot create symbolization cache directory: "
+				"path=\"%s\", %s", cache->dir,
+				g_strerror(errno));
+			goto error;
+		}
+
+		file->append_fd = open(file->path,
+			O_RDWR | O_APPEND | O_CREAT, 0644);
+		if (file->append_fd < 0) {
+			BT_LOGW("Cannot open symbolization cache file for "
+				"appending: path=\"%s\", %s", file->path,
+				g_strerror(errno));
+			goto error;
+		}
+	}
+
+	while (flock(file->append_fd, LOCK_EX)) {
+		if (errno != EINTR) {
+			BT_LOGW("Cannot lock symbolization cache file: "
+				"path=\"%s\", %s", file->path,
+				g_strerror(errno));
+			goto error;
+		}
+	}
+
+	locked = true;
+
+	if (fstat(file->append_fd, &st)) {
+		BT_LOGW("Cannot get the size of the symbolization cache file: "
+			"path=\"%s\", %s", file->path, g_strerror(errno));
+		goto error;
+	}
+
+	if (st.st_size == 0) {
+		struct sym_cache_file_header header;
+
+		memcpy(header.magic, SYM_CACHE_FILE_MAGIC,
+			sizeof(header.magic));
+		header.version = SYM_CACHE_FILE_VERSION;
+		header.byte_order = SYM_CACHE_FILE_BYTE_ORDER;
+
+		if (write_all(file->append_fd, &header, sizeof(header))) {
+			BT_LOGW("Cannot write symbolization cache file header: "
+				"path=\"%s\", %s", file->path,
+				g_strerror(errno));
+			goto error;
+		}
+	} else {
+		struct sym_cache_file_header header;
+		size_t misalignment;
+
+		/*
+		 * Another process could have created the file since
+		 * it was loaded: check its header.
+		 */
+		if (st.st_size < (off_t) sizeof(header) ||
+				pread(file->append_fd, &header, sizeof(header),
+					0) != sizeof(header) ||
+				!sym_cache_file_header_is_valid(&header)) {
+			BT_LOGW("Not appending to invalid symbolization cache "
+				"file: path=\"%s\"", file->path);
+			file->is_unusable = true;
+			goto end;
+		}
+
+		/*
+		 * A size which is not a multiple of the record alignment
+		 * means a record was partially written: pad it so that
+		 * the appended record is aligned. Loading the file skips
+		 * the partial record.
+		 */
+		misalignment = (st.st_size - sizeof(header)) %
+			SYM_CACHE_RECORD_ALIGN;
+		if (misalignment != 0 && ftruncate(file->append_fd,
+				st.st_size + SYM_CACHE_RECORD_ALIGN -
+					misalignment)) {
+			BT_LOGW("Cannot pad symbolization cache file: "
+				"path=\"%s\", %s", file->path,
+				g_strerror(errno));
+			goto error;
+		}
+	}
+
+	if (write_all(file->append_fd, record, record->size)) {
+		BT_LOGW("Cannot append record to symbolization cache file: "
+			"path=\"%s\", %s", file->path, g_strerror(errno));
+		goto error;
+	}
+
+	goto end;
+
+error:
+	file->is_unusable = true;
+	ret = -1;
+
+end:
+	if (locked) {
+		if (flock(file->append_fd, LOCK_UN)) {
+			BT_LOGE("Cannot unlock symbolization cache file: "
+				"path=\"%s\", %s", file->path,
+				g_strerror(errno));
+		}
+	}
+
+	return ret;
+}
+
+static
+struct sym_cache_file *sym_cache_borrow_file(struct sym_cache *cache,
+		const uint8_t *build_id, size_t build_id_len)
+{
+	struct sym_cache_file *file = NULL;
+	GString *build_id_str;
+	gchar *file_name = NULL;
+	size_t i;
+
+	build_id_str = g_string_sized_new(build_id_len * 2);
+	if (!build_id_str) {
+		goto error;
+	}
+
+	for (i = 0; i < build_id_len; i++) {
+		g_string_append_printf(build_id_str, "%02x", build_id[i]);
+	}
+
+	file = g_hash_table_lookup(cache->files, build_id_str->str);
+	if (file) {
+		g_string_free(build_id_str, TRUE);
+		goto end;
+	}
+
+	file = g_new0(struct sym_cache_file, 1);
+	if (!file) {
+		goto error;
+	}
+
+	file->append_fd = -1;
+	file_name = g_strdup_printf("%s%s", build_id_str->str,
+		SYM_CACHE_FILE_SUFFIX);
+	if (!file_name) {
+		goto error;
+	}
+
+	file->path = g_build_filename(cache->dir, file_name, NULL);
+	if (!file->path) {
+		goto error;
+	}
+
+	file->added_records = g_ptr_array_new_with_free_func(g_free);
+	if (!file->added_records) {
+		goto error;
+	}
+
+	file->records = g_hash_table_new(g_int64_hash, g_int64_equal);
+	if (!file->records) {
+		goto error;
+	}
+
+	/* On failure, the file is only used in memory */
+	(void) sym_cache_file_load(file);
+
+	/* Ownership of the key passed to the hash table */
+	g_hash_table_insert(cache->files, g_string_free(build_id_str, FALSE),
+		file);
+	g_free(file_name);
+	goto end;
+
+error:
+	if (build_id_str) {
+		g_string_free(build_id_str, TRUE);
+	}
+
+	g_free(file_name);
+	sym_cache_file_destroy(file);
+	file = NULL;
+
+end:
+	return file;
+}
+
+BT_HIDDEN
+struct sym_cache *sym_cache_create(const char *dir)
+{
+	struct sym_cache *cache;
+
+	BT_ASSERT(dir);
+	cache = g_new0(struct sym_cache, 1);
+	if (!cache) {
+		goto error;
+	}
+
+	cache->dir = g_strdup(dir);
+	if (!cache->dir) {
+		goto error;
+	}
+
+	cache->files = g_hash_table_new_full(g_str_hash, g_str_equal,
+		g_free, (GDestroyNotify) sym_cache_file_destroy);
+	if (!cache->files) {
+		goto error;
+	}
+
+	return cache;
+
+error:
+	sym_cache_destroy(cache);
+	return NULL;
+}
+
+BT_HIDDEN
+void sym_cache_destroy(struct sym_cache *cache)
+{
+	if (!cache) {
+		return;
+	}
+
+	if (cache->files) {
+		g_hash_table_destroy(cache->files);
+	}
+
+	g_free(cache->dir);
+	g_free(cache);
+}
+
+BT_HIDDEN
+int sym_cache_lookup(struct sym_cache *cache, const uint8_t *build_id,
+		size_t build_id_len, uint64_t addr,
+		struct sym_cache_entry *entry, bool *found)
+{
+	struct sym_cache_file *file;
+	const struct sym_cache_record *record;
+
+	BT_ASSERT(cache);
+	BT_ASSERT(build_id);
+	BT_ASSERT(entry);
+	BT_ASSERT(found);
+
+	file = sym_cache_borrow_file(cache, build_id, build_id_len);
+	if (!file) {
+		return -1;
+	}
+
+	record = g_hash_table_lookup(file->records, &addr);
+	*found = record != NULL;
+	if (record) {
+		entry->func_name = sym_cache_record_func_name(record);
+		entry->src_path = sym_cache_record_src_path(record);
+		entry->line_no = record->line_no;
+	}
+
+	return 0;
+}
+
+BT_HIDDEN
+int sym_cache_add(struct sym_cache *cache, const uint8_t *build_id,
+		size_t build_id_len, uint64_t addr,
+		const struct sym_cache_entry *entry)
+{
+	struct sym_cache_file *file;
+	struct sym_cache_record *record;
+	size_t func_name_len = 0, src_path_len = 0;
+	uint64_t size;
+
+	BT_ASSERT(cache);
+	BT_ASSERT(build_id);
+	BT_ASSERT(entry);
+
+	file = sym_cache_borrow_file(cache, build_id, build_id_len);
+	if (!file) {
+		return -1;
+	}
+
+	if (g_hash_table_contains(file->records, &addr)) {
+		return 0;
+	}
+
+	if (entry->func_name) {
+		func_name_len = strlen(entry->func_name) + 1;
+	}
+
+	if (entry->src_path) {
+		src_path_len = strlen(entry->src_path) + 1;
+	}
+
+	size = sizeof(*record) + (uint64_t) func_name_len + src_path_len;
+	size = (size + SYM_CACHE_RECORD_ALIGN - 1) &
+		~((uint64_t) SYM_CACHE_RECORD_ALIGN - 1);
+	if (size > UINT32_MAX) {
+		BT_LOGW("Symbolization cache record is too large: "
+			"addr=%#" PRIx64 ", size=%" PRIu64, addr, size);
+		return -1;
+	}
+
+	/* Zeroed padding */
+	record = g_malloc0(size);
+	if (!record) {
+		return -1;
+	}
+
+	record->size = size;
+	record->addr = addr;
+	record->line_no = entry->src_path ? entry->line_no : 0;
+	record->func_name_len = func_name_len;
+	record->src_path_len = src_path_len;
+	if (entry->func_name) {
+		memcpy(record + 1, entry->func_name, func_name_len);
+	}
+
+	if (entry->src_path) {
+		memcpy((char *) (record + 1) + func_name_len, entry->src_path,
+			src_path_len);
+	}
+
+	record->checksum = sym_cache_record_checksum(record);
+	g_ptr_array_add(file->added_records, record);
+	g_hash_table_insert(file->records, &record->addr, record);
+	return sym_cache_file_append(cache, file, record);
+}
@@ -0,0 +1,121 @@
+#ifndef _BABELTRACE_SYM_CACHE_H
+#define _BABELTRACE_SYM_CACHE_H
+
+/*
+ * sym-cache.h
+ *
+ * Babeltrace - Persistent Symbolization Cache
+ *
+ * Copyright 2019 - EfficiOS Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * The symbolization cache keeps, in a directory, one file per build ID
+ * containing the resolved function name and source location of
+ * addresses within the binary having this build ID.
+ *
+ * A cache file is memory-mapped when first needed and only ever
+ * appended to, under an exclusive advisory lock, so that many
+ * processes can share the same cache directory. A record which is
+ * truncated or corrupted (for example because a process was killed
+ * while appending it) ends the readable part of the file: delete the
+ * file to start over.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <babeltrace/babeltrace-internal.h>
+
+struct sym_cache;
+
+struct sym_cache_entry {
+	/* Function name, or NULL if unknown. */
+	const char *func_name;
+	/* Source file name, or NULL if the source location is unknown. */
+	const char *src_path;
+	/* Source line number, meaningful if `src_path` is not NULL. */
+	uint64_t line_no;
+};
+
+/**
+ * Create a symbolization cache of which the files are in the
+ * directory `dir`.
+ *
+ * The directory is created when the first entry is added if it does
+ * not exist.
+ *
+ * @param dir		Path of the cache directory
+ * @returns		Pointer to the new cache on success, NULL on failure
+ */
+BT_HIDDEN
+struct sym_cache *sym_cache_create(const char *dir);
+
+/**
+ * Destroy the given symbolization cache instance.
+ *
+ * @param cache		Cache to destroy
+ */
+BT_HIDDEN
+void sym_cache_destroy(struct sym_cache *cache);
+
+/**
+ * Look up the entry of a given address within the binary having a
+ * given build ID.
+ *
+ * On success, if found, the out parameter `entry` is set: its strings
+ * belong to the cache and remain valid until the cache is destroyed.
+ *
+ * @param cache		Symbolization cache
+ * @param build_id	Build ID of the binary
+ * @param build_id_len	Length in bytes of `build_id`
+ * @param addr		Address within the binary (relative to its base
+ *			address if it is position independent code)
+ * @param entry		Out parameter, the cached entry
+ * @param found		Out parameter, whether or not the address is
+ *			in the cache
+ * @returns		0 on success, -1 on failure
+ */
+BT_HIDDEN
+int sym_cache_lookup(struct sym_cache *cache, const uint8_t *build_id,
+		size_t build_id_len, uint64_t addr,
+		struct sym_cache_entry *entry, bool *found);
+
+/**
+ * Add the entry of a given address within the binary having a given
+ * build ID to the cache, both in memory and in the cache file.
+ *
+ * Does nothing if the cache already has an entry for this address.
+ *
+ * @param cache		Symbolization cache
+ * @param build_id	Build ID of the binary
+ * @param build_id_len	Length in bytes of `build_id`
+ * @param addr		Address within the binary (relative to its base
+ *			address if it is position independent code)
+ * @param entry		Entry to add (strings are copied)
+ * @returns		0 on success, -1 on failure
+ */
+BT_HIDDEN
+int sym_cache_add(struct sym_cache *cache, const uint8_t *build_id,
+		size_t build_id_len, uint64_t addr,
+		const struct sym_cache_entry *entry);
+
+#endif	/* _BABELTRACE_SYM_CACHE_H */
@@ -36,6 +36,7 @@
 #include <inttypes.h>
 #include <babeltrace/assert-internal.h>
 #include <babeltrace/common-internal.h>
+#include <babeltrace/msg-ring-internal.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -58,7 +59,7 @@ struct muxer_upstream_msg_iter {
 	bt_self_component_port_input_message_iterator *msg_iter;
 
 	/* Contains `const bt_message *`, owned by this */
-	GQueue *msgs;
+	struct bt_msg_ring msgs;
 };
 
 enum muxer_msg_iter_clock_class_expectation {
@@ -108,7 +109,7 @@ void empty_message_queue(struct muxer_upstream_msg_iter *upstream_msg_iter)
 {
 	const bt_message *msg;
 
-	while ((msg = g_queue_pop_head(upstream_msg_iter->msgs))) {
+	while ((msg = bt_msg_ring_pop(&upstream_msg_iter->msgs))) {
 		bt_message_put_ref(msg);
 	}
 }
@@ -122,16 +123,16 @@ void destroy_muxer_upstream_msg_iter(
 	}
 
 	BT_LOGD("Destroying muxer's upstream message iterator wrapper: "
-		"addr=%p, msg-iter-addr=%p, queue-len=%u",
+		"addr=%p, msg-iter-addr=%p, queue-len=%" PRIu64,
 		muxer_upstream_msg_iter,
 		muxer_upstream_msg_iter->msg_iter,
-		muxer_upstream_msg_iter->msgs->length);
+		bt_msg_ring_length(&muxer_upstream_msg_iter->msgs));
 	bt_self_component_port_input_message_iterator_put_ref(
 		muxer_upstream_msg_iter->msg_iter);
 
-	if (muxer_upstream_msg_iter->msgs) {
+	if (muxer_upstream_msg_iter->msgs.msgs) {
 		empty_message_queue(muxer_upstream_msg_iter);
-		g_queue_free(muxer_upstream_msg_iter->msgs);
+		bt_msg_ring_fini(&muxer_upstream_msg_iter->msgs);
 	}
 
 	g_free(muxer_upstream_msg_iter);
@@ -150,14 +151,14 @@ int muxer_msg_iter_add_upstream_msg_iter(struct muxer_msg_iter *muxer_msg_iter,
 		goto error;
 	}
 
-	muxer_upstream_msg_iter->msg_iter = self_msg_iter;
-	bt_self_component_port_input_message_iterator_get_ref(muxer_upstream_msg_iter->msg_iter);
-	muxer_upstream_msg_iter->msgs = g_queue_new();
-	if (!muxer_upstream_msg_iter->msgs) {
-		BT_LOGE_STR("Failed to allocate a GQueue.");
+	if (bt_msg_ring_init(&muxer_upstream_msg_iter->msgs, 0)) {
+		BT_LOGE_STR("Failed to allocate a message queue.");
 		goto error;
 	}
 
+	muxer_upstream_msg_iter->msg_iter = self_msg_iter;
+	bt_self_component_port_input_message_iterator_get_ref(muxer_upstream_msg_iter->msg_iter);
+
 	g_ptr_array_add(muxer_msg_iter->active_muxer_upstream_msg_iters,
 		muxer_upstream_msg_iter);
 	BT_LOGD("Added muxer's upstream message iterator wrapper: "
@@ -436,7 +437,6 @@ bt_self_message_iterator_status muxer_upstream_msg_iter_next(
 	bt_self_message_iterator_status status;
 	bt_message_iterator_status input_port_iter_status;
 	bt_message_array_const msgs;
-	uint64_t i;
 	uint64_t count;
 
 	BT_LOGV("Calling upstream message iterator's \"next\" method: "
@@ -457,16 +457,25 @@ bt_self_message_iterator_status muxer_upstream_msg_iter_next(
 		BT_LOGV_STR("Validated upstream message iterator wrapper.");
 		BT_ASSERT(count > 0);
 
-		/* Move messages to our queue */
-		for (i = 0; i < count; i++) {
-			/*
-			 * Push to tail in order; other side
-			 * (muxer_msg_iter_do_next_one()) consumes
-			 * from the head first.
-			 */
-			g_queue_push_tail(muxer_upstream_msg_iter->msgs,
-				(void *) msgs[i]);
+		/*
+		 * Move messages to our queue: push to tail in order;
+		 * other side (muxer_msg_iter_do_next_one()) consumes
+		 * from the head first.
+		 */
+		if (bt_msg_ring_push_array(&muxer_upstream_msg_iter->msgs,
+				msgs, count)) {
+			uint64_t i;
+
+			BT_LOGE_STR("Failed to grow a message queue.");
+
+			for (i = 0; i < count; i++) {
+				bt_message_put_ref(msgs[i]);
+			}
+
+			status = BT_SELF_MESSAGE_ITERATOR_STATUS_NOMEM;
+			break;
 		}
+
 		status = BT_SELF_MESSAGE_ITERATOR_STATUS_OK;
 		break;
 	case BT_MESSAGE_ITERATOR_STATUS_AGAIN:
@@ -873,8 +882,9 @@ muxer_msg_iter_youngest_upstream_msg_iter(
 			continue;
 		}
 
-		BT_ASSERT(cur_muxer_upstream_msg_iter->msgs->length > 0);
-		msg = g_queue_peek_head(cur_muxer_upstream_msg_iter->msgs);
+		BT_ASSERT(!bt_msg_ring_is_empty(
+			&cur_muxer_upstream_msg_iter->msgs));
+		msg = bt_msg_ring_peek(&cur_muxer_upstream_msg_iter->msgs);
 		BT_ASSERT(msg);
 
 		if (unlikely(bt_message_get_type(msg) ==
@@ -944,11 +954,11 @@ bt_self_message_iterator_status validate_muxer_upstream_msg_iter(
 		"muxer-upstream-msg-iter-wrap-addr=%p",
 		muxer_upstream_msg_iter);
 
-	if (muxer_upstream_msg_iter->msgs->length > 0 ||
+	if (!bt_msg_ring_is_empty(&muxer_upstream_msg_iter->msgs) ||
 			!muxer_upstream_msg_iter->msg_iter) {
 		BT_LOGV("Already valid or not considered: "
-			"queue-len=%u, upstream-msg-iter-addr=%p",
-			muxer_upstream_msg_iter->msgs->length,
+			"queue-len=%" PRIu64 ", upstream-msg-iter-addr=%p",
+			bt_msg_ring_length(&muxer_upstream_msg_iter->msgs),
 			muxer_upstream_msg_iter->msg_iter);
 		goto end;
 	}
@@ -1090,7 +1100,7 @@ bt_self_message_iterator_status muxer_msg_iter_do_next_one(
 	 * Consume from the queue's head: other side
 	 * (muxer_upstream_msg_iter_next()) writes to the tail.
 	 */
-	*msg = g_queue_pop_head(muxer_upstream_msg_iter->msgs);
+	*msg = bt_msg_ring_pop(&muxer_upstream_msg_iter->msgs);
 	BT_ASSERT(*msg);
 	muxer_msg_iter->last_returned_ts_ns = next_return_ts;
 
@@ -1435,43 +1445,112 @@ end:
 	return ret;
 }
 
-BT_HIDDEN
-bt_self_message_iterator_status muxer_msg_iter_seek_beginning(
-		bt_self_message_iterator *self_msg_iter)
+/*
+ * An upstream message iterator which cannot seek a specific time
+ * natively, but which can seek its beginning, can still seek this
+ * time: the library automatically seeks its beginning and then skips
+ * the messages preceding the requested time.
+ */
+static inline
+bt_bool muxer_upstream_msg_iters_can_all_seek_ns_from_origin(
+		GPtrArray *muxer_upstream_msg_iters, int64_t ns_from_origin)
 {
-	struct muxer_msg_iter *muxer_msg_iter =
-		bt_self_message_iterator_get_data(self_msg_iter);
-	bt_message_iterator_status status = BT_MESSAGE_ITERATOR_STATUS_OK;
 	uint64_t i;
+	bt_bool ret = BT_TRUE;
 
-	/* Seek all ended upstream iterators first */
-	for (i = 0; i < muxer_msg_iter->ended_muxer_upstream_msg_iters->len;
-			i++) {
+	for (i = 0; i < muxer_upstream_msg_iters->len; i++) {
 		struct muxer_upstream_msg_iter *upstream_msg_iter =
-			muxer_msg_iter->ended_muxer_upstream_msg_iters->pdata[i];
+			muxer_upstream_msg_iters->pdata[i];
 
-		status = bt_self_component_port_input_message_iterator_seek_beginning(
-			upstream_msg_iter->msg_iter);
-		if (status != BT_MESSAGE_ITERATOR_STATUS_OK) {
+		if (!bt_self_component_port_input_message_iterator_can_seek_ns_from_origin(
+				upstream_msg_iter->msg_iter, ns_from_origin)) {
+			ret = BT_FALSE;
 			goto end;
 		}
+	}
+
+end:
+	return ret;
+}
+
+BT_HIDDEN
+bt_bool muxer_msg_iter_can_seek_ns_from_origin(
+		bt_self_message_iterator *self_msg_iter,
+		int64_t ns_from_origin)
+{
+	struct muxer_msg_iter *muxer_msg_iter =
+		bt_self_message_iterator_get_data(self_msg_iter);
+	bt_bool ret = BT_TRUE;
 
-		empty_message_queue(upstream_msg_iter);
+	if (!muxer_upstream_msg_iters_can_all_seek_ns_from_origin(
+			muxer_msg_iter->active_muxer_upstream_msg_iters,
+			ns_from_origin)) {
+		ret = BT_FALSE;
+		goto end;
 	}
 
-	/* Seek all previously active upstream iterators */
-	for (i = 0; i < muxer_msg_iter->active_muxer_upstream_msg_iters->len;
-			i++) {
-		struct muxer_upstream_msg_iter *upstream_msg_iter =
-			muxer_msg_iter->active_muxer_upstream_msg_iters->pdata[i];
+	if (!muxer_upstream_msg_iters_can_all_seek_ns_from_origin(
+			muxer_msg_iter->ended_muxer_upstream_msg_iters,
+			ns_from_origin)) {
+		ret = BT_FALSE;
+		goto end;
+	}
 
-		status = bt_self_component_port_input_message_iterator_seek_beginning(
-			upstream_msg_iter->msg_iter);
-		if (status != BT_MESSAGE_ITERATOR_STATUS_OK) {
-			goto end;
-		}
+end:
+	return ret;
+}
+
+/*
+ * Makes all the upstream message iterators of `muxer_msg_iter` seek
+ * either their beginning (`seek_beginning` is true) or
+ * `ns_from_origin`, empty their message queues, make them all active,
+ * and reset the muxer message iterator's time and clock class
+ * expectation states.
+ */
+static
+bt_message_iterator_status muxer_msg_iter_seek_upstream_msg_iters(
+		struct muxer_msg_iter *muxer_msg_iter, bool seek_beginning,
+		int64_t ns_from_origin)
+{
+	bt_message_iterator_status status = BT_MESSAGE_ITERATOR_STATUS_OK;
+	GPtrArray *upstream_msg_iter_arrays[] = {
+		/* Seek all ended upstream iterators first */
+		muxer_msg_iter->ended_muxer_upstream_msg_iters,
+
+		/* Then seek all previously active upstream iterators */
+		muxer_msg_iter->active_muxer_upstream_msg_iters,
+	};
+	uint64_t i;
+	size_t a;
+
+	for (a = 0; a < G_N_ELEMENTS(upstream_msg_iter_arrays); a++) {
+		GPtrArray *upstream_msg_iters = upstream_msg_iter_arrays[a];
 
-		empty_message_queue(upstream_msg_iter);
+		for (i = 0; i < upstream_msg_iters->len; i++) {
+			struct muxer_upstream_msg_iter *upstream_msg_iter =
+				upstream_msg_iters->pdata[i];
+
+			if (seek_beginning) {
+				status = bt_self_component_port_input_message_iterator_seek_beginning(
+					upstream_msg_iter->msg_iter);
+			} else {
+				status = bt_self_component_port_input_message_iterator_seek_ns_from_origin(
+					upstream_msg_iter->msg_iter,
+					ns_from_origin);
+			}
+
+			if (status != BT_MESSAGE_ITERATOR_STATUS_OK) {
+				BT_LOGE("Cannot make upstream message iterator seek: "
+					"msg-iter-addr=%p, seek-beginning=%d, "
+					"ns-from-origin=%" PRId64 ", status=%s",
+					upstream_msg_iter->msg_iter,
+					seek_beginning, ns_from_origin,
+					bt_message_iterator_status_string(status));
+				goto end;
+			}
+
+			empty_message_queue(upstream_msg_iter);
+		}
 	}
 
 	/* Make them all active */
@@ -1492,5 +1571,39 @@ bt_self_message_iterator_status muxer_msg_iter_seek_beginning(
 		MUXER_MSG_ITER_CLOCK_CLASS_EXPECTATION_ANY;
 
 end:
-	return (bt_self_message_iterator_status) status;
+	return status;
+}
+
+BT_HIDDEN
+bt_self_message_iterator_status muxer_msg_iter_seek_beginning(
+		bt_self_message_iterator *self_msg_iter)
+{
+	struct muxer_msg_iter *muxer_msg_iter =
+		bt_self_message_iterator_get_data(self_msg_iter);
+
+	return (bt_self_message_iterator_status)
+		muxer_msg_iter_seek_upstream_msg_iters(muxer_msg_iter,
+			true, 0);
+}
+
+BT_HIDDEN
+bt_self_message_iterator_status muxer_msg_iter_seek_ns_from_origin(
+		bt_self_message_iterator *self_msg_iter,
+		int64_t ns_from_origin)
+{
+	struct muxer_msg_iter *muxer_msg_iter =
+		bt_self_message_iterator_get_data(self_msg_iter);
+
+	BT_LOGD("Seeking muxer message iterator: "
+		"muxer-msg-iter-addr=%p, ns-from-origin=%" PRId64,
+		muxer_msg_iter, ns_from_origin);
+
+	/*
+	 * Each upstream message iterator seeks on its own: the ones
+	 * which support seeking a time natively do so, while the
+	 * library falls back to automatic seeking for the others.
+	 */
+	return (bt_self_message_iterator_status)
+		muxer_msg_iter_seek_upstream_msg_iters(muxer_msg_iter,
+			false, ns_from_origin);
 }
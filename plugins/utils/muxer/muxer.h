@@ -66,4 +66,14 @@ BT_HIDDEN
 bt_self_message_iterator_status muxer_msg_iter_seek_beginning(
 		bt_self_message_iterator *message_iterator);
 
+BT_HIDDEN
+bt_bool muxer_msg_iter_can_seek_ns_from_origin(
+		bt_self_message_iterator *message_iterator,
+		int64_t ns_from_origin);
+
+BT_HIDDEN
+bt_self_message_iterator_status muxer_msg_iter_seek_ns_from_origin(
+		bt_self_message_iterator *message_iterator,
+		int64_t ns_from_origin);
+
 #endif /* BABELTRACE_PLUGINS_UTILS_MUXER_H */
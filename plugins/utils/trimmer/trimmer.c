@@ -30,6 +30,7 @@
 #include <babeltrace/common-internal.h>
 #include <plugins-common.h>
 #include <babeltrace/assert-internal.h>
+#include <babeltrace/msg-ring-internal.h>
 #include <stdint.h>
 #include <inttypes.h>
 #include <glib.h>
@@ -68,8 +69,24 @@ struct trimmer_bound {
 	struct trimmer_time time;
 };
 
-struct trimmer_comp {
+/*
+ * Minimal gap (ns) between the end of a trimming range and the
+ * beginning of the next one for which a message iterator seeks its
+ * upstream message iterator instead of reading and discarding the
+ * messages in between.
+ */
+#define TRIMMER_RANGE_SEEK_MIN_GAP_NS	NS_PER_S
+
+struct trimmer_range {
 	struct trimmer_bound begin, end;
+};
+
+struct trimmer_comp {
+	/*
+	 * Array of `struct trimmer_range`, sorted by time, with at
+	 * least one element.
+	 */
+	GArray *ranges;
 	bool is_gmt;
 };
 
@@ -109,6 +126,18 @@ struct trimmer_iterator {
 
 	/* Owned by this */
 	bt_self_component_port_input_message_iterator *upstream_iter;
+
+	/*
+	 * Array of `struct trimmer_range` (copy of the component's
+	 * ranges, with all the bounds set once the first message's date
+	 * is known).
+	 */
+	GArray *ranges;
+
+	/* Index of the current range within `ranges` */
+	uint64_t cur_range_index;
+
+	/* Current range's bounds */
 	struct trimmer_bound begin, end;
 
 	/*
@@ -117,7 +146,7 @@ struct trimmer_iterator {
 	 * This is where the trimming operation pushes the messages to
 	 * output by this message iterator.
 	 */
-	GQueue *output_messages;
+	struct bt_msg_ring output_messages;
 
 	/*
 	 * Hash table of `bt_stream *` (weak) to
@@ -159,13 +188,39 @@ static
 void destroy_trimmer_comp(struct trimmer_comp *trimmer_comp)
 {
 	BT_ASSERT(trimmer_comp);
+
+	if (trimmer_comp->ranges) {
+		g_array_free(trimmer_comp->ranges, TRUE);
+	}
+
 	g_free(trimmer_comp);
 }
 
 static
 struct trimmer_comp *create_trimmer_comp(void)
 {
-	return g_new0(struct trimmer_comp, 1);
+	struct trimmer_comp *trimmer_comp = g_new0(struct trimmer_comp, 1);
+
+	if (!trimmer_comp) {
+		goto error;
+	}
+
+	trimmer_comp->ranges = g_array_new(FALSE, TRUE,
+		sizeof(struct trimmer_range));
+	if (!trimmer_comp->ranges) {
+		goto error;
+	}
+
+	goto end;
+
+error:
+	if (trimmer_comp) {
+		destroy_trimmer_comp(trimmer_comp);
+		trimmer_comp = NULL;
+	}
+
+end:
+	return trimmer_comp;
 }
 
 BT_HIDDEN
@@ -422,11 +477,136 @@ end:
 	return ret;
 }
 
+/*
+ * Validates all the trimming ranges of `ranges` (array of
+ * `struct trimmer_range`), all the bounds of which must be set: each
+ * range must be valid and must begin after the previous range's end.
+ */
+static
+int validate_trimmer_ranges(GArray *ranges)
+{
+	int ret = 0;
+	uint64_t i;
+
+	for (i = 0; i < ranges->len; i++) {
+		struct trimmer_range *range =
+			&g_array_index(ranges, struct trimmer_range, i);
+		struct trimmer_range *prev_range;
+
+		/* validate_trimmer_bounds() logs errors */
+		ret = validate_trimmer_bounds(&range->begin, &range->end);
+		if (ret) {
+			goto end;
+		}
+
+		if (i == 0) {
+			continue;
+		}
+
+		prev_range = &g_array_index(ranges, struct trimmer_range,
+			i - 1);
+		if (range->begin.is_infinite || prev_range->end.is_infinite ||
+				range->begin.ns_from_origin <=
+					prev_range->end.ns_from_origin) {
+			BT_LOGE("Trimming time ranges are not sorted or overlap: "
+				"range-index=%" PRIu64 ", "
+				"begin-ns-from-origin=%" PRId64 ", "
+				"prev-end-ns-from-origin=%" PRId64,
+				i, range->begin.ns_from_origin,
+				prev_range->end.ns_from_origin);
+			ret = -1;
+			goto end;
+		}
+	}
+
+end:
+	return ret;
+}
+
+static
+bool trimmer_ranges_are_set(GArray *ranges)
+{
+	bool is_set = true;
+	uint64_t i;
+
+	for (i = 0; i < ranges->len; i++) {
+		struct trimmer_range *range =
+			&g_array_index(ranges, struct trimmer_range, i);
+
+		if (!range->begin.is_set || !range->end.is_set) {
+			is_set = false;
+			break;
+		}
+	}
+
+	return is_set;
+}
+
+/*
+ * Appends the trimming ranges of the `ranges` parameter, an array of
+ * `[BEGIN, END]` arrays, to the ranges of `trimmer_comp`.
+ */
+static
+int append_ranges_from_param(struct trimmer_comp *trimmer_comp,
+		const bt_value *ranges_param)
+{
+	int ret = 0;
+	uint64_t i;
+
+	if (!bt_value_is_array(ranges_param) ||
+			bt_value_array_is_empty(ranges_param)) {
+		BT_LOGE_STR("`ranges` parameter must be a non-empty array value.");
+		ret = -1;
+		goto end;
+	}
+
+	for (i = 0; i < bt_value_array_get_size(ranges_param); i++) {
+		struct trimmer_range range = { 0 };
+		const bt_value *range_param =
+			bt_value_array_borrow_element_by_index_const(
+				ranges_param, i);
+
+		if (!bt_value_is_array(range_param) ||
+				bt_value_array_get_size(range_param) != 2) {
+			BT_LOGE("`ranges` parameter's element must be an array "
+				"of two values (beginning and end times): "
+				"index=%" PRIu64, i);
+			ret = -1;
+			goto end;
+		}
+
+		/* set_bound_from_param() logs errors */
+		ret = set_bound_from_param("ranges",
+			bt_value_array_borrow_element_by_index_const(
+				range_param, 0),
+			&range.begin, trimmer_comp->is_gmt);
+		if (ret) {
+			goto end;
+		}
+
+		ret = set_bound_from_param("ranges",
+			bt_value_array_borrow_element_by_index_const(
+				range_param, 1),
+			&range.end, trimmer_comp->is_gmt);
+		if (ret) {
+			goto end;
+		}
+
+		g_array_append_val(trimmer_comp->ranges, range);
+	}
+
+end:
+	return ret;
+}
+
 static
 int init_trimmer_comp_from_params(struct trimmer_comp *trimmer_comp,
 		const bt_value *params)
 {
 	const bt_value *value;
+	const bt_value *begin_value;
+	const bt_value *end_value;
+	struct trimmer_range range = { 0 };
 	int ret = 0;
 
 	BT_ASSERT(params);
@@ -435,37 +615,52 @@ int init_trimmer_comp_from_params(struct trimmer_comp *trimmer_comp,
 		trimmer_comp->is_gmt = (bool) bt_value_bool_get(value);
 	}
 
-        value = bt_value_map_borrow_entry_value_const(params, "begin");
+	begin_value = bt_value_map_borrow_entry_value_const(params, "begin");
+	end_value = bt_value_map_borrow_entry_value_const(params, "end");
+	value = bt_value_map_borrow_entry_value_const(params, "ranges");
 	if (value) {
-		if (set_bound_from_param("begin", value,
-				&trimmer_comp->begin, trimmer_comp->is_gmt)) {
+		if (begin_value || end_value) {
+			BT_LOGE_STR("`ranges` parameter cannot be used with the "
+				"`begin` or `end` parameters.");
+			ret = -1;
+			goto end;
+		}
+
+		/* append_ranges_from_param() logs errors */
+		ret = append_ranges_from_param(trimmer_comp, value);
+		goto end;
+	}
+
+	if (begin_value) {
+		if (set_bound_from_param("begin", begin_value,
+				&range.begin, trimmer_comp->is_gmt)) {
 			/* set_bound_from_param() logs errors */
 			ret = BT_SELF_COMPONENT_STATUS_ERROR;
 			goto end;
 		}
 	} else {
-		trimmer_comp->begin.is_infinite = true;
-		trimmer_comp->begin.is_set = true;
+		range.begin.is_infinite = true;
+		range.begin.is_set = true;
 	}
 
-        value = bt_value_map_borrow_entry_value_const(params, "end");
-	if (value) {
-		if (set_bound_from_param("end", value,
-				&trimmer_comp->end, trimmer_comp->is_gmt)) {
+	if (end_value) {
+		if (set_bound_from_param("end", end_value,
+				&range.end, trimmer_comp->is_gmt)) {
 			/* set_bound_from_param() logs errors */
 			ret = BT_SELF_COMPONENT_STATUS_ERROR;
 			goto end;
 		}
 	} else {
-		trimmer_comp->end.is_infinite = true;
-		trimmer_comp->end.is_set = true;
+		range.end.is_infinite = true;
+		range.end.is_set = true;
 	}
 
+	g_array_append_val(trimmer_comp->ranges, range);
+
 end:
-	if (trimmer_comp->begin.is_set && trimmer_comp->end.is_set) {
-		/* validate_trimmer_bounds() logs errors */
-		ret = validate_trimmer_bounds(&trimmer_comp->begin,
-			&trimmer_comp->end);
+	if (ret == 0 && trimmer_ranges_are_set(trimmer_comp->ranges)) {
+		/* validate_trimmer_ranges() logs errors */
+		ret = validate_trimmer_ranges(trimmer_comp->ranges);
 	}
 
 	return ret;
@@ -526,14 +721,24 @@ void destroy_trimmer_iterator(struct trimmer_iterator *trimmer_it)
 	bt_self_component_port_input_message_iterator_put_ref(
 		trimmer_it->upstream_iter);
 
-	if (trimmer_it->output_messages) {
-		g_queue_free(trimmer_it->output_messages);
+	if (trimmer_it->output_messages.msgs) {
+		const bt_message *msg;
+
+		while ((msg = bt_msg_ring_pop(&trimmer_it->output_messages))) {
+			bt_message_put_ref(msg);
+		}
+
+		bt_msg_ring_fini(&trimmer_it->output_messages);
 	}
 
 	if (trimmer_it->stream_states) {
 		g_hash_table_destroy(trimmer_it->stream_states);
 	}
 
+	if (trimmer_it->ranges) {
+		g_array_free(trimmer_it->ranges, TRUE);
+	}
+
 	g_free(trimmer_it);
 }
 
@@ -567,19 +772,32 @@ bt_self_message_iterator_status trimmer_msg_iter_init(
 		bt_self_component_filter_as_self_component(self_comp));
 	BT_ASSERT(trimmer_it->trimmer_comp);
 
-	if (trimmer_it->trimmer_comp->begin.is_set &&
-			trimmer_it->trimmer_comp->end.is_set) {
+	if (trimmer_ranges_are_set(trimmer_it->trimmer_comp->ranges)) {
 		/*
-		 * Both trimming time range's bounds are set, so skip
-		 * the
+		 * All the trimming time ranges's bounds are set, so
+		 * skip the
 		 * `TRIMMER_ITERATOR_STATE_SET_BOUNDS_NS_FROM_ORIGIN`
 		 * phase.
 		 */
 		trimmer_it->state = TRIMMER_ITERATOR_STATE_SEEK_INITIALLY;
 	}
 
-	trimmer_it->begin = trimmer_it->trimmer_comp->begin;
-	trimmer_it->end = trimmer_it->trimmer_comp->end;
+	trimmer_it->ranges = g_array_sized_new(FALSE, FALSE,
+		sizeof(struct trimmer_range),
+		trimmer_it->trimmer_comp->ranges->len);
+	if (!trimmer_it->ranges) {
+		status = BT_SELF_MESSAGE_ITERATOR_STATUS_NOMEM;
+		goto end;
+	}
+
+	g_array_append_vals(trimmer_it->ranges,
+		trimmer_it->trimmer_comp->ranges->data,
+		trimmer_it->trimmer_comp->ranges->len);
+	BT_ASSERT(trimmer_it->ranges->len > 0);
+	trimmer_it->begin = g_array_index(trimmer_it->ranges,
+		struct trimmer_range, 0).begin;
+	trimmer_it->end = g_array_index(trimmer_it->ranges,
+		struct trimmer_range, 0).end;
 	trimmer_it->upstream_iter =
 		bt_self_component_port_input_message_iterator_create(
 			bt_self_component_filter_borrow_input_port_by_name(
@@ -589,8 +807,7 @@ bt_self_message_iterator_status trimmer_msg_iter_init(
 		goto end;
 	}
 
-	trimmer_it->output_messages = g_queue_new();
-	if (!trimmer_it->output_messages) {
+	if (bt_msg_ring_init(&trimmer_it->output_messages, 0)) {
 		status = BT_SELF_MESSAGE_ITERATOR_STATUS_NOMEM;
 		goto end;
 	}
@@ -806,8 +1023,7 @@ bt_self_message_iterator_status state_set_trimmer_iterator_bounds(
 	uint64_t i;
 	int ret;
 
-	BT_ASSERT(!trimmer_it->begin.is_set ||
-		!trimmer_it->end.is_set);
+	BT_ASSERT(!trimmer_ranges_are_set(trimmer_it->ranges));
 
 	while (true) {
 		upstream_iter_status =
@@ -842,30 +1058,38 @@ bt_self_message_iterator_status state_set_trimmer_iterator_bounds(
 	}
 
 found:
-	if (!trimmer_it->begin.is_set) {
-		BT_ASSERT(!trimmer_it->begin.is_infinite);
-		ret = set_trimmer_iterator_bound(&trimmer_it->begin,
-			ns_from_origin, trimmer_comp->is_gmt);
-		if (ret) {
-			goto error;
+	for (i = 0; i < trimmer_it->ranges->len; i++) {
+		struct trimmer_range *range = &g_array_index(
+			trimmer_it->ranges, struct trimmer_range, i);
+
+		if (!range->begin.is_set) {
+			BT_ASSERT(!range->begin.is_infinite);
+			ret = set_trimmer_iterator_bound(&range->begin,
+				ns_from_origin, trimmer_comp->is_gmt);
+			if (ret) {
+				goto error;
+			}
 		}
-	}
 
-	if (!trimmer_it->end.is_set) {
-		BT_ASSERT(!trimmer_it->end.is_infinite);
-		ret = set_trimmer_iterator_bound(&trimmer_it->end,
-			ns_from_origin, trimmer_comp->is_gmt);
-		if (ret) {
-			goto error;
+		if (!range->end.is_set) {
+			BT_ASSERT(!range->end.is_infinite);
+			ret = set_trimmer_iterator_bound(&range->end,
+				ns_from_origin, trimmer_comp->is_gmt);
+			if (ret) {
+				goto error;
+			}
 		}
 	}
 
-	ret = validate_trimmer_bounds(&trimmer_it->begin,
-		&trimmer_it->end);
+	ret = validate_trimmer_ranges(trimmer_it->ranges);
 	if (ret) {
 		goto error;
 	}
 
+	trimmer_it->begin = g_array_index(trimmer_it->ranges,
+		struct trimmer_range, 0).begin;
+	trimmer_it->end = g_array_index(trimmer_it->ranges,
+		struct trimmer_range, 0).end;
 	goto end;
 
 error:
@@ -921,13 +1145,11 @@ end:
 static inline
 void push_message(struct trimmer_iterator *trimmer_it, const bt_message *msg)
 {
-	g_queue_push_head(trimmer_it->output_messages, (void *) msg);
-}
+	int ret;
 
-static inline
-const bt_message *pop_message(struct trimmer_iterator *trimmer_it)
-{
-	return g_queue_pop_tail(trimmer_it->output_messages);
+	/* Growing the queue only fails if g_new() returns NULL */
+	ret = bt_msg_ring_push(&trimmer_it->output_messages, msg);
+	BT_ASSERT(ret == 0);
 }
 
 static inline
@@ -945,6 +1167,63 @@ int clock_raw_value_from_ns_from_origin(const bt_clock_class *clock_class,
 		cc_offset_cycles, cc_freq, ns_from_origin, raw_value);
 }
 
+/*
+ * Ends the current packet of the stream state `sstate`, pushing a
+ * packet end message having the trimming range's end time.
+ */
+static inline
+bt_self_message_iterator_status end_cur_packet(
+		struct trimmer_iterator *trimmer_it,
+		struct trimmer_iterator_stream_state *sstate)
+{
+	bt_self_message_iterator_status status =
+		BT_SELF_MESSAGE_ITERATOR_STATUS_OK;
+	uint64_t raw_value;
+	const bt_clock_class *clock_class;
+	int ret;
+	bt_message *msg = NULL;
+
+	BT_ASSERT(!trimmer_it->end.is_infinite);
+	BT_ASSERT(sstate->cur_packet);
+
+	/*
+	 * The last message could not have been a stream activity end
+	 * message if we have a current packet.
+	 */
+	BT_ASSERT(!sstate->last_msg_is_stream_activity_end);
+	clock_class = bt_stream_class_borrow_default_clock_class_const(
+		bt_stream_borrow_class_const(sstate->stream));
+	BT_ASSERT(clock_class);
+	ret = clock_raw_value_from_ns_from_origin(clock_class,
+		trimmer_it->end.ns_from_origin, &raw_value);
+	if (ret) {
+		status = BT_SELF_MESSAGE_ITERATOR_STATUS_ERROR;
+		goto end;
+	}
+
+	msg = bt_message_packet_end_create_with_default_clock_snapshot(
+		trimmer_it->self_msg_iter, sstate->cur_packet, raw_value);
+	if (!msg) {
+		status = BT_SELF_MESSAGE_ITERATOR_STATUS_NOMEM;
+		goto end;
+	}
+
+	push_message(trimmer_it, msg);
+	msg = NULL;
+	BT_PACKET_PUT_REF_AND_RESET(sstate->cur_packet);
+
+	/*
+	 * Because we generated a packet end message, set the stream
+	 * activity end message's time to use to the trimming range's
+	 * end time (this packet end message's time).
+	 */
+	sstate->stream_act_end_ns_from_origin = trimmer_it->end.ns_from_origin;
+
+end:
+	bt_message_put_ref(msg);
+	return status;
+}
+
 static inline
 bt_self_message_iterator_status end_stream(struct trimmer_iterator *trimmer_it,
 		struct trimmer_iterator_stream_state *sstate)
@@ -963,46 +1242,10 @@ bt_self_message_iterator_status end_stream(struct trimmer_iterator *trimmer_it,
 	}
 
 	if (sstate->cur_packet) {
-		/*
-		 * The last message could not have been a stream
-		 * activity end message if we have a current packet.
-		 */
-		BT_ASSERT(!sstate->last_msg_is_stream_activity_end);
-
-		/*
-		 * Create and push a packet end message, making its time
-		 * the trimming range's end time.
-		 */
-		clock_class = bt_stream_class_borrow_default_clock_class_const(
-			bt_stream_borrow_class_const(sstate->stream));
-		BT_ASSERT(clock_class);
-		ret = clock_raw_value_from_ns_from_origin(clock_class,
-			trimmer_it->end.ns_from_origin, &raw_value);
-		if (ret) {
-			status = BT_SELF_MESSAGE_ITERATOR_STATUS_ERROR;
-			goto end;
-		}
-
-		msg = bt_message_packet_end_create_with_default_clock_snapshot(
-			trimmer_it->self_msg_iter, sstate->cur_packet,
-			raw_value);
-		if (!msg) {
-			status = BT_SELF_MESSAGE_ITERATOR_STATUS_NOMEM;
+		status = end_cur_packet(trimmer_it, sstate);
+		if (status != BT_SELF_MESSAGE_ITERATOR_STATUS_OK) {
 			goto end;
 		}
-
-		push_message(trimmer_it, msg);
-		msg = NULL;
-		BT_PACKET_PUT_REF_AND_RESET(sstate->cur_packet);
-
-		/*
-		 * Because we generated a packet end message, set the
-		 * stream activity end message's time to use to the
-		 * trimming range's end time (this packet end message's
-		 * time).
-		 */
-		sstate->stream_act_end_ns_from_origin =
-			trimmer_it->end.ns_from_origin;
 	}
 
 	if (!sstate->last_msg_is_stream_activity_end) {
@@ -1090,6 +1333,14 @@ bt_self_message_iterator_status end_iterator_streams(
 	g_hash_table_iter_init(&iter, trimmer_it->stream_states);
 
 	while (g_hash_table_iter_next(&iter, &key, &sstate)) {
+		if (!((struct trimmer_iterator_stream_state *) sstate)->inited) {
+			/*
+			 * Nothing was pushed for this stream: nothing
+			 * to end.
+			 */
+			continue;
+		}
+
 		status = end_stream(trimmer_it, sstate);
 		if (status) {
 			goto end;
@@ -1103,6 +1354,63 @@ end:
 	return status;
 }
 
+/*
+ * Ends the current packet of each stream at the end of a trimming range
+ * which is not the last one.
+ *
+ * The streams themselves remain begun: the stream states are kept, so
+ * that the next range's messages continue the same streams, beginning
+ * new packets at the next range's beginning time if needed. This
+ * function does not push any stream activity message either: only the
+ * last range ends the streams (see end_iterator_streams()).
+ */
+static inline
+bt_self_message_iterator_status end_iterator_packets(
+		struct trimmer_iterator *trimmer_it)
+{
+	bt_self_message_iterator_status status =
+		BT_SELF_MESSAGE_ITERATOR_STATUS_OK;
+	GHashTableIter iter;
+	gpointer key, value;
+
+	BT_ASSERT(!trimmer_it->end.is_infinite);
+	g_hash_table_iter_init(&iter, trimmer_it->stream_states);
+
+	while (g_hash_table_iter_next(&iter, &key, &value)) {
+		struct trimmer_iterator_stream_state *sstate = value;
+
+		if (!sstate->cur_packet) {
+			continue;
+		}
+
+		status = end_cur_packet(trimmer_it, sstate);
+		if (status != BT_SELF_MESSAGE_ITERATOR_STATUS_OK) {
+			goto end;
+		}
+	}
+
+end:
+	return status;
+}
+
+/*
+ * Ends the current trimming range: ends the iterator's streams if it's
+ * the last range, or only their current packets otherwise.
+ */
+static inline
+bt_self_message_iterator_status end_range(struct trimmer_iterator *trimmer_it)
+{
+	bt_self_message_iterator_status status;
+
+	if (trimmer_it->cur_range_index + 1 < trimmer_it->ranges->len) {
+		status = end_iterator_packets(trimmer_it);
+	} else {
+		status = end_iterator_streams(trimmer_it);
+	}
+
+	return status;
+}
+
 static inline
 bt_self_message_iterator_status create_stream_beginning_activity_message(
 		struct trimmer_iterator *trimmer_it,
@@ -1289,13 +1597,31 @@ end:
 	return status;
 }
 
+/*
+ * Returns whether or not the known time `ns_from_origin` is before the
+ * current trimming range's beginning time. This only happens when the
+ * iterator did not seek the beginning of the current range, for
+ * example between two trimming ranges.
+ */
+static inline
+bool ns_from_origin_is_before_range(struct trimmer_iterator *trimmer_it,
+		int64_t ns_from_origin)
+{
+	return !trimmer_it->begin.is_infinite &&
+		ns_from_origin != INT64_MIN &&
+		ns_from_origin < trimmer_it->begin.ns_from_origin;
+}
+
 /*
  * Handles a message which is associated to a given stream state. This
  * _could_ make the iterator's output message queue grow; this could
  * also consume the message without pushing anything to this queue, only
  * modifying the stream state.
  *
- * This function consumes the `msg` reference, _whatever the outcome_.
+ * This function consumes the `msg` reference, _whatever the outcome_,
+ * except when it sets `reached_end`: the caller keeps its reference in
+ * this case so that it can handle the message again within the next
+ * trimming range, if any.
  *
  * `ns_from_origin` is the message's time, as given by
  * get_msg_ns_from_origin().
@@ -1316,11 +1642,25 @@ bt_self_message_iterator_status handle_message_with_stream_state(
 	bt_message_type msg_type = bt_message_get_type(msg);
 	int ret;
 
+	if (unlikely(msg_type != BT_MESSAGE_TYPE_DISCARDED_EVENTS &&
+			msg_type != BT_MESSAGE_TYPE_DISCARDED_PACKETS &&
+			ns_from_origin_is_before_range(trimmer_it,
+				ns_from_origin))) {
+		/*
+		 * Known time before the trimming range's beginning:
+		 * drop this message. A subsequent message within the
+		 * range initializes the stream state and creates the
+		 * current packet, if needed, at the range's beginning
+		 * time.
+		 */
+		goto end;
+	}
+
 	switch (msg_type) {
 	case BT_MESSAGE_TYPE_EVENT:
 		if (unlikely(!trimmer_it->end.is_infinite &&
 				ns_from_origin > trimmer_it->end.ns_from_origin)) {
-			status = end_iterator_streams(trimmer_it);
+			status = end_range(trimmer_it);
 			*reached_end = true;
 			break;
 		}
@@ -1353,7 +1693,7 @@ bt_self_message_iterator_status handle_message_with_stream_state(
 	case BT_MESSAGE_TYPE_PACKET_BEGINNING:
 		if (unlikely(!trimmer_it->end.is_infinite &&
 				ns_from_origin > trimmer_it->end.ns_from_origin)) {
-			status = end_iterator_streams(trimmer_it);
+			status = end_range(trimmer_it);
 			*reached_end = true;
 			break;
 		}
@@ -1378,7 +1718,7 @@ bt_self_message_iterator_status handle_message_with_stream_state(
 
 		if (unlikely(!trimmer_it->end.is_infinite &&
 				ns_from_origin > trimmer_it->end.ns_from_origin)) {
-			status = end_iterator_streams(trimmer_it);
+			status = end_range(trimmer_it);
 			*reached_end = true;
 			break;
 		}
@@ -1442,11 +1782,17 @@ bt_self_message_iterator_status handle_message_with_stream_state(
 			goto end;
 		}
 
+		if (ns_from_origin_is_before_range(trimmer_it,
+				end_ns_from_origin)) {
+			/* Whole time range before the trimming range */
+			break;
+		}
+
 		sstate->stream_act_end_ns_from_origin = end_ns_from_origin;
 
 		if (!trimmer_it->end.is_infinite &&
 				ns_from_origin > trimmer_it->end.ns_from_origin) {
-			status = end_iterator_streams(trimmer_it);
+			status = end_range(trimmer_it);
 			*reached_end = true;
 			break;
 		}
@@ -1523,7 +1869,7 @@ bt_self_message_iterator_status handle_message_with_stream_state(
 			 * always less than
 			 * `trimmer_it->end.ns_from_origin`.
 			 */
-			status = end_iterator_streams(trimmer_it);
+			status = end_range(trimmer_it);
 			*reached_end = true;
 			break;
 		}
@@ -1564,7 +1910,7 @@ bt_self_message_iterator_status handle_message_with_stream_state(
 			if (ns_from_origin > trimmer_it->end.ns_from_origin) {
 				sstate->stream_act_end_ns_from_origin =
 					trimmer_it->end.ns_from_origin;
-				status = end_iterator_streams(trimmer_it);
+				status = end_range(trimmer_it);
 				*reached_end = true;
 				break;
 			}
@@ -1592,12 +1938,20 @@ bt_self_message_iterator_status handle_message_with_stream_state(
 
 		break;
 	case BT_MESSAGE_TYPE_STREAM_BEGINNING:
+		if (sstate->inited) {
+			/*
+			 * The upstream message iterator seeked the
+			 * next trimming range's beginning and begins
+			 * this stream again: it's already begun.
+			 */
+			break;
+		}
+
 		/*
 		 * We don't know what follows at this point, so just
 		 * keep this message until we know what to do with it
 		 * (it will be used in ensure_stream_state_is_inited()).
 		 */
-		BT_ASSERT(!sstate->inited);
 		BT_MESSAGE_MOVE_REF(sstate->stream_beginning_msg, msg);
 		break;
 	case BT_MESSAGE_TYPE_STREAM_END:
@@ -1637,8 +1991,14 @@ bt_self_message_iterator_status handle_message_with_stream_state(
 	}
 
 end:
-	/* We release the message's reference whatever the outcome */
-	bt_message_put_ref(msg);
+	if (!*reached_end) {
+		/*
+		 * We release the message's reference whatever the
+		 * outcome, unless the caller keeps it.
+		 */
+		bt_message_put_ref(msg);
+	}
+
 	return BT_SELF_MESSAGE_ITERATOR_STATUS_OK;
 }
 
@@ -1647,7 +2007,10 @@ end:
  * message queue grow; this could also consume the message without
  * pushing anything to this queue, only modifying the stream state.
  *
- * This function consumes the `msg` reference, _whatever the outcome_.
+ * This function consumes the `msg` reference, _whatever the outcome_,
+ * except when it sets `reached_end`: the caller keeps its reference in
+ * this case so that it can handle the message again within the next
+ * trimming range, if any.
  *
  * This function sets `reached_end` if handling this message made the
  * iterator reach the end of the trimming range. Note that the output
@@ -1760,8 +2123,8 @@ bt_self_message_iterator_status handle_message(
 			sstate, ns_from_origin, reached_end);
 
 		/*
-		 * handle_message_with_stream_state() unconditionally
-		 * consumes `msg`.
+		 * handle_message_with_stream_state() consumes `msg`
+		 * or leaves it to the caller.
 		 */
 		msg = NULL;
 	} else {
@@ -1770,9 +2133,14 @@ bt_self_message_iterator_status handle_message(
 		 * inactivity).
 		 */
 		if (unlikely(ns_from_origin > trimmer_it->end.ns_from_origin)) {
-			BT_MESSAGE_PUT_REF_AND_RESET(msg);
-			status = end_iterator_streams(trimmer_it);
+			/* Caller keeps the message */
+			msg = NULL;
+			status = end_range(trimmer_it);
 			*reached_end = true;
+		} else if (unlikely(ns_from_origin_is_before_range(trimmer_it,
+				ns_from_origin))) {
+			/* Drop it */
+			status = BT_SELF_MESSAGE_ITERATOR_STATUS_OK;
 		} else {
 			push_message(trimmer_it, msg);
 			status = BT_SELF_MESSAGE_ITERATOR_STATUS_OK;
@@ -1781,28 +2149,80 @@ bt_self_message_iterator_status handle_message(
 	}
 
 end:
-	/* We release the message's reference whatever the outcome */
 	bt_message_put_ref(msg);
 	return status;
 }
 
+/*
+ * Makes the next trimming range the current one after the iterator
+ * reached the end of the current range.
+ *
+ * If the gap between the two ranges is large enough and the upstream
+ * message iterator can do it, this function makes the upstream message
+ * iterator seek the next range's beginning time and sets `seeked`: the
+ * caller must then discard the upstream messages it still holds.
+ */
+static
+bt_self_message_iterator_status switch_to_next_range(
+		struct trimmer_iterator *trimmer_it, bool *seeked)
+{
+	bt_self_message_iterator_status status =
+		BT_SELF_MESSAGE_ITERATOR_STATUS_OK;
+	struct trimmer_range *range;
+	int64_t prev_end_ns_from_origin = trimmer_it->end.ns_from_origin;
+
+	BT_ASSERT(!trimmer_it->end.is_infinite);
+	BT_ASSERT(trimmer_it->cur_range_index + 1 < trimmer_it->ranges->len);
+	trimmer_it->cur_range_index++;
+	range = &g_array_index(trimmer_it->ranges, struct trimmer_range,
+		trimmer_it->cur_range_index);
+	trimmer_it->begin = range->begin;
+	trimmer_it->end = range->end;
+	*seeked = false;
+
+	/* validate_trimmer_ranges() guarantees this */
+	BT_ASSERT(!trimmer_it->begin.is_infinite);
+	BT_ASSERT(trimmer_it->begin.ns_from_origin > prev_end_ns_from_origin);
+	BT_LOGD("Switching to next trimming range: "
+		"range-index=%" PRIu64 ", begin-ns-from-origin=%" PRId64 ", "
+		"end-ns-from-origin=%" PRId64, trimmer_it->cur_range_index,
+		trimmer_it->begin.ns_from_origin,
+		trimmer_it->end.ns_from_origin);
+
+	if ((uint64_t) trimmer_it->begin.ns_from_origin -
+			(uint64_t) prev_end_ns_from_origin <
+			(uint64_t) TRIMMER_RANGE_SEEK_MIN_GAP_NS) {
+		/* Small gap: read and discard the messages in between */
+		goto end;
+	}
+
+	if (!bt_self_component_port_input_message_iterator_can_seek_ns_from_origin(
+			trimmer_it->upstream_iter,
+			trimmer_it->begin.ns_from_origin)) {
+		goto end;
+	}
+
+	status = (int) bt_self_component_port_input_message_iterator_seek_ns_from_origin(
+		trimmer_it->upstream_iter, trimmer_it->begin.ns_from_origin);
+	if (status == BT_SELF_MESSAGE_ITERATOR_STATUS_OK) {
+		*seeked = true;
+	}
+
+end:
+	return status;
+}
+
 static inline
 void fill_message_array_from_output_messages(
 		struct trimmer_iterator *trimmer_it,
 		bt_message_array_const msgs, uint64_t capacity, uint64_t *count)
 {
-	*count = 0;
-
 	/*
-	 * Move auto-seek messages to the output array (which is this
+	 * Move output messages to the output array (which is this
 	 * iterator's base message array).
 	 */
-	while (capacity > 0 && !g_queue_is_empty(trimmer_it->output_messages)) {
-		msgs[*count] = pop_message(trimmer_it);
-		capacity--;
-		(*count)++;
-	}
-
+	*count = bt_msg_ring_pop_array(&trimmer_it->output_messages,
+		msgs, capacity);
 	BT_ASSERT(*count > 0);
 }
 
@@ -1815,7 +2235,7 @@ bt_self_message_iterator_status state_ending(
 	bt_self_message_iterator_status status =
 		BT_SELF_MESSAGE_ITERATOR_STATUS_OK;
 
-	if (g_queue_is_empty(trimmer_it->output_messages)) {
+	if (bt_msg_ring_is_empty(&trimmer_it->output_messages)) {
 		trimmer_it->state = TRIMMER_ITERATOR_STATE_ENDED;
 		status = BT_SELF_MESSAGE_ITERATOR_STATUS_END;
 		goto end;
@@ -1840,7 +2260,7 @@ bt_self_message_iterator_status state_trim(struct trimmer_iterator *trimmer_it,
 	uint64_t i;
 	bool reached_end = false;
 
-	while (g_queue_is_empty(trimmer_it->output_messages)) {
+	while (bt_msg_ring_is_empty(&trimmer_it->output_messages)) {
 		status = (int) bt_self_component_port_input_message_iterator_next(
 			trimmer_it->upstream_iter, &my_msgs, &my_count);
 		if (unlikely(status != BT_SELF_MESSAGE_ITERATOR_STATUS_OK)) {
@@ -1860,16 +2280,22 @@ bt_self_message_iterator_status state_trim(struct trimmer_iterator *trimmer_it,
 		}
 
 		BT_ASSERT(my_count > 0);
+		i = 0;
 
-		for (i = 0; i < my_count; i++) {
+		while (i < my_count) {
+			bool seeked;
+
+			reached_end = false;
 			status = handle_message(trimmer_it, my_msgs[i],
 				&reached_end);
 
-			/*
-			 * handle_message() unconditionally consumes the
-			 * message reference.
-			 */
-			my_msgs[i] = NULL;
+			if (likely(!reached_end)) {
+				/*
+				 * handle_message() consumed the message
+				 * reference.
+				 */
+				my_msgs[i] = NULL;
+			}
 
 			if (unlikely(status !=
 					BT_SELF_MESSAGE_ITERATOR_STATUS_OK)) {
@@ -1877,11 +2303,17 @@ bt_self_message_iterator_status state_trim(struct trimmer_iterator *trimmer_it,
 				goto end;
 			}
 
-			if (unlikely(reached_end)) {
+			if (likely(!reached_end)) {
+				i++;
+				continue;
+			}
+
+			if (trimmer_it->cur_range_index + 1 >=
+					trimmer_it->ranges->len) {
 				/*
 				 * This message's time was passed the
-				 * trimming time range's end time: we
-				 * are done. Their might still be
+				 * last trimming time range's end time:
+				 * we are done. Their might still be
 				 * messages in the output message queue,
 				 * so move to the "ending" state and
 				 * apply it immediately since
@@ -1895,6 +2327,28 @@ bt_self_message_iterator_status state_trim(struct trimmer_iterator *trimmer_it,
 					capacity, count);
 				goto end;
 			}
+
+			status = switch_to_next_range(trimmer_it, &seeked);
+			if (unlikely(status !=
+					BT_SELF_MESSAGE_ITERATOR_STATUS_OK)) {
+				put_messages(my_msgs, my_count);
+				goto end;
+			}
+
+			if (seeked) {
+				/*
+				 * The upstream message iterator now
+				 * starts at the next range's beginning:
+				 * discard what's left of this batch.
+				 */
+				put_messages(my_msgs, my_count);
+				break;
+			}
+
+			/*
+			 * Handle the same message again within the
+			 * next range.
+			 */
 		}
 	}
 
@@ -1902,7 +2356,7 @@ bt_self_message_iterator_status state_trim(struct trimmer_iterator *trimmer_it,
 	 * There's at least one message in the output message queue:
 	 * move the messages to the output message array.
 	 */
-	BT_ASSERT(!g_queue_is_empty(trimmer_it->output_messages));
+	BT_ASSERT(!bt_msg_ring_is_empty(&trimmer_it->output_messages));
 	fill_message_array_from_output_messages(trimmer_it, msgs,
 		capacity, count);
 
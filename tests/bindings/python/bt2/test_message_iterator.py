@@ -174,3 +174,111 @@ class OutputPortMessageIteratorTestCase(unittest.TestCase):
             self.assertEqual(msg.event.event_class.name, 'salut')
             field = msg.event.payload_field['my_int']
             self.assertEqual(field, at * 3)
+
+
+# Message with a fake native address, the references of which the
+# tests count.
+class _FakeMessage(bt2.message._Message):
+    refs = collections.Counter()
+
+    @staticmethod
+    def _get_ref(ptr):
+        _FakeMessage.refs[ptr] += 1
+
+    @staticmethod
+    def _put_ref(ptr):
+        _FakeMessage.refs[ptr] -= 1
+
+
+class UserMessageIteratorBatchTestCase(unittest.TestCase):
+    def setUp(self):
+        _FakeMessage.refs.clear()
+
+    # Creates a user message iterator the way the native side does.
+    @staticmethod
+    def _create_iter(iter_cls):
+        msg_iter = iter_cls.__new__(iter_cls, None)
+        msg_iter.__init__()
+        return msg_iter
+
+    # Calls _next_from_native() with `capacity` until the iterator
+    # ends, returning the list of returned address lists.
+    @staticmethod
+    def _next_all(msg_iter, capacity):
+        batches = []
+
+        while True:
+            try:
+                batches.append(msg_iter._next_from_native(capacity))
+            except bt2.Stop:
+                return batches
+
+    def test_batch(self):
+        class MyIter(bt2._UserMessageIterator):
+            def __init__(self):
+                self._at = 0
+
+            def __next__(self):
+                if self._at == 10:
+                    raise bt2.Stop
+
+                msgs = []
+
+                for i in range(2):
+                    msgs.append(_FakeMessage._create_from_ptr_and_get_ref(self._at * 3))
+                    self._at += 1
+
+                return msgs
+
+        batches = self._next_all(self._create_iter(MyIter), 16)
+        self.assertEqual(batches, [[0, 3], [6, 9], [12, 15], [18, 21], [24, 27]])
+
+        # only the native side's references are left
+        for at in range(10):
+            self.assertEqual(_FakeMessage.refs[at * 3], 1)
+
+    def test_batch_over_capacity(self):
+        class MyIter(bt2._UserMessageIterator):
+            def __init__(self):
+                self._done = False
+
+            def __next__(self):
+                if self._done:
+                    raise bt2.Stop
+
+                self._done = True
+                return [_FakeMessage._create_from_ptr_and_get_ref(at) for at in range(5)]
+
+        batches = self._next_all(self._create_iter(MyIter), 2)
+        self.assertEqual(batches, [[0, 1], [2, 3], [4]])
+
+    def test_single_msg(self):
+        class MyIter(bt2._UserMessageIterator):
+            def __init__(self):
+                self._at = 0
+
+            def __next__(self):
+                if self._at == 3:
+                    raise bt2.Stop
+
+                self._at += 1
+                return _FakeMessage._create_from_ptr_and_get_ref(self._at)
+
+        batches = self._next_all(self._create_iter(MyIter), 16)
+        self.assertEqual(batches, [[1], [2], [3]])
+
+    def test_empty_batch(self):
+        class MyIter(bt2._UserMessageIterator):
+            def __next__(self):
+                return []
+
+        with self.assertRaises(ValueError):
+            self._create_iter(MyIter)._next_from_native(16)
+
+    def test_batch_wrong_type(self):
+        class MyIter(bt2._UserMessageIterator):
+            def __next__(self):
+                return [_FakeMessage._create_from_ptr_and_get_ref(1), 23]
+
+        with self.assertRaises(TypeError):
+            self._create_iter(MyIter)._next_from_native(16)
@@ -0,0 +1,329 @@
+/*
+ * test_fc_enum_lookup.c
+ *
+ * Enumeration field class label lookup tests
+ *
+ * Copyright (C) - 2019 EfficiOS Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; under version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <babeltrace/babeltrace.h>
+#include <babeltrace/assert-internal.h>
+#include <inttypes.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "tap/tap.h"
+
+#define NR_TESTS	27
+
+/*
+ * Checks that `label_array` contains exactly the `count` labels
+ * passed as variable arguments, in this order.
+ */
+static
+bool labels_are(bt_field_class_enumeration_mapping_label_array label_array,
+		uint64_t count, uint64_t exp_count, ...)
+{
+	bool ret = true;
+	uint64_t i;
+	va_list args;
+
+	if (count != exp_count) {
+		diag("Expecting %" PRIu64 " labels, got %" PRIu64,
+			exp_count, count);
+		return false;
+	}
+
+	va_start(args, exp_count);
+
+	for (i = 0; i < count; i++) {
+		const char *exp_label = va_arg(args, const char *);
+
+		if (strcmp(label_array[i], exp_label) != 0) {
+			diag("Expecting label `%s` at index %" PRIu64
+				", got `%s`", exp_label, i, label_array[i]);
+			ret = false;
+		}
+	}
+
+	va_end(args);
+	return ret;
+}
+
+static
+bool unsigned_labels_are(const bt_field_class *fc, uint64_t value,
+		uint64_t exp_count, const char *label0, const char *label1)
+{
+	bt_field_class_enumeration_mapping_label_array label_array;
+	uint64_t count;
+	bt_field_class_status status;
+
+	status = bt_field_class_unsigned_enumeration_get_mapping_labels_by_value(
+		fc, value, &label_array, &count);
+	BT_ASSERT(status == BT_FIELD_CLASS_STATUS_OK);
+	return labels_are(label_array, count, exp_count, label0, label1);
+}
+
+static
+bool signed_labels_are(const bt_field_class *fc, int64_t value,
+		uint64_t exp_count, const char *label0, const char *label1)
+{
+	bt_field_class_enumeration_mapping_label_array label_array;
+	uint64_t count;
+	bt_field_class_status status;
+
+	status = bt_field_class_signed_enumeration_get_mapping_labels_by_value(
+		fc, value, &label_array, &count);
+	BT_ASSERT(status == BT_FIELD_CLASS_STATUS_OK);
+	return labels_are(label_array, count, exp_count, label0, label1);
+}
+
+static
+bt_field_class *create_unsigned_enum_fc(bt_trace_class *tc, bool sparse)
+{
+	bt_field_class *fc;
+	int ret;
+
+	fc = bt_field_class_unsigned_enumeration_create(tc);
+	BT_ASSERT(fc);
+	ret = bt_field_class_unsigned_enumeration_map_range(fc, "A", 0, 4);
+	BT_ASSERT(ret == 0);
+	ret = bt_field_class_unsigned_enumeration_map_range(fc, "B", 3, 10);
+	BT_ASSERT(ret == 0);
+	ret = bt_field_class_unsigned_enumeration_map_range(fc, "C", 100, 100);
+	BT_ASSERT(ret == 0);
+	ret = bt_field_class_unsigned_enumeration_map_range(fc, "A", 200, 300);
+	BT_ASSERT(ret == 0);
+
+	if (sparse) {
+		/* Too far from the other ranges for a direct table */
+		ret = bt_field_class_unsigned_enumeration_map_range(fc, "D",
+			UINT64_C(1) << 40, (UINT64_C(1) << 40) + 5);
+		BT_ASSERT(ret == 0);
+		ret = bt_field_class_unsigned_enumeration_map_range(fc, "E",
+			UINT64_MAX - 1, UINT64_MAX);
+		BT_ASSERT(ret == 0);
+	}
+
+	return fc;
+}
+
+static
+void test_unsigned(bt_trace_class *tc, bool sparse)
+{
+	bt_field_class *fc = create_unsigned_enum_fc(tc, sparse);
+	const char *kind = sparse ? "sparse" : "dense";
+	int ret;
+
+	ok(unsigned_labels_are(fc, 0, 1, "A", NULL) &&
+		unsigned_labels_are(fc, 2, 1, "A", NULL),
+		"unsigned %s enumeration: value in a single range", kind);
+	ok(unsigned_labels_are(fc, 3, 2, "A", "B") &&
+		unsigned_labels_are(fc, 4, 2, "A", "B"),
+		"unsigned %s enumeration: value in overlapping ranges (mapping order)",
+		kind);
+	ok(unsigned_labels_are(fc, 5, 1, "B", NULL) &&
+		unsigned_labels_are(fc, 10, 1, "B", NULL) &&
+		unsigned_labels_are(fc, 100, 1, "C", NULL) &&
+		unsigned_labels_are(fc, 250, 1, "A", NULL),
+		"unsigned %s enumeration: range bounds", kind);
+	ok(unsigned_labels_are(fc, 11, 0, NULL, NULL) &&
+		unsigned_labels_are(fc, 99, 0, NULL, NULL) &&
+		unsigned_labels_are(fc, 301, 0, NULL, NULL),
+		"unsigned %s enumeration: unmapped values", kind);
+
+	if (sparse) {
+		ok(unsigned_labels_are(fc, (UINT64_C(1) << 40) + 3, 1, "D",
+			NULL) &&
+			unsigned_labels_are(fc, UINT64_MAX, 1, "E", NULL) &&
+			unsigned_labels_are(fc, UINT64_MAX - 2, 0, NULL,
+				NULL),
+			"unsigned sparse enumeration: far ranges");
+	} else {
+		ok(unsigned_labels_are(fc, UINT64_MAX, 0, NULL, NULL),
+			"unsigned dense enumeration: value beyond the direct table");
+	}
+
+	/* Adding a mapping after a lookup */
+	ret = bt_field_class_unsigned_enumeration_map_range(fc, "F", 11, 11);
+	BT_ASSERT(ret == 0);
+	ok(unsigned_labels_are(fc, 11, 1, "F", NULL) &&
+		unsigned_labels_are(fc, 10, 1, "B", NULL),
+		"unsigned %s enumeration: lookup sees a mapping added after a lookup",
+		kind);
+	bt_field_class_put_ref(fc);
+}
+
+static
+void test_signed(bt_trace_class *tc, bool sparse)
+{
+	bt_field_class *fc;
+	const char *kind = sparse ? "sparse" : "dense";
+	int ret;
+
+	fc = bt_field_class_signed_enumeration_create(tc);
+	BT_ASSERT(fc);
+	ret = bt_field_class_signed_enumeration_map_range(fc, "NEG", -10, -1);
+	BT_ASSERT(ret == 0);
+	ret = bt_field_class_signed_enumeration_map_range(fc, "MID", -1, 5);
+	BT_ASSERT(ret == 0);
+
+	if (sparse) {
+		ret = bt_field_class_signed_enumeration_map_range(fc, "MIN",
+			INT64_MIN, INT64_MIN + 1);
+		BT_ASSERT(ret == 0);
+		ret = bt_field_class_signed_enumeration_map_range(fc, "MAX",
+			INT64_MAX, INT64_MAX);
+		BT_ASSERT(ret == 0);
+	}
+
+	ok(signed_labels_are(fc, -10, 1, "NEG", NULL) &&
+		signed_labels_are(fc, -5, 1, "NEG", NULL),
+		"signed %s enumeration: negative value", kind);
+	ok(signed_labels_are(fc, -1, 2, "NEG", "MID"),
+		"signed %s enumeration: value in overlapping ranges", kind);
+	ok(signed_labels_are(fc, 0, 1, "MID", NULL) &&
+		signed_labels_are(fc, 5, 1, "MID", NULL),
+		"signed %s enumeration: non-negative value", kind);
+	ok(signed_labels_are(fc, -11, 0, NULL, NULL) &&
+		signed_labels_are(fc, 6, 0, NULL, NULL),
+		"signed %s enumeration: unmapped values", kind);
+
+	if (sparse) {
+		ok(signed_labels_are(fc, INT64_MIN, 1, "MIN", NULL) &&
+			signed_labels_are(fc, INT64_MAX, 1, "MAX", NULL) &&
+			signed_labels_are(fc, INT64_MIN + 2, 0, NULL, NULL),
+			"signed sparse enumeration: extreme values");
+	} else {
+		ok(signed_labels_are(fc, INT64_MIN, 0, NULL, NULL) &&
+			signed_labels_are(fc, INT64_MAX, 0, NULL, NULL),
+			"signed dense enumeration: values beyond the direct table");
+	}
+
+	ok(signed_labels_are(fc, 4, 1, "MID", NULL),
+		"signed %s enumeration: repeated lookup", kind);
+	bt_field_class_put_ref(fc);
+}
+
+/*
+ * Ranges which end at the largest (biased) key, all close enough to
+ * each other to get a direct lookup table.
+ */
+static
+void test_dense_extremes(bt_trace_class *tc)
+{
+	bt_field_class *fc;
+	int ret;
+
+	fc = bt_field_class_unsigned_enumeration_create(tc);
+	BT_ASSERT(fc);
+	ret = bt_field_class_unsigned_enumeration_map_range(fc, "LOW",
+		UINT64_MAX - 10, UINT64_MAX - 8);
+	BT_ASSERT(ret == 0);
+	ret = bt_field_class_unsigned_enumeration_map_range(fc, "TOP",
+		UINT64_MAX - 3, UINT64_MAX);
+	BT_ASSERT(ret == 0);
+	ok(unsigned_labels_are(fc, UINT64_MAX, 1, "TOP", NULL) &&
+		unsigned_labels_are(fc, UINT64_MAX - 3, 1, "TOP", NULL) &&
+		unsigned_labels_are(fc, UINT64_MAX - 4, 0, NULL, NULL) &&
+		unsigned_labels_are(fc, UINT64_MAX - 9, 1, "LOW", NULL),
+		"unsigned dense enumeration: range ending at UINT64_MAX");
+	bt_field_class_put_ref(fc);
+
+	fc = bt_field_class_signed_enumeration_create(tc);
+	BT_ASSERT(fc);
+	ret = bt_field_class_signed_enumeration_map_range(fc, "LOW",
+		INT64_MAX - 6, INT64_MAX - 5);
+	BT_ASSERT(ret == 0);
+	ret = bt_field_class_signed_enumeration_map_range(fc, "TOP",
+		INT64_MAX - 2, INT64_MAX);
+	BT_ASSERT(ret == 0);
+	ok(signed_labels_are(fc, INT64_MAX, 1, "TOP", NULL) &&
+		signed_labels_are(fc, INT64_MAX - 2, 1, "TOP", NULL) &&
+		signed_labels_are(fc, INT64_MAX - 3, 0, NULL, NULL) &&
+		signed_labels_are(fc, INT64_MAX - 5, 1, "LOW", NULL),
+		"signed dense enumeration: range ending at INT64_MAX");
+	bt_field_class_put_ref(fc);
+
+	fc = bt_field_class_signed_enumeration_create(tc);
+	BT_ASSERT(fc);
+	ret = bt_field_class_signed_enumeration_map_range(fc, "BOTTOM",
+		INT64_MIN, INT64_MIN + 2);
+	BT_ASSERT(ret == 0);
+	ret = bt_field_class_signed_enumeration_map_range(fc, "HIGH",
+		INT64_MIN + 5, INT64_MIN + 5);
+	BT_ASSERT(ret == 0);
+	ok(signed_labels_are(fc, INT64_MIN, 1, "BOTTOM", NULL) &&
+		signed_labels_are(fc, INT64_MIN + 2, 1, "BOTTOM", NULL) &&
+		signed_labels_are(fc, INT64_MIN + 3, 0, NULL, NULL) &&
+		signed_labels_are(fc, INT64_MIN + 5, 1, "HIGH", NULL) &&
+		signed_labels_are(fc, INT64_MAX, 0, NULL, NULL),
+		"signed dense enumeration: range starting at INT64_MIN");
+	bt_field_class_put_ref(fc);
+}
+
+static
+bt_self_component_status src_init(
+	bt_self_component_source *self_comp,
+	const bt_value *params, void *init_method_data)
+{
+	bt_trace_class *tc;
+
+	tc = bt_trace_class_create(
+		bt_self_component_source_as_self_component(self_comp));
+	BT_ASSERT(tc);
+	test_unsigned(tc, false);
+	test_unsigned(tc, true);
+	test_signed(tc, false);
+	test_signed(tc, true);
+	test_dense_extremes(tc);
+	bt_trace_class_put_ref(tc);
+	return BT_SELF_COMPONENT_STATUS_OK;
+}
+
+static
+bt_self_message_iterator_status src_iter_next(
+		bt_self_message_iterator *self_iterator,
+		bt_message_array_const msgs, uint64_t capacity,
+		uint64_t *count)
+{
+	return BT_SELF_MESSAGE_ITERATOR_STATUS_ERROR;
+}
+
+int main(int argc, char **argv)
+{
+	bt_component_class_source *comp_cls;
+	bt_graph *graph;
+	int ret;
+
+	plan_tests(NR_TESTS);
+
+	/* A trace class needs a component: run the tests in its init */
+	comp_cls = bt_component_class_source_create("src", src_iter_next);
+	BT_ASSERT(comp_cls);
+	ret = bt_component_class_source_set_init_method(comp_cls, src_init);
+	BT_ASSERT(ret == 0);
+	graph = bt_graph_create();
+	BT_ASSERT(graph);
+	ret = bt_graph_add_source_component(graph, comp_cls, "src-comp",
+		NULL, NULL);
+	BT_ASSERT(ret == 0);
+	bt_graph_put_ref(graph);
+	bt_component_class_source_put_ref(comp_cls);
+	return exit_status();
+}
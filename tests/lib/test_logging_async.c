@@ -0,0 +1,301 @@
+/*
+ * test_logging_async.c
+ *
+ * Babeltrace asynchronous logging output tests
+ *
+ * Copyright (C) - 2019 EfficiOS Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; under version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#define BT_LOG_OUTPUT_LEVEL log_level
+#define BT_LOG_TAG "TEST/LOGGING-ASYNC"
+#include <babeltrace/logging-internal.h>
+
+#include <babeltrace/assert-internal.h>
+#include <babeltrace/logging-async-internal.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "tap/tap.h"
+
+#define NR_TESTS	13
+
+/* Few enough to fit in a ring buffer: none is dropped */
+#define NR_LINES	200
+
+static int log_level = BT_LOG_INFO;
+
+/* Only declared in debug mode, but always defined */
+extern void bt_common_assert_failed(const char *file, int line,
+	const char *func, const char *assertion) __attribute__((noreturn));
+
+enum child_end {
+	CHILD_END_EXIT,
+	CHILD_END_ABORT,
+	CHILD_END_ASSERT,
+	CHILD_END_SEGV,
+};
+
+/* Writes the message part of a log line only */
+static
+void pipe_output_cb(const bt_log_message *msg, void *arg)
+{
+	const int fd = *(int *) arg;
+	ssize_t ret;
+
+	*msg->p = '\n';
+	ret = write(fd, msg->msg_b, msg->p - msg->msg_b + 1);
+	BT_ASSERT(ret == msg->p - msg->msg_b + 1);
+}
+
+/*
+ * Makes the calling (child) process's log lines go to `fd`, exiting
+ * with a failure status if the asynchronous output is not enabled.
+ */
+static
+void set_child_output(int fd)
+{
+	static int child_fd;
+
+	if (!bt_log_async_backend_is_enabled()) {
+		exit(EXIT_FAILURE);
+	}
+
+	child_fd = fd;
+	bt_log_set_output_v(BT_LOG_PUT_STD, &child_fd, pipe_output_cb);
+}
+
+/*
+ * Logs `NR_LINES` lines of various lengths (so that the ring buffer
+ * records have various sizes), and then terminates as per `end`.
+ */
+static
+void run_child(int fd, enum child_end end)
+{
+	int i;
+
+	set_child_output(fd);
+
+	for (i = 0; i < NR_LINES; i++) {
+		BT_LOGI("Line #%d: %.*s", i, i % 61,
+			"abcdefghijklmnopqrstuvwxyzabcdefghijklmnopqrstuvwxyz0123456789");
+	}
+
+	switch (end) {
+	case CHILD_END_EXIT:
+		exit(EXIT_SUCCESS);
+	case CHILD_END_ABORT:
+		abort();
+	case CHILD_END_ASSERT:
+		bt_common_assert_failed(__FILE__, __LINE__, __func__, "false");
+	case CHILD_END_SEGV:
+		raise(SIGSEGV);
+		break;
+	}
+
+	exit(EXIT_FAILURE);
+}
+
+/*
+ * Logs lines of which the message part is formatted by the writer
+ * thread, or by the logging thread for a format string which the
+ * asynchronous output cannot defer, and then exits.
+ */
+static
+void run_format_child(int fd)
+{
+	char str[] = "copied";
+
+	set_child_output(fd);
+	BT_LOGI("Format: %d %u %ld %lld %zu %jd %td %hhd %x %#o %c %%",
+		-1, 2U, -3L, 4LL, (size_t) 5, (intmax_t) -6, (ptrdiff_t) 7,
+		8, 0xbeef, 9, 'z');
+	BT_LOGI("Format: %8.3f|%-6e|%g|%p|%s|%.3s|%5s|%*d|%-*.*s|",
+		3.14159, 2.5, 0.125, (void *) 0x1234, "str", "abcdef", "ab",
+		4, 10, 6, 2, "xyz");
+	BT_LOGI("Format: %s", str);
+
+	/* The writer thread must not see this */
+	strcpy(str, "CHANGE");
+	BT_LOGI("Format: %1$d %1$d", 11);
+	exit(EXIT_SUCCESS);
+}
+
+/*
+ * Returns the message parts which run_format_child() logs, formatted
+ * synchronously.
+ */
+static
+void expected_format_lines(char lines[][128])
+{
+	snprintf(lines[0], 128,
+		"Format: %d %u %ld %lld %zu %jd %td %hhd %x %#o %c %%",
+		-1, 2U, -3L, 4LL, (size_t) 5, (intmax_t) -6, (ptrdiff_t) 7,
+		8, 0xbeef, 9, 'z');
+	snprintf(lines[1], 128,
+		"Format: %8.3f|%-6e|%g|%p|%s|%.3s|%5s|%*d|%-*.*s|",
+		3.14159, 2.5, 0.125, (void *) 0x1234, "str", "abcdef", "ab",
+		4, 10, 6, 2, "xyz");
+	snprintf(lines[2], 128, "Format: %s", "copied");
+	snprintf(lines[3], 128, "Format: %1$d %1$d", 11);
+}
+
+/*
+ * Forks a child which runs run_format_child() if `format` is true, or
+ * run_child() with `end` otherwise, and returns a stream of what it
+ * logs, setting `*pid` to its process ID.
+ */
+static
+FILE *fork_child(enum child_end end, bool format, pid_t *pid)
+{
+	int fds[2];
+	FILE *fp;
+	int ret;
+
+	ret = pipe(fds);
+	BT_ASSERT(ret == 0);
+
+	/* Do not write the pending TAP output twice */
+	fflush(stdout);
+	*pid = fork();
+	BT_ASSERT(*pid >= 0);
+
+	if (*pid == 0) {
+		/* Keep the TAP output clean of the child's messages */
+		const int null_fd = open("/dev/null", O_WRONLY);
+
+		BT_ASSERT(null_fd >= 0);
+		dup2(null_fd, STDOUT_FILENO);
+		dup2(null_fd, STDERR_FILENO);
+		close(fds[0]);
+
+		if (format) {
+			run_format_child(fds[1]);
+		} else {
+			run_child(fds[1], end);
+		}
+	}
+
+	close(fds[1]);
+	fp = fdopen(fds[0], "r");
+	BT_ASSERT(fp);
+	return fp;
+}
+
+/*
+ * Counts the log lines which a child terminating as per `end` writes,
+ * setting `*status` to its wait status.
+ */
+static
+int count_child_lines(enum child_end end, int *status)
+{
+	pid_t pid;
+	FILE *fp;
+	char line[512];
+	int count = 0;
+	int ret;
+
+	fp = fork_child(end, false, &pid);
+
+	while (fgets(line, sizeof(line), fp)) {
+		if (strstr(line, "Line #")) {
+			count++;
+		}
+	}
+
+	ret = fclose(fp);
+	BT_ASSERT(ret == 0);
+	ret = waitpid(pid, status, 0);
+	BT_ASSERT(ret == pid);
+	return count;
+}
+
+static
+void test_child_end(enum child_end end, const char *what, int sig)
+{
+	int status;
+	int count;
+
+	count = count_child_lines(end, &status);
+	ok(count == NR_LINES, "all log lines are written on %s", what);
+
+	if (sig) {
+		ok(WIFSIGNALED(status) && WTERMSIG(status) == sig,
+			"process is still terminated by the signal on %s",
+			what);
+	} else {
+		ok(WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS,
+			"process exits normally on %s", what);
+	}
+}
+
+static
+void test_format(void)
+{
+	char expected[4][128];
+	char line[512];
+	int status;
+	pid_t pid;
+	FILE *fp;
+	int i = 0;
+	int ret;
+
+	expected_format_lines(expected);
+	fp = fork_child(CHILD_END_EXIT, true, &pid);
+
+	while (fgets(line, sizeof(line), fp)) {
+		line[strcspn(line, "\n")] = '\0';
+
+		if (i < 4) {
+			ok(strcmp(line, expected[i]) == 0,
+				"log line #%d is formatted as if synchronously", i);
+		}
+
+		i++;
+	}
+
+	ret = fclose(fp);
+	BT_ASSERT(ret == 0);
+	ret = waitpid(pid, &status, 0);
+	BT_ASSERT(ret == pid);
+	ok(i == 4 && WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS,
+		"child process exits normally after logging 4 lines");
+}
+
+int main(void)
+{
+	int ret;
+
+	/* Only the child processes log, so they start the writer thread */
+	ret = setenv("BABELTRACE_LOGGING_ASYNC", "1", 1);
+	BT_ASSERT(ret == 0);
+
+	plan_tests(NR_TESTS);
+	test_child_end(CHILD_END_EXIT, "exit", 0);
+	test_child_end(CHILD_END_ABORT, "abort()", SIGABRT);
+	test_child_end(CHILD_END_ASSERT, "assertion failure", SIGABRT);
+	test_child_end(CHILD_END_SEGV, "fatal signal", SIGSEGV);
+	test_format();
+	return exit_status();
+}
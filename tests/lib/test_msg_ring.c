@@ -0,0 +1,184 @@
+/*
+ * test_msg_ring.c
+ *
+ * Babeltrace message ring buffer tests
+ *
+ * Copyright (C) - 2019 EfficiOS Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; under version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <babeltrace/msg-ring-internal.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "tap/tap.h"
+
+#define NR_TESTS	13
+
+/*
+ * The ring never dereferences its messages: use fake, non-NULL
+ * message pointers.
+ */
+static inline
+const bt_message *fake_msg(uint64_t index)
+{
+	return (const bt_message *) (uintptr_t) ((index + 1) * 8);
+}
+
+static
+void test_init(void)
+{
+	struct bt_msg_ring ring;
+	int ret;
+
+	ret = bt_msg_ring_init(&ring, 0);
+	ok(ret == 0, "bt_msg_ring_init() succeeds");
+	ok(ring.capacity == BT_MSG_RING_DEFAULT_CAPACITY,
+		"bt_msg_ring_init() uses the default capacity");
+	ok(bt_msg_ring_is_empty(&ring) && !bt_msg_ring_pop(&ring) &&
+		!bt_msg_ring_peek(&ring),
+		"a new ring is empty");
+	bt_msg_ring_fini(&ring);
+
+	ret = bt_msg_ring_init(&ring, 15);
+	ok(ret == 0 && ring.capacity == 16,
+		"bt_msg_ring_init() rounds the capacity up to a power of two");
+	bt_msg_ring_fini(&ring);
+}
+
+static
+void test_push_pop(void)
+{
+	struct bt_msg_ring ring;
+	uint64_t i;
+	uint64_t next_pop = 0;
+	uint64_t next_push = 0;
+	bool in_order = true;
+	int ret;
+
+	ret = bt_msg_ring_init(&ring, 4);
+	BT_ASSERT(ret == 0);
+
+	/* Wrap around many times without growing */
+	for (i = 0; i < 100; i++) {
+		ret = bt_msg_ring_push(&ring, fake_msg(next_push++));
+		BT_ASSERT(ret == 0);
+		ret = bt_msg_ring_push(&ring, fake_msg(next_push++));
+		BT_ASSERT(ret == 0);
+
+		if (bt_msg_ring_peek(&ring) != fake_msg(next_pop) ||
+				bt_msg_ring_pop(&ring) != fake_msg(next_pop)) {
+			in_order = false;
+		}
+
+		next_pop++;
+
+		if (bt_msg_ring_pop(&ring) != fake_msg(next_pop)) {
+			in_order = false;
+		}
+
+		next_pop++;
+	}
+
+	ok(in_order, "messages are popped in push order when wrapping around");
+	ok(ring.capacity == 4, "the ring does not grow when not full");
+
+	/* Grow while the content wraps around */
+	ret = bt_msg_ring_push(&ring, fake_msg(next_push++));
+	BT_ASSERT(ret == 0);
+	ret = bt_msg_ring_push(&ring, fake_msg(next_push++));
+	BT_ASSERT(ret == 0);
+	bt_msg_ring_pop(&ring);
+	next_pop++;
+
+	for (i = 0; i < 20; i++) {
+		ret = bt_msg_ring_push(&ring, fake_msg(next_push++));
+		BT_ASSERT(ret == 0);
+	}
+
+	ok(ring.capacity == 32, "the ring grows to the next power of two");
+	ok(bt_msg_ring_length(&ring) == 21,
+		"the ring's length is correct after growing");
+
+	in_order = true;
+
+	while (!bt_msg_ring_is_empty(&ring)) {
+		if (bt_msg_ring_pop(&ring) != fake_msg(next_pop++)) {
+			in_order = false;
+		}
+	}
+
+	ok(in_order && next_pop == next_push,
+		"growing keeps the messages in order");
+	bt_msg_ring_fini(&ring);
+}
+
+static
+void test_arrays(void)
+{
+	struct bt_msg_ring ring;
+	const bt_message *in_msgs[40];
+	const bt_message *out_msgs[40];
+	uint64_t count;
+	uint64_t i;
+	bool in_order = true;
+	int ret;
+
+	for (i = 0; i < 40; i++) {
+		in_msgs[i] = fake_msg(i);
+	}
+
+	ret = bt_msg_ring_init(&ring, 8);
+	BT_ASSERT(ret == 0);
+
+	/* Move the head so that the next array push wraps around */
+	ret = bt_msg_ring_push_array(&ring, in_msgs, 6);
+	BT_ASSERT(ret == 0);
+	count = bt_msg_ring_pop_array(&ring, out_msgs, 5);
+	ok(count == 5 && out_msgs[0] == fake_msg(0) &&
+		out_msgs[4] == fake_msg(4),
+		"bt_msg_ring_pop_array() pops at most the requested count");
+
+	ret = bt_msg_ring_push_array(&ring, &in_msgs[6], 6);
+	BT_ASSERT(ret == 0);
+	ok(ring.capacity == 8 && bt_msg_ring_length(&ring) == 7,
+		"bt_msg_ring_push_array() wraps around without growing");
+
+	ret = bt_msg_ring_push_array(&ring, &in_msgs[12], 28);
+	BT_ASSERT(ret == 0);
+	ok(ring.capacity == 64 && bt_msg_ring_length(&ring) == 35,
+		"bt_msg_ring_push_array() grows the ring to fit all the messages");
+
+	count = bt_msg_ring_pop_array(&ring, out_msgs, 40);
+
+	for (i = 0; i < count; i++) {
+		if (out_msgs[i] != fake_msg(i + 5)) {
+			in_order = false;
+		}
+	}
+
+	ok(count == 35 && in_order && bt_msg_ring_is_empty(&ring),
+		"bt_msg_ring_pop_array() pops all the messages in order");
+	bt_msg_ring_fini(&ring);
+}
+
+int main(void)
+{
+	plan_tests(NR_TESTS);
+	test_init();
+	test_push_pop();
+	test_arrays();
+	return exit_status();
+}
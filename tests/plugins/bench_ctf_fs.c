@@ -0,0 +1,636 @@
+/*
+ * bench_ctf_fs.c
+ *
+ * Babeltrace src.ctf.fs to sink.ctf.fs trace conversion microbenchmark
+ *
+ * Copyright (C) - 2019 EfficiOS Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; under version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+/*
+ * This program converts a CTF trace to another CTF trace:
+ *
+ *     src.ctf.fs -> sink.ctf.fs
+ *
+ * It first generates the input trace, in a temporary directory, with
+ * the following graph:
+ *
+ *     src -> sink.ctf.fs
+ *
+ * The source component emits EVENT-COUNT events of a single event class
+ * of which the payload contains integer fields of various sizes and
+ * signedness, real number fields, a nested structure field, and a
+ * string field, as typical tracer events do. Only the time spent
+ * running the conversion graph is measured.
+ *
+ * Usage:
+ *
+ *     BABELTRACE_PLUGIN_PATH=plugins/ctf \
+ *         bench_ctf_fs [EVENT-COUNT [EVENT-COUNT-PER-PACKET]]
+ *
+ * To compare two versions of the CTF plugin, run this program with
+ * each of them on the same machine with the same arguments.
+ */
+
+#include <babeltrace/babeltrace.h>
+#include <babeltrace/assert-internal.h>
+#include <babeltrace/compat/stdlib-internal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <unistd.h>
+#include <ftw.h>
+#include <sys/stat.h>
+#include <glib.h>
+
+#define DEFAULT_EVENT_COUNT		5000000
+#define DEFAULT_EVENT_COUNT_PER_PACKET	10000
+
+enum bench_src_iter_state {
+	BENCH_SRC_ITER_STATE_STREAM_BEGINNING,
+	BENCH_SRC_ITER_STATE_PACKET_BEGINNING,
+	BENCH_SRC_ITER_STATE_EVENT,
+	BENCH_SRC_ITER_STATE_PACKET_END,
+	BENCH_SRC_ITER_STATE_STREAM_END,
+	BENCH_SRC_ITER_STATE_DONE,
+};
+
+struct bench_src {
+	/* Owned by this */
+	bt_trace_class *trace_class;
+
+	/* Owned by this */
+	bt_clock_class *clock_class;
+
+	/* Owned by this */
+	bt_stream_class *stream_class;
+
+	/* Owned by this */
+	bt_event_class *event_class;
+
+	/* Owned by this */
+	bt_trace *trace;
+
+	/* Owned by this */
+	bt_stream *stream;
+};
+
+struct bench_src_iter {
+	/* Weak */
+	struct bench_src *src;
+
+	/* Weak */
+	bt_self_message_iterator *self_msg_iter;
+
+	/* Owned by this */
+	bt_packet *packet;
+
+	enum bench_src_iter_state state;
+	uint64_t next_event_index;
+	uint64_t packet_event_count;
+};
+
+static uint64_t event_count = DEFAULT_EVENT_COUNT;
+static uint64_t event_count_per_packet = DEFAULT_EVENT_COUNT_PER_PACKET;
+
+static
+void append_member(bt_field_class *struct_fc, const char *name,
+		bt_field_class *member_fc)
+{
+	int ret;
+
+	BT_ASSERT(member_fc);
+	ret = bt_field_class_structure_append_member(struct_fc, name,
+		member_fc);
+	BT_ASSERT(ret == 0);
+	bt_field_class_put_ref(member_fc);
+}
+
+static
+bt_field_class *create_int_fc(bt_trace_class *tc, bool is_signed,
+		uint64_t size)
+{
+	bt_field_class *fc = is_signed ?
+		bt_field_class_signed_integer_create(tc) :
+		bt_field_class_unsigned_integer_create(tc);
+
+	BT_ASSERT(fc);
+	bt_field_class_integer_set_field_value_range(fc, size);
+	return fc;
+}
+
+static
+bt_field_class *create_real_fc(bt_trace_class *tc, bool single_precision)
+{
+	bt_field_class *fc = bt_field_class_real_create(tc);
+
+	BT_ASSERT(fc);
+	bt_field_class_real_set_is_single_precision(fc,
+		single_precision ? BT_TRUE : BT_FALSE);
+	return fc;
+}
+
+static
+bt_field_class *create_payload_fc(bt_trace_class *tc)
+{
+	bt_field_class *payload_fc = bt_field_class_structure_create(tc);
+	bt_field_class *inner_fc = bt_field_class_structure_create(tc);
+
+	BT_ASSERT(payload_fc);
+	BT_ASSERT(inner_fc);
+	append_member(inner_fc, "fd", create_int_fc(tc, true, 32));
+	append_member(inner_fc, "addr", create_int_fc(tc, false, 64));
+	append_member(payload_fc, "cpu", create_int_fc(tc, false, 8));
+	append_member(payload_fc, "prio", create_int_fc(tc, true, 16));
+	append_member(payload_fc, "tid", create_int_fc(tc, false, 32));
+	append_member(payload_fc, "len", create_int_fc(tc, false, 64));
+	append_member(payload_fc, "ret", create_int_fc(tc, true, 64));
+	append_member(payload_fc, "ratio", create_real_fc(tc, false));
+	append_member(payload_fc, "load", create_real_fc(tc, true));
+	append_member(payload_fc, "file", inner_fc);
+	append_member(payload_fc, "flags", create_int_fc(tc, false, 7));
+	append_member(payload_fc, "comm",
+		bt_field_class_string_create(tc));
+	append_member(payload_fc, "seq", create_int_fc(tc, false, 32));
+	return payload_fc;
+}
+
+static
+void fill_payload_field(bt_field *payload_field, uint64_t index)
+{
+	bt_field *inner_field;
+	int ret;
+
+#define MEMBER(_i)	bt_field_structure_borrow_member_field_by_index( \
+				payload_field, (_i))
+
+	bt_field_unsigned_integer_set_value(MEMBER(0), index % 8);
+	bt_field_signed_integer_set_value(MEMBER(1), -20 + (int64_t) (index % 40));
+	bt_field_unsigned_integer_set_value(MEMBER(2), 1000 + index % 64);
+	bt_field_unsigned_integer_set_value(MEMBER(3), index * 4096);
+	bt_field_signed_integer_set_value(MEMBER(4), -(int64_t) index);
+	bt_field_real_set_value(MEMBER(5), (double) index / 3.);
+	bt_field_real_set_value(MEMBER(6), (double) (index % 100) / 100.);
+	inner_field = MEMBER(7);
+	bt_field_signed_integer_set_value(
+		bt_field_structure_borrow_member_field_by_index(inner_field, 0),
+		(int64_t) (index % 1024));
+	bt_field_unsigned_integer_set_value(
+		bt_field_structure_borrow_member_field_by_index(inner_field, 1),
+		UINT64_C(0x7f0000000000) + index * 8);
+	bt_field_unsigned_integer_set_value(MEMBER(8), index % 128);
+	ret = bt_field_string_set_value(MEMBER(9), "bench-thread");
+	BT_ASSERT(ret == 0);
+	bt_field_unsigned_integer_set_value(MEMBER(10), index);
+
+#undef MEMBER
+}
+
+static
+bt_self_component_status src_init(bt_self_component_source *self_comp,
+		const bt_value *params, void *init_method_data)
+{
+	struct bench_src *src = g_new0(struct bench_src, 1);
+	bt_self_component *self_comp_base =
+		bt_self_component_source_as_self_component(self_comp);
+	bt_field_class *payload_fc;
+	int ret;
+
+	BT_ASSERT(src);
+	src->trace_class = bt_trace_class_create(self_comp_base);
+	BT_ASSERT(src->trace_class);
+	src->clock_class = bt_clock_class_create(self_comp_base);
+	BT_ASSERT(src->clock_class);
+	src->stream_class = bt_stream_class_create(src->trace_class);
+	BT_ASSERT(src->stream_class);
+	ret = bt_stream_class_set_default_clock_class(src->stream_class,
+		src->clock_class);
+	BT_ASSERT(ret == 0);
+	src->event_class = bt_event_class_create(src->stream_class);
+	BT_ASSERT(src->event_class);
+	ret = bt_event_class_set_name(src->event_class, "bench_event");
+	BT_ASSERT(ret == 0);
+	payload_fc = create_payload_fc(src->trace_class);
+	ret = bt_event_class_set_payload_field_class(src->event_class,
+		payload_fc);
+	BT_ASSERT(ret == 0);
+	bt_field_class_put_ref(payload_fc);
+	src->trace = bt_trace_create(src->trace_class);
+	BT_ASSERT(src->trace);
+	src->stream = bt_stream_create(src->stream_class, src->trace);
+	BT_ASSERT(src->stream);
+	ret = bt_self_component_source_add_output_port(self_comp, "out",
+		NULL, NULL);
+	BT_ASSERT(ret == 0);
+	bt_self_component_set_data(self_comp_base, src);
+	return BT_SELF_COMPONENT_STATUS_OK;
+}
+
+static
+void src_finalize(bt_self_component_source *self_comp)
+{
+	struct bench_src *src = bt_self_component_get_data(
+		bt_self_component_source_as_self_component(self_comp));
+
+	bt_stream_put_ref(src->stream);
+	bt_trace_put_ref(src->trace);
+	bt_event_class_put_ref(src->event_class);
+	bt_stream_class_put_ref(src->stream_class);
+	bt_clock_class_put_ref(src->clock_class);
+	bt_trace_class_put_ref(src->trace_class);
+	g_free(src);
+}
+
+static
+bt_self_message_iterator_status src_iter_init(
+		bt_self_message_iterator *self_msg_iter,
+		bt_self_component_source *self_comp,
+		bt_self_component_port_output *self_port)
+{
+	struct bench_src_iter *src_iter = g_new0(struct bench_src_iter, 1);
+
+	BT_ASSERT(src_iter);
+	src_iter->src = bt_self_component_get_data(
+		bt_self_component_source_as_self_component(self_comp));
+	src_iter->self_msg_iter = self_msg_iter;
+	src_iter->state = BENCH_SRC_ITER_STATE_STREAM_BEGINNING;
+	bt_self_message_iterator_set_data(self_msg_iter, src_iter);
+	return BT_SELF_MESSAGE_ITERATOR_STATUS_OK;
+}
+
+static
+void src_iter_finalize(bt_self_message_iterator *self_msg_iter)
+{
+	struct bench_src_iter *src_iter =
+		bt_self_message_iterator_get_data(self_msg_iter);
+
+	bt_packet_put_ref(src_iter->packet);
+	g_free(src_iter);
+}
+
+static
+bt_message *src_iter_next_msg(struct bench_src_iter *src_iter)
+{
+	struct bench_src *src = src_iter->src;
+	bt_message *msg = NULL;
+
+	/* The event index is the clock value */
+	switch (src_iter->state) {
+	case BENCH_SRC_ITER_STATE_STREAM_BEGINNING:
+		msg = bt_message_stream_beginning_create(
+			src_iter->self_msg_iter, src->stream);
+		src_iter->state = src_iter->next_event_index < event_count ?
+			BENCH_SRC_ITER_STATE_PACKET_BEGINNING :
+			BENCH_SRC_ITER_STATE_STREAM_END;
+		break;
+	case BENCH_SRC_ITER_STATE_PACKET_BEGINNING:
+		BT_ASSERT(!src_iter->packet);
+		src_iter->packet = bt_packet_create(src->stream);
+		BT_ASSERT(src_iter->packet);
+		msg = bt_message_packet_beginning_create_with_default_clock_snapshot(
+			src_iter->self_msg_iter, src_iter->packet,
+			src_iter->next_event_index);
+		src_iter->packet_event_count = 0;
+		src_iter->state = BENCH_SRC_ITER_STATE_EVENT;
+		break;
+	case BENCH_SRC_ITER_STATE_EVENT:
+		msg = bt_message_event_create_with_default_clock_snapshot(
+			src_iter->self_msg_iter, src->event_class,
+			src_iter->packet, src_iter->next_event_index);
+		BT_ASSERT(msg);
+		fill_payload_field(bt_event_borrow_payload_field(
+			bt_message_event_borrow_event(msg)),
+			src_iter->next_event_index);
+		src_iter->next_event_index++;
+		src_iter->packet_event_count++;
+
+		if (src_iter->next_event_index == event_count ||
+				src_iter->packet_event_count ==
+				event_count_per_packet) {
+			src_iter->state = BENCH_SRC_ITER_STATE_PACKET_END;
+		}
+
+		break;
+	case BENCH_SRC_ITER_STATE_PACKET_END:
+		msg = bt_message_packet_end_create_with_default_clock_snapshot(
+			src_iter->self_msg_iter, src_iter->packet,
+			src_iter->next_event_index);
+		BT_PACKET_PUT_REF_AND_RESET(src_iter->packet);
+		src_iter->state = src_iter->next_event_index < event_count ?
+			BENCH_SRC_ITER_STATE_PACKET_BEGINNING :
+			BENCH_SRC_ITER_STATE_STREAM_END;
+		break;
+	case BENCH_SRC_ITER_STATE_STREAM_END:
+		msg = bt_message_stream_end_create(src_iter->self_msg_iter,
+			src->stream);
+		src_iter->state = BENCH_SRC_ITER_STATE_DONE;
+		break;
+	default:
+		abort();
+	}
+
+	BT_ASSERT(msg);
+	return msg;
+}
+
+static
+bt_self_message_iterator_status src_iter_next(
+		bt_self_message_iterator *self_msg_iter,
+		bt_message_array_const msgs, uint64_t capacity,
+		uint64_t *count)
+{
+	struct bench_src_iter *src_iter =
+		bt_self_message_iterator_get_data(self_msg_iter);
+	uint64_t i = 0;
+
+	if (src_iter->state == BENCH_SRC_ITER_STATE_DONE) {
+		return BT_SELF_MESSAGE_ITERATOR_STATUS_END;
+	}
+
+	while (i < capacity && src_iter->state != BENCH_SRC_ITER_STATE_DONE) {
+		msgs[i] = src_iter_next_msg(src_iter);
+		i++;
+	}
+
+	*count = i;
+	return BT_SELF_MESSAGE_ITERATOR_STATUS_OK;
+}
+
+static
+bt_value *create_sink_params(const char *path)
+{
+	bt_value *params = bt_value_map_create();
+	int ret;
+
+	BT_ASSERT(params);
+	ret = bt_value_map_insert_string_entry(params, "path", path);
+	BT_ASSERT(ret == 0);
+	ret = bt_value_map_insert_bool_entry(params, "assume-single-trace",
+		BT_TRUE);
+	BT_ASSERT(ret == 0);
+	ret = bt_value_map_insert_bool_entry(params, "quiet", BT_TRUE);
+	BT_ASSERT(ret == 0);
+	return params;
+}
+
+static
+bt_graph_status run_graph(bt_graph *graph)
+{
+	bt_graph_status graph_status;
+
+	do {
+		graph_status = bt_graph_run(graph);
+	} while (graph_status == BT_GRAPH_STATUS_AGAIN);
+
+	return graph_status;
+}
+
+/*
+ * Generates the input trace in `path` with the `src` component class.
+ */
+static
+int generate_trace(const bt_component_class_sink *fs_sink_comp_class,
+		const char *path)
+{
+	bt_component_class_source *src_comp_class;
+	const bt_component_source *src_comp;
+	const bt_component_sink *sink_comp;
+	bt_value *sink_params;
+	bt_graph *graph;
+	bt_graph_status graph_status;
+	int ret;
+
+	src_comp_class = bt_component_class_source_create("src",
+		src_iter_next);
+	BT_ASSERT(src_comp_class);
+	ret = bt_component_class_source_set_init_method(src_comp_class,
+		src_init);
+	BT_ASSERT(ret == 0);
+	ret = bt_component_class_source_set_finalize_method(src_comp_class,
+		src_finalize);
+	BT_ASSERT(ret == 0);
+	ret = bt_component_class_source_set_message_iterator_init_method(
+		src_comp_class, src_iter_init);
+	BT_ASSERT(ret == 0);
+	ret = bt_component_class_source_set_message_iterator_finalize_method(
+		src_comp_class, src_iter_finalize);
+	BT_ASSERT(ret == 0);
+	sink_params = create_sink_params(path);
+	graph = bt_graph_create();
+	BT_ASSERT(graph);
+	graph_status = bt_graph_add_source_component(graph, src_comp_class,
+		"src", NULL, &src_comp);
+	BT_ASSERT(graph_status == BT_GRAPH_STATUS_OK);
+	graph_status = bt_graph_add_sink_component(graph, fs_sink_comp_class,
+		"sink", sink_params, &sink_comp);
+	BT_ASSERT(graph_status == BT_GRAPH_STATUS_OK);
+	graph_status = bt_graph_connect_ports(graph,
+		bt_component_source_borrow_output_port_by_name_const(
+			src_comp, "out"),
+		bt_component_sink_borrow_input_port_by_name_const(
+			sink_comp, "in"), NULL);
+	BT_ASSERT(graph_status == BT_GRAPH_STATUS_OK);
+	graph_status = run_graph(graph);
+	ret = graph_status == BT_GRAPH_STATUS_END ? 0 : -1;
+	bt_graph_put_ref(graph);
+	bt_component_source_put_ref(src_comp);
+	bt_component_sink_put_ref(sink_comp);
+	bt_value_put_ref(sink_params);
+	bt_component_class_source_put_ref(src_comp_class);
+	return ret;
+}
+
+/*
+ * Converts the trace in `in_path` to a trace in `out_path`, setting
+ * `*elapsed` to the time spent running the graph (seconds).
+ */
+static
+int convert_trace(const bt_component_class_source *fs_src_comp_class,
+		const bt_component_class_sink *fs_sink_comp_class,
+		const char *in_path, const char *out_path, double *elapsed)
+{
+	const bt_component_source *src_comp;
+	const bt_component_sink *sink_comp;
+	bt_value *src_params;
+	bt_value *sink_params;
+	bt_value *paths;
+	bt_graph *graph;
+	GTimer *timer;
+	bt_graph_status graph_status;
+	int ret;
+
+	src_params = bt_value_map_create();
+	BT_ASSERT(src_params);
+	ret = bt_value_map_insert_empty_array_entry(src_params, "paths");
+	BT_ASSERT(ret == 0);
+	paths = bt_value_map_borrow_entry_value(src_params, "paths");
+	ret = bt_value_array_append_string_element(paths, in_path);
+	BT_ASSERT(ret == 0);
+	sink_params = create_sink_params(out_path);
+	graph = bt_graph_create();
+	BT_ASSERT(graph);
+	graph_status = bt_graph_add_source_component(graph,
+		fs_src_comp_class, "src", src_params, &src_comp);
+	BT_ASSERT(graph_status == BT_GRAPH_STATUS_OK);
+	graph_status = bt_graph_add_sink_component(graph, fs_sink_comp_class,
+		"sink", sink_params, &sink_comp);
+	BT_ASSERT(graph_status == BT_GRAPH_STATUS_OK);
+
+	/* Single data stream: single output port */
+	BT_ASSERT(bt_component_source_get_output_port_count(src_comp) == 1);
+	graph_status = bt_graph_connect_ports(graph,
+		bt_component_source_borrow_output_port_by_index_const(
+			src_comp, 0),
+		bt_component_sink_borrow_input_port_by_name_const(
+			sink_comp, "in"), NULL);
+	BT_ASSERT(graph_status == BT_GRAPH_STATUS_OK);
+	timer = g_timer_new();
+	BT_ASSERT(timer);
+	graph_status = run_graph(graph);
+	g_timer_stop(timer);
+	*elapsed = g_timer_elapsed(timer, NULL);
+	g_timer_destroy(timer);
+	ret = graph_status == BT_GRAPH_STATUS_END ? 0 : -1;
+	bt_graph_put_ref(graph);
+	bt_component_source_put_ref(src_comp);
+	bt_component_sink_put_ref(sink_comp);
+	bt_value_put_ref(src_params);
+	bt_value_put_ref(sink_params);
+	return ret;
+}
+
+static
+int rm_entry(const char *path, const struct stat *sb, int flag,
+		struct FTW *s)
+{
+	if (flag == FTW_DP) {
+		rmdir(path);
+	} else {
+		unlink(path);
+	}
+
+	return 0;
+}
+
+static
+uint64_t dir_size(const char *path)
+{
+	GDir *dir = g_dir_open(path, 0, NULL);
+	const char *name;
+	uint64_t size = 0;
+
+	BT_ASSERT(dir);
+
+	while ((name = g_dir_read_name(dir))) {
+		gchar *file_path = g_build_filename(path, name, NULL);
+		struct stat st;
+
+		if (stat(file_path, &st) == 0) {
+			size += (uint64_t) st.st_size;
+		}
+
+		g_free(file_path);
+	}
+
+	g_dir_close(dir);
+	return size;
+}
+
+int main(int argc, char **argv)
+{
+	const bt_plugin *ctf_plugin;
+	const bt_component_class_source *fs_src_comp_class;
+	const bt_component_class_sink *fs_sink_comp_class;
+	gchar *tmp_path;
+	gchar *in_path;
+	gchar *out_path;
+	double elapsed = 0;
+	uint64_t in_size;
+	int ret;
+	int exit_status = 1;
+
+	if (argc > 1) {
+		event_count = g_ascii_strtoull(argv[1], NULL, 10);
+	}
+
+	if (argc > 2) {
+		event_count_per_packet = g_ascii_strtoull(argv[2], NULL, 10);
+	}
+
+	if (event_count_per_packet == 0) {
+		fprintf(stderr, "Invalid event count per packet\n");
+		return 1;
+	}
+
+	ctf_plugin = bt_plugin_find("ctf");
+	if (!ctf_plugin) {
+		fprintf(stderr, "Cannot find the `ctf` plugin "
+			"(set the BABELTRACE_PLUGIN_PATH environment variable)\n");
+		return 1;
+	}
+
+	fs_src_comp_class = bt_plugin_borrow_source_component_class_by_name_const(
+		ctf_plugin, "fs");
+	BT_ASSERT(fs_src_comp_class);
+	fs_sink_comp_class = bt_plugin_borrow_sink_component_class_by_name_const(
+		ctf_plugin, "fs");
+	BT_ASSERT(fs_sink_comp_class);
+	tmp_path = g_build_filename(g_get_tmp_dir(), "bench_ctf_fs_XXXXXX",
+		NULL);
+	BT_ASSERT(tmp_path);
+
+	if (!bt_mkdtemp(tmp_path)) {
+		perror("Cannot create temporary directory");
+		goto end;
+	}
+
+	in_path = g_build_filename(tmp_path, "in", NULL);
+	out_path = g_build_filename(tmp_path, "out", NULL);
+	ret = generate_trace(fs_sink_comp_class, in_path);
+	if (ret) {
+		fprintf(stderr, "Cannot generate input trace\n");
+		goto remove;
+	}
+
+	ret = convert_trace(fs_src_comp_class, fs_sink_comp_class, in_path,
+		out_path, &elapsed);
+	if (ret) {
+		fprintf(stderr, "Cannot convert trace\n");
+		goto remove;
+	}
+
+	in_size = dir_size(in_path);
+	printf("events: %" PRIu64 "\n", event_count);
+	printf("events per packet: %" PRIu64 "\n", event_count_per_packet);
+	printf("input trace size (bytes): %" PRIu64 "\n", in_size);
+	printf("time (s): %.3f\n", elapsed);
+	printf("throughput (events/s): %.0f\n",
+		elapsed > 0 ? (double) event_count / elapsed : 0.);
+	printf("throughput (MiB/s): %.1f\n",
+		elapsed > 0 ? (double) in_size / (1024 * 1024) / elapsed : 0.);
+	exit_status = 0;
+
+remove:
+	nftw(tmp_path, rm_entry, 8, FTW_PHYS | FTW_DEPTH);
+	g_free(in_path);
+	g_free(out_path);
+
+end:
+	g_free(tmp_path);
+	bt_plugin_put_ref(ctf_plugin);
+	return exit_status;
+}
@@ -0,0 +1,804 @@
+/*
+ * bench_ctf_lttng_live.c
+ *
+ * Babeltrace src.ctf.lttng-live request pipelining microbenchmark
+ *
+ * Copyright (C) - 2019 EfficiOS Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; under version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*
+ * This program runs a mock LTTng relay daemon in a thread and builds
+ * the following graph:
+ *
+ *     src.ctf.lttng-live -> sink
+ *
+ * The mock relay daemon serves a single tracing session containing one
+ * trace with N data streams of M packets each, the events of all the
+ * streams having interleaved times. It delays each reply by a given
+ * latency after having received the request, without waiting for this
+ * reply to be sent before reading the next request, like a network
+ * link would. The sink component only counts and discards the
+ * messages.
+ *
+ * The graph runs twice: once without pipelining
+ * (`max-requests-in-flight` parameter set to 1), and once with the
+ * requested maximum number of requests in flight. Only the time spent
+ * running the graph is measured.
+ *
+ * Usage:
+ *
+ *     BABELTRACE_PLUGIN_PATH=plugins/ctf \
+ *         bench_ctf_lttng_live [STREAM-COUNT [PACKET-COUNT-PER-STREAM
+ *                              [LATENCY-US [MAX-REQUESTS-IN-FLIGHT]]]]
+ */
+
+#include <babeltrace/babeltrace.h>
+#include <babeltrace/assert-internal.h>
+#include <babeltrace/endian-internal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <glib.h>
+
+#include "ctf/lttng-live/lttng-viewer-abi.h"
+
+#define DEFAULT_STREAM_COUNT			64
+#define DEFAULT_PACKET_COUNT_PER_STREAM		16
+#define DEFAULT_LATENCY_US			500
+#define DEFAULT_MAX_REQUESTS_IN_FLIGHT		32
+
+#define SESSION_ID		1
+#define HOSTNAME		"mock"
+#define SESSION_NAME		"bench"
+#define PACKET_SIZE		4096
+#define PACKET_HEADER_SIZE	8
+#define PACKET_CONTEXT_SIZE	32
+#define EVENT_SIZE		20
+#define EVENTS_PER_PACKET	\
+	((PACKET_SIZE - PACKET_HEADER_SIZE - PACKET_CONTEXT_SIZE) / EVENT_SIZE)
+#define CTF_MAGIC		0xc1fc1fc1
+
+static const char metadata[] =
+	"/* CTF 1.8 */\n"
+	"typealias integer { size = 32; align = 8; signed = false; } := uint32_t;\n"
+	"typealias integer { size = 64; align = 8; signed = false; } := uint64_t;\n"
+	"trace {\n"
+	"	major = 1;\n"
+	"	minor = 8;\n"
+	"	byte_order = le;\n"
+	"	packet.header := struct {\n"
+	"		uint32_t magic;\n"
+	"		uint32_t stream_id;\n"
+	"	};\n"
+	"};\n"
+	"clock {\n"
+	"	name = \"monotonic\";\n"
+	"	freq = 1000000000;\n"
+	"	offset = 0;\n"
+	"};\n"
+	"typealias integer {\n"
+	"	size = 64; align = 8; signed = false;\n"
+	"	map = clock.monotonic.value;\n"
+	"} := uint64_clock_t;\n"
+	"stream {\n"
+	"	id = 0;\n"
+	"	packet.context := struct {\n"
+	"		uint64_clock_t timestamp_begin;\n"
+	"		uint64_clock_t timestamp_end;\n"
+	"		uint64_t content_size;\n"
+	"		uint64_t packet_size;\n"
+	"	};\n"
+	"	event.header := struct {\n"
+	"		uint32_t id;\n"
+	"		uint64_clock_t timestamp;\n"
+	"	};\n"
+	"};\n"
+	"event {\n"
+	"	name = \"bench\";\n"
+	"	id = 0;\n"
+	"	stream_id = 0;\n"
+	"	fields := struct {\n"
+	"		uint64_t value;\n"
+	"	};\n"
+	"};\n";
+
+struct reply {
+	/* Monotonic time (µs) at which to send this reply */
+	gint64 due_time;
+
+	/* Owned by this */
+	GByteArray *data;
+};
+
+struct mock_relayd {
+	int listen_fd;
+	int port;
+
+	/* Index of the next packet to serve for each data stream */
+	uint64_t *next_packet_indexes;
+	uint64_t hung_up_stream_count;
+	bool metadata_sent;
+
+	/* Replies to send, in order (struct reply *) */
+	GQueue *replies;
+
+	pthread_t thread;
+};
+
+struct bench_sink {
+	/* Owned by this */
+	bt_self_component_port_input_message_iterator *msg_iter;
+};
+
+static uint64_t stream_count = DEFAULT_STREAM_COUNT;
+static uint64_t packet_count_per_stream = DEFAULT_PACKET_COUNT_PER_STREAM;
+static uint64_t latency_us = DEFAULT_LATENCY_US;
+static uint64_t max_requests_in_flight = DEFAULT_MAX_REQUESTS_IN_FLIGHT;
+
+/* Number of messages consumed by the sink component */
+static uint64_t consumed_msg_count;
+
+/* Total number of requests received by the mock relay daemon */
+static uint64_t request_count;
+
+static
+void recv_all(int fd, void *buf, size_t len)
+{
+	size_t received = 0;
+
+	while (received < len) {
+		ssize_t ret = recv(fd, (char *) buf + received,
+			len - received, 0);
+
+		BT_ASSERT(ret > 0);
+		received += ret;
+	}
+}
+
+static
+void send_all(int fd, const void *buf, size_t len)
+{
+	size_t sent = 0;
+
+	while (sent < len) {
+		ssize_t ret = send(fd, (const char *) buf + sent,
+			len - sent, MSG_NOSIGNAL);
+
+		BT_ASSERT(ret > 0);
+		sent += ret;
+	}
+}
+
+static
+uint64_t event_timestamp(uint64_t stream_index, uint64_t packet_index,
+		uint64_t event_index)
+{
+	/* Interleave the times of all the streams */
+	return (packet_index * EVENTS_PER_PACKET + event_index) *
+		stream_count + stream_index + 1;
+}
+
+static
+void write_le32(uint8_t *buf, uint32_t value)
+{
+	value = htole32(value);
+	memcpy(buf, &value, sizeof(value));
+}
+
+static
+void write_le64(uint8_t *buf, uint64_t value)
+{
+	value = htole64(value);
+	memcpy(buf, &value, sizeof(value));
+}
+
+static
+uint64_t packet_content_size(void)
+{
+	return PACKET_HEADER_SIZE + PACKET_CONTEXT_SIZE +
+		EVENTS_PER_PACKET * EVENT_SIZE;
+}
+
+static
+void write_packet(uint8_t *buf, uint64_t stream_index, uint64_t packet_index)
+{
+	uint8_t *pos = buf;
+	uint64_t i;
+
+	memset(buf, 0, PACKET_SIZE);
+	write_le32(pos, CTF_MAGIC);
+	write_le32(pos + 4, 0);
+	pos += PACKET_HEADER_SIZE;
+	write_le64(pos, event_timestamp(stream_index, packet_index, 0));
+	write_le64(pos + 8, event_timestamp(stream_index, packet_index,
+		EVENTS_PER_PACKET - 1));
+	write_le64(pos + 16, packet_content_size() * 8);
+	write_le64(pos + 24, PACKET_SIZE * 8);
+	pos += PACKET_CONTEXT_SIZE;
+
+	for (i = 0; i < EVENTS_PER_PACKET; i++) {
+		write_le32(pos, 0);
+		write_le64(pos + 4, event_timestamp(stream_index, packet_index,
+			i));
+		write_le64(pos + 12, i);
+		pos += EVENT_SIZE;
+	}
+}
+
+static
+void append_stream(GByteArray *data, uint64_t id, bool is_metadata)
+{
+	struct lttng_viewer_stream stream;
+
+	memset(&stream, 0, sizeof(stream));
+	stream.id = htobe64(id);
+	stream.ctf_trace_id = htobe64(1);
+	stream.metadata_flag = htobe32(is_metadata ? 1 : 0);
+	snprintf(stream.path_name, sizeof(stream.path_name),
+		"%s/%s/ust", HOSTNAME, SESSION_NAME);
+
+	if (is_metadata) {
+		snprintf(stream.channel_name, sizeof(stream.channel_name),
+			"metadata");
+	} else {
+		snprintf(stream.channel_name, sizeof(stream.channel_name),
+			"channel0_%" PRIu64, id - 1);
+	}
+
+	g_byte_array_append(data, (const guint8 *) &stream, sizeof(stream));
+}
+
+/*
+ * Reads one request from `fd` and appends its reply to `data`.
+ */
+static
+void handle_request(struct mock_relayd *relayd, int fd, GByteArray *data)
+{
+	struct lttng_viewer_cmd cmd;
+	uint8_t payload[64];
+	uint64_t payload_size;
+
+	recv_all(fd, &cmd, sizeof(cmd));
+	payload_size = be64toh(cmd.data_size);
+	BT_ASSERT(payload_size <= sizeof(payload));
+	recv_all(fd, payload, payload_size);
+	request_count++;
+
+	switch (be32toh(cmd.cmd)) {
+	case LTTNG_VIEWER_CONNECT:
+	{
+		struct lttng_viewer_connect connect;
+
+		memset(&connect, 0, sizeof(connect));
+		connect.viewer_session_id = htobe64(1);
+		connect.major = htobe32(2);
+		connect.minor = htobe32(4);
+		connect.type = htobe32(LTTNG_VIEWER_CLIENT_COMMAND);
+		g_byte_array_append(data, (const guint8 *) &connect,
+			sizeof(connect));
+		break;
+	}
+	case LTTNG_VIEWER_CREATE_SESSION:
+	{
+		struct lttng_viewer_create_session_response rp;
+
+		rp.status = htobe32(LTTNG_VIEWER_CREATE_SESSION_OK);
+		g_byte_array_append(data, (const guint8 *) &rp, sizeof(rp));
+		break;
+	}
+	case LTTNG_VIEWER_LIST_SESSIONS:
+	{
+		struct lttng_viewer_list_sessions list;
+		struct lttng_viewer_session session;
+
+		list.sessions_count = htobe32(1);
+		g_byte_array_append(data, (const guint8 *) &list,
+			sizeof(list));
+		memset(&session, 0, sizeof(session));
+		session.id = htobe64(SESSION_ID);
+		session.live_timer = htobe32(1000000);
+		session.streams = htobe32(stream_count + 1);
+		snprintf(session.hostname, sizeof(session.hostname), "%s",
+			HOSTNAME);
+		snprintf(session.session_name, sizeof(session.session_name),
+			"%s", SESSION_NAME);
+		g_byte_array_append(data, (const guint8 *) &session,
+			sizeof(session));
+		break;
+	}
+	case LTTNG_VIEWER_ATTACH_SESSION:
+	{
+		struct lttng_viewer_attach_session_response rp;
+		uint64_t i;
+
+		rp.status = htobe32(LTTNG_VIEWER_ATTACH_OK);
+		rp.streams_count = htobe32(stream_count + 1);
+		g_byte_array_append(data, (const guint8 *) &rp, sizeof(rp));
+		append_stream(data, 0, true);
+
+		for (i = 0; i < stream_count; i++) {
+			append_stream(data, i + 1, false);
+		}
+
+		break;
+	}
+	case LTTNG_VIEWER_GET_METADATA:
+	{
+		struct lttng_viewer_metadata_packet rp;
+
+		if (relayd->metadata_sent) {
+			rp.len = 0;
+			rp.status = htobe32(LTTNG_VIEWER_NO_NEW_METADATA);
+			g_byte_array_append(data, (const guint8 *) &rp,
+				sizeof(rp));
+			break;
+		}
+
+		rp.len = htobe64(sizeof(metadata) - 1);
+		rp.status = htobe32(LTTNG_VIEWER_METADATA_OK);
+		g_byte_array_append(data, (const guint8 *) &rp, sizeof(rp));
+		g_byte_array_append(data, (const guint8 *) metadata,
+			sizeof(metadata) - 1);
+		relayd->metadata_sent = true;
+		break;
+	}
+	case LTTNG_VIEWER_GET_NEW_STREAMS:
+	{
+		struct lttng_viewer_new_streams_response rp;
+
+		rp.streams_count = 0;
+
+		if (relayd->hung_up_stream_count == stream_count) {
+			rp.status = htobe32(LTTNG_VIEWER_NEW_STREAMS_HUP);
+		} else {
+			rp.status = htobe32(LTTNG_VIEWER_NEW_STREAMS_NO_NEW);
+		}
+
+		g_byte_array_append(data, (const guint8 *) &rp, sizeof(rp));
+		break;
+	}
+	case LTTNG_VIEWER_GET_NEXT_INDEX:
+	{
+		struct lttng_viewer_get_next_index rq;
+		struct lttng_viewer_index rp;
+		uint64_t stream_index;
+		uint64_t packet_index;
+
+		memcpy(&rq, payload, sizeof(rq));
+		stream_index = be64toh(rq.stream_id) - 1;
+		BT_ASSERT(stream_index < stream_count);
+		packet_index = relayd->next_packet_indexes[stream_index];
+		memset(&rp, 0, sizeof(rp));
+
+		if (packet_index == packet_count_per_stream) {
+			rp.status = htobe32(LTTNG_VIEWER_INDEX_HUP);
+			relayd->next_packet_indexes[stream_index]++;
+			relayd->hung_up_stream_count++;
+		} else {
+			BT_ASSERT(packet_index < packet_count_per_stream);
+			rp.offset = htobe64(packet_index * PACKET_SIZE);
+			rp.packet_size = htobe64(PACKET_SIZE * 8);
+			rp.content_size = htobe64(packet_content_size() * 8);
+			rp.timestamp_begin = htobe64(event_timestamp(
+				stream_index, packet_index, 0));
+			rp.timestamp_end = htobe64(event_timestamp(
+				stream_index, packet_index,
+				EVENTS_PER_PACKET - 1));
+			rp.status = htobe32(LTTNG_VIEWER_INDEX_OK);
+			relayd->next_packet_indexes[stream_index]++;
+		}
+
+		g_byte_array_append(data, (const guint8 *) &rp, sizeof(rp));
+		break;
+	}
+	case LTTNG_VIEWER_GET_PACKET:
+	{
+		struct lttng_viewer_get_packet rq;
+		struct lttng_viewer_trace_packet rp;
+		uint8_t packet[PACKET_SIZE];
+		uint64_t stream_index;
+		uint64_t offset;
+		uint32_t len;
+
+		memcpy(&rq, payload, sizeof(rq));
+		stream_index = be64toh(rq.stream_id) - 1;
+		offset = be64toh(rq.offset);
+		len = be32toh(rq.len);
+		BT_ASSERT(stream_index < stream_count);
+		BT_ASSERT(offset / PACKET_SIZE < packet_count_per_stream);
+		BT_ASSERT(offset % PACKET_SIZE + len <= PACKET_SIZE);
+		write_packet(packet, stream_index, offset / PACKET_SIZE);
+		rp.status = htobe32(LTTNG_VIEWER_GET_PACKET_OK);
+		rp.len = htobe32(len);
+		rp.flags = 0;
+		g_byte_array_append(data, (const guint8 *) &rp, sizeof(rp));
+		g_byte_array_append(data, packet + offset % PACKET_SIZE, len);
+		break;
+	}
+	case LTTNG_VIEWER_DETACH_SESSION:
+	{
+		struct lttng_viewer_detach_session_response rp;
+
+		rp.status = htobe32(LTTNG_VIEWER_DETACH_SESSION_OK);
+		g_byte_array_append(data, (const guint8 *) &rp, sizeof(rp));
+		break;
+	}
+	default:
+		fprintf(stderr, "Unexpected command %" PRIu32 "\n",
+			be32toh(cmd.cmd));
+		abort();
+	}
+}
+
+static
+void *mock_relayd_thread(void *data)
+{
+	struct mock_relayd *relayd = data;
+	int fd;
+
+	fd = accept(relayd->listen_fd, NULL, NULL);
+	BT_ASSERT(fd >= 0);
+
+	while (true) {
+		struct pollfd pollfd = { .fd = fd, .events = POLLIN };
+		struct reply *reply = g_queue_peek_head(relayd->replies);
+		int timeout_ms = -1;
+		int ret;
+
+		if (reply) {
+			gint64 now = g_get_monotonic_time();
+
+			if (reply->due_time <= now) {
+				/* Send this reply */
+				send_all(fd, reply->data->data,
+					reply->data->len);
+				g_queue_pop_head(relayd->replies);
+				g_byte_array_free(reply->data, TRUE);
+				g_free(reply);
+				continue;
+			}
+
+			timeout_ms = (int) ((reply->due_time - now + 999) /
+				1000);
+		}
+
+		ret = poll(&pollfd, 1, timeout_ms);
+		BT_ASSERT(ret >= 0);
+
+		if (ret == 0) {
+			continue;
+		}
+
+		if (pollfd.revents & POLLIN) {
+			char byte;
+
+			if (recv(fd, &byte, 1, MSG_PEEK) <= 0) {
+				/* Client closed the connection */
+				break;
+			}
+
+			reply = g_new0(struct reply, 1);
+			BT_ASSERT(reply);
+			reply->data = g_byte_array_new();
+			BT_ASSERT(reply->data);
+			handle_request(relayd, fd, reply->data);
+			reply->due_time = g_get_monotonic_time() + latency_us;
+			g_queue_push_tail(relayd->replies, reply);
+		} else {
+			/* Error or hang up */
+			break;
+		}
+	}
+
+	close(fd);
+	return NULL;
+}
+
+static
+void mock_relayd_start(struct mock_relayd *relayd)
+{
+	struct sockaddr_in addr;
+	socklen_t addr_len = sizeof(addr);
+	int ret;
+
+	memset(relayd, 0, sizeof(*relayd));
+	relayd->next_packet_indexes = g_new0(uint64_t, stream_count);
+	BT_ASSERT(relayd->next_packet_indexes);
+	relayd->replies = g_queue_new();
+	BT_ASSERT(relayd->replies);
+	relayd->listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+	BT_ASSERT(relayd->listen_fd >= 0);
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	addr.sin_port = 0;
+	ret = bind(relayd->listen_fd, (struct sockaddr *) &addr,
+		sizeof(addr));
+	BT_ASSERT(ret == 0);
+	ret = listen(relayd->listen_fd, 1);
+	BT_ASSERT(ret == 0);
+	ret = getsockname(relayd->listen_fd, (struct sockaddr *) &addr,
+		&addr_len);
+	BT_ASSERT(ret == 0);
+	relayd->port = ntohs(addr.sin_port);
+	ret = pthread_create(&relayd->thread, NULL, mock_relayd_thread,
+		relayd);
+	BT_ASSERT(ret == 0);
+}
+
+static
+void mock_relayd_stop(struct mock_relayd *relayd)
+{
+	int ret;
+
+	ret = pthread_join(relayd->thread, NULL);
+	BT_ASSERT(ret == 0);
+	close(relayd->listen_fd);
+
+	while (!g_queue_is_empty(relayd->replies)) {
+		struct reply *reply = g_queue_pop_head(relayd->replies);
+
+		g_byte_array_free(reply->data, TRUE);
+		g_free(reply);
+	}
+
+	g_queue_free(relayd->replies);
+	g_free(relayd->next_packet_indexes);
+}
+
+static
+bt_self_component_status sink_init(bt_self_component_sink *self_comp,
+		const bt_value *params, void *init_method_data)
+{
+	struct bench_sink *sink = g_new0(struct bench_sink, 1);
+	int ret;
+
+	BT_ASSERT(sink);
+	ret = bt_self_component_sink_add_input_port(self_comp, "in",
+		NULL, NULL);
+	BT_ASSERT(ret == 0);
+	bt_self_component_set_data(
+		bt_self_component_sink_as_self_component(self_comp), sink);
+	return BT_SELF_COMPONENT_STATUS_OK;
+}
+
+static
+void sink_finalize(bt_self_component_sink *self_comp)
+{
+	struct bench_sink *sink = bt_self_component_get_data(
+		bt_self_component_sink_as_self_component(self_comp));
+
+	bt_self_component_port_input_message_iterator_put_ref(sink->msg_iter);
+	g_free(sink);
+}
+
+static
+bt_self_component_status sink_input_port_connected(
+		bt_self_component_sink *self_comp,
+		bt_self_component_port_input *self_port,
+		const bt_port_output *other_port)
+{
+	struct bench_sink *sink = bt_self_component_get_data(
+		bt_self_component_sink_as_self_component(self_comp));
+
+	sink->msg_iter = bt_self_component_port_input_message_iterator_create(
+		self_port);
+	BT_ASSERT(sink->msg_iter);
+	return BT_SELF_COMPONENT_STATUS_OK;
+}
+
+static
+bt_self_component_status sink_consume(bt_self_component_sink *self_comp)
+{
+	struct bench_sink *sink = bt_self_component_get_data(
+		bt_self_component_sink_as_self_component(self_comp));
+	bt_message_array_const msgs;
+	uint64_t count;
+	uint64_t i;
+	bt_self_component_status status;
+
+	switch (bt_self_component_port_input_message_iterator_next(
+			sink->msg_iter, &msgs, &count)) {
+	case BT_MESSAGE_ITERATOR_STATUS_OK:
+		for (i = 0; i < count; i++) {
+			bt_message_put_ref(msgs[i]);
+		}
+
+		consumed_msg_count += count;
+		status = BT_SELF_COMPONENT_STATUS_OK;
+		break;
+	case BT_MESSAGE_ITERATOR_STATUS_AGAIN:
+		status = BT_SELF_COMPONENT_STATUS_AGAIN;
+		break;
+	case BT_MESSAGE_ITERATOR_STATUS_END:
+		status = BT_SELF_COMPONENT_STATUS_END;
+		break;
+	default:
+		status = BT_SELF_COMPONENT_STATUS_ERROR;
+		break;
+	}
+
+	return status;
+}
+
+/*
+ * Runs the graph once against a new mock relay daemon and returns the
+ * elapsed time in seconds, or a negative value on error.
+ */
+static
+double run_graph(const bt_component_class_source *live_comp_class,
+		const bt_component_class_sink *sink_comp_class,
+		uint64_t requests_in_flight)
+{
+	struct mock_relayd relayd;
+	const bt_component_source *src_comp;
+	const bt_component_sink *sink_comp;
+	bt_value *params;
+	bt_graph *graph;
+	GTimer *timer;
+	double elapsed;
+	bt_graph_status graph_status;
+	char url[128];
+	int ret;
+
+	mock_relayd_start(&relayd);
+	consumed_msg_count = 0;
+	request_count = 0;
+	snprintf(url, sizeof(url), "net://127.0.0.1:%d/host/%s/%s",
+		relayd.port, HOSTNAME, SESSION_NAME);
+	params = bt_value_map_create();
+	BT_ASSERT(params);
+	ret = bt_value_map_insert_string_entry(params, "url", url);
+	BT_ASSERT(ret == 0);
+	ret = bt_value_map_insert_string_entry(params,
+		"session-not-found-action", "end");
+	BT_ASSERT(ret == 0);
+	ret = bt_value_map_insert_signed_integer_entry(params,
+		"max-requests-in-flight", (int64_t) requests_in_flight);
+	BT_ASSERT(ret == 0);
+
+	graph = bt_graph_create();
+	BT_ASSERT(graph);
+	graph_status = bt_graph_add_source_component(graph, live_comp_class,
+		"src", params, &src_comp);
+	BT_ASSERT(graph_status == BT_GRAPH_STATUS_OK);
+	graph_status = bt_graph_add_sink_component(graph, sink_comp_class,
+		"sink", NULL, &sink_comp);
+	BT_ASSERT(graph_status == BT_GRAPH_STATUS_OK);
+	graph_status = bt_graph_connect_ports(graph,
+		bt_component_source_borrow_output_port_by_index_const(
+			src_comp, 0),
+		bt_component_sink_borrow_input_port_by_name_const(
+			sink_comp, "in"), NULL);
+	BT_ASSERT(graph_status == BT_GRAPH_STATUS_OK);
+
+	timer = g_timer_new();
+	BT_ASSERT(timer);
+
+	do {
+		graph_status = bt_graph_run(graph);
+	} while (graph_status == BT_GRAPH_STATUS_AGAIN);
+
+	g_timer_stop(timer);
+	elapsed = g_timer_elapsed(timer, NULL);
+	g_timer_destroy(timer);
+
+	if (graph_status != BT_GRAPH_STATUS_END) {
+		fprintf(stderr, "Graph failed: status=%d\n", graph_status);
+		elapsed = -1.;
+	}
+
+	/* Closes the connection to the mock relay daemon */
+	bt_graph_put_ref(graph);
+	bt_component_source_put_ref(src_comp);
+	bt_component_sink_put_ref(sink_comp);
+	bt_value_put_ref(params);
+	mock_relayd_stop(&relayd);
+	return elapsed;
+}
+
+int main(int argc, char **argv)
+{
+	bt_component_class_sink *sink_comp_class;
+	const bt_plugin *ctf_plugin;
+	const bt_component_class_source *live_comp_class;
+	double elapsed_no_pipelining;
+	double elapsed;
+	int ret;
+
+	if (argc > 1) {
+		stream_count = g_ascii_strtoull(argv[1], NULL, 10);
+	}
+
+	if (argc > 2) {
+		packet_count_per_stream = g_ascii_strtoull(argv[2], NULL, 10);
+	}
+
+	if (argc > 3) {
+		latency_us = g_ascii_strtoull(argv[3], NULL, 10);
+	}
+
+	if (argc > 4) {
+		max_requests_in_flight = g_ascii_strtoull(argv[4], NULL, 10);
+	}
+
+	if (stream_count == 0 || max_requests_in_flight == 0) {
+		fprintf(stderr, "Invalid stream count or maximum number "
+			"of requests in flight\n");
+		return 1;
+	}
+
+	ctf_plugin = bt_plugin_find("ctf");
+	if (!ctf_plugin) {
+		fprintf(stderr, "Cannot find the `ctf` plugin "
+			"(set the BABELTRACE_PLUGIN_PATH environment variable)\n");
+		return 1;
+	}
+
+	live_comp_class = bt_plugin_borrow_source_component_class_by_name_const(
+		ctf_plugin, "lttng-live");
+	BT_ASSERT(live_comp_class);
+
+	sink_comp_class = bt_component_class_sink_create("sink",
+		sink_consume);
+	BT_ASSERT(sink_comp_class);
+	ret = bt_component_class_sink_set_init_method(sink_comp_class,
+		sink_init);
+	BT_ASSERT(ret == 0);
+	ret = bt_component_class_sink_set_finalize_method(sink_comp_class,
+		sink_finalize);
+	BT_ASSERT(ret == 0);
+	ret = bt_component_class_sink_set_input_port_connected_method(
+		sink_comp_class, sink_input_port_connected);
+	BT_ASSERT(ret == 0);
+
+	printf("streams: %" PRIu64 "\n", stream_count);
+	printf("packets per stream: %" PRIu64 "\n", packet_count_per_stream);
+	printf("latency (us): %" PRIu64 "\n", latency_us);
+
+	elapsed_no_pipelining = run_graph(live_comp_class, sink_comp_class, 1);
+	if (elapsed_no_pipelining < 0) {
+		return 1;
+	}
+
+	printf("max-requests-in-flight=1: %" PRIu64 " messages, "
+		"%" PRIu64 " requests, %.3f s\n", consumed_msg_count,
+		request_count, elapsed_no_pipelining);
+
+	elapsed = run_graph(live_comp_class, sink_comp_class,
+		max_requests_in_flight);
+	if (elapsed < 0) {
+		return 1;
+	}
+
+	printf("max-requests-in-flight=%" PRIu64 ": %" PRIu64 " messages, "
+		"%" PRIu64 " requests, %.3f s\n", max_requests_in_flight,
+		consumed_msg_count, request_count, elapsed);
+	printf("speedup: %.2f\n",
+		elapsed > 0 ? elapsed_no_pipelining / elapsed : 0.);
+
+	bt_component_class_sink_put_ref(sink_comp_class);
+	bt_plugin_put_ref(ctf_plugin);
+	return 0;
+}
@@ -0,0 +1,387 @@
+/*
+ * bench_utils_muxer.c
+ *
+ * Babeltrace flt.utils.muxer throughput microbenchmark
+ *
+ * Copyright (C) - 2019 EfficiOS Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; under version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*
+ * This program builds the following graph:
+ *
+ *     src (N output ports) -> flt.utils.muxer -> sink
+ *
+ * Each output port of the source component produces M message
+ * iterator inactivity messages with interleaved times, so that the
+ * muxer needs to switch from one upstream message iterator to another
+ * for each message. The sink component only counts and discards the
+ * messages. Only the time spent running the graph is measured.
+ *
+ * Usage:
+ *
+ *     BABELTRACE_PLUGIN_PATH=plugins/utils \
+ *         bench_utils_muxer [PORT-COUNT [MSG-COUNT-PER-PORT]]
+ *
+ * This program only uses the public API: to compare two revisions of
+ * the muxer, build it once and run it with the `BABELTRACE_PLUGIN_PATH`
+ * and `LD_LIBRARY_PATH` of each revision's build directory, keeping the
+ * best of a few runs of each.
+ */
+
+#include <babeltrace/babeltrace.h>
+#include <babeltrace/assert-internal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <glib.h>
+
+#define DEFAULT_PORT_COUNT		16
+#define DEFAULT_MSG_COUNT_PER_PORT	1000000
+
+struct bench_src {
+	/* Owned by this */
+	bt_clock_class *clock_class;
+	uint64_t port_count;
+	uint64_t msg_count_per_port;
+};
+
+struct bench_src_iter {
+	/* Weak */
+	struct bench_src *src;
+
+	/* Weak */
+	bt_self_message_iterator *self_msg_iter;
+
+	uint64_t port_index;
+	uint64_t next_msg_index;
+};
+
+struct bench_sink {
+	/* Owned by this */
+	bt_self_component_port_input_message_iterator *msg_iter;
+};
+
+static uint64_t port_count = DEFAULT_PORT_COUNT;
+static uint64_t msg_count_per_port = DEFAULT_MSG_COUNT_PER_PORT;
+
+/* Number of messages consumed by the sink component */
+static uint64_t consumed_msg_count;
+
+static
+bt_self_component_status src_init(bt_self_component_source *self_comp,
+		const bt_value *params, void *init_method_data)
+{
+	struct bench_src *src = g_new0(struct bench_src, 1);
+	uint64_t i;
+
+	BT_ASSERT(src);
+	src->port_count = port_count;
+	src->msg_count_per_port = msg_count_per_port;
+	src->clock_class = bt_clock_class_create(
+		bt_self_component_source_as_self_component(self_comp));
+	BT_ASSERT(src->clock_class);
+
+	for (i = 0; i < src->port_count; i++) {
+		char name[32];
+		int ret;
+
+		snprintf(name, sizeof(name), "out%" PRIu64, i);
+		ret = bt_self_component_source_add_output_port(self_comp,
+			name, (void *) (uintptr_t) i, NULL);
+		BT_ASSERT(ret == 0);
+	}
+
+	bt_self_component_set_data(
+		bt_self_component_source_as_self_component(self_comp), src);
+	return BT_SELF_COMPONENT_STATUS_OK;
+}
+
+static
+void src_finalize(bt_self_component_source *self_comp)
+{
+	struct bench_src *src = bt_self_component_get_data(
+		bt_self_component_source_as_self_component(self_comp));
+
+	bt_clock_class_put_ref(src->clock_class);
+	g_free(src);
+}
+
+static
+bt_self_message_iterator_status src_iter_init(
+		bt_self_message_iterator *self_msg_iter,
+		bt_self_component_source *self_comp,
+		bt_self_component_port_output *self_port)
+{
+	struct bench_src_iter *src_iter = g_new0(struct bench_src_iter, 1);
+
+	BT_ASSERT(src_iter);
+	src_iter->src = bt_self_component_get_data(
+		bt_self_component_source_as_self_component(self_comp));
+	src_iter->self_msg_iter = self_msg_iter;
+	src_iter->port_index = (uint64_t) (uintptr_t)
+		bt_self_component_port_get_data(
+			bt_self_component_port_output_as_self_component_port(
+				self_port));
+	bt_self_message_iterator_set_data(self_msg_iter, src_iter);
+	return BT_SELF_MESSAGE_ITERATOR_STATUS_OK;
+}
+
+static
+void src_iter_finalize(bt_self_message_iterator *self_msg_iter)
+{
+	g_free(bt_self_message_iterator_get_data(self_msg_iter));
+}
+
+static
+bt_self_message_iterator_status src_iter_next(
+		bt_self_message_iterator *self_msg_iter,
+		bt_message_array_const msgs, uint64_t capacity,
+		uint64_t *count)
+{
+	struct bench_src_iter *src_iter =
+		bt_self_message_iterator_get_data(self_msg_iter);
+	struct bench_src *src = src_iter->src;
+	uint64_t i = 0;
+
+	if (src_iter->next_msg_index == src->msg_count_per_port) {
+		return BT_SELF_MESSAGE_ITERATOR_STATUS_END;
+	}
+
+	while (i < capacity &&
+			src_iter->next_msg_index < src->msg_count_per_port) {
+		/* Interleave the times of all the output ports */
+		uint64_t raw_value = src_iter->next_msg_index *
+			src->port_count + src_iter->port_index;
+
+		msgs[i] = bt_message_message_iterator_inactivity_create(
+			src_iter->self_msg_iter, src->clock_class, raw_value);
+		BT_ASSERT(msgs[i]);
+		src_iter->next_msg_index++;
+		i++;
+	}
+
+	*count = i;
+	return BT_SELF_MESSAGE_ITERATOR_STATUS_OK;
+}
+
+static
+bt_self_component_status sink_init(bt_self_component_sink *self_comp,
+		const bt_value *params, void *init_method_data)
+{
+	struct bench_sink *sink = g_new0(struct bench_sink, 1);
+	int ret;
+
+	BT_ASSERT(sink);
+	ret = bt_self_component_sink_add_input_port(self_comp, "in",
+		NULL, NULL);
+	BT_ASSERT(ret == 0);
+	bt_self_component_set_data(
+		bt_self_component_sink_as_self_component(self_comp), sink);
+	return BT_SELF_COMPONENT_STATUS_OK;
+}
+
+static
+void sink_finalize(bt_self_component_sink *self_comp)
+{
+	struct bench_sink *sink = bt_self_component_get_data(
+		bt_self_component_sink_as_self_component(self_comp));
+
+	bt_self_component_port_input_message_iterator_put_ref(sink->msg_iter);
+	g_free(sink);
+}
+
+static
+bt_self_component_status sink_input_port_connected(
+		bt_self_component_sink *self_comp,
+		bt_self_component_port_input *self_port,
+		const bt_port_output *other_port)
+{
+	struct bench_sink *sink = bt_self_component_get_data(
+		bt_self_component_sink_as_self_component(self_comp));
+
+	sink->msg_iter = bt_self_component_port_input_message_iterator_create(
+		self_port);
+	BT_ASSERT(sink->msg_iter);
+	return BT_SELF_COMPONENT_STATUS_OK;
+}
+
+static
+bt_self_component_status sink_consume(bt_self_component_sink *self_comp)
+{
+	struct bench_sink *sink = bt_self_component_get_data(
+		bt_self_component_sink_as_self_component(self_comp));
+	bt_message_array_const msgs;
+	uint64_t count;
+	uint64_t i;
+	bt_self_component_status status;
+
+	switch (bt_self_component_port_input_message_iterator_next(
+			sink->msg_iter, &msgs, &count)) {
+	case BT_MESSAGE_ITERATOR_STATUS_OK:
+		for (i = 0; i < count; i++) {
+			bt_message_put_ref(msgs[i]);
+		}
+
+		consumed_msg_count += count;
+		status = BT_SELF_COMPONENT_STATUS_OK;
+		break;
+	case BT_MESSAGE_ITERATOR_STATUS_AGAIN:
+		status = BT_SELF_COMPONENT_STATUS_AGAIN;
+		break;
+	case BT_MESSAGE_ITERATOR_STATUS_END:
+		status = BT_SELF_COMPONENT_STATUS_END;
+		break;
+	default:
+		status = BT_SELF_COMPONENT_STATUS_ERROR;
+		break;
+	}
+
+	return status;
+}
+
+int main(int argc, char **argv)
+{
+	bt_component_class_source *src_comp_class;
+	bt_component_class_sink *sink_comp_class;
+	const bt_plugin *utils_plugin;
+	const bt_component_class_filter *muxer_comp_class;
+	const bt_component_source *src_comp;
+	const bt_component_filter *muxer_comp;
+	const bt_component_sink *sink_comp;
+	bt_graph *graph;
+	GTimer *timer;
+	double elapsed;
+	bt_graph_status graph_status;
+	uint64_t i;
+	int ret;
+
+	if (argc > 1) {
+		port_count = g_ascii_strtoull(argv[1], NULL, 10);
+	}
+
+	if (argc > 2) {
+		msg_count_per_port = g_ascii_strtoull(argv[2], NULL, 10);
+	}
+
+	if (port_count == 0) {
+		fprintf(stderr, "Invalid port count\n");
+		return 1;
+	}
+
+	utils_plugin = bt_plugin_find("utils");
+	if (!utils_plugin) {
+		fprintf(stderr, "Cannot find the `utils` plugin "
+			"(set the BABELTRACE_PLUGIN_PATH environment variable)\n");
+		return 1;
+	}
+
+	muxer_comp_class = bt_plugin_borrow_filter_component_class_by_name_const(
+		utils_plugin, "muxer");
+	BT_ASSERT(muxer_comp_class);
+
+	src_comp_class = bt_component_class_source_create("src",
+		src_iter_next);
+	BT_ASSERT(src_comp_class);
+	ret = bt_component_class_source_set_init_method(src_comp_class,
+		src_init);
+	BT_ASSERT(ret == 0);
+	ret = bt_component_class_source_set_finalize_method(src_comp_class,
+		src_finalize);
+	BT_ASSERT(ret == 0);
+	ret = bt_component_class_source_set_message_iterator_init_method(
+		src_comp_class, src_iter_init);
+	BT_ASSERT(ret == 0);
+	ret = bt_component_class_source_set_message_iterator_finalize_method(
+		src_comp_class, src_iter_finalize);
+	BT_ASSERT(ret == 0);
+
+	sink_comp_class = bt_component_class_sink_create("sink",
+		sink_consume);
+	BT_ASSERT(sink_comp_class);
+	ret = bt_component_class_sink_set_init_method(sink_comp_class,
+		sink_init);
+	BT_ASSERT(ret == 0);
+	ret = bt_component_class_sink_set_finalize_method(sink_comp_class,
+		sink_finalize);
+	BT_ASSERT(ret == 0);
+	ret = bt_component_class_sink_set_input_port_connected_method(
+		sink_comp_class, sink_input_port_connected);
+	BT_ASSERT(ret == 0);
+
+	graph = bt_graph_create();
+	BT_ASSERT(graph);
+	graph_status = bt_graph_add_source_component(graph, src_comp_class,
+		"src", NULL, &src_comp);
+	BT_ASSERT(graph_status == BT_GRAPH_STATUS_OK);
+	graph_status = bt_graph_add_filter_component(graph, muxer_comp_class,
+		"muxer", NULL, &muxer_comp);
+	BT_ASSERT(graph_status == BT_GRAPH_STATUS_OK);
+	graph_status = bt_graph_add_sink_component(graph, sink_comp_class,
+		"sink", NULL, &sink_comp);
+	BT_ASSERT(graph_status == BT_GRAPH_STATUS_OK);
+
+	for (i = 0; i < port_count; i++) {
+		char name[32];
+
+		/* The muxer adds an input port each time one is connected */
+		snprintf(name, sizeof(name), "in%" PRIu64, i);
+		graph_status = bt_graph_connect_ports(graph,
+			bt_component_source_borrow_output_port_by_index_const(
+				src_comp, i),
+			bt_component_filter_borrow_input_port_by_name_const(
+				muxer_comp, name), NULL);
+		BT_ASSERT(graph_status == BT_GRAPH_STATUS_OK);
+	}
+
+	graph_status = bt_graph_connect_ports(graph,
+		bt_component_filter_borrow_output_port_by_name_const(
+			muxer_comp, "out"),
+		bt_component_sink_borrow_input_port_by_name_const(
+			sink_comp, "in"), NULL);
+	BT_ASSERT(graph_status == BT_GRAPH_STATUS_OK);
+
+	timer = g_timer_new();
+	BT_ASSERT(timer);
+
+	do {
+		graph_status = bt_graph_run(graph);
+	} while (graph_status == BT_GRAPH_STATUS_AGAIN);
+
+	g_timer_stop(timer);
+	elapsed = g_timer_elapsed(timer, NULL);
+	g_timer_destroy(timer);
+
+	if (graph_status != BT_GRAPH_STATUS_END) {
+		fprintf(stderr, "Graph failed: status=%d\n", graph_status);
+		return 1;
+	}
+
+	printf("ports: %" PRIu64 "\n", port_count);
+	printf("messages: %" PRIu64 "\n", consumed_msg_count);
+	printf("time (s): %.3f\n", elapsed);
+	printf("throughput (messages/s): %.0f\n",
+		elapsed > 0 ? (double) consumed_msg_count / elapsed : 0.);
+
+	bt_graph_put_ref(graph);
+	bt_component_source_put_ref(src_comp);
+	bt_component_filter_put_ref(muxer_comp);
+	bt_component_sink_put_ref(sink_comp);
+	bt_component_class_source_put_ref(src_comp_class);
+	bt_component_class_sink_put_ref(sink_comp_class);
+	bt_plugin_put_ref(utils_plugin);
+	return 0;
+}
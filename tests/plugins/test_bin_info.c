@@ -29,7 +29,7 @@
 
 #include "tap/tap.h"
 
-#define NR_TESTS 36
+#define NR_TESTS 41
 #define SO_NAME "libhello_so"
 #define SO_NAME_ELF "libhello_elf_so"
 #define SO_NAME_BUILD_ID "libhello_build_id_so"
@@ -294,6 +294,87 @@ void test_bin_info(const char *data_dir)
 	bt_fd_cache_fini(&fdc);
 }
 
+static
+void test_bin_info_background_loading(const char *data_dir)
+{
+	int ret;
+	char path[PATH_MAX];
+	char *func_name = NULL;
+	struct bin_info *bin = NULL, *bin_build_id = NULL, *bin_unused = NULL;
+	struct bin_info_loader *loader;
+	struct source_location *src_loc = NULL;
+	struct bt_fd_cache fdc;
+	uint8_t build_id[BUILD_ID_LEN] = {
+		0xcd, 0xd9, 0x8c, 0xdd, 0x87, 0xf7, 0xfe, 0x64, 0xc1, 0x3b,
+		0x6d, 0xaa, 0xd5, 0x53, 0x98, 0x7e, 0xaf, 0xd4, 0x0c, 0xbb
+	};
+
+	diag("bin-info tests - background loading");
+
+	ret = bt_fd_cache_init(&fdc);
+	BT_ASSERT(ret == 0);
+	loader = bin_info_loader_create(2);
+	ok(loader != NULL, "bin_info_loader_create successful");
+	if (!loader) {
+		skip(4, "bin_info_loader_create failed");
+		bt_fd_cache_fini(&fdc);
+		return;
+	}
+
+	snprintf(path, PATH_MAX, "%s/%s", data_dir, SO_NAME);
+	bin = bin_info_create(&fdc, path, SO_LOW_ADDR, SO_MEMSZ, true,
+		data_dir, NULL);
+	BT_ASSERT(bin);
+	bin_info_loader_add(loader, bin);
+
+	snprintf(path, PATH_MAX, "%s/%s", data_dir, SO_NAME_BUILD_ID);
+	bin_build_id = bin_info_create(&fdc, path, SO_LOW_ADDR, SO_MEMSZ,
+		true, data_dir, NULL);
+	BT_ASSERT(bin_build_id);
+	bin_info_loader_add(loader, bin_build_id);
+
+	/* The build ID is set before the loading starts */
+	ret = bin_info_set_build_id(bin_build_id, build_id, BUILD_ID_LEN);
+	ok(ret == 0, "bin_info_set_build_id successful (deferred loading)");
+
+	snprintf(path, PATH_MAX, "%s/%s", data_dir, SO_NAME_ELF);
+	bin_unused = bin_info_create(&fdc, path, SO_LOW_ADDR, SO_MEMSZ,
+		true, data_dir, NULL);
+	BT_ASSERT(bin_unused);
+	bin_info_loader_add(loader, bin_unused);
+
+	bin_info_loader_start_deferred(loader);
+
+	/* Destroying a binary which can still be loading */
+	bin_info_destroy(bin_unused);
+
+	ret = bin_info_lookup_function_name(bin, FUNC_FOO_ADDR, &func_name);
+	ok(ret == 0 && func_name && strcmp(func_name, FUNC_FOO_NAME) == 0,
+		"bin_info_lookup_function_name - correct func_name value "
+		"(background loading)");
+	free(func_name);
+	func_name = NULL;
+
+	ret = bin_info_lookup_source_location(bin, FUNC_FOO_ADDR, &src_loc);
+	ok(ret == 0 && src_loc && src_loc->line_no == FUNC_FOO_LINE_NO &&
+		strcmp(src_loc->filename, FUNC_FOO_FILENAME) == 0,
+		"bin_info_lookup_source_location - correct source location "
+		"(background loading)");
+	source_location_destroy(src_loc);
+
+	ret = bin_info_lookup_function_name(bin_build_id, FUNC_FOO_ADDR,
+		&func_name);
+	ok(ret == 0 && func_name && strcmp(func_name, FUNC_FOO_NAME) == 0,
+		"bin_info_lookup_function_name - correct func_name value "
+		"(background loading, build ID)");
+	free(func_name);
+
+	bin_info_destroy(bin);
+	bin_info_destroy(bin_build_id);
+	bin_info_loader_destroy(loader);
+	bt_fd_cache_fini(&fdc);
+}
+
 int main(int argc, char **argv)
 {
 	int ret;
@@ -313,6 +394,7 @@ int main(int argc, char **argv)
 	test_bin_info_elf(opt_debug_info_dir);
 	test_bin_info_build_id(opt_debug_info_dir);
 	test_bin_info_debug_link(opt_debug_info_dir);
+	test_bin_info_background_loading(opt_debug_info_dir);
 
 	return EXIT_SUCCESS;
 }
@@ -0,0 +1,171 @@
+/*
+ * test_ctf_columnar_sink.c
+ *
+ * Babeltrace sink.ctf.columnar round-trip tests
+ *
+ * Copyright (c) 2019 EfficiOS Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; under version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <inttypes.h>
+#include <ctf/columnar-sink/columnar-reader.h>
+#include "tap/tap.h"
+
+#define NR_TESTS 17
+
+static
+bool var_value_is(struct columnar_reader_column *column, uint64_t row,
+		const char *expected)
+{
+	const void *data;
+	uint64_t len = columnar_reader_column_borrow_var_value(column, row,
+		&data);
+
+	return len == strlen(expected) && memcmp(data, expected, len) == 0;
+}
+
+/*
+ * `smalltrace` contains two `string` events without timestamps, each
+ * one having a single `str` string field.
+ */
+static
+void test_smalltrace(const char *table_path)
+{
+	struct columnar_reader_table *table;
+	struct columnar_reader_column *column;
+
+	diag("sink.ctf.columnar tests - smalltrace");
+	table = columnar_reader_table_open(table_path);
+	ok(table, "Open smalltrace table %s", table_path);
+	if (!table) {
+		exit(EXIT_FAILURE);
+	}
+
+	ok(strcmp(table->event_class_name->str, "string") == 0,
+		"smalltrace table - correct event class name");
+	ok(table->row_count == 2, "smalltrace table - correct row count");
+	ok(!columnar_reader_table_borrow_column_by_name(table,
+		COLUMNAR_TIMESTAMP_COLUMN_NAME),
+		"smalltrace table - no timestamp column without a clock");
+	column = columnar_reader_table_borrow_column_by_name(table,
+		"payload.str");
+	ok(column && column->type == COLUMNAR_COLUMN_TYPE_STRING,
+		"smalltrace table - `payload.str` string column");
+	if (!column) {
+		exit(EXIT_FAILURE);
+	}
+
+	ok(var_value_is(column, 0, "This is a test trace"),
+		"smalltrace table - correct first string");
+	ok(var_value_is(column, 1, "with only two small events."),
+		"smalltrace table - correct second string");
+	columnar_reader_table_close(table);
+}
+
+/*
+ * `sequence` contains `sequence event` events with a timestamp and two
+ * sequences of signed integers, each one preceded by its length.
+ */
+static
+void test_sequence(const char *table_path, uint64_t event_count)
+{
+	struct columnar_reader_table *table;
+	struct columnar_reader_column *ts_column;
+	struct columnar_reader_column *int_column;
+	struct columnar_reader_column *long_column;
+	struct columnar_reader_column *len_column;
+	bool ts_sorted = true;
+	bool lens_match = true;
+	uint64_t row;
+
+	diag("sink.ctf.columnar tests - sequence");
+	table = columnar_reader_table_open(table_path);
+	ok(table, "Open sequence table %s", table_path);
+	if (!table) {
+		exit(EXIT_FAILURE);
+	}
+
+	ok(strcmp(table->event_class_name->str, "sequence event") == 0,
+		"sequence table - correct event class name");
+	ok(table->row_count == event_count,
+		"sequence table - one row per event (%" PRIu64 ")",
+		event_count);
+	ts_column = columnar_reader_table_borrow_column_by_name(table,
+		COLUMNAR_TIMESTAMP_COLUMN_NAME);
+	ok(ts_column && ts_column->type == COLUMNAR_COLUMN_TYPE_INT64,
+		"sequence table - 64-bit timestamp column");
+	int_column = columnar_reader_table_borrow_column_by_name(table,
+		"payload.seq_int_field");
+	ok(int_column && int_column->type == COLUMNAR_COLUMN_TYPE_LIST_INT32,
+		"sequence table - `payload.seq_int_field` list column");
+	long_column = columnar_reader_table_borrow_column_by_name(table,
+		"payload.seq_long_field");
+	ok(long_column && long_column->type == COLUMNAR_COLUMN_TYPE_LIST_INT64,
+		"sequence table - `payload.seq_long_field` list column");
+	if (!ts_column || !int_column || !long_column) {
+		exit(EXIT_FAILURE);
+	}
+
+	len_column = columnar_reader_table_borrow_column_by_name(table,
+		"payload._seq_int_field_length");
+	ok(len_column && len_column->type == COLUMNAR_COLUMN_TYPE_UINT64,
+		"sequence table - `payload._seq_int_field_length` column");
+	if (!len_column) {
+		exit(EXIT_FAILURE);
+	}
+
+	for (row = 0; row < table->row_count; row++) {
+		const void *data;
+
+		if (columnar_reader_column_get_unsigned_int(len_column, row) !=
+				columnar_reader_column_borrow_var_value(
+					int_column, row, &data)) {
+			lens_match = false;
+		}
+	}
+
+	ok(lens_match,
+		"sequence table - list lengths match the length fields");
+
+	for (row = 1; row < table->row_count; row++) {
+		if (columnar_reader_column_get_signed_int(ts_column, row) <
+				columnar_reader_column_get_signed_int(
+					ts_column, row - 1)) {
+			ts_sorted = false;
+		}
+	}
+
+	ok(ts_sorted, "sequence table - timestamps are sorted");
+
+	ok(columnar_reader_table_open("/nonexistent") == NULL,
+		"Opening a nonexistent table fails");
+	columnar_reader_table_close(table);
+}
+
+int main(int argc, char **argv)
+{
+	plan_tests(NR_TESTS);
+
+	if (argc != 4) {
+		return EXIT_FAILURE;
+	}
+
+	test_smalltrace(argv[1]);
+	test_sequence(argv[2], g_ascii_strtoull(argv[3], NULL, 10));
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,257 @@
+/*
+ * test_ctf_metadata_decoder.c
+ *
+ * CTF metadata decoder incremental decoding tests
+ *
+ * Copyright (C) - 2019 EfficiOS Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; under version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <babeltrace/babeltrace.h>
+#include <babeltrace/assert-internal.h>
+#include <babeltrace/compat/memstream-internal.h>
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <glib.h>
+
+#include "ctf/common/metadata/decoder.h"
+#include "ctf/common/metadata/ctf-meta.h"
+
+#include "tap/tap.h"
+
+#define NR_TESTS		8
+
+/* Number of event class chunks of the parse work test */
+#define CHUNK_COUNT		2000
+
+static const char first_chunk[] =
+	"/* CTF 1.8 */\n"
+	"typealias integer { size = 32; align = 8; signed = false; } := uint32_t;\n"
+	"typealias integer { size = 64; align = 8; signed = false; } := uint64_t;\n"
+	"trace {\n"
+	"	major = 1;\n"
+	"	minor = 8;\n"
+	"	byte_order = le;\n"
+	"	packet.header := struct {\n"
+	"		uint32_t magic;\n"
+	"		uint32_t stream_id;\n"
+	"	};\n"
+	"};\n"
+	"clock {\n"
+	"	name = \"monotonic\";\n"
+	"	freq = 1000000000;\n"
+	"};\n"
+	"typealias integer {\n"
+	"	size = 64; align = 8; signed = false;\n"
+	"	map = clock.monotonic.value;\n"
+	"} := uint64_clock_t;\n"
+	"stream {\n"
+	"	id = 0;\n"
+	"	packet.context := struct {\n"
+	"		uint64_clock_t timestamp_begin;\n"
+	"		uint64_clock_t timestamp_end;\n"
+	"		uint64_t content_size;\n"
+	"		uint64_t packet_size;\n"
+	"	};\n"
+	"	event.header := struct {\n"
+	"		uint32_t id;\n"
+	"		uint64_clock_t timestamp;\n"
+	"	};\n"
+	"};\n";
+
+static const char int16_chunk[] =
+	"typealias integer { size = 16; align = 8; signed = true; } := int16_t;\n"
+	"event {\n"
+	"	name = \"with_new_type\";\n"
+	"	id = 0;\n"
+	"	stream_id = 0;\n"
+	"	fields := struct {\n"
+	"		uint64_t first_chunk_type;\n"
+	"		int16_t this_chunk_type;\n"
+	"	};\n"
+	"};\n";
+
+static const char incomplete_chunk[] =
+	"event {\n"
+	"	name = \"split\";\n"
+	"	id = 2;\n";
+
+static const char completed_chunk[] =
+	"event {\n"
+	"	name = \"split\";\n"
+	"	id = 2;\n"
+	"	stream_id = 0;\n"
+	"	fields := struct {\n"
+	"		uint32_t value;\n"
+	"	};\n"
+	"};\n";
+
+/* First event class ID of the parse work test */
+#define FIRST_CHUNK_EVENT_ID	3
+
+static
+enum ctf_metadata_decoder_status decode(struct ctf_metadata_decoder *mdec,
+		const char *text)
+{
+	enum ctf_metadata_decoder_status status;
+	FILE *fp;
+	int ret;
+
+	fp = bt_fmemopen((void *) text, strlen(text), "rb");
+	BT_ASSERT(fp);
+	status = ctf_metadata_decoder_decode(mdec, fp);
+	ret = fclose(fp);
+	BT_ASSERT(ret == 0);
+	return status;
+}
+
+static
+uint64_t event_class_count(struct ctf_metadata_decoder *mdec)
+{
+	struct ctf_trace_class *tc =
+		ctf_metadata_decoder_borrow_ctf_trace_class(mdec);
+	struct ctf_stream_class *sc;
+
+	BT_ASSERT(tc->stream_classes->len == 1);
+	sc = tc->stream_classes->pdata[0];
+	return sc->event_classes->len;
+}
+
+/*
+ * Decodes `CHUNK_COUNT` chunks of one event class each, checking that
+ * the decoder parses and visits only the new chunk every time instead
+ * of all the metadata so far. Counting the top-level AST nodes instead
+ * of timing the calls keeps this test deterministic.
+ */
+static
+void test_parse_work(struct ctf_metadata_decoder *mdec)
+{
+	GString *chunk = g_string_new(NULL);
+	bool all_ok = true;
+	bool work_is_constant = true;
+	uint64_t i;
+
+	BT_ASSERT(chunk);
+
+	for (i = 0; i < CHUNK_COUNT; i++) {
+		uint64_t id = FIRST_CHUNK_EVENT_ID + i;
+		enum ctf_metadata_decoder_status status;
+		uint64_t node_count;
+
+		g_string_printf(chunk,
+			"event {\n"
+			"	name = \"event_%" PRIu64 "\";\n"
+			"	id = %" PRIu64 ";\n"
+			"	stream_id = 0;\n"
+			"	fields := struct {\n"
+			"		uint32_t a;\n"
+			"		uint64_t b;\n"
+			"		int16_t c;\n"
+			"		string d;\n"
+			"	};\n"
+			"};\n", id, id);
+		status = decode(mdec, chunk->str);
+		if (status != CTF_METADATA_DECODER_STATUS_OK) {
+			diag("Cannot decode chunk #%" PRIu64 ": status=%d",
+				i, status);
+			all_ok = false;
+			break;
+		}
+
+		node_count = ctf_metadata_decoder_get_last_chunk_node_count(
+			mdec);
+		if (node_count != 1 && work_is_constant) {
+			diag("Chunk #%" PRIu64 " has %" PRIu64 " top-level "
+				"AST nodes instead of 1", i, node_count);
+			work_is_constant = false;
+		}
+	}
+
+	ok(all_ok, "chunks of one event class each are decoded");
+	ok(event_class_count(mdec) == FIRST_CHUNK_EVENT_ID + CHUNK_COUNT,
+		"trace class has all the event classes");
+	ok(all_ok && work_is_constant,
+		"decoding a chunk does not parse the previous chunks again");
+	g_string_free(chunk, TRUE);
+}
+
+static
+bt_self_component_status src_init(
+	bt_self_component_source *self_comp,
+	const bt_value *params, void *init_method_data)
+{
+	struct ctf_metadata_decoder *mdec;
+
+	/* The decoder needs a component to create IR objects */
+	mdec = ctf_metadata_decoder_create(self_comp, NULL);
+	BT_ASSERT(mdec);
+	ok(decode(mdec, first_chunk) == CTF_METADATA_DECODER_STATUS_OK,
+		"first chunk is decoded");
+	ok(decode(mdec, int16_chunk) == CTF_METADATA_DECODER_STATUS_OK,
+		"chunk uses types of a previous chunk and of its own");
+	ok(decode(mdec,
+		"event {\n"
+		"	name = \"with_previous_type\";\n"
+		"	id = 1;\n"
+		"	stream_id = 0;\n"
+		"	fields := struct {\n"
+		"		int16_t value;\n"
+		"	};\n"
+		"};\n") == CTF_METADATA_DECODER_STATUS_OK,
+		"chunk uses a type declared by a chunk other than the first");
+	ok(decode(mdec, incomplete_chunk) ==
+		CTF_METADATA_DECODER_STATUS_INCOMPLETE,
+		"incomplete chunk is reported as such");
+	ok(decode(mdec, completed_chunk) == CTF_METADATA_DECODER_STATUS_OK &&
+		event_class_count(mdec) == FIRST_CHUNK_EVENT_ID,
+		"incomplete chunk is decoded once completed");
+	test_parse_work(mdec);
+	ctf_metadata_decoder_destroy(mdec);
+	return BT_SELF_COMPONENT_STATUS_OK;
+}
+
+static
+bt_self_message_iterator_status src_iter_next(
+		bt_self_message_iterator *self_iterator,
+		bt_message_array_const msgs, uint64_t capacity,
+		uint64_t *count)
+{
+	return BT_SELF_MESSAGE_ITERATOR_STATUS_ERROR;
+}
+
+int main(int argc, char **argv)
+{
+	bt_component_class_source *comp_cls;
+	bt_graph *graph;
+	int ret;
+
+	plan_tests(NR_TESTS);
+
+	/* The decoder needs a component: run the tests in its init */
+	comp_cls = bt_component_class_source_create("src", src_iter_next);
+	BT_ASSERT(comp_cls);
+	ret = bt_component_class_source_set_init_method(comp_cls, src_init);
+	BT_ASSERT(ret == 0);
+	graph = bt_graph_create();
+	BT_ASSERT(graph);
+	ret = bt_graph_add_source_component(graph, comp_cls, "src-comp",
+		NULL, NULL);
+	BT_ASSERT(ret == 0);
+	bt_graph_put_ref(graph);
+	bt_component_class_source_put_ref(comp_cls);
+	return exit_status();
+}
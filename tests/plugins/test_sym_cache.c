@@ -0,0 +1,256 @@
+/*
+ * test_sym_cache.c
+ *
+ * Babeltrace debug-info symbolization cache tests
+ *
+ * Copyright (c) 2019 EfficiOS Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; under version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <glib.h>
+
+#include <babeltrace/assert-internal.h>
+#include <lttng-utils/debug-info/sym-cache.h>
+
+#include "tap/tap.h"
+
+#define NR_TESTS 14
+#define BUILD_ID_LEN 20
+#define FUNC_FOO_ADDR 0x14ee
+#define FUNC_BAR_ADDR 0x1520
+#define UNKNOWN_ADDR 0x1600
+#define FUNC_BAZ_ADDR 0x1680
+
+static const uint8_t build_id[BUILD_ID_LEN] = {
+	0xcd, 0xd9, 0x8c, 0xdd, 0x87, 0xf7, 0xfe, 0x64, 0xc1, 0x3b,
+	0x6d, 0xaa, 0xd5, 0x53, 0x98, 0x7e, 0xaf, 0xd4, 0x0c, 0xbb
+};
+
+static const uint8_t other_build_id[BUILD_ID_LEN] = {
+	0xcd, 0xd9, 0x8c, 0xdd, 0x87, 0xf7, 0xfe, 0x64, 0xc1, 0x3b,
+	0x6d, 0xaa, 0xd5, 0x53, 0x98, 0x7e, 0xaf, 0xd4, 0x0c, 0xbc
+};
+
+static
+bool str_eq(const char *a, const char *b)
+{
+	if (!a || !b) {
+		return a == b;
+	}
+
+	return strcmp(a, b) == 0;
+}
+
+/*
+ * Returns whether or not the cache has the expected entry for `addr`
+ * within the binary having the build ID `build_id`.
+ */
+static
+bool entry_is(struct sym_cache *cache, const uint8_t *bid, uint64_t addr,
+		const char *func_name, const char *src_path, uint64_t line_no)
+{
+	struct sym_cache_entry entry;
+	bool found;
+	int ret;
+
+	ret = sym_cache_lookup(cache, bid, BUILD_ID_LEN, addr, &entry, &found);
+	BT_ASSERT(ret == 0);
+	if (!found) {
+		diag("Address %#" PRIx64 " is not in the cache", addr);
+		return false;
+	}
+
+	if (!str_eq(entry.func_name, func_name) ||
+			!str_eq(entry.src_path, src_path) ||
+			(src_path && entry.line_no != line_no)) {
+		diag("Unexpected entry for address %#" PRIx64 ": "
+			"func-name=\"%s\", src-path=\"%s\", line-no=%" PRIu64,
+			addr, entry.func_name ? entry.func_name : "(null)",
+			entry.src_path ? entry.src_path : "(null)",
+			entry.line_no);
+		return false;
+	}
+
+	return true;
+}
+
+static
+bool is_missing(struct sym_cache *cache, const uint8_t *bid, uint64_t addr)
+{
+	struct sym_cache_entry entry;
+	bool found;
+	int ret;
+
+	ret = sym_cache_lookup(cache, bid, BUILD_ID_LEN, addr, &entry, &found);
+	BT_ASSERT(ret == 0);
+	return !found;
+}
+
+static
+void add_entry(struct sym_cache *cache, uint64_t addr, const char *func_name,
+		const char *src_path, uint64_t line_no)
+{
+	struct sym_cache_entry entry = {
+		.func_name = func_name,
+		.src_path = src_path,
+		.line_no = line_no,
+	};
+
+	ok(sym_cache_add(cache, build_id, BUILD_ID_LEN, addr, &entry) == 0,
+		"sym_cache_add successful (address %#" PRIx64 ")", addr);
+}
+
+static
+gchar *cache_file_path(const char *cache_dir)
+{
+	gchar *path = g_strdup_printf("%s/"
+		"cdd98cdd87f7fe64c13b6daad553987eafd40cbb.symcache",
+		cache_dir);
+
+	BT_ASSERT(path);
+	return path;
+}
+
+/* Appends a truncated record to the cache file of `build_id`. */
+static
+void append_truncated_record(const char *cache_dir)
+{
+	gchar *path = cache_file_path(cache_dir);
+	FILE *file;
+	static const uint8_t garbage[] = { 0x40, 0, 0, 0, 0x12, 0x34 };
+	size_t count;
+	int ret;
+
+	file = fopen(path, "ab");
+	BT_ASSERT(file);
+	count = fwrite(garbage, sizeof(garbage), 1, file);
+	BT_ASSERT(count == 1);
+	ret = fclose(file);
+	BT_ASSERT(ret == 0);
+	g_free(path);
+}
+
+/*
+ * Corrupts the first record of the cache file of `build_id`, which
+ * directly follows the 16-byte file header.
+ */
+static
+void corrupt_first_record(const char *cache_dir)
+{
+	gchar *path = cache_file_path(cache_dir);
+	FILE *file;
+	int ch;
+	int ret;
+
+	file = fopen(path, "r+b");
+	BT_ASSERT(file);
+
+	/* Within the record's address */
+	ret = fseek(file, 16 + 8, SEEK_SET);
+	BT_ASSERT(ret == 0);
+	ch = fgetc(file);
+	BT_ASSERT(ch != EOF);
+	ret = fseek(file, 16 + 8, SEEK_SET);
+	BT_ASSERT(ret == 0);
+	ret = fputc(ch ^ 0xff, file);
+	BT_ASSERT(ret != EOF);
+	ret = fclose(file);
+	BT_ASSERT(ret == 0);
+	g_free(path);
+}
+
+int main(int argc, char **argv)
+{
+	struct sym_cache *cache;
+	gchar *cache_dir;
+
+	if (argc != 2) {
+		fprintf(stderr, "Usage: %s TMPDIR\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	plan_tests(NR_TESTS);
+
+	/* The cache directory does not exist yet */
+	cache_dir = g_build_filename(argv[1], "cache", NULL);
+	BT_ASSERT(cache_dir);
+
+	diag("symbolization cache tests - first run");
+	cache = sym_cache_create(cache_dir);
+	BT_ASSERT(cache);
+	ok(is_missing(cache, build_id, FUNC_FOO_ADDR),
+		"address is not in an empty cache");
+	add_entry(cache, FUNC_FOO_ADDR, "foo+0xc3", "/efficios/libhello.c", 8);
+	add_entry(cache, FUNC_BAR_ADDR, "bar", NULL, 0);
+	add_entry(cache, UNKNOWN_ADDR, NULL, NULL, 0);
+	ok(entry_is(cache, build_id, FUNC_FOO_ADDR, "foo+0xc3",
+		"/efficios/libhello.c", 8),
+		"added entry is found by the same cache");
+	sym_cache_destroy(cache);
+
+	diag("symbolization cache tests - second run");
+	cache = sym_cache_create(cache_dir);
+	BT_ASSERT(cache);
+	ok(entry_is(cache, build_id, FUNC_FOO_ADDR, "foo+0xc3",
+		"/efficios/libhello.c", 8),
+		"function name and source location are found in a new cache");
+	ok(entry_is(cache, build_id, FUNC_BAR_ADDR, "bar", NULL, 0) &&
+		entry_is(cache, build_id, UNKNOWN_ADDR, NULL, NULL, 0),
+		"entries without source location or function name are found");
+	ok(is_missing(cache, other_build_id, FUNC_FOO_ADDR),
+		"entries are specific to a build ID");
+	add_entry(cache, FUNC_FOO_ADDR, "other", NULL, 0);
+	ok(entry_is(cache, build_id, FUNC_FOO_ADDR, "foo+0xc3",
+		"/efficios/libhello.c", 8),
+		"adding an existing entry keeps the original one");
+	sym_cache_destroy(cache);
+
+	diag("symbolization cache tests - truncated record");
+	append_truncated_record(cache_dir);
+	cache = sym_cache_create(cache_dir);
+	BT_ASSERT(cache);
+	ok(entry_is(cache, build_id, FUNC_FOO_ADDR, "foo+0xc3",
+		"/efficios/libhello.c", 8) &&
+		entry_is(cache, build_id, FUNC_BAR_ADDR, "bar", NULL, 0),
+		"entries before a truncated record are found");
+	add_entry(cache, FUNC_BAZ_ADDR, "baz", NULL, 0);
+	sym_cache_destroy(cache);
+
+	diag("symbolization cache tests - after a truncated record");
+	cache = sym_cache_create(cache_dir);
+	BT_ASSERT(cache);
+	ok(entry_is(cache, build_id, FUNC_BAR_ADDR, "bar", NULL, 0) &&
+		entry_is(cache, build_id, FUNC_BAZ_ADDR, "baz", NULL, 0),
+		"entries appended after a truncated record are found");
+	sym_cache_destroy(cache);
+
+	diag("symbolization cache tests - corrupted record");
+	corrupt_first_record(cache_dir);
+	cache = sym_cache_create(cache_dir);
+	BT_ASSERT(cache);
+	ok(is_missing(cache, build_id, FUNC_FOO_ADDR) &&
+		entry_is(cache, build_id, FUNC_BAR_ADDR, "bar", NULL, 0) &&
+		entry_is(cache, build_id, FUNC_BAZ_ADDR, "baz", NULL, 0),
+		"entries after a corrupted record are found");
+	sym_cache_destroy(cache);
+
+	g_free(cache_dir);
+	return exit_status();
+}